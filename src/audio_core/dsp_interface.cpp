@@ -7,6 +7,7 @@
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "core/settings.h"
 
 namespace AudioCore {
@@ -86,4 +87,9 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     }
 }
 
+void DspInterface::DoState(PointerWrap& p) {
+    LOG_ERROR(Audio_DSP, "Save states are not supported by this DSP implementation");
+    p.SetError(PointerWrap::ERROR_FAILURE);
+}
+
 } // namespace AudioCore
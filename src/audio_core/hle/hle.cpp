@@ -16,6 +16,7 @@
 #include "audio_core/hle/source.h"
 #include "audio_core/sink.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
@@ -46,6 +47,8 @@ public:
 
     void SetServiceToInterrupt(std::weak_ptr<DSP_DSP> dsp);
 
+    void DoState(PointerWrap& p);
+
 private:
     void ResetPipes();
     void WriteU16(DspPipe pipe_number, u16 value);
@@ -266,6 +269,20 @@ std::array<u8, Memory::DSP_RAM_SIZE>& DspHle::Impl::GetDspMemory() {
     return dsp_memory.raw_memory;
 }
 
+void DspHle::Impl::DoState(PointerWrap& p) {
+    auto section = p.Section("DspHle", 1);
+    if (!section) {
+        return;
+    }
+
+    // The sources and mixers are reconfigured by the application through the shared memory
+    p.DoArray(dsp_memory.raw_memory.data(), static_cast<int>(dsp_memory.raw_memory.size()));
+    p.Do(dsp_state);
+    for (auto& pipe : pipe_data) {
+        p.Do(pipe);
+    }
+}
+
 void DspHle::Impl::SetServiceToInterrupt(std::weak_ptr<DSP_DSP> dsp) {
     dsp_dsp = std::move(dsp);
 }
@@ -454,4 +471,8 @@ void DspHle::UnloadComponent() {
     // Do nothing
 }
 
+void DspHle::DoState(PointerWrap& p) {
+    impl->DoState(p);
+}
+
 } // namespace AudioCore
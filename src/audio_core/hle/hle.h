@@ -38,6 +38,8 @@ public:
     void LoadComponent(const std::vector<u8>& buffer) override;
     void UnloadComponent() override;
 
+    void DoState(PointerWrap& p) override;
+
 private:
     struct Impl;
     friend struct Impl;
@@ -2,11 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <regex>
 #include <string>
 #include <thread>
+#include <vector>
 
 // This needs to be included before getopt.h because the latter #defines symbols used by it
 #include "common/microprofile.h"
@@ -31,6 +33,7 @@
 #include "common/string_util.h"
 #include "core/core.h"
 #include "core/file_sys/cia_container.h"
+#include "core/file_sys/compressed_image.h"
 #include "core/frontend/applets/default_applets.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/service/am/am.h"
@@ -57,7 +60,10 @@ static void PrintHelp(const char* argv0) {
     std::cout << "Usage: " << argv0
               << " [options] <filename>\n"
                  "-g, --gdbport=NUMBER Enable gdb stub on port NUMBER\n"
-                 "-i, --install=FILE    Installs a specified CIA file\n"
+                 "-i, --install=FILE    Installs a specified CIA file, can be given several"
+                 " times to install CIAs concurrently\n"
+                 "-z, --compress=FILE   Converts the ROM to a compressed image (.zcci, .zcxi)"
+                 " written to FILE, and exits\n"
                  "-m, --multiplayer=nick:password@address:port"
                  " Nickname, password, address and port for multiplayer\n"
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
@@ -187,6 +193,8 @@ int main(int argc, char** argv) {
     u32 gdb_port = static_cast<u32>(Settings::values.gdbstub_port);
     std::string movie_record;
     std::string movie_play;
+    std::string compress_path;
+    std::vector<std::string> install_paths;
 
     InitializeLogging();
 
@@ -212,6 +220,7 @@ int main(int argc, char** argv) {
     static struct option long_options[] = {
         {"gdbport", required_argument, 0, 'g'},
         {"install", required_argument, 0, 'i'},
+        {"compress", required_argument, 0, 'z'},
         {"multiplayer", required_argument, 0, 'm'},
         {"movie-record", required_argument, 0, 'r'},
         {"movie-play", required_argument, 0, 'p'},
@@ -222,7 +231,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:z:m:r:p:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -236,17 +245,12 @@ int main(int argc, char** argv) {
                     exit(1);
                 }
                 break;
-            case 'i': {
-                const auto cia_progress = [](std::size_t written, std::size_t total) {
-                    LOG_INFO(Frontend, "{:02d}%", (written * 100 / total));
-                };
-                if (Service::AM::InstallCIA(std::string(optarg), cia_progress) !=
-                    Service::AM::InstallStatus::Success)
-                    errno = EINVAL;
-                if (errno != 0)
-                    exit(1);
+            case 'i':
+                install_paths.emplace_back(optarg);
+                break;
+            case 'z':
+                compress_path = optarg;
                 break;
-            }
             case 'm': {
                 use_multiplayer = true;
                 const std::string str_arg(optarg);
@@ -310,6 +314,18 @@ int main(int argc, char** argv) {
     LocalFree(argv_w);
 #endif
 
+    if (!install_paths.empty()) {
+        const auto cia_progress = [&install_paths](std::size_t index, std::size_t written,
+                                                   std::size_t total) {
+            LOG_INFO(Frontend, "{}: {:02d}%", install_paths[index], (written * 100 / total));
+        };
+        const auto statuses = Service::AM::InstallCIAs(install_paths, cia_progress);
+        if (std::any_of(statuses.begin(), statuses.end(), [](Service::AM::InstallStatus status) {
+                return status != Service::AM::InstallStatus::Success;
+            }))
+            exit(1);
+    }
+
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
 
@@ -318,6 +334,18 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!compress_path.empty()) {
+        const auto compress_progress = [](std::size_t written, std::size_t total) {
+            LOG_INFO(Frontend, "{:02d}%", (written * 100 / total));
+        };
+        if (FileSys::CompressImage(filepath, compress_path, compress_progress) !=
+            Loader::ResultStatus::Success) {
+            LOG_CRITICAL(Frontend, "Failed to compress {}", filepath);
+            return -1;
+        }
+        return 0;
+    }
+
     if (!movie_record.empty() && !movie_play.empty()) {
         LOG_CRITICAL(Frontend, "Cannot both play and record a movie");
         return -1;
@@ -0,0 +1,662 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// Runs a batch of titles, optionally playing back a movie in each, without showing any window.
+// Every title runs for a fixed number of frames in a process of its own: the core is built around
+// process-wide state (Core::System, the GPU registers, the Pica state, the settings), so processes
+// are what isolates the instances from each other. A pool of threads keeps a given number of these
+// processes running, and each of them records the hash of the displayed framebuffers at every
+// frame along with timing reports. The hashes can be checked against golden files, and the runs
+// against a frame time budget, which makes the runner usable as a regression gate.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <set>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+// This needs to be included before getopt.h because the latter #defines symbols used by it
+#include "common/microprofile.h"
+
+#ifdef _WIN32
+// windows.h needs to be included before shellapi.h
+#include <windows.h>
+
+#include <shellapi.h>
+#endif
+
+#include "citra/config.h"
+#include "citra/emu_window/emu_window_sdl2.h"
+#include "common/common_paths.h"
+#include "common/detached_tasks.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/string_util.h"
+#include "common/thread_pool.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/applets/default_applets.h"
+#include "core/movie.h"
+#include "core/settings.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// A title to run, and the movie to play back while running it, if any
+struct Job {
+    std::string title;
+    std::string movie;
+    /// File holding the expected hashes of the frames, if any
+    std::string golden;
+};
+
+/// How the instances run and check their job
+struct InstanceOptions {
+    /// Number of frames to run for, or 0 to run until the movie of the job ends
+    u32 frames = 0;
+    /// Whether to write the hashes of the frames to the golden file instead of checking them
+    bool update_golden = false;
+    /// Largest mean wall time of a frame, in milliseconds, or 0 for no limit
+    double max_frame_ms = 0.0;
+};
+
+using FrameHashes = RendererBase::FrameHashes;
+
+constexpr char ReportHeader[] = "title,movie,result,frames,mismatch_frame,emulated_ms,wall_ms,"
+                                "mean_frame_ms,max_frame_ms,speed\n";
+constexpr char FramesHeader[] =
+    "frame,emulated_us,wall_us,top_hash,top_right_hash,bottom_hash\n";
+constexpr char GoldenHeader[] = "frame,top_hash,top_right_hash,bottom_hash\n";
+
+} // Anonymous namespace
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] [<filename>...]\n"
+                 "-n, --frames=NUMBER  Number of frames to run each title for, 0 to run until\n"
+                 "                     the movie ends\n"
+                 "-j, --jobs=NUMBER    Number of titles to run in parallel (default: one per\n"
+                 "                     core)\n"
+                 "-l, --list=FILE      Reads titles to run from FILE, one per line, each\n"
+                 "                     optionally followed by a tab and a movie to play back\n"
+                 "-o, --output=DIR     Directory receiving the frame hashes and the reports\n"
+                 "                     (default: headless)\n"
+                 "-g, --golden=DIR     Checks the frame hashes against the golden files in DIR,\n"
+                 "                     named after the movie or the title that is run\n"
+                 "-u, --update-golden  Writes the golden files instead of checking them\n"
+                 "--max-frame-ms=TIME  Fails the runs whose mean frame time exceeds TIME\n"
+                 "-h, --help           Display this help and exit\n"
+                 "-v, --version        Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+static void InitializeLogging(const std::string& log_file) {
+    Log::Filter log_filter(Log::Level::Debug);
+    log_filter.ParseFilterString(Settings::values.log_filter);
+    Log::SetGlobalFilter(log_filter);
+
+    // The instances log to a file of their own, as their output would be interleaved otherwise
+    if (log_file.empty()) {
+        Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+    } else {
+        Log::AddBackend(std::make_unique<Log::FileBackend>(log_file));
+    }
+#ifdef _WIN32
+    Log::AddBackend(std::make_unique<Log::DebuggerBackend>());
+#endif
+}
+
+/// Overrides the settings that would make two runs of a title differ, or slow them down
+static void ApplyDeterministicSettings() {
+    Settings::values.use_hw_renderer = false;
+    Settings::values.use_hw_shader = false;
+    Settings::values.async_shader_compilation = false;
+    Settings::values.async_surface_downloads = false;
+    // The instances already run in parallel
+    Settings::values.sw_renderer_threads = 1;
+    Settings::values.sw_shader_threads = 1;
+    Settings::values.enable_dsp_lle_multithread = false;
+    Settings::values.resolution_factor = 1;
+    Settings::values.vsync_enabled = false;
+    Settings::values.use_frame_limit = false;
+    Settings::values.init_clock = Settings::InitClock::FixedTime;
+    Settings::values.sink_id = "null";
+    Settings::values.use_gdbstub = false;
+    Settings::values.enable_telemetry = false;
+    Settings::Apply();
+}
+
+static std::string FormatHashes(const FrameHashes& hashes) {
+    return fmt::format("{:016x},{:016x},{:016x}", hashes[0], hashes[1], hashes[2]);
+}
+
+static bool ReadGoldenFile(const std::string& path, std::vector<FrameHashes>& frames) {
+    std::string golden;
+    if (!FileUtil::Exists(path) || FileUtil::ReadFileToString(true, path, golden) == 0) {
+        LOG_ERROR(Frontend, "Failed to read the golden file {}", path);
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    Common::SplitString(golden, '\n', lines);
+    for (std::size_t i = 1; i < lines.size(); ++i) {
+        if (lines[i].empty() || lines[i] == "\r") {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        Common::SplitString(lines[i], ',', fields);
+        FrameHashes hashes{};
+        bool valid = fields.size() == hashes.size() + 1 && fields[0] == std::to_string(i - 1);
+        for (std::size_t j = 0; valid && j < hashes.size(); ++j) {
+            char* end;
+            hashes[j] = std::strtoull(fields[j + 1].c_str(), &end, 16);
+            valid = end != fields[j + 1].c_str() && (*end == '\0' || *end == '\r');
+        }
+        if (!valid) {
+            LOG_ERROR(Frontend, "Invalid line {} in the golden file {}", i + 1, path);
+            return false;
+        }
+        frames.push_back(hashes);
+    }
+    return true;
+}
+
+static bool WriteGoldenFile(const std::string& path, const std::vector<FrameHashes>& frames) {
+    std::string golden = GoldenHeader;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        golden += fmt::format("{},{}\n", i, FormatHashes(frames[i]));
+    }
+    if (FileUtil::WriteStringToFile(true, path, golden) != golden.size()) {
+        LOG_ERROR(Frontend, "Failed to write the golden file {}", path);
+        return false;
+    }
+    return true;
+}
+
+static std::string EscapeCsv(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+
+    std::string escaped = "\"";
+    for (const char c : value) {
+        if (c == '"') {
+            escaped += '"';
+        }
+        escaped += c;
+    }
+    return escaped + '"';
+}
+
+/**
+ * Runs a job in the current process, and writes its report and the hashes and times of its frames
+ * to a directory.
+ * @return The exit code of the process
+ */
+static int RunInstance(const Job& job, const InstanceOptions& options,
+                       const std::string& directory) {
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    std::vector<FrameHashes> frames;
+    std::string result = "ok";
+    std::string mismatch_frame;
+    std::chrono::microseconds emulated_time{0};
+    Clock::duration wall_time{0};
+    Clock::duration max_frame_time{0};
+
+    const auto write_report = [&] {
+        const double wall_ms = Milliseconds(wall_time).count();
+        const double emulated_ms = Milliseconds(emulated_time).count();
+        const std::string report = fmt::format(
+            "{}{},{},{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}\n", ReportHeader,
+            EscapeCsv(job.title), EscapeCsv(job.movie), result, frames.size(), mismatch_frame,
+            emulated_ms, wall_ms, frames.empty() ? 0.0 : wall_ms / frames.size(),
+            Milliseconds(max_frame_time).count(), wall_ms != 0.0 ? emulated_ms / wall_ms : 0.0);
+        FileUtil::WriteStringToFile(true, directory + "report.csv", report);
+    };
+
+    if (!job.movie.empty()) {
+        Core::Movie::GetInstance().PrepareForPlayback(job.movie);
+    }
+
+    ApplyDeterministicSettings();
+    Frontend::RegisterDefaultApplets();
+
+    auto emu_window = std::make_unique<EmuWindow_SDL2>(false, true);
+
+    Core::System& system{Core::System::GetInstance()};
+    SCOPE_EXIT({ system.Shutdown(); });
+
+    const Core::System::ResultStatus load_result{system.Load(*emu_window, job.title)};
+    if (load_result != Core::System::ResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to load {} ({})", job.title,
+                     static_cast<u32>(load_result));
+        result = "load_failed";
+        write_report();
+        return 1;
+    }
+
+    std::atomic<bool> movie_ended{false};
+    if (!job.movie.empty()) {
+        Core::Movie::GetInstance().StartPlayback(job.movie, [&movie_ended] { movie_ended = true; });
+    }
+    SCOPE_EXIT({ Core::Movie::GetInstance().Shutdown(); });
+
+    FileUtil::IOFile frames_file(directory + "frames.csv", "w");
+    frames_file.WriteString(FramesHeader);
+
+    const auto start_wall = Clock::now();
+    auto frame_start_wall = start_wall;
+    auto frame_start_emulated = system.CoreTiming().GetGlobalTimeUs();
+
+    VideoCore::g_renderer->SetFrameCallback([&](const FrameHashes& hashes) {
+        const auto now_wall = Clock::now();
+        const auto now_emulated = system.CoreTiming().GetGlobalTimeUs();
+        const auto frame_time = now_wall - frame_start_wall;
+        max_frame_time = std::max(max_frame_time, frame_time);
+
+        frames_file.WriteString(fmt::format(
+            "{},{},{},{}\n", frames.size(), (now_emulated - frame_start_emulated).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(frame_time).count(),
+            FormatHashes(hashes)));
+        frames.push_back(hashes);
+
+        emulated_time += now_emulated - frame_start_emulated;
+        frame_start_wall = now_wall;
+        frame_start_emulated = now_emulated;
+    });
+    SCOPE_EXIT({ VideoCore::g_renderer->SetFrameCallback(nullptr); });
+
+    while (options.frames == 0 || frames.size() < options.frames) {
+        if (!emu_window->IsOpen()) {
+            result = "interrupted";
+            break;
+        }
+        if (options.frames == 0 && movie_ended) {
+            break;
+        }
+
+        const Core::System::ResultStatus run_result = system.RunLoop();
+        if (run_result == Core::System::ResultStatus::ShutdownRequested) {
+            result = "shutdown";
+            break;
+        }
+        if (run_result != Core::System::ResultStatus::Success) {
+            result = "error";
+            break;
+        }
+    }
+    wall_time = Clock::now() - start_wall;
+
+    const bool completed = result == "ok" || result == "shutdown";
+    if (completed && !job.golden.empty()) {
+        if (options.update_golden) {
+            if (!WriteGoldenFile(job.golden, frames)) {
+                result = "error";
+            }
+        } else {
+            std::vector<FrameHashes> golden;
+            if (!ReadGoldenFile(job.golden, golden)) {
+                result = "no_golden";
+            } else {
+                const auto mismatch = std::mismatch(frames.begin(), frames.end(), golden.begin(),
+                                                    golden.end());
+                if (mismatch.first != frames.end() || mismatch.second != golden.end()) {
+                    result = "mismatch";
+                    mismatch_frame = std::to_string(mismatch.first - frames.begin());
+                    LOG_ERROR(Frontend, "Frame {} differs from the golden file {}",
+                              mismatch_frame, job.golden);
+                }
+            }
+        }
+    }
+
+    if (result == "ok" && options.max_frame_ms != 0.0 && !frames.empty() &&
+        Milliseconds(wall_time).count() / frames.size() > options.max_frame_ms) {
+        result = "slow";
+    }
+
+    write_report();
+    return result == "ok" || result == "shutdown" ? 0 : 1;
+}
+
+static std::string QuoteArgument(const std::string& argument) {
+#ifdef _WIN32
+    std::string quoted = "\"";
+    for (const char c : argument) {
+        if (c == '"') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+#else
+    std::string quoted = "'";
+    for (const char c : argument) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + '\'';
+#endif
+}
+
+static int RunCommand(const std::string& command) {
+#ifdef _WIN32
+    // cmd.exe strips the outer quotes of a command line that starts with a quoted argument
+    return _wsystem(Common::UTF8ToUTF16W('"' + command + '"').c_str());
+#else
+    return std::system(command.c_str());
+#endif
+}
+
+/**
+ * Runs every job in a process of its own, at most num_workers at a time, and gathers their
+ * reports in a summary.
+ * @return The exit code of the process
+ */
+static int RunJobs(const std::string& executable, const std::vector<Job>& jobs,
+                   const InstanceOptions& options, std::size_t num_workers,
+                   const std::string& output_dir) {
+    std::vector<int> exit_codes(jobs.size());
+    const auto directory_of = [&output_dir](std::size_t index) {
+        return fmt::format("{}{:04}" DIR_SEP, output_dir, index);
+    };
+
+    {
+        Common::ThreadPool pool(std::min(num_workers, jobs.size()), "HeadlessRunner");
+        for (std::size_t i = 0; i < jobs.size(); ++i) {
+            pool.QueueWork([&, i] {
+                const std::string directory = directory_of(i);
+                FileUtil::CreateFullPath(directory);
+
+                std::string command = fmt::format(
+                    "{} --instance={} --frames={} --max-frame-ms={}", QuoteArgument(executable),
+                    QuoteArgument(directory), options.frames, options.max_frame_ms);
+                if (!jobs[i].movie.empty()) {
+                    command += " --movie=" + QuoteArgument(jobs[i].movie);
+                }
+                if (!jobs[i].golden.empty()) {
+                    command += " --golden-file=" + QuoteArgument(jobs[i].golden);
+                }
+                if (options.update_golden) {
+                    command += " --update-golden";
+                }
+                command += " -- " + QuoteArgument(jobs[i].title);
+
+                LOG_INFO(Frontend, "Running {}", jobs[i].title);
+                exit_codes[i] = RunCommand(command);
+                LOG_INFO(Frontend, "Finished {} ({})", jobs[i].title, exit_codes[i]);
+            });
+        }
+        pool.WaitForIdle();
+    }
+
+    std::string summary = ReportHeader;
+    std::size_t failures = 0;
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        std::string report;
+        FileUtil::ReadFileToString(true, directory_of(i) + "report.csv", report);
+        const std::size_t row = report.find('\n');
+        if (row == std::string::npos || row + 1 == report.size()) {
+            // The instance crashed before writing its report
+            report = fmt::format("{},{},crashed,0,,0,0,0,0,0\n", EscapeCsv(jobs[i].title),
+                                 EscapeCsv(jobs[i].movie));
+        } else {
+            report.erase(0, row + 1);
+        }
+
+        if (exit_codes[i] != 0) {
+            ++failures;
+        }
+        summary += report;
+    }
+
+    FileUtil::WriteStringToFile(true, output_dir + "summary.csv", summary);
+    std::cout << summary;
+    LOG_INFO(Frontend, "{} of {} titles ran successfully", jobs.size() - failures, jobs.size());
+    return failures == 0 ? 0 : 1;
+}
+
+/// Reads jobs from a file holding a title per line, optionally followed by a tab and a movie
+static bool ReadJobList(const std::string& path, std::vector<Job>& jobs) {
+    std::string list;
+    if (!FileUtil::Exists(path) || FileUtil::ReadFileToString(true, path, list) == 0) {
+        LOG_CRITICAL(Frontend, "Failed to read the list of titles {}", path);
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    Common::SplitString(list, '\n', lines);
+    for (std::string& line : lines) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        const std::size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            jobs.push_back({line, "", ""});
+        } else {
+            jobs.push_back({line.substr(0, tab), line.substr(tab + 1), ""});
+        }
+    }
+    return true;
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Common::DetachedTasks detached_tasks;
+    Config config;
+    int option_index = 0;
+    char* endarg;
+
+#ifdef _WIN32
+    int argc_w;
+    auto argv_w = CommandLineToArgvW(GetCommandLineW(), &argc_w);
+
+    if (argv_w == nullptr) {
+        std::cerr << "Failed to get command line arguments" << std::endl;
+        return -1;
+    }
+#endif
+
+    std::vector<Job> jobs;
+    std::string list_file;
+    std::string output_dir = "headless";
+    std::string golden_dir;
+    std::string instance_dir;
+    std::string movie;
+    std::string golden_file;
+    InstanceOptions options;
+    std::size_t num_workers = Common::ThreadPool::DefaultThreadCount();
+
+    static struct option long_options[] = {
+        {"frames", required_argument, 0, 'n'},
+        {"jobs", required_argument, 0, 'j'},
+        {"list", required_argument, 0, 'l'},
+        {"output", required_argument, 0, 'o'},
+        {"golden", required_argument, 0, 'g'},
+        {"update-golden", no_argument, 0, 'u'},
+        {"max-frame-ms", required_argument, 0, 'F'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        // Used by the runner to start the instances
+        {"instance", required_argument, 0, 'I'},
+        {"movie", required_argument, 0, 'M'},
+        {"golden-file", required_argument, 0, 'G'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "n:j:l:o:g:uhv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'n':
+            case 'j': {
+                errno = 0;
+                const unsigned long value = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || *endarg != '\0' || (arg == 'j' && value == 0))
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror(arg == 'n' ? "--frames" : "--jobs");
+                    exit(1);
+                }
+                if (arg == 'n') {
+                    options.frames = static_cast<u32>(value);
+                } else {
+                    num_workers = value;
+                }
+                break;
+            }
+            case 'l':
+                list_file = optarg;
+                break;
+            case 'o':
+                output_dir = optarg;
+                break;
+            case 'g':
+                golden_dir = optarg;
+                break;
+            case 'u':
+                options.update_golden = true;
+                break;
+            case 'F':
+                errno = 0;
+                options.max_frame_ms = strtod(optarg, &endarg);
+                if (endarg == optarg || *endarg != '\0' || options.max_frame_ms < 0.0)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--max-frame-ms");
+                    exit(1);
+                }
+                break;
+            case 'I':
+                instance_dir = optarg;
+                break;
+            case 'M':
+                movie = optarg;
+                break;
+            case 'G':
+                golden_file = optarg;
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            default:
+                PrintHelp(argv[0]);
+                return -1;
+            }
+        } else {
+#ifdef _WIN32
+            jobs.push_back({Common::UTF16ToUTF8(argv_w[optind]), "", ""});
+#else
+            jobs.push_back({argv[optind], "", ""});
+#endif
+            optind++;
+        }
+    }
+
+#ifdef _WIN32
+    LocalFree(argv_w);
+#endif
+
+    if (!instance_dir.empty()) {
+        InitializeLogging(instance_dir + "log.txt");
+        if (jobs.size() != 1) {
+            LOG_CRITICAL(Frontend, "An instance runs exactly one title");
+            return -1;
+        }
+        jobs[0].movie = movie;
+        jobs[0].golden = golden_file;
+
+        MicroProfileOnThreadCreate("EmuThread");
+        SCOPE_EXIT({ MicroProfileShutdown(); });
+
+        const int exit_code = RunInstance(jobs[0], options, instance_dir);
+        detached_tasks.WaitForAllTasks();
+        return exit_code;
+    }
+
+    InitializeLogging("");
+
+    if (!list_file.empty() && !ReadJobList(list_file, jobs)) {
+        return -1;
+    }
+    if (jobs.empty()) {
+        LOG_CRITICAL(Frontend, "No title to run");
+        return -1;
+    }
+    if (options.frames == 0) {
+        const auto has_no_movie = [](const Job& job) { return job.movie.empty(); };
+        if (std::any_of(jobs.begin(), jobs.end(), has_no_movie)) {
+            LOG_CRITICAL(Frontend, "Titles without a movie need a number of frames to run for");
+            return -1;
+        }
+    }
+
+    if (output_dir.back() != '/' && output_dir.back() != '\\') {
+        output_dir += DIR_SEP;
+    }
+    if (!FileUtil::CreateFullPath(output_dir)) {
+        LOG_CRITICAL(Frontend, "Failed to create the output directory {}", output_dir);
+        return -1;
+    }
+
+    if (options.update_golden && golden_dir.empty()) {
+        LOG_CRITICAL(Frontend, "--update-golden needs the directory of the golden files");
+        return -1;
+    }
+    if (!golden_dir.empty()) {
+        if (golden_dir.back() != '/' && golden_dir.back() != '\\') {
+            golden_dir += DIR_SEP;
+        }
+        if (options.update_golden && !FileUtil::CreateFullPath(golden_dir)) {
+            LOG_CRITICAL(Frontend, "Failed to create the golden directory {}", golden_dir);
+            return -1;
+        }
+
+        // Golden files are named after the movies, or after the titles run without one
+        std::set<std::string> names;
+        for (Job& job : jobs) {
+            std::string name;
+            Common::SplitPath(job.movie.empty() ? job.title : job.movie, nullptr, &name, nullptr);
+            if (!names.insert(name).second) {
+                LOG_CRITICAL(Frontend, "Two runs would share the golden file of {}", name);
+                return -1;
+            }
+            job.golden = golden_dir + name + ".csv";
+        }
+    }
+
+    return RunJobs(argv[0], jobs, options, num_workers, output_dir);
+}
@@ -104,6 +104,28 @@ use_hw_renderer =
 # 0: Software, 1 (default): Hardware
 use_hw_shader =
 
+# Whether to store the shaders generated for each game on disk and build them again at boot
+# 0: Off, 1 (default): On
+use_disk_shader_cache =
+
+# Whether to compile the hardware shaders in the background. Until a shader is ready, its draws
+# use the software vertex shader and a generic fragment shader, which may look less accurate.
+# 0 (default): Off, 1: On
+async_shader_compilation =
+
+# Whether to skip the draws whose shaders are still compiling, instead of using a generic shader
+# 0 (default): Off, 1: On
+async_shader_skip_draws =
+
+# Whether to hash the textures loaded from memory, to reuse the ones already decoded with the same
+# contents instead of decoding and uploading them again
+# 0 (default): Off, 1: On
+texture_content_hashing =
+
+# Whether to read back the render targets the game reads from ahead of time, without stalling
+# 0 (default): Off, 1: On
+async_surface_downloads =
+
 # Whether to use accurate multiplication in hardware shaders
 # 0: Off (Default. Faster, but causes issues in some games) 1: On (Slower, but correct)
 shaders_accurate_mul =
@@ -116,6 +138,14 @@ shaders_accurate_gs =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Number of threads used by the software renderer to rasterize triangles
+# 0: Auto (one per CPU core), 1 (default): Single-threaded, Otherwise the number of threads
+sw_renderer_threads =
+
+# Number of threads used to run vertex shaders on the CPU, when hardware shaders are not used
+# 0: Auto (one per CPU core), 1 (default): Single-threaded, Otherwise the number of threads
+sw_shader_threads =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -12,7 +12,8 @@ struct SDL_Window;
 
 class EmuWindow_SDL2 : public Frontend::EmuWindow {
 public:
-    explicit EmuWindow_SDL2(bool fullscreen);
+    /// @param hidden Whether to keep the window hidden, for runs that don't need to show it
+    explicit EmuWindow_SDL2(bool fullscreen, bool hidden = false);
     ~EmuWindow_SDL2();
 
     /// Swap buffers to display the next frame
@@ -27,6 +28,9 @@ public:
     /// Releases the GL context from the caller thread
     void DoneCurrent() override;
 
+    /// Creates a GL context sharing its objects with the one of the window
+    std::unique_ptr<Frontend::GraphicsContext> CreateSharedContext() const override;
+
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
@@ -94,11 +94,25 @@ void Config::ReadValues() {
     // Renderer
     Settings::values.use_hw_renderer = sdl2_config->GetBoolean("Renderer", "use_hw_renderer", true);
     Settings::values.use_hw_shader = sdl2_config->GetBoolean("Renderer", "use_hw_shader", true);
+    Settings::values.use_disk_shader_cache =
+        sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
+    Settings::values.async_shader_compilation =
+        sdl2_config->GetBoolean("Renderer", "async_shader_compilation", false);
+    Settings::values.async_shader_skip_draws =
+        sdl2_config->GetBoolean("Renderer", "async_shader_skip_draws", false);
+    Settings::values.texture_content_hashing =
+        sdl2_config->GetBoolean("Renderer", "texture_content_hashing", false);
+    Settings::values.async_surface_downloads =
+        sdl2_config->GetBoolean("Renderer", "async_surface_downloads", false);
     Settings::values.shaders_accurate_gs =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_gs", true);
     Settings::values.shaders_accurate_mul =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", false);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.sw_renderer_threads =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "sw_renderer_threads", 1));
+    Settings::values.sw_shader_threads =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "sw_shader_threads", 1));
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
     Settings::values.vsync_enabled = sdl2_config->GetBoolean("Renderer", "vsync_enabled", false);
@@ -19,6 +19,37 @@
 #include "input_common/motion_emu.h"
 #include "network/network.h"
 
+namespace {
+
+/// An EGL context bound to an offscreen surface, or to none if pbuffers are not supported
+class SharedContext_Android final : public Frontend::GraphicsContext {
+public:
+    SharedContext_Android(EGLDisplay display, EGLSurface surface, EGLContext context)
+        : display(display), surface(surface), context(context) {}
+
+    ~SharedContext_Android() override {
+        eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(display, surface);
+        }
+    }
+
+    void MakeCurrent() override {
+        eglMakeCurrent(display, surface, surface, context);
+    }
+
+    void DoneCurrent() override {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+private:
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+};
+
+} // Anonymous namespace
+
 void EmuWindow_Android::OnSurfaceChanged(ANativeWindow* surface) {
     render_window = surface;
 }
@@ -78,6 +109,22 @@ void EmuWindow_Android::PollEvents() {
     }
 }
 
+std::unique_ptr<Frontend::GraphicsContext> EmuWindow_Android::CreateSharedContext() const {
+    const EGLDisplay display = gl_context->GetDisplay();
+    const EGLint context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    const EGLContext context = eglCreateContext(display, gl_context->GetConfig(),
+                                                gl_context->GetContext(), context_attribs);
+    if (context == EGL_NO_CONTEXT) {
+        LOG_ERROR(Frontend, "Failed to create a shared context: {:#x}", eglGetError());
+        return nullptr;
+    }
+
+    const EGLint surface_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    const EGLSurface surface =
+        eglCreatePbufferSurface(display, gl_context->GetConfig(), surface_attribs);
+    return std::make_unique<SharedContext_Android>(display, surface, context);
+}
+
 void EmuWindow_Android::MakeCurrent() {
     gl_context->Resume(render_window);
 }
@@ -26,6 +26,9 @@ public:
     /// Releases the GL context from the caller thread
     void DoneCurrent() override;
 
+    /// Creates an EGL context sharing its objects with the one of the window
+    std::unique_ptr<Frontend::GraphicsContext> CreateSharedContext() const override;
+
     /// Called by the onSurfaceChanges() method to change the surface
     void OnSurfaceChanged(ANativeWindow* surface);
 
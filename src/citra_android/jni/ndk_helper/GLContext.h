@@ -107,6 +107,8 @@ class GLContext {
 
   EGLDisplay GetDisplay() const { return display_; }
   EGLSurface GetSurface() const { return surface_; }
+  EGLContext GetContext() const { return context_; }
+  EGLConfig GetConfig() const { return config_; }
 };
 
 }  // namespace ndkHelper
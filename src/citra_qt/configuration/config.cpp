@@ -157,9 +157,22 @@ void Config::ReadValues() {
 #else
     Settings::values.use_hw_shader = ReadSetting("use_hw_shader", true).toBool();
 #endif
+    Settings::values.use_disk_shader_cache = ReadSetting("use_disk_shader_cache", true).toBool();
+    Settings::values.async_shader_compilation =
+        ReadSetting("async_shader_compilation", false).toBool();
+    Settings::values.async_shader_skip_draws =
+        ReadSetting("async_shader_skip_draws", false).toBool();
+    Settings::values.texture_content_hashing =
+        ReadSetting("texture_content_hashing", false).toBool();
+    Settings::values.async_surface_downloads =
+        ReadSetting("async_surface_downloads", false).toBool();
     Settings::values.shaders_accurate_gs = ReadSetting("shaders_accurate_gs", true).toBool();
     Settings::values.shaders_accurate_mul = ReadSetting("shaders_accurate_mul", false).toBool();
     Settings::values.use_shader_jit = ReadSetting("use_shader_jit", true).toBool();
+    Settings::values.sw_renderer_threads =
+        static_cast<u16>(ReadSetting("sw_renderer_threads", 1).toInt());
+    Settings::values.sw_shader_threads =
+        static_cast<u16>(ReadSetting("sw_shader_threads", 1).toInt());
     Settings::values.resolution_factor =
         static_cast<u16>(ReadSetting("resolution_factor", 1).toInt());
     Settings::values.vsync_enabled = ReadSetting("vsync_enabled", false).toBool();
@@ -447,9 +460,16 @@ void Config::SaveValues() {
     qt_config->beginGroup("Renderer");
     WriteSetting("use_hw_renderer", Settings::values.use_hw_renderer, true);
     WriteSetting("use_hw_shader", Settings::values.use_hw_shader, true);
+    WriteSetting("use_disk_shader_cache", Settings::values.use_disk_shader_cache, true);
+    WriteSetting("async_shader_compilation", Settings::values.async_shader_compilation, false);
+    WriteSetting("async_shader_skip_draws", Settings::values.async_shader_skip_draws, false);
+    WriteSetting("texture_content_hashing", Settings::values.texture_content_hashing, false);
+    WriteSetting("async_surface_downloads", Settings::values.async_surface_downloads, false);
     WriteSetting("shaders_accurate_gs", Settings::values.shaders_accurate_gs, true);
     WriteSetting("shaders_accurate_mul", Settings::values.shaders_accurate_mul, false);
     WriteSetting("use_shader_jit", Settings::values.use_shader_jit, true);
+    WriteSetting("sw_renderer_threads", Settings::values.sw_renderer_threads, 1);
+    WriteSetting("sw_shader_threads", Settings::values.sw_shader_threads, 1);
     WriteSetting("resolution_factor", Settings::values.resolution_factor, 1);
     WriteSetting("vsync_enabled", Settings::values.vsync_enabled, false);
     WriteSetting("use_frame_limit", Settings::values.use_frame_limit, true);
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <QMenu>
 #include <QString>
 #include <QWidget>
@@ -28,6 +29,10 @@ class QTreeView;
 class QToolButton;
 class QVBoxLayout;
 
+namespace Loader {
+class TitleScanner;
+}
+
 enum class GameListOpenTarget { SAVE_DATA = 0, EXT_DATA = 1, APPLICATION = 2, UPDATE_DATA = 3 };
 
 class GameList : public QWidget {
@@ -103,6 +108,8 @@ private:
     QTreeView* tree_view = nullptr;
     QStandardItemModel* item_model = nullptr;
     GameListWorker* current_worker = nullptr;
+    /// Kept across refreshes, shared with the workers which can outlive the game list
+    std::shared_ptr<Loader::TitleScanner> title_scanner;
     QFileSystemWatcher* watcher = nullptr;
     CompatibilityList compatibility_list;
 
@@ -15,9 +15,8 @@
 #include "citra_qt/ui_settings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
-#include "core/hle/service/am/am.h"
-#include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
+#include "core/loader/title_scanner.h"
 
 namespace {
 bool HasSupportedFileExtension(const std::string& file_name) {
@@ -27,16 +26,17 @@ bool HasSupportedFileExtension(const std::string& file_name) {
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(QList<UISettings::GameDir>& game_dirs,
-                               const CompatibilityList& compatibility_list)
-    : game_dirs(game_dirs), compatibility_list(compatibility_list) {}
+                               const CompatibilityList& compatibility_list,
+                               std::shared_ptr<Loader::TitleScanner> scanner)
+    : scanner(std::move(scanner)), game_dirs(game_dirs), compatibility_list(compatibility_list) {}
 
 GameListWorker::~GameListWorker() = default;
 
 void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
-                                             GameListDir* parent_dir) {
-    const auto callback = [this, recursion, parent_dir](u64* num_entries_out,
-                                                        const std::string& directory,
-                                                        const std::string& virtual_name) -> bool {
+                                             std::vector<std::string>& files) {
+    const auto callback = [this, recursion, &files](u64* num_entries_out,
+                                                    const std::string& directory,
+                                                    const std::string& virtual_name) -> bool {
         if (stop_processing) {
             // Breaks the callback loop.
             return false;
@@ -45,66 +45,10 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
         const std::string physical_name = directory + DIR_SEP + virtual_name;
         const bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader)
-                return true;
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh = [program_id, &loader]() -> std::vector<u8> {
-                std::vector<u8> original_smdh;
-                loader->ReadIcon(original_smdh);
-
-                if (program_id < 0x0004000000000000 || program_id > 0x00040000FFFFFFFF)
-                    return original_smdh;
-
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id + 0x0000000E00000000);
-
-                if (!FileUtil::Exists(update_path))
-                    return original_smdh;
-
-                std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path);
-
-                if (!update_loader)
-                    return original_smdh;
-
-                std::vector<u8> update_smdh;
-                update_loader->ReadIcon(update_smdh);
-                return update_smdh;
-            }();
-
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
-                // Skip this invalid entry
-                return true;
-            }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility("99");
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
-
+            files.push_back(physical_name);
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
-            AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir);
+            AddFstEntriesToGameList(physical_name, recursion - 1, files);
         }
 
         return true;
@@ -113,6 +57,38 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::AddEntriesToGameList(const std::vector<std::string>& files,
+                                          GameListDir* parent_dir) {
+    for (const Loader::TitleInfo& title : scanner->Scan(files, stop_processing)) {
+        if (stop_processing)
+            return;
+
+        if (!Loader::IsValidSMDH(title.smdh) && UISettings::values.game_list_hide_no_icon) {
+            // Skip this invalid entry
+            continue;
+        }
+
+        auto it = FindMatchingCompatibilityEntry(compatibility_list, title.program_id);
+
+        // The game list uses this as compatibility number for untested games
+        QString compatibility("99");
+        if (it != compatibility_list.end())
+            compatibility = it->second.first;
+
+        emit EntryReady(
+            {
+                new GameListItemPath(QString::fromStdString(title.path), title.smdh,
+                                     title.program_id, title.extdata_id),
+                new GameListItemCompat(compatibility),
+                new GameListItemRegion(title.smdh),
+                new GameListItem(
+                    QString::fromStdString(Loader::GetFileTypeString(title.file_type))),
+                new GameListItemSize(title.size),
+            },
+            parent_dir);
+    }
+}
+
 void GameListWorker::run() {
     stop_processing = false;
     for (UISettings::GameDir& game_dir : game_dirs) {
@@ -131,8 +107,10 @@ void GameListWorker::run() {
             watch_list.append(demos_path);
             GameListDir* game_list_dir = new GameListDir(game_dir, GameListItemType::InstalledDir);
             emit DirEntryReady({game_list_dir});
-            AddFstEntriesToGameList(games_path.toStdString(), 2, game_list_dir);
-            AddFstEntriesToGameList(demos_path.toStdString(), 2, game_list_dir);
+            std::vector<std::string> files;
+            AddFstEntriesToGameList(games_path.toStdString(), 2, files);
+            AddFstEntriesToGameList(demos_path.toStdString(), 2, files);
+            AddEntriesToGameList(files, game_list_dir);
         } else if (game_dir.path == "SYSTEM") {
             QString path =
                 QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)) +
@@ -140,15 +118,21 @@ void GameListWorker::run() {
             watch_list.append(path);
             GameListDir* game_list_dir = new GameListDir(game_dir, GameListItemType::SystemDir);
             emit DirEntryReady({game_list_dir});
-            AddFstEntriesToGameList(path.toStdString(), 2, game_list_dir);
+            std::vector<std::string> files;
+            AddFstEntriesToGameList(path.toStdString(), 2, files);
+            AddEntriesToGameList(files, game_list_dir);
         } else {
             watch_list.append(game_dir.path);
             GameListDir* game_list_dir = new GameListDir(game_dir);
             emit DirEntryReady({game_list_dir});
+            std::vector<std::string> files;
             AddFstEntriesToGameList(game_dir.path.toStdString(), game_dir.deep_scan ? 256 : 0,
-                                    game_list_dir);
+                                    files);
+            AddEntriesToGameList(files, game_list_dir);
         }
     };
+    if (!stop_processing)
+        scanner->SaveCache();
     emit Finished(watch_list);
 }
 
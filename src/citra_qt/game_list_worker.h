@@ -9,25 +9,30 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QString>
 #include "citra_qt/compatibility_list.h"
 #include "common/common_types.h"
+#include "core/loader/title_scanner.h"
 
 class QStandardItem;
 
 /**
  * Asynchronous worker object for populating the game list.
- * Communicates with other threads through Qt's signal/slot system.
+ * Communicates with other threads through Qt's signal/slot system. The titles are read by the
+ * Loader::TitleScanner of the game list, which only opens the files that changed since the last
+ * time.
  */
 class GameListWorker : public QObject, public QRunnable {
     Q_OBJECT
 
 public:
     GameListWorker(QList<UISettings::GameDir>& game_dirs,
-                   const CompatibilityList& compatibility_list);
+                   const CompatibilityList& compatibility_list,
+                   std::shared_ptr<Loader::TitleScanner> scanner);
     ~GameListWorker() override;
 
     /// Starts the processing of directory tree information.
@@ -52,10 +57,15 @@ signals:
     void Finished(QStringList watch_list);
 
 private:
+    /// Collects the files with a supported extension in a directory and its subdirectories
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
-                                 GameListDir* parent_dir);
+                                 std::vector<std::string>& files);
+
+    /// Reads the titles of the collected files and adds them to a directory of the game list
+    void AddEntriesToGameList(const std::vector<std::string>& files, GameListDir* parent_dir);
 
     QStringList watch_list;
+    std::shared_ptr<Loader::TitleScanner> scanner;
     const CompatibilityList& compatibility_list;
     QList<UISettings::GameDir>& game_dirs;
     std::atomic_bool stop_processing;
@@ -4,7 +4,9 @@
 
 #include <clocale>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include <glad/glad.h>
 #define QT_NO_OPENGL
 #include <QDesktopWidget>
@@ -1102,14 +1104,36 @@ void GMainWindow::InstallCIA(QStringList filepaths) {
     progress_bar->setMaximum(INT_MAX);
 
     QtConcurrent::run([&, filepaths] {
-        QString current_path;
-        Service::AM::InstallStatus status;
-        const auto cia_progress = [&](std::size_t written, std::size_t total) {
+        std::vector<std::string> paths;
+        std::vector<std::size_t> totals;
+        std::size_t total = 0;
+        for (const auto& path : filepaths) {
+            paths.push_back(path.toStdString());
+            totals.push_back(FileUtil::GetSize(paths.back()));
+            total += totals.back();
+        }
+
+        // The CIAs are installed concurrently, so the progress is the sum of their progress. The
+        // size of a CIA stands for its total until its install reports how much it writes.
+        std::mutex progress_mutex;
+        std::vector<std::size_t> progress(paths.size());
+        std::size_t written = 0;
+        const auto cia_progress = [&](std::size_t index, std::size_t cia_written,
+                                      std::size_t cia_total) {
+            std::lock_guard lock{progress_mutex};
+            written += cia_written - progress[index];
+            progress[index] = cia_written;
+            total += cia_total - totals[index];
+            totals[index] = cia_total;
             emit UpdateProgress(written, total);
         };
-        for (const auto current_path : filepaths) {
-            status = Service::AM::InstallCIA(current_path.toStdString(), cia_progress);
-            emit CIAInstallReport(status, current_path);
+        const auto statuses = Service::AM::InstallCIAs(paths, cia_progress);
+        // CIAs that failed didn't write everything
+        if (total != 0) {
+            emit UpdateProgress(total, total);
+        }
+        for (int i = 0; i < filepaths.size(); ++i) {
+            emit CIAInstallReport(statuses[i], filepaths[i]);
         }
         emit CIAInstallFinished();
     });
@@ -26,6 +26,7 @@
 // - Zero backwards/forwards compatibility
 // - Serialization code for anything complex has to be manually written.
 
+#include <algorithm>
 #include <cstring>
 #include <deque>
 #include <list>
@@ -128,6 +129,9 @@ public:
     };
 
     u8** ptr;
+    // End of the buffer in MODE_READ, reading past it fails instead of overrunning the buffer.
+    // Unchecked if null.
+    u8* end = nullptr;
     Mode mode;
     Error error;
 
@@ -135,6 +139,8 @@ public:
     PointerWrap(u8** ptr_, Mode mode_) : ptr(ptr_), mode(mode_), error(ERROR_NONE) {}
     PointerWrap(unsigned char** ptr_, int mode_)
         : ptr((u8**)ptr_), mode((Mode)mode_), error(ERROR_NONE) {}
+    PointerWrap(u8** ptr_, u8* end_, Mode mode_)
+        : ptr(ptr_), end(end_), mode(mode_), error(ERROR_NONE) {}
 
     PointerWrapSection Section(const char* title, int ver) {
         return Section(title, ver, ver);
@@ -184,6 +190,7 @@ public:
     }
 
     bool ExpectVoid(void* data, int size) {
+        CheckSize(size);
         switch (mode) {
         case MODE_READ:
             if (memcmp(data, *ptr, size) != 0)
@@ -211,6 +218,7 @@ public:
     }
 
     void DoVoid(void* data, int size) {
+        CheckSize(size);
         switch (mode) {
         case MODE_READ:
             memcpy(data, *ptr, size);
@@ -257,6 +265,7 @@ public:
     void DoMap(std::map<K, T>& x, T& default_val) {
         unsigned int number = (unsigned int)x.size();
         Do(number);
+        CheckCount<T>(number);
         switch (mode) {
         case MODE_READ: {
             x.clear();
@@ -306,6 +315,7 @@ public:
     void DoMultimap(std::multimap<K, T>& x, T& default_val) {
         unsigned int number = (unsigned int)x.size();
         Do(number);
+        CheckCount<T>(number);
         switch (mode) {
         case MODE_READ: {
             x.clear();
@@ -360,6 +370,7 @@ public:
     void DoVector(std::vector<T>& x, T& default_val) {
         u32 vec_size = (u32)x.size();
         Do(vec_size);
+        CheckCount<T>(vec_size);
         x.resize(vec_size, default_val);
         if (vec_size > 0)
             DoArray(&x[0], vec_size);
@@ -369,6 +380,7 @@ public:
     void DoVectorPOD(std::vector<T>& x, T& default_val) {
         u32 vec_size = (u32)x.size();
         Do(vec_size);
+        CheckCount<T>(vec_size);
         x.resize(vec_size, default_val);
         if (vec_size > 0)
             DoArray(&x[0], vec_size);
@@ -391,6 +403,7 @@ public:
     void DoDeque(std::deque<T>& x, T& default_val) {
         u32 deq_size = (u32)x.size();
         Do(deq_size);
+        CheckCount<T>(deq_size);
         x.resize(deq_size, default_val);
         u32 i;
         for (i = 0; i < deq_size; i++)
@@ -419,6 +432,7 @@ public:
     void DoList(std::list<T>& x, T& default_val) {
         u32 list_size = (u32)x.size();
         Do(list_size);
+        CheckCount<T>(list_size);
         x.resize(list_size, default_val);
 
         typename std::list<T>::iterator itr, end;
@@ -447,6 +461,7 @@ public:
     void DoSet(std::set<T>& x) {
         unsigned int number = (unsigned int)x.size();
         Do(number);
+        CheckCount<T>(number);
 
         switch (mode) {
         case MODE_READ: {
@@ -474,10 +489,11 @@ public:
     void Do(std::string& x) {
         int stringLen = (int)x.length() + 1;
         Do(stringLen);
+        CheckSize(stringLen);
 
         switch (mode) {
         case MODE_READ:
-            x = (char*)*ptr;
+            x.assign((char*)*ptr, std::find((char*)*ptr, (char*)*ptr + stringLen, '\0'));
             break;
         case MODE_WRITE:
             memcpy(*ptr, x.c_str(), stringLen);
@@ -496,10 +512,12 @@ public:
     void Do(std::wstring& x) {
         int stringLen = sizeof(wchar_t) * ((int)x.length() + 1);
         Do(stringLen);
+        CheckSize(stringLen);
 
         switch (mode) {
         case MODE_READ:
-            x = (wchar_t*)*ptr;
+            x.assign((wchar_t*)*ptr, std::find((wchar_t*)*ptr,
+                                               (wchar_t*)*ptr + stringLen / sizeof(wchar_t), 0));
             break;
         case MODE_WRITE:
             memcpy(*ptr, x.c_str(), stringLen);
@@ -614,6 +632,32 @@ public:
             SetError(ERROR_FAILURE);
         }
     }
+
+private:
+    // Fails the state if reading size bytes would go past the end of the buffer
+    void CheckSize(int size) {
+        if (mode == MODE_READ && end != nullptr && (size < 0 || size > end - *ptr)) {
+            LOG_ERROR(Common, "Savestate failure: {} bytes to read past the end of the buffer",
+                      size);
+            SetError(ERROR_FAILURE);
+        }
+    }
+
+    // Fails the state if a number of elements can't fit in the rest of the buffer, before
+    // allocating them. Each element takes at least a byte, and POD ones their size.
+    template <class T>
+    void CheckCount(u32& count) {
+        if (mode != MODE_READ || end == nullptr)
+            return;
+        const std::size_t element_size =
+            std::is_pod<T>::value && !std::is_pointer<T>::value ? sizeof(T) : 1;
+        if (count > static_cast<std::size_t>(end - *ptr) / element_size) {
+            LOG_ERROR(Common, "Savestate failure: {} elements to read past the end of the buffer",
+                      count);
+            SetError(ERROR_FAILURE);
+            count = 0;
+        }
+    }
 };
 
 inline PointerWrapSection::~PointerWrapSection() {
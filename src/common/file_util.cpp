@@ -42,6 +42,7 @@
 #include <cstring>
 #include <dirent.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -342,6 +343,17 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+u64 GetModificationTime(const std::string& filename) {
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) != 0)
+#else
+    if (stat(filename.c_str(), &buf) != 0)
+#endif
+        return 0;
+    return static_cast<u64>(buf.st_mtime);
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
@@ -863,4 +875,109 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+std::size_t IOFile::ReadAtOffset(void* data, std::size_t length, u64 offset) const {
+    if (!IsOpen()) {
+        return 0;
+    }
+
+    u8* buffer = static_cast<u8*>(data);
+    std::size_t total = 0;
+    while (total < length) {
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset + total);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+        const DWORD chunk =
+            static_cast<DWORD>(std::min<std::size_t>(length - total, 0x40000000));
+        DWORD read = 0;
+        const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_file)));
+        if (!ReadFile(handle, buffer + total, chunk, &read, &overlapped) || read == 0) {
+            break;
+        }
+#else
+        const ssize_t read = pread(fileno(m_file), buffer + total, length - total,
+                                   static_cast<off_t>(offset + total));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            break;
+        }
+#endif
+        total += static_cast<std::size_t>(read);
+    }
+    return total;
+}
+
+MappedFile::MappedFile() {}
+
+MappedFile::MappedFile(const IOFile& file) {
+    const u64 file_size = file.GetSize();
+    if (file_size == 0 || file_size > std::numeric_limits<std::size_t>::max()) {
+        return;
+    }
+
+#ifdef _WIN32
+    const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file.m_file)));
+    mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Failed to map a file: {}", GetLastErrorMsg());
+        return;
+    }
+    data = static_cast<u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Failed to map a file: {}", GetLastErrorMsg());
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return;
+    }
+#else
+    void* view = mmap(nullptr, static_cast<std::size_t>(file_size), PROT_READ, MAP_SHARED,
+                      fileno(file.m_file), 0);
+    if (view == MAP_FAILED) {
+        LOG_WARNING(Common_Filesystem, "Failed to map a file: {}", GetLastErrorMsg());
+        return;
+    }
+    data = static_cast<u8*>(view);
+#endif
+    size = static_cast<std::size_t>(file_size);
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) {
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+    Swap(other);
+    return *this;
+}
+
+void MappedFile::Swap(MappedFile& other) {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+#ifdef _WIN32
+    std::swap(mapping, other.mapping);
+#endif
+}
+
+void MappedFile::Unmap() {
+    if (data == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
 } // namespace FileUtil
@@ -58,6 +58,9 @@ u64 GetSize(const int fd);
 // Overloaded GetSize, accepts FILE*
 u64 GetSize(FILE* f);
 
+// Returns the time filename was last modified in seconds since the epoch, 0 if it doesn't exist
+u64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -234,6 +237,14 @@ public:
         return WriteArray(str.data(), str.length());
     }
 
+    /**
+     * Reads from an offset of the file, independently of the position of the stream, so that
+     * several threads can read the file at once. The position of the stream is undefined
+     * afterwards, and data buffered by previous writes may not be seen.
+     * @return The number of bytes read
+     */
+    std::size_t ReadAtOffset(void* data, std::size_t length, u64 offset) const;
+
     bool IsOpen() const {
         return nullptr != m_file;
     }
@@ -259,10 +270,49 @@ public:
     }
 
 private:
+    friend class MappedFile;
+
     std::FILE* m_file = nullptr;
     bool m_good = true;
 };
 
+/// A read-only view of a whole file mapped into memory, which stays valid after the file is closed
+class MappedFile : public NonCopyable {
+public:
+    MappedFile();
+
+    /// Maps an open file. Mapping can fail, e.g. when the file is larger than the address space.
+    explicit MappedFile(const IOFile& file);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+
+    void Swap(MappedFile& other);
+
+    bool IsMapped() const {
+        return data != nullptr;
+    }
+
+    const u8* Data() const {
+        return data;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+private:
+    void Unmap();
+
+    u8* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
+
 } // namespace FileUtil
 
 // To deal with Windows being dumb at unicode:
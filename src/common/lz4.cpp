@@ -0,0 +1,209 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "common/lz4.h"
+
+namespace Common::LZ4 {
+
+namespace {
+
+constexpr std::size_t MinMatch = 4;
+/// The last bytes of a block are always literals
+constexpr std::size_t LastLiterals = 5;
+/// Matches start at least this many bytes before the end of a block
+constexpr std::size_t MatchFindLimit = 12;
+constexpr std::size_t MaxOffset = 0xFFFF;
+constexpr u32 HashBits = 13;
+
+u32 Read32(const u8* data) {
+    u32 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+u32 Hash(u32 sequence) {
+    return (sequence * 2654435761U) >> (32 - HashBits);
+}
+
+class Writer {
+public:
+    Writer(u8* data, std::size_t capacity) : data(data), capacity(capacity) {}
+
+    void Put(u8 value) {
+        if (size < capacity) {
+            data[size] = value;
+        } else {
+            overflow = true;
+        }
+        ++size;
+    }
+
+    void Put(const u8* values, std::size_t count) {
+        if (count == 0) {
+            return;
+        }
+        if (count <= capacity - std::min(size, capacity)) {
+            std::memcpy(data + size, values, count);
+        } else {
+            overflow = true;
+        }
+        size += count;
+    }
+
+    /// Writes the part of a length that doesn't fit in the 4 bits of the token
+    void PutLength(std::size_t length) {
+        for (length -= 15; length >= 255; length -= 255) {
+            Put(255);
+        }
+        Put(static_cast<u8>(length));
+    }
+
+    /// Writes the literals since the last match, and the match that follows if any
+    void PutSequence(const u8* literals, std::size_t num_literals, std::size_t offset,
+                     std::size_t match_length) {
+        const std::size_t extra_length = match_length - std::min(match_length, MinMatch);
+        Put(static_cast<u8>(std::min<std::size_t>(num_literals, 15) << 4 |
+                            std::min<std::size_t>(extra_length, 15)));
+        if (num_literals >= 15) {
+            PutLength(num_literals);
+        }
+        Put(literals, num_literals);
+        if (match_length == 0) {
+            return;
+        }
+
+        Put(static_cast<u8>(offset));
+        Put(static_cast<u8>(offset >> 8));
+        if (extra_length >= 15) {
+            PutLength(extra_length);
+        }
+    }
+
+    std::size_t Size() const {
+        return overflow ? 0 : size;
+    }
+
+private:
+    u8* data;
+    std::size_t capacity;
+    std::size_t size = 0;
+    bool overflow = false;
+};
+
+/// Reads the part of a length that follows the token
+bool ReadLength(const u8* source, std::size_t source_size, std::size_t& position,
+                std::size_t& length) {
+    u8 value;
+    do {
+        if (position == source_size) {
+            return false;
+        }
+        value = source[position++];
+        length += value;
+    } while (value == 255);
+    return true;
+}
+
+} // Anonymous namespace
+
+std::size_t Compress(const u8* source, std::size_t source_size, u8* destination,
+                     std::size_t capacity) {
+    Writer writer(destination, capacity);
+    std::size_t anchor = 0;
+
+    if (source_size > MatchFindLimit) {
+        // Positions of the last sequences seen with each hash, plus one as 0 means none
+        std::array<u32, 1 << HashBits> table{};
+        std::size_t position = 0;
+        while (position + MatchFindLimit <= source_size) {
+            const u32 sequence = Read32(source + position);
+            u32& entry = table[Hash(sequence)];
+            const std::size_t candidate = entry;
+            entry = static_cast<u32>(position + 1);
+
+            if (candidate == 0 || position - (candidate - 1) > MaxOffset ||
+                Read32(source + candidate - 1) != sequence) {
+                // Data that doesn't compress is skipped faster and faster
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            const std::size_t match = candidate - 1;
+            const std::size_t max_length = source_size - LastLiterals - position;
+            std::size_t length = MinMatch;
+            while (length < max_length && source[match + length] == source[position + length]) {
+                ++length;
+            }
+
+            writer.PutSequence(source + anchor, position - anchor, position - match, length);
+            position += length;
+            anchor = position;
+        }
+    }
+
+    writer.PutSequence(source + anchor, source_size - anchor, 0, 0);
+    return writer.Size();
+}
+
+bool Decompress(const u8* source, std::size_t source_size, u8* destination,
+                std::size_t destination_size) {
+    std::size_t in = 0;
+    std::size_t out = 0;
+    while (in < source_size) {
+        const u8 token = source[in++];
+
+        std::size_t num_literals = token >> 4;
+        if (num_literals == 15 && !ReadLength(source, source_size, in, num_literals)) {
+            return false;
+        }
+        if (num_literals > source_size - in || num_literals > destination_size - out) {
+            return false;
+        }
+        if (num_literals != 0) {
+            std::memcpy(destination + out, source + in, num_literals);
+        }
+        in += num_literals;
+        out += num_literals;
+
+        // The last sequence has no match
+        if (in == source_size) {
+            break;
+        }
+
+        if (source_size - in < 2) {
+            return false;
+        }
+        const std::size_t offset = source[in] | source[in + 1] << 8;
+        in += 2;
+        if (offset == 0 || offset > out) {
+            return false;
+        }
+
+        std::size_t length = token & 0xF;
+        if (length == 15 && !ReadLength(source, source_size, in, length)) {
+            return false;
+        }
+        length += MinMatch;
+        if (length > destination_size - out) {
+            return false;
+        }
+
+        // Matches can overlap the data they produce, which repeats it
+        const u8* match = destination + out - offset;
+        if (offset >= length) {
+            std::memcpy(destination + out, match, length);
+        } else {
+            for (std::size_t i = 0; i < length; ++i) {
+                destination[out + i] = match[i];
+            }
+        }
+        out += length;
+    }
+    return out == destination_size;
+}
+
+} // namespace Common::LZ4
@@ -0,0 +1,36 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+/**
+ * Compression in the LZ4 block format, which favors the speed of decompression over the ratio.
+ * The blocks are compatible with the LZ4 reference implementation.
+ */
+namespace Common::LZ4 {
+
+/// Returns the largest size that compressing data of the given size can produce
+constexpr std::size_t CompressBound(std::size_t size) {
+    return size + size / 255 + 16;
+}
+
+/**
+ * Compresses data into a block.
+ * @return The size of the block, or 0 if it doesn't fit in the destination
+ */
+std::size_t Compress(const u8* source, std::size_t source_size, u8* destination,
+                     std::size_t capacity);
+
+/**
+ * Decompresses a block.
+ * @param destination_size The size of the decompressed data, which must be known
+ * @return Whether the block is valid and decompresses to exactly destination_size bytes
+ */
+bool Decompress(const u8* source, std::size_t source_size, u8* destination,
+                std::size_t destination_size);
+
+} // namespace Common::LZ4
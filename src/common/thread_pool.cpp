@@ -0,0 +1,103 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(std::size_t num_threads, std::string name) {
+    threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([this, name] {
+            SetCurrentThreadName(name.c_str());
+            WorkerLoop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex};
+        stop = true;
+    }
+    task_cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::QueueWork(std::function<void()> task) {
+    {
+        std::lock_guard lock{mutex};
+        tasks.push_back(std::move(task));
+        ++pending;
+    }
+    task_cv.notify_one();
+}
+
+void ThreadPool::WaitForIdle() {
+    std::unique_lock lock{mutex};
+    idle_cv.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func) {
+    std::atomic<std::size_t> next{0};
+    auto run = [&] {
+        for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            func(i);
+        }
+    };
+
+    // The calling thread takes part in the work, so at most count - 1 helpers are useful
+    const std::size_t num_helpers = std::min(threads.size(), count > 0 ? count - 1 : 0);
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    std::size_t remaining = num_helpers;
+    for (std::size_t i = 0; i < num_helpers; ++i) {
+        QueueWork([&] {
+            run();
+            std::lock_guard lock{done_mutex};
+            --remaining;
+            // Notify while holding the lock: the waiter owns done_cv and may return immediately
+            done_cv.notify_one();
+        });
+    }
+
+    run();
+
+    std::unique_lock lock{done_mutex};
+    done_cv.wait(lock, [&] { return remaining == 0; });
+}
+
+std::size_t ThreadPool::DefaultThreadCount() {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mutex};
+            task_cv.wait(lock, [this] { return stop || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        std::lock_guard lock{mutex};
+        if (--pending == 0) {
+            idle_cv.notify_all();
+        }
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,62 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/**
+ * A fixed-size pool of worker threads.
+ *
+ * Work can either be queued as independent tasks, or be submitted as an index range via
+ * ParallelFor(), in which case the range is shared between the workers and the calling thread.
+ * Neither QueueWork() nor ParallelFor() may be called from inside a task running on the same pool.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t num_threads, std::string name = "ThreadPool");
+    ~ThreadPool();
+
+    /// Returns the number of worker threads owned by the pool
+    std::size_t NumThreads() const {
+        return threads.size();
+    }
+
+    /// Queues a task to be run on one of the worker threads
+    void QueueWork(std::function<void()> task);
+
+    /// Blocks until every queued task has finished executing
+    void WaitForIdle();
+
+    /**
+     * Calls func(i) for every i in [0, count), spreading the calls over the workers and the
+     * calling thread. Blocks until all calls have returned.
+     */
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func);
+
+    /// Returns the number of threads to use when a setting requests automatic detection
+    static std::size_t DefaultThreadCount();
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_cv;
+    std::condition_variable idle_cv;
+    std::size_t pending = 0;
+    bool stop = false;
+};
+
+} // namespace Common
@@ -7,6 +7,7 @@
 // a simple lockless thread-safe,
 // single reader, single writer queue
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
@@ -162,4 +163,130 @@ private:
     SPSCQueue<T> spsc_queue;
     std::mutex write_lock;
 };
+
+// a bounded lock-free,
+// single reader, multiple writer queue which doesn't allocate after construction.
+// Based on Dmitry Vyukov's bounded MPMC queue: each cell holds a sequence number telling whether it
+// is free for the writer of a given position or ready for the reader.
+
+template <typename T, std::size_t capacity>
+class BoundedMPSCQueue {
+    static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+public:
+    BoundedMPSCQueue() {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Pushes an element, unless the queue is full. Can be called from any thread.
+    template <typename Arg>
+    bool TryPush(Arg&& t) {
+        std::size_t pos = write_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The reader hasn't freed this cell yet
+                return false;
+            } else {
+                pos = write_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<Arg>(t);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns whether no element is ready to be popped. Reader only.
+    bool Empty() const {
+        return cells[read_pos & mask].sequence.load(std::memory_order_acquire) != read_pos + 1;
+    }
+
+    /// Reader only.
+    bool Pop(T& t) {
+        Cell& cell = cells[read_pos & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != read_pos + 1) {
+            return false;
+        }
+        t = std::move(cell.data);
+        cell.sequence.store(read_pos + capacity, std::memory_order_release);
+        ++read_pos;
+        return true;
+    }
+
+    /// Pops every element that is ready and passes it to func, in order. Reader only.
+    template <typename Func>
+    std::size_t PopAll(Func&& func) {
+        std::size_t count = 0;
+        for (T t; Pop(t); ++count) {
+            func(std::move(t));
+        }
+        return count;
+    }
+
+private:
+    static constexpr std::size_t mask = capacity - 1;
+
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    std::array<Cell, capacity> cells;
+    // Kept on separate cache lines, as they are written by different threads
+    alignas(64) std::atomic<std::size_t> write_pos{0};
+    alignas(64) std::size_t read_pos = 0;
+};
+
+// a bounded blocking,
+// multiple reader, multiple writer queue which doesn't allocate after construction.
+// Writers wait while the queue is full and readers wait while it is empty, which makes it suited to
+// connecting the stages of a pipeline.
+
+template <typename T, std::size_t capacity>
+class BoundedQueue {
+    static_assert(capacity >= 1, "capacity must not be zero");
+
+public:
+    /// Pushes an element, waiting for the queue to have room for it
+    template <typename Arg>
+    void Push(Arg&& t) {
+        std::unique_lock lock{mutex};
+        not_full.wait(lock, [this] { return size != capacity; });
+        cells[(read_pos + size) % capacity] = std::forward<Arg>(t);
+        ++size;
+        lock.unlock();
+        not_empty.notify_one();
+    }
+
+    /// Pops an element, waiting for one to be pushed if the queue is empty
+    T PopWait() {
+        std::unique_lock lock{mutex};
+        not_empty.wait(lock, [this] { return size != 0; });
+        T t = std::move(cells[read_pos]);
+        read_pos = (read_pos + 1) % capacity;
+        --size;
+        lock.unlock();
+        not_full.notify_one();
+        return t;
+    }
+
+private:
+    std::array<T, capacity> cells{};
+    std::size_t read_pos = 0;
+    std::size_t size = 0;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+};
 } // namespace Common
@@ -0,0 +1,282 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <mutex>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/write_tracked_memory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+constexpr bool SupportsTracking = true;
+#else
+constexpr bool SupportsTracking = false;
+#endif
+
+/// Memories being tracked, looked up by the fault handler without locking
+constexpr std::size_t MaxTrackedMemories = 8;
+std::array<std::atomic<WriteTrackedMemory*>, MaxTrackedMemories> tracked_memories{};
+std::mutex registration_mutex;
+
+bool HandleWriteFault(const void* address) {
+    for (auto& slot : tracked_memories) {
+        WriteTrackedMemory* memory = slot.load(std::memory_order_acquire);
+        if (memory != nullptr && memory->HandleWrite(static_cast<const u8*>(address))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef _WIN32
+
+LONG CALLBACK HandleException(PEXCEPTION_POINTERS pointers) {
+    const EXCEPTION_RECORD* record = pointers->ExceptionRecord;
+    // The first parameter of an access violation is 1 for writes
+    if (record->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && record->NumberParameters >= 2 &&
+        record->ExceptionInformation[0] == 1 &&
+        HandleWriteFault(reinterpret_cast<const void*>(record->ExceptionInformation[1]))) {
+        return EXCEPTION_CONTINUE_EXECUTION;
+    }
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+bool InstallFaultHandler() {
+    static const bool installed = AddVectoredExceptionHandler(1, HandleException) != nullptr;
+    return installed;
+}
+
+u8* AllocatePages(std::size_t size) {
+    return static_cast<u8*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+}
+
+void FreePages(u8* pages, std::size_t size) {
+    VirtualFree(pages, 0, MEM_RELEASE);
+}
+
+bool ProtectPages(u8* pages, std::size_t size, bool writable) {
+    DWORD old_protect;
+    return VirtualProtect(pages, size, writable ? PAGE_READWRITE : PAGE_READONLY, &old_protect) !=
+           0;
+}
+
+std::size_t QueryPageSize() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+// Writes to protected pages raise SIGBUS rather than SIGSEGV on some systems
+constexpr std::array<int, 2> FaultSignals{{SIGSEGV, SIGBUS}};
+std::array<struct sigaction, FaultSignals.size()> previous_actions;
+
+void HandleSignal(int signal, siginfo_t* info, void* context) {
+    if (HandleWriteFault(info->si_addr)) {
+        return;
+    }
+
+    // Not a tracked write, hand it over to the handler that was there before
+    const std::size_t index = signal == FaultSignals[0] ? 0 : 1;
+    const struct sigaction& previous = previous_actions[index];
+    if (previous.sa_flags & SA_SIGINFO) {
+        previous.sa_sigaction(signal, info, context);
+    } else if (previous.sa_handler == SIG_DFL || previous.sa_handler == SIG_IGN) {
+        // The fault happens again once the handler returns, and is then handled as usual
+        sigaction(signal, &previous, nullptr);
+    } else {
+        previous.sa_handler(signal);
+    }
+}
+
+bool InstallFaultHandler() {
+    struct sigaction action {};
+    action.sa_sigaction = HandleSignal;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    for (std::size_t i = 0; i < FaultSignals.size(); ++i) {
+        // Other handlers may have replaced this one since it was installed
+        struct sigaction current {};
+        if (sigaction(FaultSignals[i], nullptr, &current) != 0) {
+            return false;
+        }
+        if ((current.sa_flags & SA_SIGINFO) && current.sa_sigaction == HandleSignal) {
+            continue;
+        }
+        if (sigaction(FaultSignals[i], &action, &previous_actions[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+u8* AllocatePages(std::size_t size) {
+    void* pages =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return pages != MAP_FAILED ? static_cast<u8*>(pages) : nullptr;
+}
+
+void FreePages(u8* pages, std::size_t size) {
+    munmap(pages, size);
+}
+
+bool ProtectPages(u8* pages, std::size_t size, bool writable) {
+    return mprotect(pages, size, writable ? PROT_READ | PROT_WRITE : PROT_READ) == 0;
+}
+
+std::size_t QueryPageSize() {
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+#else
+
+bool InstallFaultHandler() {
+    return false;
+}
+
+u8* AllocatePages(std::size_t size) {
+    return nullptr;
+}
+
+void FreePages(u8* pages, std::size_t size) {}
+
+bool ProtectPages(u8* pages, std::size_t size, bool writable) {
+    return false;
+}
+
+std::size_t QueryPageSize() {
+    return 0x1000;
+}
+
+#endif
+
+std::size_t AlignToPages(std::size_t size) {
+    const std::size_t page_size = WriteTrackedMemory::GetPageSize();
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+} // Anonymous namespace
+
+WriteTrackedMemory::WriteTrackedMemory(std::size_t size) : size(size) {
+    if (SupportsTracking) {
+        data = AllocatePages(AlignToPages(size));
+    }
+    page_allocated = data != nullptr;
+    if (!page_allocated) {
+        data = new u8[size]();
+    }
+}
+
+WriteTrackedMemory::~WriteTrackedMemory() {
+    StopTracking();
+    if (page_allocated) {
+        FreePages(data, AlignToPages(size));
+    } else {
+        delete[] data;
+    }
+}
+
+std::size_t WriteTrackedMemory::GetPageSize() {
+    static const std::size_t page_size = QueryPageSize();
+    return page_size;
+}
+
+bool WriteTrackedMemory::StartTracking() {
+    if (tracking) {
+        return true;
+    }
+    if (!page_allocated) {
+        return false;
+    }
+
+    {
+        std::lock_guard lock{registration_mutex};
+        if (!InstallFaultHandler()) {
+            LOG_WARNING(Common_Memory, "Failed to install the write fault handler");
+            return false;
+        }
+        registration = 0;
+        while (registration < MaxTrackedMemories &&
+               tracked_memories[registration].load(std::memory_order_relaxed) != nullptr) {
+            ++registration;
+        }
+        if (registration == MaxTrackedMemories) {
+            LOG_WARNING(Common_Memory, "Too many memories are tracked at once");
+            return false;
+        }
+        tracked_memories[registration].store(this, std::memory_order_release);
+    }
+
+    const std::size_t num_pages = AlignToPages(size) / GetPageSize();
+    written_pages = std::make_unique<std::atomic<bool>[]>(num_pages);
+    for (std::size_t page = 0; page < num_pages; ++page) {
+        written_pages[page].store(false, std::memory_order_relaxed);
+    }
+    tracking = true;
+    if (!ProtectPages(data, AlignToPages(size), false)) {
+        LOG_WARNING(Common_Memory, "Failed to write-protect memory: {}", GetLastErrorMsg());
+        StopTracking();
+        return false;
+    }
+    return true;
+}
+
+void WriteTrackedMemory::StopTracking() {
+    if (!tracking) {
+        return;
+    }
+    ProtectPages(data, AlignToPages(size), true);
+    tracking = false;
+
+    std::lock_guard lock{registration_mutex};
+    tracked_memories[registration].store(nullptr, std::memory_order_release);
+}
+
+std::vector<bool> WriteTrackedMemory::TakeWrittenPages() {
+    ASSERT(tracking);
+    const std::size_t page_size = GetPageSize();
+    const std::size_t num_pages = AlignToPages(size) / page_size;
+    std::vector<bool> pages(num_pages);
+
+    // Consecutive pages are protected at once
+    std::size_t run_start = 0;
+    std::size_t run_length = 0;
+    for (std::size_t page = 0; page <= num_pages; ++page) {
+        if (page < num_pages && written_pages[page].exchange(false, std::memory_order_relaxed)) {
+            pages[page] = true;
+            if (run_length++ == 0) {
+                run_start = page;
+            }
+        } else if (run_length != 0) {
+            ProtectPages(data + run_start * page_size, run_length * page_size, false);
+            run_length = 0;
+        }
+    }
+    return pages;
+}
+
+bool WriteTrackedMemory::HandleWrite(const u8* address) {
+    if (!tracking || address < data || address >= data + AlignToPages(size)) {
+        return false;
+    }
+    const std::size_t page_size = GetPageSize();
+    const std::size_t page = static_cast<std::size_t>(address - data) / page_size;
+    written_pages[page].store(true, std::memory_order_relaxed);
+    return ProtectPages(data + page * page_size, page_size, true);
+}
+
+} // namespace Common
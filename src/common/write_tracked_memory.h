@@ -0,0 +1,78 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Zero-initialized memory whose writes can be tracked per host page, to find what changed without
+ * comparing the whole memory.
+ *
+ * While tracking, the memory is write-protected: the first write to a page faults, and the fault
+ * handler records the page and makes it writable again, so the following writes to it run at full
+ * speed. This catches writes from any code, including JIT-compiled code writing through a page
+ * table. System calls writing into the memory fail instead of faulting though, so file reads and
+ * the like must go through a buffer while tracking.
+ *
+ * Tracking isn't available on every host, in which case the memory is allocated normally and
+ * StartTracking fails.
+ */
+class WriteTrackedMemory : NonCopyable {
+public:
+    explicit WriteTrackedMemory(std::size_t size);
+    ~WriteTrackedMemory();
+
+    u8* Data() const {
+        return data;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    /// Returns the size of the pages writes are tracked by
+    static std::size_t GetPageSize();
+
+    /**
+     * Write-protects the memory, so that the pages written from then on are recorded.
+     * @return false if writes can't be tracked on this host
+     */
+    bool StartTracking();
+
+    /// Makes the whole memory writable again, and forgets the pages written.
+    void StopTracking();
+
+    bool IsTracking() const {
+        return tracking.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the pages written since tracking started or since the last call, one flag per page,
+     * and write-protects them again. Must not run concurrently with writes to the memory.
+     */
+    std::vector<bool> TakeWrittenPages();
+
+    /// Called by the fault handler, returns true if the fault was a tracked write to this memory
+    bool HandleWrite(const u8* address);
+
+private:
+    u8* data = nullptr;
+    std::size_t size = 0;
+    /// Whether the memory comes from the page allocator, otherwise it can't be protected
+    bool page_allocated = false;
+    std::atomic<bool> tracking{false};
+    /// Index in the list of memories the fault handler looks at
+    std::size_t registration = 0;
+    std::unique_ptr<std::atomic<bool>[]> written_pages;
+};
+
+} // namespace Common
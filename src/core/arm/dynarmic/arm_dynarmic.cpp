@@ -274,11 +274,12 @@ void ARM_Dynarmic::ClearInstructionCache() {
     for (const auto& j : jits) {
         j.second->ClearCache();
     }
-    interpreter_state->instruction_cache.clear();
+    interpreter_state->instruction_cache.Clear();
 }
 
 void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, std::size_t length) {
     jit->InvalidateCacheRange(start_address, length);
+    interpreter_state->instruction_cache.InvalidateRange(start_address, length);
 }
 
 void ARM_Dynarmic::PageTableChanged() {
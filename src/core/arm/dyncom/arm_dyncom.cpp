@@ -86,12 +86,12 @@ void ARM_DynCom::Step() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
+    state->instruction_cache.Clear();
     trans_cache_buf_top = 0;
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    state->instruction_cache.InvalidateRange(start_address, length);
 }
 
 void ARM_DynCom::PageTableChanged() {
@@ -50,9 +50,14 @@ public:
 
     void PrepareReschedule() override;
 
-private:
+    /**
+     * Runs at most the given number of instructions. Run runs the instructions left in the time
+     * slice of the system through this, which can also be called without a system.
+     */
     void ExecuteInstructions(u64 num_instructions);
 
+private:
+
     Core::System* system;
     std::unique_ptr<ARMul_State> state;
 };
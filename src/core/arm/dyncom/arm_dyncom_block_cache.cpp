@@ -0,0 +1,59 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+
+BlockCache::BlockCache() = default;
+
+BlockCache::~BlockCache() = default;
+
+void BlockCache::Insert(u32 address, u32 offset) {
+    const std::size_t index = address >> PAGE_BITS;
+    if (!pages[index]) {
+        pages[index] = std::make_unique<Page>();
+        used_pages.push_back(index);
+    }
+    pages[index]->blocks[(address & PAGE_MASK) >> 1] = offset;
+}
+
+void BlockCache::Link(u32 address, u32* link) {
+    Page* page = pages[address >> PAGE_BITS].get();
+    ASSERT(page != nullptr);
+    *link = page->blocks[(address & PAGE_MASK) >> 1];
+    ASSERT(*link != NO_BLOCK);
+    page->links.push_back(link);
+}
+
+void BlockCache::InvalidateRange(u32 start_address, std::size_t length) {
+    if (length == 0)
+        return;
+
+    const u64 end_address = std::min<u64>(u64{start_address} + length, u64{1} << 32);
+    const std::size_t first_page = start_address >> PAGE_BITS;
+    const std::size_t last_page = static_cast<std::size_t>((end_address - 1) >> PAGE_BITS);
+    for (std::size_t index = first_page; index <= last_page; ++index) {
+        InvalidatePage(index);
+    }
+}
+
+void BlockCache::Clear() {
+    // The instructions holding the links are discarded along with the blocks
+    for (const std::size_t index : used_pages) {
+        pages[index].reset();
+    }
+    used_pages.clear();
+}
+
+void BlockCache::InvalidatePage(std::size_t index) {
+    if (!pages[index])
+        return;
+
+    // The instructions holding the links can be in other pages, which stay in use
+    for (u32* link : pages[index]->links) {
+        *link = NO_BLOCK;
+    }
+    pages[index].reset();
+}
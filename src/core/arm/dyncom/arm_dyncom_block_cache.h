@@ -0,0 +1,72 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * Maps the addresses of translated blocks to their offsets in the translation cache buffer.
+ *
+ * The table has two levels: one entry per page of the address space, pointing to the offsets of
+ * the blocks starting in that page. Blocks end at page boundaries, so the blocks of a page can be
+ * invalidated on their own. Branches with a static target are chained to the block they jump to
+ * through a link in their instruction, which is reset when the block is invalidated.
+ */
+class BlockCache {
+public:
+    /// Offset of a block that isn't translated, and value of a link that isn't chained
+    static constexpr u32 NO_BLOCK = 0xFFFFFFFF;
+
+    BlockCache();
+    ~BlockCache();
+
+    /// Returns the offset of the block starting at an address, or NO_BLOCK
+    u32 Find(u32 address) const {
+        const Page* page = pages[address >> PAGE_BITS].get();
+        return page ? page->blocks[(address & PAGE_MASK) >> 1] : NO_BLOCK;
+    }
+
+    /// Adds the block starting at an address
+    void Insert(u32 address, u32 offset);
+
+    /**
+     * Chains a link to the block starting at an address, which must have been added. The link is
+     * reset to NO_BLOCK when the block is invalidated.
+     */
+    void Link(u32 address, u32* link);
+
+    /// Invalidates the blocks starting in the pages overlapping a range of addresses
+    void InvalidateRange(u32 start_address, std::size_t length);
+
+    /// Invalidates all the blocks
+    void Clear();
+
+private:
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_SIZE = 1 << PAGE_BITS;
+    static constexpr u32 PAGE_MASK = PAGE_SIZE - 1;
+    static constexpr std::size_t NUM_PAGES = std::size_t{1} << (32 - PAGE_BITS);
+
+    struct Page {
+        Page() {
+            blocks.fill(NO_BLOCK);
+        }
+
+        /// Offsets of the blocks, indexed by halfword as Thumb instructions are 2-byte aligned
+        std::array<u32, PAGE_SIZE / 2> blocks;
+        /// Links chained to the blocks of the page
+        std::vector<u32*> links;
+    };
+
+    void InvalidatePage(std::size_t index);
+
+    std::array<std::unique_ptr<Page>, NUM_PAGES> pages;
+    /// Indices of the pages that were allocated since the last Clear, which can repeat
+    std::vector<std::size_t> used_pages;
+};
@@ -840,6 +840,12 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     return inst_size;
 }
 
+// Blocks end at page boundaries, so this is more than the translation of any block takes
+constexpr std::size_t MAX_BLOCK_SIZE = 0x1000 / 2 * (sizeof(arm_inst) + 0x100);
+
+static_assert(TRANS_CACHE_SIZE < BlockCache::NO_BLOCK,
+              "Block offsets must fit in the entries of the block cache");
+
 static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
@@ -868,7 +874,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, static_cast<u32>(bb_start));
 
     return KEEP_GOING;
 }
@@ -888,7 +894,7 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, static_cast<u32>(bb_start));
 
     return KEEP_GOING;
 }
@@ -953,6 +959,15 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 #define INC_PC(l) ptr += sizeof(arm_inst) + l
 #define INC_PC_STUB ptr += sizeof(arm_inst)
 
+// Jumps to the block a static branch is chained to, or chains it through DISPATCH
+#define GOTO_LINKED_BLOCK(link)                                                                    \
+    if (link != BlockCache::NO_BLOCK) {                                                            \
+        ptr = link;                                                                                \
+        goto LINKED_DISPATCH;                                                                      \
+    }                                                                                              \
+    block_link = &link;                                                                            \
+    goto DISPATCH
+
 #define GDB_BP_CHECK                                                                               \
     cpu->Cpsr &= ~(1 << 5);                                                                        \
     cpu->Cpsr |= cpu->TFlag << 5;                                                                  \
@@ -1626,6 +1641,8 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     unsigned int num_instrs = 0;
 
     std::size_t ptr;
+    // Link of the static branch that jumped to DISPATCH, to chain to the block at its target
+    u32* block_link = nullptr;
 
     LOAD_NZCVT;
 DISPATCH : {
@@ -1641,15 +1658,27 @@ DISPATCH : {
         cpu->Reg[15] &= 0xfffffffc;
 
     // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
-    } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    ptr = cpu->instruction_cache.Find(cpu->Reg[15]);
+    if (ptr == BlockCache::NO_BLOCK) {
+        // Invalidated blocks keep their space, which is only reclaimed once the buffer is full
+        if (trans_cache_buf_top + MAX_BLOCK_SIZE > TRANS_CACHE_SIZE) {
+            cpu->instruction_cache.Clear();
+            trans_cache_buf_top = 0;
+            block_link = nullptr;
+        }
+
+        if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
+    }
+
+    if (block_link) {
+        cpu->instruction_cache.Link(cpu->Reg[15], block_link);
+        block_link = nullptr;
     }
 
     // Find breakpoint if one exists within the block
@@ -1661,6 +1690,14 @@ DISPATCH : {
     inst_base = (arm_inst*)&trans_cache_buf[ptr];
     GOTO_NEXT_INST;
 }
+LINKED_DISPATCH : {
+    // Interrupts and breakpoints are only handled by DISPATCH
+    if ((!cpu->NirqSig && !(cpu->Cpsr & 0x80)) || GDBStub::IsConnected())
+        goto DISPATCH;
+
+    inst_base = (arm_inst*)&trans_cache_buf[ptr];
+    GOTO_NEXT_INST;
+}
 ADC_INST : {
     if (inst_base->cond == ConditionCode::AL || CondPassed(cpu, inst_base->cond)) {
         adc_inst* const inst_cream = (adc_inst*)inst_base->component;
@@ -1761,18 +1798,16 @@ AND_INST : {
     GOTO_NEXT_INST;
 }
 BBL_INST : {
+    bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
     if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
-        bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
         if (inst_cream->L) {
             LINK_RTN_ADDR;
         }
         SET_PC;
-        INC_PC(sizeof(bbl_inst));
-        goto DISPATCH;
+        GOTO_LINKED_BLOCK(inst_cream->jmp_block);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
-    INC_PC(sizeof(bbl_inst));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->next_block);
 }
 BIC_INST : {
     bic_inst* inst_cream = (bic_inst*)inst_base->component;
@@ -4322,19 +4357,17 @@ UMULL_INST : {
 B_2_THUMB : {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    INC_PC(sizeof(b_2_thumb));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->jmp_block);
 }
 B_COND_THUMB : {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-    if (CondPassed(cpu, inst_cream->cond))
+    if (CondPassed(cpu, inst_cream->cond)) {
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
-        cpu->Reg[15] += 2;
-
-    INC_PC(sizeof(b_cond_thumb));
-    goto DISPATCH;
+        GOTO_LINKED_BLOCK(inst_cream->jmp_block);
+    }
+    cpu->Reg[15] += 2;
+    GOTO_LINKED_BLOCK(inst_cream->next_block);
 }
 BL_1_THUMB : {
     bl_1_thumb* inst_cream = (bl_1_thumb*)inst_base->component;
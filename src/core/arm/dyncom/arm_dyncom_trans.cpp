@@ -99,6 +99,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bbl)(unsigned int inst, int index) {
 
     inst_cream->L = BIT(inst, 24);
     inst_cream->signed_immed_24 = BIT(inst, 23) ? NEGBRANCH : POSBRANCH;
+    inst_cream->next_block = BlockCache::NO_BLOCK;
+    inst_cream->jmp_block = BlockCache::NO_BLOCK;
 
     return inst_base;
 }
@@ -1646,6 +1648,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_2_thumb)(unsigned int tinst, int ind
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
 
     inst_cream->imm = ((tinst & 0x3FF) << 1) | ((tinst & (1 << 10)) ? 0xFFFFF800 : 0);
+    inst_cream->jmp_block = BlockCache::NO_BLOCK;
 
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
@@ -1659,6 +1662,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_cond_thumb)(unsigned int tinst, int
 
     inst_cream->imm = (((tinst & 0x7F) << 1) | ((tinst & (1 << 7)) ? 0xFFFFFF00 : 0));
     inst_cream->cond = ((tinst >> 8) & 0xf);
+    inst_cream->next_block = BlockCache::NO_BLOCK;
+    inst_cream->jmp_block = BlockCache::NO_BLOCK;
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
 
@@ -86,8 +86,8 @@ struct eor_inst {
 struct bbl_inst {
     unsigned int L;
     int signed_immed_24;
-    unsigned int next_addr;
-    unsigned int jmp_addr;
+    u32 next_block;
+    u32 jmp_block;
 };
 
 struct bx_inst {
@@ -451,10 +451,13 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    u32 jmp_block;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    u32 next_block;
+    u32 jmp_block;
 };
 
 struct bl_1_thumb {
@@ -0,0 +1,60 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/checkpoint.h"
+#include "core/core.h"
+#include "core/savestate.h"
+
+namespace Core {
+
+CheckpointRing::CheckpointRing(System& system, std::size_t capacity)
+    : system(system), capacity(capacity) {
+    ASSERT(capacity > 0);
+}
+
+CheckpointRing::~CheckpointRing() = default;
+
+bool CheckpointRing::Save() {
+    Checkpoint checkpoint;
+    if (!SaveStateWithoutMemory(system, checkpoint.state)) {
+        return false;
+    }
+
+    const Memory::MemorySnapshot* previous =
+        checkpoints.empty() ? nullptr : &checkpoints.back().memory;
+    checkpoint.memory = system.Memory().TakeSnapshot(previous);
+    LOG_DEBUG(Core, "Checkpoint saved, {} memory pages copied",
+              checkpoint.memory.GetCopiedPageCount());
+
+    if (checkpoints.size() == capacity) {
+        checkpoints.pop_front();
+    }
+    checkpoints.push_back(std::move(checkpoint));
+    return true;
+}
+
+bool CheckpointRing::Rewind(std::size_t steps) {
+    if (steps >= checkpoints.size()) {
+        LOG_ERROR(Core, "No checkpoint {} steps back", steps);
+        return false;
+    }
+
+    const Checkpoint& checkpoint = checkpoints[checkpoints.size() - 1 - steps];
+    if (!LoadStateWithoutMemory(system, checkpoint.state)) {
+        return false;
+    }
+    system.Memory().RestoreSnapshot(checkpoint.memory);
+
+    checkpoints.resize(checkpoints.size() - steps);
+    return true;
+}
+
+void CheckpointRing::Clear() {
+    checkpoints.clear();
+}
+
+} // namespace Core
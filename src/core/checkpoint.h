@@ -0,0 +1,68 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "common/common_types.h"
+#include "core/memory.h"
+
+namespace Core {
+
+class System;
+
+/**
+ * Keeps the last few states of the system in host memory, to rewind to them quickly. A checkpoint
+ * stores the state without the emulated memory, and a memory snapshot that only copies the pages
+ * that changed since the previous checkpoint.
+ */
+class CheckpointRing {
+public:
+    /**
+     * @param system The system to save and restore
+     * @param capacity The number of checkpoints to keep
+     */
+    CheckpointRing(System& system, std::size_t capacity);
+    ~CheckpointRing();
+
+    /**
+     * Saves a checkpoint of the current state, dropping the oldest checkpoint when the ring is
+     * full. Must be called from the emulation thread between two runs of the CPU.
+     * @return Whether the state could be saved, see Core::SaveState
+     */
+    bool Save();
+
+    /**
+     * Goes back to a checkpoint. The checkpoints saved after it are dropped.
+     * @param steps The number of checkpoints to go back before the latest one
+     * @return Whether the checkpoint has been restored
+     */
+    bool Rewind(std::size_t steps = 0);
+
+    /// Drops every checkpoint.
+    void Clear();
+
+    /// Returns the number of checkpoints that are kept.
+    std::size_t Size() const {
+        return checkpoints.size();
+    }
+
+    std::size_t Capacity() const {
+        return capacity;
+    }
+
+private:
+    struct Checkpoint {
+        std::vector<u8> state;
+        Memory::MemorySnapshot memory;
+    };
+
+    System& system;
+    std::size_t capacity;
+    std::deque<Checkpoint> checkpoints;
+};
+
+} // namespace Core
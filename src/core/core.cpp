@@ -28,8 +28,11 @@
 #include "core/loader/loader.h"
 #include "core/movie.h"
 #include "core/rpc/rpc_server.h"
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "network/network.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 namespace Core {
@@ -85,9 +88,38 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         return ResultStatus::ShutdownRequested;
     }
 
+    HandleStateRequests();
+
     return status;
 }
 
+void System::RequestSaveState(std::string path) {
+    std::lock_guard lock{state_request_mutex};
+    save_state_path = std::move(path);
+}
+
+void System::RequestLoadState(std::string path) {
+    std::lock_guard lock{state_request_mutex};
+    load_state_path = std::move(path);
+}
+
+void System::HandleStateRequests() {
+    std::string save_path;
+    std::string load_path;
+    {
+        std::lock_guard lock{state_request_mutex};
+        save_path = std::exchange(save_state_path, {});
+        load_path = std::exchange(load_state_path, {});
+    }
+
+    if (!save_path.empty() && !SaveStateToFile(*this, save_path)) {
+        LOG_ERROR(Core, "Failed to save the state to {}", save_path);
+    }
+    if (!load_path.empty() && !LoadStateFromFile(*this, load_path)) {
+        LOG_ERROR(Core, "Failed to load the state from {}", load_path);
+    }
+}
+
 System::ResultStatus System::SingleStep() {
     return RunLoop(false);
 }
@@ -141,6 +173,12 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
             return ResultStatus::ErrorLoader;
         }
     }
+
+    u64 program_id = 0;
+    if (app_loader->ReadProgramId(program_id) == Loader::ResultStatus::Success) {
+        VideoCore::g_renderer->Rasterizer()->LoadDiskResources(program_id);
+    }
+
     cheat_engine = std::make_unique<Cheats::CheatEngine>(*this);
     status = ResultStatus::Success;
     m_emu_window = &emu_window;
@@ -154,7 +192,16 @@ void System::PrepareReschedule() {
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return perf_stats.GetAndResetStats(timing->GetGlobalTimeUs());
+    auto results = perf_stats.GetAndResetStats(timing->GetGlobalTimeUs());
+
+    const auto event_stats = timing->GetAndResetThreadsafeEventStats();
+    results.threadsafe_event_queue_depth = event_stats.max_queue_depth;
+    if (event_stats.latency_samples != 0) {
+        results.threadsafe_event_latency =
+            std::chrono::duration<double>(event_stats.total_latency).count() /
+            event_stats.latency_samples;
+    }
+    return results;
 }
 
 void System::Reschedule() {
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include "common/common_types.h"
 #include "core/frontend/applets/mii_selector.h"
@@ -117,6 +118,12 @@ public:
         shutdown_requested = true;
     }
 
+    /// Request the state of the system to be saved to a file, see Core::SaveState
+    void RequestSaveState(std::string path);
+
+    /// Request the state of the system to be loaded from a file, see Core::LoadState
+    void RequestLoadState(std::string path);
+
     /**
      * Load an executable application.
      * @param emu_window Reference to the host-system window used for video output and keyboard
@@ -251,6 +258,9 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Saves or loads the states that have been requested
+    void HandleStateRequests();
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -296,6 +306,10 @@ private:
 
     std::atomic<bool> reset_requested;
     std::atomic<bool> shutdown_requested;
+
+    std::mutex state_request_mutex;
+    std::string save_state_path;
+    std::string load_state_path;
 };
 
 inline ARM_Interface& CPU() {
@@ -6,16 +6,13 @@
 #include <cinttypes>
 #include <tuple>
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/core_timing.h"
 
 namespace Core {
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
-bool Timing::Event::operator>(const Event& right) const {
-    return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
-}
-
 bool Timing::Event::operator<(const Event& right) const {
     return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
 }
@@ -54,8 +51,8 @@ u64 Timing::GetIdleTicks() const {
     return static_cast<u64>(idled_cycles);
 }
 
-void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
-                           u64 userdata) {
+TimingEventToken Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
+                                       u64 userdata) {
     ASSERT(event_type != nullptr);
     s64 timeout = GetTicks() + cycles_into_future;
 
@@ -63,38 +60,69 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
     if (!is_global_timer_sane)
         ForceExceptionCheck(cycles_into_future);
 
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    return PushEvent(Event{timeout, event_fifo_id++, userdata, event_type, 0});
 }
 
 void Timing::ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventType* event_type,
                                      u64 userdata) {
-    ts_queue.Push(Event{global_timer + cycles_into_future, 0, userdata, event_type});
+    ThreadsafeEvent event{global_timer + cycles_into_future, userdata, event_type, std::nullopt};
+    thread_local u32 latency_sample_counter = 0;
+    if (++latency_sample_counter == LATENCY_SAMPLE_PERIOD) {
+        latency_sample_counter = 0;
+        event.schedule_time = std::chrono::steady_clock::now();
+    }
+
+    // Events that overflowed earlier are still waiting, this one must be moved after them
+    if (ts_overflow_size.load() != 0 || !ts_queue.TryPush(event)) {
+        ts_overflow_size.fetch_add(1);
+        ts_overflow_queue.Push(event);
+        ts_stats_overflowed_events.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
-void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    });
+Timing::ThreadsafeEventStats Timing::GetAndResetThreadsafeEventStats() {
+    ThreadsafeEventStats stats;
+    stats.events = ts_stats_events.exchange(0, std::memory_order_relaxed);
+    stats.max_queue_depth = ts_stats_max_queue_depth.exchange(0, std::memory_order_relaxed);
+    stats.overflowed_events = ts_stats_overflowed_events.exchange(0, std::memory_order_relaxed);
+    stats.latency_samples = ts_stats_latency_samples.exchange(0, std::memory_order_relaxed);
+    stats.total_latency = std::chrono::nanoseconds{
+        ts_stats_total_latency_ns.exchange(0, std::memory_order_relaxed)};
+    return stats;
+}
 
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+void Timing::UnscheduleEvent(TimingEventToken token) {
+    if (token.slot >= event_slots.size()) {
+        return;
+    }
+    const EventSlot& slot = event_slots[token.slot];
+    if (slot.generation == token.generation && slot.position != FREE_SLOT) {
+        RemoveEventAt(slot.position);
     }
 }
 
-void Timing::RemoveEvent(const TimingEventType* event_type) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
-                              [&](const Event& e) { return e.type == event_type; });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+template <typename Predicate>
+void Timing::RemoveEvents(Predicate predicate) {
+    // Removing an event moves others around, so the matching events are found first by slot
+    std::vector<u32> slots;
+    for (const Event& event : event_queue) {
+        if (predicate(event)) {
+            slots.push_back(event.slot);
+        }
+    }
+    for (const u32 slot : slots) {
+        RemoveEventAt(event_slots[slot].position);
     }
 }
 
+void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
+    RemoveEvents([&](const Event& e) { return e.type == event_type && e.userdata == userdata; });
+}
+
+void Timing::RemoveEvent(const TimingEventType* event_type) {
+    RemoveEvents([&](const Event& e) { return e.type == event_type; });
+}
+
 void Timing::RemoveNormalAndThreadsafeEvent(const TimingEventType* event_type) {
     MoveEvents();
     RemoveEvent(event_type);
@@ -109,13 +137,117 @@ void Timing::ForceExceptionCheck(s64 cycles) {
 }
 
 void Timing::MoveEvents() {
-    for (Event ev; ts_queue.Pop(ev);) {
-        ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    if (ts_queue.Empty() && ts_overflow_queue.Empty()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds latency{0};
+    u64 latency_samples = 0;
+    const auto move_event = [&](const ThreadsafeEvent& ev) {
+        if (ev.schedule_time) {
+            latency += now - *ev.schedule_time;
+            ++latency_samples;
+        }
+        PushEvent(Event{ev.time, event_fifo_id++, ev.userdata, ev.type, 0});
+    };
+    // The events in ts_queue were pushed before the ones in ts_overflow_queue, which is drained
+    // before other threads push to ts_queue again
+    std::size_t count = ts_queue.PopAll(move_event);
+    for (ThreadsafeEvent ev; ts_overflow_queue.Pop(ev); ++count) {
+        move_event(ev);
+        ts_overflow_size.fetch_sub(1);
+    }
+
+    ts_stats_events.fetch_add(count, std::memory_order_relaxed);
+    ts_stats_latency_samples.fetch_add(latency_samples, std::memory_order_relaxed);
+    ts_stats_total_latency_ns.fetch_add(latency.count(), std::memory_order_relaxed);
+    const u32 depth = static_cast<u32>(count);
+    if (depth > ts_stats_max_queue_depth.load(std::memory_order_relaxed)) {
+        ts_stats_max_queue_depth.store(depth, std::memory_order_relaxed);
     }
 }
 
+TimingEventToken Timing::PushEvent(Event event) {
+    if (free_event_slots.empty()) {
+        event_slots.push_back(EventSlot{FREE_SLOT, 1});
+        event.slot = static_cast<u32>(event_slots.size() - 1);
+    } else {
+        event.slot = free_event_slots.back();
+        free_event_slots.pop_back();
+    }
+
+    const TimingEventToken token{event.slot, event_slots[event.slot].generation};
+    event_queue.emplace_back(std::move(event));
+    SiftUp(event_queue.size() - 1);
+    return token;
+}
+
+Timing::Event Timing::RemoveEventAt(std::size_t position) {
+    Event event = std::move(event_queue[position]);
+    EventSlot& slot = event_slots[event.slot];
+    slot.position = FREE_SLOT;
+    // Invalidates the tokens of the event, generation 0 is never used
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    free_event_slots.push_back(event.slot);
+
+    Event last = std::move(event_queue.back());
+    event_queue.pop_back();
+    if (position < event_queue.size()) {
+        PlaceEvent(position, std::move(last));
+        if (position > 0 && event_queue[position] < event_queue[(position - 1) / QUEUE_ARITY]) {
+            SiftUp(position);
+        } else {
+            SiftDown(position);
+        }
+    }
+    return event;
+}
+
+void Timing::PlaceEvent(std::size_t position, Event event) {
+    event_slots[event.slot].position = static_cast<u32>(position);
+    event_queue[position] = std::move(event);
+}
+
+void Timing::SiftUp(std::size_t position) {
+    Event event = std::move(event_queue[position]);
+    while (position > 0) {
+        const std::size_t parent = (position - 1) / QUEUE_ARITY;
+        if (!(event < event_queue[parent])) {
+            break;
+        }
+        PlaceEvent(position, std::move(event_queue[parent]));
+        position = parent;
+    }
+    PlaceEvent(position, std::move(event));
+}
+
+void Timing::SiftDown(std::size_t position) {
+    const std::size_t size = event_queue.size();
+    Event event = std::move(event_queue[position]);
+    while (true) {
+        const std::size_t first_child = position * QUEUE_ARITY + 1;
+        if (first_child >= size) {
+            break;
+        }
+        const std::size_t last_child = std::min(first_child + QUEUE_ARITY, size);
+        std::size_t smallest = first_child;
+        for (std::size_t child = first_child + 1; child < last_child; ++child) {
+            if (event_queue[child] < event_queue[smallest]) {
+                smallest = child;
+            }
+        }
+        if (!(event_queue[smallest] < event)) {
+            break;
+        }
+        PlaceEvent(position, std::move(event_queue[smallest]));
+        position = smallest;
+    }
+    PlaceEvent(position, std::move(event));
+}
+
 void Timing::Advance() {
     MoveEvents();
 
@@ -126,9 +258,7 @@ void Timing::Advance() {
     is_global_timer_sane = true;
 
     while (!event_queue.empty() && event_queue.front().time <= global_timer) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+        Event evt = RemoveEventAt(0);
         evt.type->callback(evt.userdata, global_timer - evt.time);
     }
 
@@ -156,4 +286,84 @@ s64 Timing::GetDowncount() const {
     return downcount;
 }
 
+void Timing::DoState(PointerWrap& p) {
+    auto section = p.Section("CoreTiming", 1);
+    if (!section) {
+        return;
+    }
+
+    MoveEvents();
+    p.Do(global_timer);
+    p.Do(slice_length);
+    p.Do(downcount);
+    p.Do(event_fifo_id);
+    p.Do(idled_cycles);
+    p.Do(is_global_timer_sane);
+
+    const bool reading = p.GetMode() == PointerWrap::MODE_READ;
+    u32 num_slots = static_cast<u32>(event_slots.size());
+    p.Do(num_slots);
+    if (reading) {
+        event_slots.assign(p.error == PointerWrap::ERROR_FAILURE ? 0 : num_slots,
+                           EventSlot{FREE_SLOT, 1});
+    }
+    for (EventSlot& slot : event_slots) {
+        p.Do(slot.generation);
+    }
+
+    std::vector<Event> events;
+    if (!reading) {
+        events = event_queue;
+    }
+    u32 num_events = static_cast<u32>(events.size());
+    p.Do(num_events);
+    if (reading) {
+        events.resize(p.error == PointerWrap::ERROR_FAILURE ? 0 : num_events);
+    }
+    for (Event& event : events) {
+        p.Do(event.time);
+        p.Do(event.fifo_order);
+        p.Do(event.userdata);
+        p.Do(event.slot);
+
+        std::string name = reading ? std::string{} : *event.type->name;
+        p.Do(name);
+        if (!reading) {
+            continue;
+        }
+        auto itr = event_types.find(name);
+        if (itr == event_types.end()) {
+            LOG_ERROR(Core_Timing, "Unknown event type {} in save state", name);
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            break;
+        }
+        if (event.slot >= event_slots.size() || event_slots[event.slot].position != FREE_SLOT) {
+            LOG_ERROR(Core_Timing, "Invalid event slot {} in save state", event.slot);
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            break;
+        }
+        event.type = &itr->second;
+        event_slots[event.slot].position = 0;
+    }
+    if (!reading) {
+        return;
+    }
+
+    event_queue.clear();
+    free_event_slots.clear();
+    if (p.error == PointerWrap::ERROR_FAILURE) {
+        event_slots.clear();
+        return;
+    }
+    for (Event& event : events) {
+        event_queue.push_back(std::move(event));
+        SiftUp(event_queue.size() - 1);
+    }
+    for (u32 slot = 0; slot < event_slots.size(); ++slot) {
+        if (event_slots[slot].position == FREE_SLOT) {
+            free_event_slots.push_back(slot);
+        }
+    }
+}
+
 } // namespace Core
@@ -17,9 +17,11 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <limits>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -27,6 +29,8 @@
 #include "common/logging/log.h"
 #include "common/threadsafe_queue.h"
 
+class PointerWrap;
+
 // The timing we get from the assembly is 268,111,855.956 Hz
 // It is possible that this number isn't just an integer because the compiler could have
 // optimized the multiplication by a multiply-by-constant division.
@@ -132,8 +136,32 @@ struct TimingEventType {
     const std::string* name;
 };
 
+/**
+ * Identifies an event scheduled with Timing::ScheduleEvent, to unschedule it. A token stays valid
+ * across save states, and refers to no event once the event has fired or has been unscheduled.
+ */
+struct TimingEventToken {
+    u32 slot = 0;
+    u32 generation = 0; ///< Never 0 for a scheduled event
+};
+
 class Timing {
 public:
+    /// Statistics of the events scheduled from other threads, see ScheduleEventThreadsafe
+    struct ThreadsafeEventStats {
+        /// Number of events moved into the event queue
+        u64 events;
+        /// Largest number of events that were waiting to be moved at once
+        u32 max_queue_depth;
+        /// Number of events that went through the overflow queue
+        u64 overflowed_events;
+        /// Number of events whose latency was measured, one out of LATENCY_SAMPLE_PERIOD
+        u64 latency_samples;
+        /// Cumulative time between scheduling the sampled events and moving them into the event
+        /// queue
+        std::chrono::nanoseconds total_latency;
+    };
+
     ~Timing();
 
     /**
@@ -153,18 +181,29 @@ public:
      * After the first Advance, the slice lengths and the downcount will be reduced whenever an
      * event is scheduled earlier than the current values. Scheduling from a callback will not
      * update the downcount until the Advance() completes.
+     * @return A token to unschedule the event with
      */
-    void ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type, u64 userdata = 0);
+    TimingEventToken ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
+                                   u64 userdata = 0);
 
     /**
      * This is to be called when outside of hle threads, such as the graphics thread, wants to
      * schedule things to be executed on the main thread.
      * Not that this doesn't change slice_length and thus events scheduled by this might be called
      * with a delay of up to MAX_SLICE_LENGTH
+     * The event goes through a bounded lock-free queue, and only allocates if that queue is full.
+     * Events from the same thread are moved into the event queue in the order they were scheduled.
      */
     void ScheduleEventThreadsafe(s64 cycles_into_future, const TimingEventType* event_type,
                                  u64 userdata);
 
+    /// Can be called from any thread.
+    ThreadsafeEventStats GetAndResetThreadsafeEventStats();
+
+    /// Unschedules an event in O(log n). Does nothing if the event isn't scheduled anymore.
+    void UnscheduleEvent(TimingEventToken token);
+
+    /// Unschedules the events of a type with the given userdata. Scans the whole queue.
     void UnscheduleEvent(const TimingEventType* event_type, u64 userdata);
 
     /// We only permit one event of each type in the queue at a time.
@@ -189,19 +228,56 @@ public:
 
     s64 GetDowncount() const;
 
+    /**
+     * Saves or restores the clock and the event queue. Events are stored by the name of their
+     * type, which must have been registered before loading.
+     */
+    void DoState(PointerWrap& p);
+
 private:
     struct Event {
         s64 time;
         u64 fifo_order;
         u64 userdata;
         const TimingEventType* type;
+        u32 slot;
 
-        bool operator>(const Event& right) const;
         bool operator<(const Event& right) const;
     };
 
+    /// Tracks where the event a token refers to is in the queue
+    struct EventSlot {
+        u32 position;
+        u32 generation;
+    };
+
+    struct ThreadsafeEvent {
+        s64 time;
+        u64 userdata;
+        const TimingEventType* type;
+        /// Only set for the events whose latency is sampled
+        std::optional<std::chrono::steady_clock::time_point> schedule_time;
+    };
+
     static constexpr int MAX_SLICE_LENGTH = 20000;
 
+    /// Number of children of each node of the queue
+    static constexpr std::size_t QUEUE_ARITY = 4;
+    static constexpr u32 FREE_SLOT = std::numeric_limits<u32>::max();
+
+    /// Number of events from other threads that can wait to be moved without allocating
+    static constexpr std::size_t THREADSAFE_QUEUE_SIZE = 1024;
+    /// Reading the clock for every event from other threads is too expensive
+    static constexpr u32 LATENCY_SAMPLE_PERIOD = 64;
+
+    TimingEventToken PushEvent(Event event);
+    Event RemoveEventAt(std::size_t position);
+    template <typename Predicate>
+    void RemoveEvents(Predicate predicate);
+    void PlaceEvent(std::size_t position, Event event);
+    void SiftUp(std::size_t position);
+    void SiftDown(std::size_t position);
+
     s64 global_timer = 0;
     s64 slice_length = MAX_SLICE_LENGTH;
     s64 downcount = MAX_SLICE_LENGTH;
@@ -210,15 +286,28 @@ private:
     // elements remain stable regardless of rehashes/resizing.
     std::unordered_map<std::string, TimingEventType> event_types;
 
-    // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-    // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-    // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-    // accomodated by the standard adaptor class.
+    // The queue is an indexed 4-ary min-heap. Each event owns a slot that follows its position in
+    // the heap, so that the event can be erased through a token without searching for it. We don't
+    // use std::priority_queue because we need to be able to serialize, unserialize and erase
+    // arbitrary events regardless of the queue order.
     std::vector<Event> event_queue;
+    std::vector<EventSlot> event_slots;
+    std::vector<u32> free_event_slots;
     u64 event_fifo_id = 0;
     // the queue for storing the events from other threads threadsafe until they will be added
     // to the event_queue by the emu thread
-    Common::MPSCQueue<Event> ts_queue;
+    Common::BoundedMPSCQueue<ThreadsafeEvent, THREADSAFE_QUEUE_SIZE> ts_queue;
+    // the events that didn't fit in ts_queue. While it isn't empty, events are pushed to it
+    // rather than to ts_queue, so that they are moved in order once ts_queue has room again
+    Common::MPSCQueue<ThreadsafeEvent> ts_overflow_queue;
+    // number of events pushed to ts_overflow_queue that haven't been moved yet
+    std::atomic<std::size_t> ts_overflow_size{0};
+
+    std::atomic<u64> ts_stats_events{0};
+    std::atomic<u32> ts_stats_max_queue_depth{0};
+    std::atomic<u64> ts_stats_overflowed_events{0};
+    std::atomic<u64> ts_stats_latency_samples{0};
+    std::atomic<s64> ts_stats_total_latency_ns{0};
     s64 idled_cycles = 0;
 
     // Are we in a function that has been called from Advance()
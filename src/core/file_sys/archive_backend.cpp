@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <iomanip>
 #include <sstream>
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/file_sys/archive_backend.h"
@@ -118,4 +119,14 @@ std::vector<u8> Path::AsBinary() const {
         return {};
     }
 }
+
+void Path::DoState(PointerWrap& p) {
+    p.Do(type);
+    p.Do(binary);
+    p.Do(string);
+    std::vector<char16_t> u16_chars(u16str.begin(), u16str.end());
+    p.Do(u16_chars);
+    u16str.assign(u16_chars.begin(), u16_chars.end());
+}
+
 } // namespace FileSys
@@ -14,6 +14,8 @@
 #include "core/file_sys/delay_generator.h"
 #include "core/hle/result.h"
 
+class PointerWrap;
+
 namespace FileSys {
 
 class FileBackend;
@@ -59,6 +61,8 @@ public:
     std::u16string AsU16Str() const;
     std::vector<u8> AsBinary() const;
 
+    void DoState(PointerWrap& p);
+
 private:
     LowPathType type;
     std::vector<u8> binary;
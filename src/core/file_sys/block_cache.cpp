@@ -0,0 +1,51 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/file_sys/block_cache.h"
+
+namespace FileSys {
+
+BlockCache::BlockCache(std::size_t capacity) : capacity(capacity) {}
+
+BlockCache::~BlockCache() = default;
+
+BlockCache::Block BlockCache::Get(std::size_t index, const std::function<FillCallback>& fill) {
+    bool sequential;
+    {
+        std::lock_guard lock{mutex};
+        sequential = index == next_block;
+        next_block = index + 1;
+
+        const auto cached = blocks.find(index);
+        if (cached != blocks.end()) {
+            lru.splice(lru.begin(), lru, cached->second);
+            return cached->second->second;
+        }
+    }
+
+    std::vector<Block> read = fill(index, sequential);
+    if (read.empty())
+        return nullptr;
+
+    std::lock_guard lock{mutex};
+    // Inserted last to first, so that the block that was asked for is the most recently used
+    for (std::size_t i = read.size(); i-- > 0;) {
+        const auto cached = blocks.find(index + i);
+        if (cached != blocks.end()) {
+            // Another thread read the block in the meantime
+            if (i == 0)
+                read[0] = cached->second->second;
+            continue;
+        }
+        lru.emplace_front(index + i, read[i]);
+        blocks.emplace(index + i, lru.begin());
+    }
+    while (lru.size() > capacity) {
+        blocks.erase(lru.back().first);
+        lru.pop_back();
+    }
+    return read[0];
+}
+
+} // namespace FileSys
@@ -0,0 +1,58 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace FileSys {
+
+/**
+ * Cache of the most recently used blocks of data that take time to read, such as decrypted or
+ * decompressed blocks of a file. Several threads can use the cache at once: blocks are read without
+ * holding its lock, so that readers of other blocks don't wait.
+ */
+class BlockCache {
+public:
+    using Block = std::shared_ptr<const std::vector<u8>>;
+
+    /**
+     * Reads blocks for the cache.
+     * @param index Index of the block to read
+     * @param sequential Whether the block follows the last one asked for, in which case the blocks
+     *        that follow it can be read ahead
+     * @return The block and any blocks that follow it, or nothing if it couldn't be read
+     */
+    using FillCallback = std::vector<Block>(std::size_t index, bool sequential);
+
+    /// @param capacity Number of blocks kept in the cache
+    explicit BlockCache(std::size_t capacity);
+    ~BlockCache();
+
+    /**
+     * Returns a block from the cache, reading it if needed.
+     * @return The block, or nullptr if it couldn't be read
+     */
+    Block Get(std::size_t index, const std::function<FillCallback>& fill);
+
+private:
+    std::size_t capacity;
+
+    std::mutex mutex;
+    /// Cached blocks with their index, most recently used first
+    std::list<std::pair<std::size_t, Block>> lru;
+    std::unordered_map<std::size_t, decltype(lru)::iterator> blocks;
+    /// Index of the block following the last one asked for, which a sequential read asks next
+    std::size_t next_block = 0;
+};
+
+} // namespace FileSys
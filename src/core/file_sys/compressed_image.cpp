@@ -0,0 +1,358 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/logging/log.h"
+#include "common/lz4.h"
+#include "common/swap.h"
+#include "core/file_sys/compressed_image.h"
+#include "core/file_sys/ncch_container.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+/// Version of the image format, to be increased whenever the layout changes
+constexpr u32 ImageVersion = 1;
+
+constexpr std::array<u8, 4> ImageMagic{{'C', 'Z', 'I', 0x1A}};
+
+/// Blocks can't be larger than this, so that a corrupted header can't make reads allocate much
+constexpr std::size_t MaxBlockSize = 0x1000000;
+/// Images can't be larger than this, far above the size of any NCSD, so that computing the number
+/// of blocks from a corrupted header can't overflow
+constexpr u64 MaxImageSize = u64{1} << 40;
+
+/// Offset of the magic of NCSD and NCCH files, after their signature
+constexpr std::size_t ContentMagicOffset = 0x100;
+/// Offset of the partition table of NCSD files
+constexpr std::size_t PartitionTableOffset = 0x120;
+constexpr std::size_t MaxPartitions = 8;
+/// NCSD offsets and sizes are in media units
+constexpr std::size_t MediaUnitSize = 0x200;
+
+#pragma pack(push, 1)
+struct ImageHeader {
+    std::array<u8, 4> magic; ///< Identifies the file type (always "CZI"0x1A)
+    u32_le version;          ///< Version of the image format
+    u32_le content_magic;    ///< Magic of the image contents ("NCSD" or "NCCH")
+    u32_le block_size;       ///< Decompressed size of the blocks, except for the last one
+    u64_le image_size;       ///< Decompressed size of the image
+    u64_le num_blocks;       ///< Number of blocks, which is followed by the block offsets
+};
+static_assert(sizeof(ImageHeader) == 32, "ImageHeader should be 32 bytes");
+#pragma pack(pop)
+
+static bool ReadHeader(const FileUtil::IOFile& file, ImageHeader& header) {
+    return file.ReadAtOffset(&header, sizeof(header), 0) == sizeof(header) &&
+           header.magic == ImageMagic;
+}
+
+std::optional<u32> CompressedImage::ReadContentMagic(const FileUtil::IOFile& file) {
+    ImageHeader header;
+    if (!ReadHeader(file, header))
+        return std::nullopt;
+    return header.content_magic;
+}
+
+CompressedImage::CompressedImage(FileUtil::IOFile&& file_) : file(std::move(file_)) {
+    ImageHeader header;
+    if (!ReadHeader(file, header)) {
+        LOG_ERROR(Service_FS, "Not a compressed image");
+        return;
+    }
+    if (header.version != ImageVersion) {
+        LOG_ERROR(Service_FS, "Compressed image has an unsupported version {}", header.version);
+        return;
+    }
+
+    const u64 file_size = file.GetSize();
+    if (header.block_size == 0 || header.block_size > MaxBlockSize ||
+        header.image_size > MaxImageSize ||
+        header.num_blocks != (header.image_size + header.block_size - 1) / header.block_size ||
+        header.num_blocks >= (file_size - sizeof(header)) / sizeof(u64)) {
+        LOG_ERROR(Service_FS, "Compressed image has an invalid header");
+        return;
+    }
+
+    std::vector<u64_le> offsets(header.num_blocks + 1);
+    const std::size_t index_size = offsets.size() * sizeof(u64);
+    if (file.ReadAtOffset(offsets.data(), index_size, sizeof(header)) != index_size) {
+        LOG_ERROR(Service_FS, "Failed to read the block index of the compressed image");
+        return;
+    }
+
+    block_size = header.block_size;
+    image_size = header.image_size;
+    block_offsets.assign(offsets.begin(), offsets.end());
+
+    // Blocks follow each other, and compression never makes them larger
+    u64 previous_end = sizeof(header) + index_size;
+    for (std::size_t i = 0; i < header.num_blocks; ++i) {
+        if (block_offsets[i] < previous_end || block_offsets[i + 1] < block_offsets[i] ||
+            block_offsets[i + 1] - block_offsets[i] > GetBlockSize(i)) {
+            LOG_ERROR(Service_FS, "Compressed image has an invalid block index");
+            return;
+        }
+        previous_end = block_offsets[i + 1];
+    }
+    if (block_offsets.back() > file_size) {
+        LOG_ERROR(Service_FS, "Compressed image is truncated");
+        return;
+    }
+
+    content_magic = header.content_magic;
+    mapped_file = FileUtil::MappedFile(file);
+    is_valid = true;
+}
+
+CompressedImage::~CompressedImage() = default;
+
+std::size_t CompressedImage::Read(u64 offset, std::size_t length, u8* buffer) {
+    if (!is_valid || length == 0 || offset >= image_size)
+        return 0;
+    const std::size_t read_length =
+        static_cast<std::size_t>(std::min<u64>(length, image_size - offset));
+
+    std::size_t done = 0;
+    while (done < read_length) {
+        const u64 position = offset + done;
+        const std::size_t index = static_cast<std::size_t>(position / block_size);
+        const std::size_t block_offset = static_cast<std::size_t>(position % block_size);
+        const std::size_t size = GetBlockSize(index);
+
+        // Whole blocks are decompressed straight into the buffer, large reads would only flush the
+        // cache otherwise
+        if (block_offset == 0 && read_length - done >= size) {
+            if (!ReadBlock(index, buffer + done))
+                break;
+            done += size;
+            continue;
+        }
+
+        const BlockCache::Block block = cache.Get(index, [this](std::size_t block_index, bool) {
+            auto data = std::make_shared<std::vector<u8>>(GetBlockSize(block_index));
+            if (!ReadBlock(block_index, data->data()))
+                return std::vector<BlockCache::Block>{};
+            return std::vector<BlockCache::Block>{std::move(data)};
+        });
+        if (block == nullptr)
+            break;
+        const std::size_t chunk = std::min(read_length - done, size - block_offset);
+        std::memcpy(buffer + done, block->data() + block_offset, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+std::size_t CompressedImage::ReadStored(u64 offset, std::size_t length, u8* buffer) const {
+    if (!mapped_file.IsMapped())
+        return file.ReadAtOffset(buffer, length, offset);
+
+    if (offset >= mapped_file.Size())
+        return 0;
+    const std::size_t read_length =
+        static_cast<std::size_t>(std::min<u64>(length, mapped_file.Size() - offset));
+    std::memcpy(buffer, mapped_file.Data() + offset, read_length);
+    return read_length;
+}
+
+std::size_t CompressedImage::GetBlockSize(std::size_t index) const {
+    return static_cast<std::size_t>(std::min<u64>(block_size, image_size - index * block_size));
+}
+
+bool CompressedImage::ReadBlock(std::size_t index, u8* buffer) const {
+    const std::size_t size = GetBlockSize(index);
+    const std::size_t stored_size =
+        static_cast<std::size_t>(block_offsets[index + 1] - block_offsets[index]);
+
+    // Blocks that don't compress are stored as is
+    if (stored_size == size)
+        return ReadStored(block_offsets[index], size, buffer) == size;
+
+    // Mapped blocks are decompressed from the mapping without copying them first
+    std::vector<u8> stored;
+    const u8* data;
+    if (mapped_file.IsMapped()) {
+        data = mapped_file.Data() + block_offsets[index];
+    } else {
+        stored.resize(stored_size);
+        if (ReadStored(block_offsets[index], stored_size, stored.data()) != stored_size)
+            return false;
+        data = stored.data();
+    }
+
+    if (!Common::LZ4::Decompress(data, stored_size, buffer, size)) {
+        LOG_ERROR(Service_FS, "Block {} of the compressed image is corrupted", index);
+        return false;
+    }
+    return true;
+}
+
+/// Returns the offsets of the NCCH partitions of an NCSD or NCCH file
+static Loader::ResultStatus GetPartitions(const FileUtil::IOFile& file, u32& content_magic,
+                                          std::vector<u64>& partitions) {
+    if (file.ReadAtOffset(&content_magic, sizeof(content_magic), ContentMagicOffset) !=
+        sizeof(content_magic))
+        return Loader::ResultStatus::ErrorInvalidFormat;
+
+    if (content_magic == Loader::MakeMagic('N', 'C', 'C', 'H')) {
+        partitions.push_back(0);
+        return Loader::ResultStatus::Success;
+    }
+
+    if (content_magic != Loader::MakeMagic('N', 'C', 'S', 'D'))
+        return Loader::ResultStatus::ErrorInvalidFormat;
+
+    // Each partition has an offset and a size
+    std::array<u32_le, MaxPartitions * 2> table;
+    if (file.ReadAtOffset(table.data(), sizeof(table), PartitionTableOffset) != sizeof(table))
+        return Loader::ResultStatus::ErrorInvalidFormat;
+    for (std::size_t i = 0; i < MaxPartitions; ++i) {
+        if (table[i * 2 + 1] != 0)
+            partitions.push_back(static_cast<u64>(table[i * 2]) * MediaUnitSize);
+    }
+    return Loader::ResultStatus::Success;
+}
+
+/// Decrypts the parts of a block of the image that are encrypted
+static void DecryptBlock(const std::vector<NCCHContainer::EncryptedRegion>& regions, u64 offset,
+                         std::size_t size, u8* data) {
+    for (const auto& region : regions) {
+        const u64 start = std::max(offset, region.offset);
+        const u64 end = std::min(offset + size, region.offset + region.size);
+        if (start >= end)
+            continue;
+
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(region.key.data(), region.key.size(),
+                                                        region.ctr.data());
+        d.Seek(region.ctr_offset + (start - region.offset));
+        u8* const begin = data + (start - offset);
+        d.ProcessData(begin, begin, static_cast<std::size_t>(end - start));
+    }
+}
+
+/// Marks the headers of the partitions in a block of the image as not encrypted
+static void MarkDecrypted(const std::vector<u64>& partitions, u64 offset, std::size_t size,
+                          u8* data) {
+    for (u64 partition : partitions) {
+        // Partitions are aligned to media units, their headers never span two blocks
+        if (partition < offset || partition + sizeof(NCCH_Header) > offset + size)
+            continue;
+
+        NCCH_Header header;
+        std::memcpy(&header, data + (partition - offset), sizeof(header));
+        header.no_crypto.Assign(1);
+        std::memcpy(data + (partition - offset), &header, sizeof(header));
+    }
+}
+
+Loader::ResultStatus CompressImage(const std::string& source_path,
+                                   const std::string& destination_path,
+                                   const std::function<CompressProgressCallback>& update_callback) {
+    FileUtil::IOFile source(source_path, "rb");
+    if (!source.IsOpen()) {
+        LOG_ERROR(Service_FS, "Failed to open {}", source_path);
+        return Loader::ResultStatus::Error;
+    }
+    if (CompressedImage::ReadContentMagic(source)) {
+        LOG_ERROR(Service_FS, "{} is already a compressed image", source_path);
+        return Loader::ResultStatus::ErrorInvalidFormat;
+    }
+
+    u32 content_magic;
+    std::vector<u64> partitions;
+    Loader::ResultStatus result = GetPartitions(source, content_magic, partitions);
+    if (result != Loader::ResultStatus::Success) {
+        LOG_ERROR(Service_FS, "{} is not an NCSD or NCCH file", source_path);
+        return result;
+    }
+
+    std::vector<NCCHContainer::EncryptedRegion> regions;
+    for (u64 partition : partitions) {
+        NCCHContainer ncch(source_path, static_cast<u32>(partition));
+        result = ncch.GetEncryptedRegions(regions);
+        if (result != Loader::ResultStatus::Success) {
+            LOG_ERROR(Service_FS, "Failed to decrypt the partition at 0x{:X} of {}", partition,
+                      source_path);
+            return result;
+        }
+    }
+
+    FileUtil::IOFile destination(destination_path, "wb");
+    if (!destination.IsOpen()) {
+        LOG_ERROR(Service_FS, "Failed to create {}", destination_path);
+        return Loader::ResultStatus::Error;
+    }
+
+    const u64 image_size = source.GetSize();
+    const std::size_t block_size = CompressedImage::DefaultBlockSize;
+    const u64 num_blocks = (image_size + block_size - 1) / block_size;
+
+    ImageHeader header{};
+    header.magic = ImageMagic;
+    header.version = ImageVersion;
+    header.content_magic = content_magic;
+    header.block_size = static_cast<u32>(block_size);
+    header.image_size = image_size;
+    header.num_blocks = num_blocks;
+
+    // The block offsets are written once all the blocks are
+    std::vector<u64_le> offsets(num_blocks + 1);
+    const std::size_t index_size = offsets.size() * sizeof(u64);
+    bool written = destination.WriteBytes(&header, sizeof(header)) == sizeof(header) &&
+                   destination.WriteBytes(offsets.data(), index_size) == index_size;
+
+    std::vector<u8> block(block_size);
+    std::vector<u8> compressed(Common::LZ4::CompressBound(block_size));
+    u64 position = sizeof(header) + index_size;
+    for (u64 i = 0; written && i < num_blocks; ++i) {
+        const u64 offset = i * block_size;
+        const std::size_t size =
+            static_cast<std::size_t>(std::min<u64>(block_size, image_size - offset));
+        if (source.ReadAtOffset(block.data(), size, offset) != size) {
+            LOG_ERROR(Service_FS, "Failed to read {}", source_path);
+            written = false;
+            break;
+        }
+        DecryptBlock(regions, offset, size, block.data());
+        MarkDecrypted(partitions, offset, size, block.data());
+
+        // Blocks that don't get smaller are stored as is
+        std::size_t stored_size =
+            Common::LZ4::Compress(block.data(), size, compressed.data(), compressed.size());
+        const u8* stored = compressed.data();
+        if (stored_size == 0 || stored_size >= size) {
+            stored_size = size;
+            stored = block.data();
+        }
+
+        written = destination.WriteBytes(stored, stored_size) == stored_size;
+        offsets[i] = position;
+        position += stored_size;
+
+        if (update_callback)
+            update_callback(static_cast<std::size_t>(offset + size),
+                            static_cast<std::size_t>(image_size));
+    }
+    offsets[num_blocks] = position;
+
+    written = written && destination.Seek(sizeof(header), SEEK_SET) &&
+              destination.WriteBytes(offsets.data(), index_size) == index_size &&
+              destination.Close();
+    if (!written) {
+        LOG_ERROR(Service_FS, "Failed to write {}", destination_path);
+        destination.Close();
+        FileUtil::Delete(destination_path);
+        return Loader::ResultStatus::Error;
+    }
+
+    LOG_INFO(Service_FS, "Compressed {} from {} to {} bytes", source_path, image_size, position);
+    return Loader::ResultStatus::Success;
+}
+
+} // namespace FileSys
@@ -0,0 +1,110 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/file_sys/block_cache.h"
+
+namespace Loader {
+enum class ResultStatus;
+}
+
+namespace FileSys {
+
+/**
+ * Reads a compressed image of an NCSD (.3ds, .cci) or NCCH (.cxi) file, made by
+ * CompressImage. The NCCH partitions of the image are stored decrypted, so that they load without
+ * keys, and split in blocks that are compressed independently, so that any part of the image can
+ * be read without decompressing what comes before it.
+ *
+ * The file starts with a header followed by the offsets of the blocks in the file, plus the offset
+ * of the end of the last block. A block takes as much space as its decompressed size when it is
+ * stored as is, and less when it is compressed with LZ4.
+ *
+ * Reads don't go through the position of the file, so several threads can read at once.
+ * Decompressed blocks are kept in a small cache for reads that don't cover whole blocks.
+ */
+class CompressedImage {
+public:
+    static constexpr std::size_t DefaultBlockSize = 0x10000;
+
+    /**
+     * Checks whether a file is a compressed image, without moving its position.
+     * @return The magic of the image contents ("NCSD" or "NCCH") if it is one
+     */
+    static std::optional<u32> ReadContentMagic(const FileUtil::IOFile& file);
+
+    explicit CompressedImage(FileUtil::IOFile&& file);
+    ~CompressedImage();
+
+    /// Whether the file is a compressed image that has a consistent block index
+    bool IsValid() const {
+        return is_valid;
+    }
+
+    /// Returns the magic of the image contents ("NCSD" or "NCCH")
+    u32 GetContentMagic() const {
+        return content_magic;
+    }
+
+    /// Returns the size of the decompressed image
+    u64 GetSize() const {
+        return image_size;
+    }
+
+    /**
+     * Reads decompressed data from the image.
+     * @return The number of bytes read, which is less than asked when reaching the end of the
+     *         image or a corrupted block
+     */
+    std::size_t Read(u64 offset, std::size_t length, u8* buffer);
+
+private:
+    /// Number of blocks kept in the cache
+    static constexpr std::size_t CacheBlocks = 16;
+
+    /// Reads data from an offset of the file
+    std::size_t ReadStored(u64 offset, std::size_t length, u8* buffer) const;
+
+    /// Returns the decompressed size of a block
+    std::size_t GetBlockSize(std::size_t index) const;
+
+    /// Decompresses a block into a buffer of its size
+    bool ReadBlock(std::size_t index, u8* buffer) const;
+
+
+    FileUtil::IOFile file;
+    FileUtil::MappedFile mapped_file;
+    bool is_valid = false;
+    u32 content_magic = 0;
+    std::size_t block_size = 0;
+    u64 image_size = 0;
+    /// Offsets of the blocks in the file, followed by the offset of the end of the last one
+    std::vector<u64> block_offsets;
+
+    BlockCache cache{CacheBlocks};
+};
+
+/// Progress callback for CompressImage, receives bytes written and total bytes
+using CompressProgressCallback = void(std::size_t, std::size_t);
+
+/**
+ * Converts an NCSD or NCCH file to a compressed image, decrypting its partitions.
+ * @param source_path Path of the NCSD or NCCH file
+ * @param destination_path Path of the compressed image to write
+ * @param update_callback Called after each block with the progress of the conversion
+ * @return Success, or ErrorEncrypted when the keys needed to decrypt the file are missing
+ */
+Loader::ResultStatus CompressImage(
+    const std::string& source_path, const std::string& destination_path,
+    const std::function<CompressProgressCallback>& update_callback = nullptr);
+
+} // namespace FileSys
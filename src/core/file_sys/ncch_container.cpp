@@ -154,6 +154,7 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
 NCCHContainer::NCCHContainer(const std::string& filepath, u32 ncch_offset)
     : ncch_offset(ncch_offset), filepath(filepath) {
     file = FileUtil::IOFile(filepath, "rb");
+    OpenImage();
 }
 
 Loader::ResultStatus NCCHContainer::OpenFile(const std::string& filepath, u32 ncch_offset) {
@@ -166,28 +167,43 @@ Loader::ResultStatus NCCHContainer::OpenFile(const std::string& filepath, u32 nc
         return Loader::ResultStatus::Error;
     }
 
+    OpenImage();
     LOG_DEBUG(Service_FS, "Opened {}", filepath);
     return Loader::ResultStatus::Success;
 }
 
+void NCCHContainer::OpenImage() {
+    image.reset();
+    if (file.IsOpen() && CompressedImage::ReadContentMagic(file)) {
+        LOG_DEBUG(Service_FS, "{} is a compressed image", filepath);
+        image = std::make_shared<CompressedImage>(FileUtil::IOFile(filepath, "rb"));
+    }
+}
+
+bool NCCHContainer::ReadAt(u64 offset, void* buffer, std::size_t size) {
+    if (image)
+        return image->Read(offset, size, static_cast<u8*>(buffer)) == size;
+    return file.ReadAtOffset(buffer, size, offset) == size;
+}
+
+u64 NCCHContainer::GetSize() {
+    return image ? image->GetSize() : file.GetSize();
+}
+
 Loader::ResultStatus NCCHContainer::Load() {
     LOG_INFO(Service_FS, "Loading NCCH from file {}", filepath);
     if (is_loaded)
         return Loader::ResultStatus::Success;
 
     if (file.IsOpen()) {
-        // Reset read pointer in case this file has been read before.
-        file.Seek(ncch_offset, SEEK_SET);
-
-        if (file.ReadBytes(&ncch_header, sizeof(NCCH_Header)) != sizeof(NCCH_Header))
+        if (!ReadAt(ncch_offset, &ncch_header, sizeof(NCCH_Header)))
             return Loader::ResultStatus::Error;
 
         // Skip NCSD header and load first NCCH (NCSD is just a container of NCCH files)...
         if (Loader::MakeMagic('N', 'C', 'S', 'D') == ncch_header.magic) {
             LOG_DEBUG(Service_FS, "Only loading the first (bootable) NCCH within the NCSD file!");
             ncch_offset += 0x4000;
-            file.Seek(ncch_offset, SEEK_SET);
-            file.ReadBytes(&ncch_header, sizeof(NCCH_Header));
+            ReadAt(ncch_offset, &ncch_header, sizeof(NCCH_Header));
         }
 
         // Verify we are loading the correct file type...
@@ -195,7 +211,6 @@ Loader::ResultStatus NCCHContainer::Load() {
             return Loader::ResultStatus::ErrorInvalidFormat;
 
         has_header = true;
-        bool failed_to_decrypt = false;
         if (!ncch_header.no_crypto) {
             is_encrypted = true;
 
@@ -232,12 +247,17 @@ Loader::ResultStatus NCCHContainer::Load() {
                     }
                 }
 
-                SetKeyY(KeySlotID::NCCHSecure1, key_y_primary);
-                if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure1)) {
-                    LOG_ERROR(Service_FS, "Secure1 KeyX missing");
-                    failed_to_decrypt = true;
-                }
-                primary_key = GetNormalKey(KeySlotID::NCCHSecure1);
+                const auto derive_key = [this](std::size_t slot_id, const AESKey& key_y,
+                                               const char* name) {
+                    const auto key = DeriveNormalKey(slot_id, key_y);
+                    if (!key) {
+                        LOG_ERROR(Service_FS, "{} KeyX missing", name);
+                        failed_to_decrypt = true;
+                    }
+                    return key.value_or(AESKey{});
+                };
+
+                primary_key = derive_key(KeySlotID::NCCHSecure1, key_y_primary, "Secure1");
 
                 switch (ncch_header.secondary_key_slot) {
                 case 0:
@@ -246,30 +266,18 @@ Loader::ResultStatus NCCHContainer::Load() {
                     break;
                 case 1:
                     LOG_DEBUG(Service_FS, "Secure2 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure2, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure2)) {
-                        LOG_ERROR(Service_FS, "Secure2 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure2);
+                    secondary_key =
+                        derive_key(KeySlotID::NCCHSecure2, key_y_secondary, "Secure2");
                     break;
                 case 10:
                     LOG_DEBUG(Service_FS, "Secure3 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure3, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure3)) {
-                        LOG_ERROR(Service_FS, "Secure3 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure3);
+                    secondary_key =
+                        derive_key(KeySlotID::NCCHSecure3, key_y_secondary, "Secure3");
                     break;
                 case 11:
                     LOG_DEBUG(Service_FS, "Secure4 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure4, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure4)) {
-                        LOG_ERROR(Service_FS, "Secure4 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure4);
+                    secondary_key =
+                        derive_key(KeySlotID::NCCHSecure4, key_y_secondary, "Secure4");
                     break;
                 }
             }
@@ -320,15 +328,12 @@ Loader::ResultStatus NCCHContainer::Load() {
 
         // System archives and DLC don't have an extended header but have RomFS
         if (ncch_header.extended_header_size) {
-            auto read_exheader = [this](FileUtil::IOFile& file) {
-                const std::size_t size = sizeof(exheader_header);
-                return file && file.ReadBytes(&exheader_header, size) == size;
-            };
-
+            const std::size_t size = sizeof(exheader_header);
             FileUtil::IOFile exheader_override_file{filepath + ".exheader", "rb"};
-            if (read_exheader(exheader_override_file)) {
+            if (exheader_override_file &&
+                exheader_override_file.ReadBytes(&exheader_header, size) == size) {
                 is_tainted = true;
-            } else if (!read_exheader(file)) {
+            } else if (!ReadAt(ncch_offset + sizeof(NCCH_Header), &exheader_header, size)) {
                 return Loader::ResultStatus::Error;
             }
 
@@ -387,8 +392,7 @@ Loader::ResultStatus NCCHContainer::Load() {
             LOG_DEBUG(Service_FS, "ExeFS offset:                0x{:08X}", exefs_offset);
             LOG_DEBUG(Service_FS, "ExeFS size:                  0x{:08X}", exefs_size);
 
-            file.Seek(exefs_offset + ncch_offset, SEEK_SET);
-            if (file.ReadBytes(&exefs_header, sizeof(ExeFs_Header)) != sizeof(ExeFs_Header))
+            if (!ReadAt(exefs_offset + ncch_offset, &exefs_header, sizeof(ExeFs_Header)))
                 return Loader::ResultStatus::Error;
 
             if (is_encrypted) {
@@ -434,6 +438,7 @@ Loader::ResultStatus NCCHContainer::LoadOverrides() {
             exefs_offset = 0;
             is_tainted = true;
             has_exefs = true;
+            has_exefs_override = true;
         } else {
             exefs_file = FileUtil::IOFile(filepath, "rb");
         }
@@ -467,9 +472,7 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
             std::size_t logo_size = ncch_header.logo_region_size * kBlockSize;
 
             buffer.resize(logo_size);
-            file.Seek(ncch_offset + logo_offset, SEEK_SET);
-
-            if (file.ReadBytes(buffer.data(), logo_size) != logo_size) {
+            if (!ReadAt(ncch_offset + logo_offset, buffer.data(), logo_size)) {
                 LOG_ERROR(Service_FS, "Could not read NCCH logo");
                 return Loader::ResultStatus::Error;
             }
@@ -497,6 +500,14 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 (section.offset + exefs_offset + sizeof(ExeFs_Header) + ncch_offset);
             exefs_file.Seek(section_offset, SEEK_SET);
 
+            // Sections of compressed images are read from the image, unless an override file
+            // replaced the ExeFS
+            const auto read_section = [&](u8* data, std::size_t size) {
+                if (image && !has_exefs_override)
+                    return ReadAt(section_offset, data, size);
+                return exefs_file.ReadBytes(data, size) == size;
+            };
+
             std::array<u8, 16> key;
             if (strcmp(section.name, "icon") == 0 || strcmp(section.name, "banner") == 0) {
                 key = primary_key;
@@ -517,7 +528,7 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                     return Loader::ResultStatus::ErrorMemoryAllocationFailed;
                 }
 
-                if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
+                if (!read_section(&temp_buffer[0], section.size))
                     return Loader::ResultStatus::Error;
 
                 if (is_encrypted) {
@@ -532,7 +543,7 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
             } else {
                 // Section is uncompressed...
                 buffer.resize(section.size);
-                if (exefs_file.ReadBytes(&buffer[0], section.size) != section.size)
+                if (!read_section(&buffer[0], section.size))
                     return Loader::ResultStatus::Error;
                 if (is_encrypted) {
                     dec.ProcessData(&buffer[0], &buffer[0], section.size);
@@ -613,9 +624,15 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     LOG_DEBUG(Service_FS, "RomFS offset:           0x{:08X}", romfs_offset);
     LOG_DEBUG(Service_FS, "RomFS size:             0x{:08X}", romfs_size);
 
-    if (file.GetSize() < romfs_offset + romfs_size)
+    if (GetSize() < romfs_offset + romfs_size)
         return Loader::ResultStatus::Error;
 
+    // Compressed images are decrypted already
+    if (image) {
+        romfs_file = std::make_shared<RomFSReader>(image, romfs_offset, romfs_size);
+        return Loader::ResultStatus::Success;
+    }
+
     // We reopen the file, to allow its position to be independent from file's
     FileUtil::IOFile romfs_file_inner(filepath, "rb");
     if (!romfs_file_inner.IsOpen())
@@ -695,6 +712,56 @@ Loader::ResultStatus NCCHContainer::ReadExtdataId(u64& extdata_id) {
     return Loader::ResultStatus::Success;
 }
 
+Loader::ResultStatus NCCHContainer::GetEncryptedRegions(std::vector<EncryptedRegion>& regions) {
+    Loader::ResultStatus result = Load();
+    if (result != Loader::ResultStatus::Success)
+        return result;
+
+    if (!is_encrypted)
+        return Loader::ResultStatus::Success;
+
+    if (failed_to_decrypt) {
+        LOG_ERROR(Service_FS, "Failed to decrypt");
+        return Loader::ResultStatus::ErrorEncrypted;
+    }
+
+    if (ncch_header.extended_header_size) {
+        regions.push_back({ncch_offset + sizeof(NCCH_Header), sizeof(ExHeader_Header), primary_key,
+                           exheader_ctr, 0});
+    }
+
+    if (ncch_header.exefs_size) {
+        // The ExeFS header is read again, as the loaded one can come from an override file
+        const u64 header_offset = ncch_offset + ncch_header.exefs_offset * kBlockSize;
+        ExeFs_Header header;
+        if (!ReadAt(header_offset, &header, sizeof(header)))
+            return Loader::ResultStatus::Error;
+        CryptoPP::byte* data = reinterpret_cast<CryptoPP::byte*>(&header);
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption(primary_key.data(), primary_key.size(),
+                                                      exefs_ctr.data())
+            .ProcessData(data, data, sizeof(header));
+        regions.push_back({header_offset, sizeof(header), primary_key, exefs_ctr, 0});
+
+        for (const auto& section : header.section) {
+            if (section.size == 0)
+                continue;
+            const bool is_primary = std::strncmp(section.name, "icon", sizeof(section.name)) == 0 ||
+                                    std::strncmp(section.name, "banner", sizeof(section.name)) == 0;
+            const u64 section_offset = sizeof(ExeFs_Header) + section.offset;
+            regions.push_back({header_offset + section_offset, section.size,
+                               is_primary ? primary_key : secondary_key, exefs_ctr,
+                               section_offset});
+        }
+    }
+
+    if (has_romfs) {
+        regions.push_back({ncch_offset + ncch_header.romfs_offset * kBlockSize,
+                           static_cast<u64>(ncch_header.romfs_size) * kBlockSize, secondary_key,
+                           romfs_ctr, 0});
+    }
+    return Loader::ResultStatus::Success;
+}
+
 bool NCCHContainer::HasExeFS() {
     Loader::ResultStatus result = Load();
     if (result != Loader::ResultStatus::Success)
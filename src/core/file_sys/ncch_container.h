@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -13,6 +14,7 @@
 #include "common/file_util.h"
 #include "common/swap.h"
 #include "core/core.h"
+#include "core/file_sys/compressed_image.h"
 #include "core/file_sys/romfs_reader.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -204,6 +206,15 @@ namespace FileSys {
  */
 class NCCHContainer {
 public:
+    /// A part of the NCCH file that is encrypted with AES-CTR
+    struct EncryptedRegion {
+        u64 offset; ///< Offset of the region in the file
+        u64 size;
+        std::array<u8, 16> key;
+        std::array<u8, 16> ctr;
+        u64 ctr_offset; ///< Offset of the region in the CTR stream
+    };
+
     NCCHContainer(const std::string& filepath, u32 ncch_offset = 0);
     NCCHContainer() {}
 
@@ -289,21 +300,39 @@ public:
      */
     bool HasExHeader();
 
+    /**
+     * Get the encrypted parts of the NCCH file, to decrypt it as a whole
+     * @param regions Vector the regions are appended to, left as is when the NCCH isn't encrypted
+     * @return ResultStatus result of function
+     */
+    Loader::ResultStatus GetEncryptedRegions(std::vector<EncryptedRegion>& regions);
+
     NCCH_Header ncch_header;
     ExeFs_Header exefs_header;
     ExHeader_Header exheader_header;
 
 private:
+    /// Opens the file as a compressed image if it is one
+    void OpenImage();
+
+    /// Reads from the NCCH file, or from the compressed image it is stored in
+    bool ReadAt(u64 offset, void* buffer, std::size_t size);
+
+    /// Returns the size of the NCCH file, or of the image in the compressed image
+    u64 GetSize();
+
     bool has_header = false;
     bool has_exheader = false;
     bool has_exefs = false;
     bool has_romfs = false;
 
     bool is_tainted = false; // Are there parts of this container being overridden?
+    bool has_exefs_override = false;
     bool is_loaded = false;
     bool is_compressed = false;
 
     bool is_encrypted = false;
+    bool failed_to_decrypt = false;
     // for decrypting exheader, exefs header and icon/banner section
     std::array<u8, 16> primary_key{};
     std::array<u8, 16> secondary_key{}; // for decrypting romfs and .code section
@@ -317,6 +346,7 @@ private:
     std::string filepath;
     FileUtil::IOFile file;
     FileUtil::IOFile exefs_file;
+    std::shared_ptr<CompressedImage> image;
 };
 
 } // namespace FileSys
@@ -1,22 +1,106 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "core/file_sys/romfs_reader.h"
 
 namespace FileSys {
 
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size) {
+    mapped_file = FileUtil::MappedFile(this->file);
+}
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
+                         const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
+                         std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size) {
+    mapped_file = FileUtil::MappedFile(this->file);
+}
+
+RomFSReader::RomFSReader(std::shared_ptr<CompressedImage> image, std::size_t image_offset,
+                         std::size_t data_size)
+    : is_encrypted(false), image(std::move(image)), file_offset(image_offset),
+      data_size(data_size) {}
+
+RomFSReader::~RomFSReader() = default;
+
 std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
-        return 0; // Crypto++ does not like zero size buffer
-    file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length = std::min(length, data_size - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    if (length == 0 || offset >= data_size)
+        return 0;
+    const std::size_t read_length = std::min(length, data_size - offset);
+    if (!is_encrypted)
+        return ReadRaw(offset, read_length, buffer);
+
+    std::size_t done = 0;
+    while (done < read_length) {
+        const std::size_t position = offset + done;
+        const std::size_t block_offset = position % BlockSize;
+
+        // Whole blocks are decrypted straight into the buffer, large reads would only flush the
+        // cache otherwise
+        const std::size_t whole_blocks = (read_length - done) / BlockSize * BlockSize;
+        if (block_offset == 0 && whole_blocks != 0) {
+            const std::size_t read = ReadRaw(position, whole_blocks, buffer + done);
+            Decrypt(position, read, buffer + done);
+            done += read;
+            if (read != whole_blocks)
+                break;
+            continue;
+        }
+
+        const BlockCache::Block block =
+            cache.Get(position / BlockSize, [this](std::size_t index, bool sequential) {
+                return ReadBlocks(index, sequential);
+            });
+        if (block->size() <= block_offset)
+            break;
+        const std::size_t chunk = std::min(read_length - done, block->size() - block_offset);
+        std::memcpy(buffer + done, block->data() + block_offset, chunk);
+        done += chunk;
     }
+    return done;
+}
+
+std::size_t RomFSReader::ReadRaw(std::size_t offset, std::size_t length, u8* buffer) const {
+    const std::size_t position = file_offset + offset;
+    if (image)
+        return image->Read(position, length, buffer);
+    if (!mapped_file.IsMapped())
+        return file.ReadAtOffset(buffer, length, position);
+
+    if (position >= mapped_file.Size())
+        return 0;
+    const std::size_t read_length = std::min(length, mapped_file.Size() - position);
+    std::memcpy(buffer, mapped_file.Data() + position, read_length);
     return read_length;
 }
 
+void RomFSReader::Decrypt(std::size_t offset, std::size_t length, u8* data) const {
+    if (length == 0)
+        return; // Crypto++ does not like zero size buffer
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
+    d.Seek(crypto_offset + offset);
+    d.ProcessData(data, data, length);
+}
+
+std::vector<BlockCache::Block> RomFSReader::ReadBlocks(std::size_t index, bool sequential) const {
+    // Sequential reads also fill the cache with the blocks they are going to read
+    const std::size_t num_blocks = (data_size + BlockSize - 1) / BlockSize;
+    const std::size_t count = std::min(sequential ? 1 + PrefetchBlocks : 1, num_blocks - index);
+
+    std::vector<u8> data(std::min(count * BlockSize, data_size - index * BlockSize));
+    data.resize(ReadRaw(index * BlockSize, data.size(), data.data()));
+    Decrypt(index * BlockSize, data.size(), data.data());
+
+    std::vector<BlockCache::Block> blocks;
+    for (std::size_t start = 0; start == 0 || start < data.size(); start += BlockSize) {
+        const auto begin = data.begin() + start;
+        const auto end = data.begin() + std::min(start + BlockSize, data.size());
+        blocks.push_back(std::make_shared<const std::vector<u8>>(begin, end));
+    }
+    return blocks;
+}
+
 } // namespace FileSys
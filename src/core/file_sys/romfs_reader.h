@@ -1,22 +1,33 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
+#include "core/file_sys/block_cache.h"
+#include "core/file_sys/compressed_image.h"
 
 namespace FileSys {
 
+/**
+ * Reads the RomFS of a title from a file, decrypting it if needed. Reads don't go through the
+ * position of the file, so several threads can read at once: the file is mapped into memory when
+ * possible, and read with positional reads otherwise. Decrypted data is kept in a cache of blocks,
+ * which is filled ahead of sequential reads. The RomFS can also be read from a compressed image.
+ */
 class RomFSReader {
 public:
-    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                 const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                std::size_t crypto_offset);
+
+    RomFSReader(std::shared_ptr<CompressedImage> image, std::size_t image_offset,
+                std::size_t data_size);
+
+    ~RomFSReader();
 
     std::size_t GetSize() const {
         return data_size;
@@ -25,13 +36,33 @@ public:
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer);
 
 private:
+    /// Size of the blocks of decrypted data kept in the cache
+    static constexpr std::size_t BlockSize = 0x10000;
+    /// Number of blocks kept in the cache
+    static constexpr std::size_t CacheBlocks = 64;
+    /// Number of blocks decrypted ahead of a sequential read
+    static constexpr std::size_t PrefetchBlocks = 3;
+
+    /// Reads data from an offset of the RomFS without decrypting it
+    std::size_t ReadRaw(std::size_t offset, std::size_t length, u8* buffer) const;
+
+    /// Decrypts data read from an offset of the RomFS in place
+    void Decrypt(std::size_t offset, std::size_t length, u8* data) const;
+
+    /// Reads and decrypts a block, and the ones that follow it when the reads are sequential
+    std::vector<BlockCache::Block> ReadBlocks(std::size_t index, bool sequential) const;
+
     bool is_encrypted;
     FileUtil::IOFile file;
+    FileUtil::MappedFile mapped_file;
+    std::shared_ptr<CompressedImage> image;
     std::array<u8, 16> key;
     std::array<u8, 16> ctr;
     std::size_t file_offset;
     std::size_t crypto_offset;
     std::size_t data_size;
+
+    BlockCache cache{CacheBlocks};
 };
 
 } // namespace FileSys
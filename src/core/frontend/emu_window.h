@@ -12,6 +12,21 @@
 
 namespace Frontend {
 
+/**
+ * A graphics context sharing its objects with the one of an EmuWindow, used to create them from
+ * another thread. It is made current on a single thread at a time.
+ */
+class GraphicsContext {
+public:
+    virtual ~GraphicsContext();
+
+    /// Makes the graphics context current for the caller thread
+    virtual void MakeCurrent() = 0;
+
+    /// Releases the graphics context from the caller thread
+    virtual void DoneCurrent() = 0;
+};
+
 /**
  * Abstraction class used to provide an interface between emulation code and the frontend
  * (e.g. SDL, QGLWidget, GLFW, etc...).
@@ -52,6 +67,15 @@ public:
     /// Releases (dunno if this is the "right" word) the GLFW context from the caller thread
     virtual void DoneCurrent() = 0;
 
+    /**
+     * Creates a graphics context sharing its objects with the one of this window. Must be called
+     * while the context of the window is current.
+     * @returns The new context, or nullptr if the frontend does not support shared contexts
+     */
+    virtual std::unique_ptr<GraphicsContext> CreateSharedContext() const {
+        return nullptr;
+    }
+
     /**
      * Signal that a touch pressed event has occurred (e.g. mouse click pressed)
      * @param framebuffer_x Framebuffer x-coordinate that was pressed
@@ -8,6 +8,7 @@
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 #include "core/memory.h"
 
@@ -65,6 +66,16 @@ std::shared_ptr<Thread> AddressArbiter::ResumeHighestPriorityThread(VAddr addres
     return thread;
 }
 
+std::function<Thread::WakeupCallback> AddressArbiter::MakeTimeoutCallback() {
+    return [this](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                  std::shared_ptr<WaitObject> object) {
+        ASSERT(reason == ThreadWakeupReason::Timeout);
+        // Remove the newly-awakened thread from the Arbiter's waiting list.
+        waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
+                              waiting_threads.end());
+    };
+}
+
 AddressArbiter::AddressArbiter(KernelSystem& kernel) : Object(kernel), kernel(kernel) {}
 AddressArbiter::~AddressArbiter() {}
 
@@ -79,14 +90,6 @@ std::shared_ptr<AddressArbiter> KernelSystem::CreateAddressArbiter(std::string n
 ResultCode AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type,
                                             VAddr address, s32 value, u64 nanoseconds) {
 
-    auto timeout_callback = [this](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
-                                   std::shared_ptr<WaitObject> object) {
-        ASSERT(reason == ThreadWakeupReason::Timeout);
-        // Remove the newly-awakened thread from the Arbiter's waiting list.
-        waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
-                              waiting_threads.end());
-    };
-
     switch (type) {
 
     // Signal thread(s) waiting for arbitrate address...
@@ -109,7 +112,7 @@ ResultCode AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, Arbi
         break;
     case ArbitrationType::WaitIfLessThanWithTimeout:
         if ((s32)kernel.memory.Read32(address) < value) {
-            thread->wakeup_callback = timeout_callback;
+            thread->SetWakeupCallback(ThreadWakeupKind::ArbitrateTimeout, MakeTimeoutCallback());
             thread->WakeAfterDelay(nanoseconds);
             WaitThread(std::move(thread), address);
         }
@@ -128,7 +131,7 @@ ResultCode AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, Arbi
         if (memory_value < value) {
             // Only change the memory value if the thread should wait
             kernel.memory.Write32(address, (s32)memory_value - 1);
-            thread->wakeup_callback = timeout_callback;
+            thread->SetWakeupCallback(ThreadWakeupKind::ArbitrateTimeout, MakeTimeoutCallback());
             thread->WakeAfterDelay(nanoseconds);
             WaitThread(std::move(thread), address);
         }
@@ -150,4 +153,20 @@ ResultCode AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, Arbi
     return RESULT_SUCCESS;
 }
 
+void AddressArbiter::DoState(StateWrap& state) {
+    state.Do(name);
+    state.DoObjects(waiting_threads);
+
+    // The threads may not be fully restored yet, so their callbacks are installed at the end
+    if (state.IsReading()) {
+        state.Defer([this] {
+            for (auto& thread : waiting_threads) {
+                if (thread->wakeup_kind == ThreadWakeupKind::ArbitrateTimeout) {
+                    thread->wakeup_callback = MakeTimeoutCallback();
+                }
+            }
+        });
+    }
+}
+
 } // namespace Kernel
@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 
 // Address arbiters are an underlying kernel synchronization object that can be created/used via
@@ -47,6 +49,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     std::string name; ///< Name of address arbiter object (optional)
 
     ResultCode ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type, VAddr address,
@@ -65,6 +69,9 @@ private:
     /// the resumed thread.
     std::shared_ptr<Thread> ResumeHighestPriorityThread(VAddr address);
 
+    /// Creates the wakeup callback of threads that wait on an address with a timeout.
+    std::function<Thread::WakeupCallback> MakeTimeoutCallback();
+
     /// Threads waiting for the address arbiter to be signaled.
     std::vector<std::shared_ptr<Thread>> waiting_threads;
 };
@@ -10,6 +10,7 @@
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/state_wrap.h"
 
 namespace Kernel {
 
@@ -45,4 +46,11 @@ void ClientPort::ConnectionClosed() {
     --active_sessions;
 }
 
+void ClientPort::DoState(StateWrap& state) {
+    state.Do(max_sessions);
+    state.Do(active_sessions);
+    state.Do(name);
+    state.DoObject(server_port);
+}
+
 } // namespace Kernel
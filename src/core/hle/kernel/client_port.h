@@ -33,6 +33,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     std::shared_ptr<ServerPort> GetServerPort() const {
         return server_port;
     }
@@ -9,6 +9,7 @@
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -52,4 +53,9 @@ ResultCode ClientSession::SendSyncRequest(std::shared_ptr<Thread> thread) {
     return server->HandleSyncRequest(std::move(thread));
 }
 
+void ClientSession::DoState(StateWrap& state) {
+    state.Do(name);
+    state.DoSession(parent);
+}
+
 } // namespace Kernel
@@ -35,6 +35,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     /**
      * Sends an SyncRequest from the current emulated thread.
      * @param thread Thread that initiated the request.
@@ -8,6 +8,7 @@
 #include "common/assert.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -52,4 +53,11 @@ void Event::WakeupAllWaitingThreads() {
         signaled = false;
 }
 
+void Event::DoState(StateWrap& state) {
+    state.Do(reset_type);
+    state.Do(signaled);
+    state.Do(name);
+    DoWaitObjectState(state);
+}
+
 } // namespace Kernel
@@ -30,6 +30,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     ResetType GetResetType() const {
         return reset_type;
     }
@@ -8,6 +8,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -102,4 +103,31 @@ void HandleTable::Clear() {
     next_free_slot = 0;
 }
 
+void HandleTable::DoState(StateWrap& state) {
+    state.Do(generations);
+    state.Do(next_generation);
+    state.Do(next_free_slot);
+
+    // Only the used slots are stored
+    std::vector<u16> slots;
+    if (!state.IsReading()) {
+        for (u16 i = 0; i < MAX_COUNT; ++i) {
+            if (objects[i] != nullptr) {
+                slots.push_back(i);
+            }
+        }
+    }
+    state.Do(slots);
+    if (state.IsReading()) {
+        objects.fill(nullptr);
+    }
+    for (u16 slot : slots) {
+        if (slot >= MAX_COUNT) {
+            state.Fail("invalid handle slot");
+            return;
+        }
+        state.DoObject(objects[slot]);
+    }
+}
+
 } // namespace Kernel
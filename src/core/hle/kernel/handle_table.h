@@ -90,6 +90,8 @@ public:
     /// Closes all handles held in this table.
     void Clear();
 
+    void DoState(StateWrap& state);
+
 private:
     /**
      * This is the maximum limit of handles allowed per process in CTR-OS. It can be further
@@ -12,6 +12,7 @@
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/state_wrap.h"
 
 namespace Kernel {
 
@@ -32,13 +33,25 @@ void SessionRequestHandler::ClientDisconnected(std::shared_ptr<ServerSession> se
         connected_sessions.end());
 }
 
+void SessionRequestHandler::DoSessionState(StateWrap& state,
+                                           const std::shared_ptr<ServerSession>& server_session) {
+    auto itr = std::find_if(
+        connected_sessions.begin(), connected_sessions.end(),
+        [&](const SessionInfo& info) { return info.session == server_session; });
+    if (itr == connected_sessions.end()) {
+        state.Fail("session is not connected to its handler");
+        return;
+    }
+    itr->data->DoState(state);
+}
+
 std::shared_ptr<Event> HLERequestContext::SleepClientThread(const std::string& reason,
                                                             std::chrono::nanoseconds timeout,
                                                             WakeupCallback&& callback) {
     // Put the client thread to sleep until the wait event is signaled or the timeout expires.
-    thread->wakeup_callback = [context = *this,
-                               callback](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
-                                         std::shared_ptr<WaitObject> object) mutable {
+    auto wakeup_callback = [context = *this,
+                            callback](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                                      std::shared_ptr<WaitObject> object) mutable {
         ASSERT(thread->status == ThreadStatus::WaitHleEvent);
         callback(thread, context, reason);
 
@@ -55,6 +68,7 @@ std::shared_ptr<Event> HLERequestContext::SleepClientThread(const std::string& r
         memory.WriteBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
                           cmd_buff.size() * sizeof(u32));
     };
+    thread->SetWakeupCallback(ThreadWakeupKind::HleEvent, std::move(wakeup_callback));
 
     auto event = kernel.CreateEvent(Kernel::ResetType::OneShot, "HLE Pause Event: " + reason);
     thread->status = ThreadStatus::WaitHleEvent;
@@ -33,6 +33,7 @@ class Thread;
 class Event;
 class HLERequestContext;
 class KernelSystem;
+class StateWrap;
 
 /**
  * Interface implemented by HLE Session handlers.
@@ -64,10 +65,27 @@ public:
      */
     virtual void ClientDisconnected(std::shared_ptr<ServerSession> server_session);
 
+    /**
+     * Returns the name of the loader that recreates this handler when a save state is loaded, see
+     * KernelSystem::RegisterHandlerLoader. Handlers that are not installed on a port must have one.
+     */
+    virtual std::string GetStateLoaderName() const {
+        return {};
+    }
+
+    /// Saves or restores the state of the handler that isn't specific to a session.
+    virtual void DoHandlerState(StateWrap& state) {}
+
+    /// Saves or restores the data the handler keeps for a connected session.
+    void DoSessionState(StateWrap& state, const std::shared_ptr<ServerSession>& server_session);
+
     /// Empty placeholder structure for services with no per-session data. The session data classes
     /// in each service must inherit from this.
     struct SessionDataBase {
         virtual ~SessionDataBase() = default;
+
+        /// Saves or restores the session data. The default implementation has nothing to save.
+        virtual void DoState(StateWrap& state) {}
     };
 
 protected:
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/config_mem.h"
 #include "core/hle/kernel/handle_table.h"
@@ -10,6 +11,7 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
 #include "core/hle/kernel/shared_page.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 
@@ -87,8 +89,83 @@ const SharedPage::Handler& KernelSystem::GetSharedPageHandler() const {
     return *shared_page_handler;
 }
 
+ConfigMem::Handler& KernelSystem::GetConfigMemHandler() {
+    return *config_mem_handler;
+}
+
 void KernelSystem::AddNamedPort(std::string name, std::shared_ptr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
 
+void KernelSystem::RegisterHandlerLoader(std::string name, HandlerLoader loader) {
+    handler_loaders.insert_or_assign(std::move(name), std::move(loader));
+}
+
+std::shared_ptr<SessionRequestHandler> KernelSystem::LoadHandler(const std::string& name) const {
+    auto itr = handler_loaders.find(name);
+    if (itr == handler_loaders.end())
+        return nullptr;
+
+    return itr->second();
+}
+
+void KernelSystem::DoState(StateWrap& state) {
+    auto section = state.Wrap().Section("Kernel", 1);
+    if (!section) {
+        return;
+    }
+
+    for (auto& region : memory_regions) {
+        state.Do(region.base);
+        state.Do(region.size);
+        state.Do(region.used);
+        state.DoIntervalSet(region.free_blocks);
+    }
+
+    state.Do(next_process_id);
+    state.DoObjects(process_list);
+    std::shared_ptr<Process> process = current_process;
+    state.DoObject(process);
+    resource_limits->DoState(state);
+
+    // Named ports are installed at boot, only the objects behind them are restored
+    std::vector<std::string> port_names;
+    for (const auto& [name, port] : named_ports) {
+        port_names.push_back(name);
+    }
+    std::sort(port_names.begin(), port_names.end());
+    u32 num_ports = static_cast<u32>(port_names.size());
+    state.Do(num_ports);
+    if (state.IsReading() && num_ports != port_names.size()) {
+        state.Fail("named ports don't match");
+        return;
+    }
+    for (auto& name : port_names) {
+        std::string saved_name = name;
+        state.Do(saved_name);
+        if (state.IsReading() && saved_name != name) {
+            state.Fail("named ports don't match");
+            return;
+        }
+        state.DoObject(named_ports.at(name));
+    }
+
+    thread_manager->DoState(state);
+    timer_manager->DoState(state);
+
+    state.DoArray(reinterpret_cast<u8*>(&config_mem_handler->GetConfigMem()),
+                  Memory::CONFIG_MEMORY_SIZE);
+    state.DoArray(reinterpret_cast<u8*>(&shared_page_handler->GetSharedPage()),
+                  Memory::SHARED_PAGE_SIZE);
+
+    u32 next_id = next_object_id;
+    state.Do(next_id);
+    if (state.IsReading() && !state.Failed()) {
+        next_object_id = next_id;
+        if (process != nullptr) {
+            SetCurrentProcess(std::move(process));
+        }
+    }
+}
+
 } // namespace Kernel
@@ -47,7 +47,9 @@ class ServerPort;
 class ClientSession;
 class ServerSession;
 class ResourceLimitList;
+class SessionRequestHandler;
 class SharedMemory;
+class StateWrap;
 class ThreadManager;
 class TimerManager;
 class VMManager;
@@ -222,6 +224,8 @@ public:
     SharedPage::Handler& GetSharedPageHandler();
     const SharedPage::Handler& GetSharedPageHandler() const;
 
+    ConfigMem::Handler& GetConfigMemHandler();
+
     MemoryRegionInfo* GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -235,6 +239,24 @@ public:
         prepare_reschedule_callback();
     }
 
+    using HandlerLoader = std::function<std::shared_ptr<SessionRequestHandler>()>;
+
+    /**
+     * Registers a function that creates an HLE handler of sessions that don't belong to a port,
+     * to restore such sessions from a save state.
+     * @param name Name returned by SessionRequestHandler::GetStateLoaderName of the handlers
+     */
+    void RegisterHandlerLoader(std::string name, HandlerLoader loader);
+
+    /// Creates a handler with the loader registered under the name, or returns nullptr.
+    std::shared_ptr<SessionRequestHandler> LoadHandler(const std::string& name) const;
+
+    /**
+     * Saves or restores the kernel objects and the state of the scheduler. Must be followed by
+     * StateWrap::Finish.
+     */
+    void DoState(StateWrap& state);
+
     /// Map of named ports managed by the kernel, which can be retrieved using the ConnectToPort
     std::unordered_map<std::string, std::shared_ptr<ClientPort>> named_ports;
 
@@ -252,6 +274,8 @@ private:
     std::unique_ptr<ResourceLimitList> resource_limits;
     std::atomic<u32> next_object_id{0};
 
+    std::unordered_map<std::string, HandlerLoader> handler_loaders;
+
     // Note: keep the member order below in order to perform correct destruction.
     // Thread manager is destructed before process list in order to Stop threads and clear thread
     // info from their parent processes first. Timer manager is destructed after process list
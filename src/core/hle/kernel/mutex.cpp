@@ -11,6 +11,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -121,4 +122,12 @@ void Mutex::UpdatePriority() {
     }
 }
 
+void Mutex::DoState(StateWrap& state) {
+    state.Do(lock_count);
+    state.Do(priority);
+    state.Do(name);
+    DoWaitObjectState(state);
+    state.DoObject(holding_thread);
+}
+
 } // namespace Kernel
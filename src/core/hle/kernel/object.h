@@ -13,6 +13,7 @@
 namespace Kernel {
 
 class KernelSystem;
+class StateWrap;
 
 using Handle = u32;
 
@@ -62,7 +63,15 @@ public:
      */
     bool IsWaitable() const;
 
+    /**
+     * Saves or restores the state of the object. Objects are restored after being created with
+     * the type's constructor, or in place when they were alive before the state was loaded.
+     */
+    virtual void DoState(StateWrap& state) = 0;
+
 private:
+    friend class StateWrap;
+
     std::atomic<u32> object_id;
 };
 
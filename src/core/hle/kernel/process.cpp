@@ -11,6 +11,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
@@ -426,4 +427,65 @@ std::shared_ptr<Process> KernelSystem::GetProcessById(u32 process_id) const {
 
     return *itr;
 }
+void CodeSet::DoState(StateWrap& state) {
+    // The code itself is only used to load the process, and is already in its memory
+    for (auto& segment : segments) {
+        u64 offset = segment.offset;
+        state.Do(offset);
+        segment.offset = static_cast<std::size_t>(offset);
+        state.Do(segment.addr);
+        state.Do(segment.size);
+    }
+    state.Do(entrypoint);
+    state.Do(name);
+    state.Do(program_id);
+}
+
+void Process::DoState(StateWrap& state) {
+    state.Do(process_id);
+    state.Do(status);
+    state.Do(flags.raw);
+    state.Do(kernel_version);
+    state.Do(ideal_processor);
+    state.Do(handle_table_size);
+    state.Do(memory_used);
+
+    std::string svc_access = svc_access_mask.to_string();
+    state.Do(svc_access);
+
+    std::vector<AddressMapping> mappings(address_mappings.begin(), address_mappings.end());
+    state.Do(mappings);
+
+    std::vector<u8> tls_pages;
+    for (const auto& slots : tls_slots) {
+        tls_pages.push_back(static_cast<u8>(slots.to_ulong()));
+    }
+    state.Do(tls_pages);
+
+    s32 region_index = -1;
+    for (std::size_t i = 0; i < kernel.memory_regions.size(); ++i) {
+        if (memory_region == &kernel.memory_regions[i]) {
+            region_index = static_cast<s32>(i);
+        }
+    }
+    state.Do(region_index);
+
+    if (state.IsReading() && !state.Failed()) {
+        if (svc_access.size() != svc_access_mask.size() || mappings.size() > 8 ||
+            region_index >= static_cast<s32>(kernel.memory_regions.size())) {
+            state.Fail("invalid process state");
+            return;
+        }
+        svc_access_mask = std::bitset<0x80>(svc_access);
+        address_mappings.assign(mappings.begin(), mappings.end());
+        tls_slots.assign(tls_pages.begin(), tls_pages.end());
+        memory_region = region_index >= 0 ? &kernel.memory_regions[region_index] : nullptr;
+    }
+
+    state.DoObject(codeset);
+    state.DoObject(resource_limit);
+    vm_manager.DoState(state);
+    handle_table.DoState(state);
+}
+
 } // namespace Kernel
@@ -73,6 +73,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     Segment& CodeSegment() {
         return segments[0];
     }
@@ -125,6 +127,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     HandleTable handle_table;
 
     std::shared_ptr<CodeSet> codeset;
@@ -6,6 +6,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/state_wrap.h"
 
 namespace Kernel {
 
@@ -149,4 +150,21 @@ ResourceLimitList::ResourceLimitList(KernelSystem& kernel) {
 
 ResourceLimitList::~ResourceLimitList() = default;
 
+void ResourceLimit::DoState(StateWrap& state) {
+    state.Do(name);
+    for (s32* value : {&max_priority, &max_commit, &max_threads, &max_events, &max_mutexes,
+                       &max_semaphores, &max_timers, &max_shared_mems, &max_address_arbiters,
+                       &max_cpu_time, &current_commit, &current_threads, &current_events,
+                       &current_mutexes, &current_semaphores, &current_timers,
+                       &current_shared_mems, &current_address_arbiters, &current_cpu_time}) {
+        state.Do(*value);
+    }
+}
+
+void ResourceLimitList::DoState(StateWrap& state) {
+    for (auto& resource_limit : resource_limits) {
+        state.DoObject(resource_limit);
+    }
+}
+
 } // namespace Kernel
@@ -54,6 +54,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     /**
      * Gets the current value for the specified resource.
      * @param resource Requested resource type
@@ -124,6 +126,8 @@ public:
      */
     std::shared_ptr<ResourceLimit> GetForCategory(ResourceLimitCategory category);
 
+    void DoState(StateWrap& state);
+
 private:
     std::array<std::shared_ptr<ResourceLimit>, 4> resource_limits;
 };
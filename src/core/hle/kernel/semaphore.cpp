@@ -6,6 +6,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -53,4 +54,11 @@ ResultVal<s32> Semaphore::Release(s32 release_count) {
     return MakeResult<s32>(previous_count);
 }
 
+void Semaphore::DoState(StateWrap& state) {
+    state.Do(max_count);
+    state.Do(available_count);
+    state.Do(name);
+    DoWaitObjectState(state);
+}
+
 } // namespace Kernel
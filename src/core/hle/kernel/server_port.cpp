@@ -3,12 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <tuple>
+#include <fmt/format.h>
 #include "common/assert.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -48,4 +50,19 @@ KernelSystem::PortPair KernelSystem::CreatePortPair(u32 max_sessions, std::strin
     return std::make_pair(std::move(server_port), std::move(client_port));
 }
 
+void ServerPort::DoState(StateWrap& state) {
+    state.Do(name);
+
+    // HLE handlers are installed when the services boot, so they must already be present
+    bool has_hle_handler = hle_handler != nullptr;
+    state.Do(has_hle_handler);
+    if (state.IsReading() && has_hle_handler != (hle_handler != nullptr)) {
+        state.Fail(fmt::format("HLE handler of port {} doesn't match", name));
+        return;
+    }
+
+    DoWaitObjectState(state);
+    state.DoObjects(pending_sessions);
+}
+
 } // namespace Kernel
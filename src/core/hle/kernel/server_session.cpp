@@ -3,12 +3,13 @@
 // Refer to the license.txt file included.
 
 #include <tuple>
-
+#include <fmt/format.h>
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -137,4 +138,18 @@ KernelSystem::SessionPair KernelSystem::CreateSessionPair(const std::string& nam
     return std::make_pair(std::move(server_session), std::move(client_session));
 }
 
+void ServerSession::DoState(StateWrap& state) {
+    if (!state.IsReading() && !mapped_buffer_context.empty()) {
+        state.Fail(fmt::format("session {} has mapped IPC buffers", name));
+        return;
+    }
+
+    state.Do(name);
+    DoWaitObjectState(state);
+    state.DoObjects(pending_requesting_threads);
+    state.DoObject(currently_handling);
+    state.DoSession(parent);
+    state.DoSessionHandler(*this);
+}
+
 } // namespace Kernel
@@ -7,6 +7,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/shared_memory.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/memory.h"
 
 namespace Kernel {
@@ -203,4 +204,26 @@ const u8* SharedMemory::GetPointer(u32 offset) const {
     return backing_blocks[0].first + offset;
 }
 
+void SharedMemory::DoState(StateWrap& state) {
+    state.Do(linear_heap_phys_offset);
+    state.Do(size);
+    state.Do(permissions);
+    state.Do(other_permissions);
+    state.Do(base_address);
+    state.Do(name);
+
+    u32 num_blocks = static_cast<u32>(backing_blocks.size());
+    state.Do(num_blocks);
+    if (state.IsReading()) {
+        backing_blocks.resize(state.Failed() ? 0 : num_blocks);
+    }
+    for (auto& [pointer, block_size] : backing_blocks) {
+        state.DoMemoryPointer(pointer);
+        state.Do(block_size);
+    }
+    state.DoIntervalSet(holding_memory);
+
+    state.DoObject(owner_process);
+}
+
 } // namespace Kernel
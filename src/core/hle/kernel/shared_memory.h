@@ -33,6 +33,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     /// Gets the size of the underlying memory block in bytes.
     u64 GetSize() const {
         return size;
@@ -94,7 +96,7 @@ private:
     /// Permission restrictions applied to other processes mapping the block.
     MemoryPermission other_permissions{};
     /// Process that created this shared memory block.
-    Process* owner_process;
+    Process* owner_process = nullptr;
     /// Address of shared memory block in the owner process if specified.
     VAddr base_address = 0;
     /// Name of shared memory object.
@@ -103,6 +105,7 @@ private:
     MemoryRegionInfo::IntervalSet holding_memory;
 
     friend class KernelSystem;
+    friend class StateWrap;
     KernelSystem& kernel;
 };
 
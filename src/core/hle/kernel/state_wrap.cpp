@@ -0,0 +1,471 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "common/logging/log.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/config_mem.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/server_port.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/session.h"
+#include "core/hle/kernel/shared_memory.h"
+#include "core/hle/kernel/shared_page.h"
+#include "core/hle/kernel/state_wrap.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/timer.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+namespace {
+
+enum class MemoryPointerKind : u8 {
+    Null,
+    Physical,
+    ConfigMem,
+    SharedPage,
+};
+
+} // Anonymous namespace
+
+StateWrap::StateWrap(PointerWrap& p, KernelSystem& kernel)
+    : p(p), kernel(kernel), reading(p.GetMode() == PointerWrap::MODE_READ) {}
+
+StateWrap::~StateWrap() = default;
+
+void StateWrap::Fail(const std::string& reason) {
+    LOG_ERROR(Kernel, "Save state failed: {}", reason);
+    p.SetError(PointerWrap::ERROR_FAILURE);
+}
+
+void StateWrap::DoObjectBase(std::shared_ptr<Object>& object) {
+    u32 index = 0;
+    if (!reading) {
+        if (object != nullptr) {
+            const auto [itr, inserted] =
+                object_indices.emplace(object.get(), static_cast<u32>(objects.size() + 1));
+            index = itr->second;
+            p.Do(index);
+            if (!inserted) {
+                return;
+            }
+
+            HandleType type = object->GetHandleType();
+            u32 object_id = object->GetObjectId();
+            p.Do(type);
+            p.Do(object_id);
+            objects.push_back(object);
+            object->DoState(*this);
+            return;
+        }
+        p.Do(index);
+        return;
+    }
+
+    object = nullptr;
+    if (Failed()) {
+        return;
+    }
+    p.Do(index);
+    if (index == 0 || Failed()) {
+        return;
+    }
+    if (index <= objects.size()) {
+        object = objects[index - 1];
+        return;
+    }
+    if (index != objects.size() + 1) {
+        Fail(fmt::format("invalid object index {}", index));
+        return;
+    }
+
+    HandleType type{};
+    u32 object_id = 0;
+    p.Do(type);
+    p.Do(object_id);
+    if (Failed()) {
+        return;
+    }
+
+    const auto itr = previous_objects.find(object_id);
+    if (itr != previous_objects.end() && itr->second->GetHandleType() == type) {
+        object = std::move(itr->second);
+        previous_objects.erase(itr);
+    } else {
+        object = MakeObject(type);
+        if (object == nullptr) {
+            return;
+        }
+        object->object_id = object_id;
+    }
+
+    // Registered before being restored, so that references back to it resolve
+    objects.push_back(object);
+    object->DoState(*this);
+}
+
+std::shared_ptr<Object> StateWrap::MakeObject(HandleType type) {
+    switch (type) {
+    case HandleType::Event:
+        return std::make_shared<Event>(kernel);
+    case HandleType::Mutex:
+        return std::make_shared<Mutex>(kernel);
+    case HandleType::SharedMemory:
+        return std::make_shared<SharedMemory>(kernel);
+    case HandleType::Thread:
+        // Threads get their context from the CPU
+        if (kernel.current_cpu == nullptr) {
+            Fail("threads can't be restored without a CPU");
+            return nullptr;
+        }
+        return std::make_shared<Thread>(kernel);
+    case HandleType::Process:
+        return std::make_shared<Process>(kernel);
+    case HandleType::AddressArbiter:
+        return std::make_shared<AddressArbiter>(kernel);
+    case HandleType::Semaphore:
+        return std::make_shared<Semaphore>(kernel);
+    case HandleType::Timer:
+        return std::make_shared<Timer>(kernel);
+    case HandleType::ResourceLimit:
+        return std::make_shared<ResourceLimit>(kernel);
+    case HandleType::CodeSet:
+        return std::make_shared<CodeSet>(kernel);
+    case HandleType::ClientPort:
+        return std::make_shared<ClientPort>(kernel);
+    case HandleType::ServerPort:
+        return std::make_shared<ServerPort>(kernel);
+    case HandleType::ClientSession:
+        return std::make_shared<ClientSession>(kernel);
+    case HandleType::ServerSession:
+        return std::make_shared<ServerSession>(kernel);
+    default:
+        Fail(fmt::format("invalid object type {}", static_cast<u32>(type)));
+        return nullptr;
+    }
+}
+
+void StateWrap::DoIntervalSet(MemoryRegionInfo::IntervalSet& set) {
+    u32 count = static_cast<u32>(set.iterative_size());
+    p.Do(count);
+    if (!reading) {
+        for (const auto& interval : set) {
+            u32 lower = interval.lower();
+            u32 upper = interval.upper();
+            p.Do(lower);
+            p.Do(upper);
+        }
+        return;
+    }
+
+    set.clear();
+    for (u32 i = 0; i < count && !Failed(); ++i) {
+        u32 lower = 0;
+        u32 upper = 0;
+        p.Do(lower);
+        p.Do(upper);
+        set += MemoryRegionInfo::Interval(lower, upper);
+    }
+}
+
+void StateWrap::DoSession(std::shared_ptr<Session>& session) {
+    u32 index = 0;
+    if (!reading) {
+        if (session != nullptr) {
+            const auto [itr, inserted] =
+                session_indices.emplace(session.get(), static_cast<u32>(sessions.size() + 1));
+            index = itr->second;
+            p.Do(index);
+            if (!inserted) {
+                return;
+            }
+            sessions.push_back(session);
+        } else {
+            p.Do(index);
+            return;
+        }
+    } else {
+        session = nullptr;
+        if (Failed()) {
+            return;
+        }
+        p.Do(index);
+        if (index == 0 || Failed()) {
+            return;
+        }
+        if (index <= sessions.size()) {
+            session = sessions[index - 1];
+            return;
+        }
+        if (index != sessions.size() + 1) {
+            Fail(fmt::format("invalid session index {}", index));
+            return;
+        }
+        // Sessions are never restored in place, the endpoints of a stale session stay linked
+        session = std::make_shared<Session>();
+        sessions.push_back(session);
+    }
+
+    DoObject(session->client);
+    DoObject(session->server);
+    DoObject(session->port);
+}
+
+void StateWrap::DoMemoryPointer(u8*& pointer) {
+    u8* const config_mem = reinterpret_cast<u8*>(&kernel.GetConfigMemHandler().GetConfigMem());
+    u8* const shared_page =
+        reinterpret_cast<u8*>(&kernel.GetSharedPageHandler().GetSharedPage());
+
+    MemoryPointerKind kind = MemoryPointerKind::Null;
+    u32 address = 0;
+    if (!reading && pointer != nullptr) {
+        if (pointer >= config_mem && pointer < config_mem + Memory::CONFIG_MEMORY_SIZE) {
+            kind = MemoryPointerKind::ConfigMem;
+            address = static_cast<u32>(pointer - config_mem);
+        } else if (pointer >= shared_page && pointer < shared_page + Memory::SHARED_PAGE_SIZE) {
+            kind = MemoryPointerKind::SharedPage;
+            address = static_cast<u32>(pointer - shared_page);
+        } else if (auto paddr = kernel.memory.GetPhysicalAddress(pointer)) {
+            kind = MemoryPointerKind::Physical;
+            address = *paddr;
+        } else {
+            Fail("pointer outside of the emulated memory");
+        }
+    }
+    p.Do(kind);
+    p.Do(address);
+    if (!reading || Failed()) {
+        return;
+    }
+
+    switch (kind) {
+    case MemoryPointerKind::Null:
+        pointer = nullptr;
+        break;
+    case MemoryPointerKind::Physical:
+        pointer = kernel.memory.GetPhysicalPointer(address);
+        if (pointer == nullptr) {
+            Fail(fmt::format("invalid physical address {:08X}", address));
+        }
+        break;
+    case MemoryPointerKind::ConfigMem:
+        pointer = config_mem + address;
+        break;
+    case MemoryPointerKind::SharedPage:
+        pointer = shared_page + address;
+        break;
+    default:
+        Fail(fmt::format("invalid memory pointer kind {}", static_cast<u32>(kind)));
+        break;
+    }
+}
+
+void StateWrap::DoSessionHandler(ServerSession& session) {
+    HandlerKind kind = HandlerKind::None;
+    std::shared_ptr<SessionRequestHandler> handler;
+    if (!reading && session.hle_handler != nullptr) {
+        handler = session.hle_handler;
+        const std::shared_ptr<ClientPort> port =
+            session.parent != nullptr ? session.parent->port : nullptr;
+        if (port != nullptr && port->GetServerPort() != nullptr &&
+            port->GetServerPort()->hle_handler == handler) {
+            kind = HandlerKind::Port;
+        } else {
+            kind = HandlerKind::Loader;
+        }
+    }
+    p.Do(kind);
+    if (Failed()) {
+        return;
+    }
+
+    switch (kind) {
+    case HandlerKind::None:
+    case HandlerKind::Port:
+        // Port handlers are looked up once the port has been restored
+        break;
+    case HandlerKind::Loader:
+        DoHandler(handler);
+        break;
+    default:
+        Fail(fmt::format("invalid handler kind {}", static_cast<u32>(kind)));
+        return;
+    }
+
+    HandlerSession entry{SharedFrom(&session), kind, std::move(handler), nullptr};
+    if (reading) {
+        entry.previous_handler = session.hle_handler;
+    }
+    if (entry.kind != HandlerKind::None || entry.previous_handler != nullptr) {
+        handler_sessions.push_back(std::move(entry));
+    }
+}
+
+void StateWrap::DoHandler(std::shared_ptr<SessionRequestHandler>& handler) {
+    u32 index = 0;
+    if (!reading) {
+        const auto [itr, inserted] =
+            handler_indices.emplace(handler.get(), static_cast<u32>(handlers.size() + 1));
+        index = itr->second;
+        p.Do(index);
+        if (!inserted) {
+            return;
+        }
+        handlers.push_back(handler);
+
+        std::string name = handler->GetStateLoaderName();
+        if (name.empty()) {
+            Fail("HLE handler without a loader");
+        }
+        p.Do(name);
+        handler->DoHandlerState(*this);
+        return;
+    }
+
+    handler = nullptr;
+    p.Do(index);
+    if (Failed()) {
+        return;
+    }
+    if (index >= 1 && index <= handlers.size()) {
+        handler = handlers[index - 1];
+        return;
+    }
+    if (index != handlers.size() + 1) {
+        Fail(fmt::format("invalid handler index {}", index));
+        return;
+    }
+
+    std::string name;
+    p.Do(name);
+    if (Failed()) {
+        return;
+    }
+    handler = kernel.LoadHandler(name);
+    if (handler == nullptr) {
+        Fail(fmt::format("no loader for HLE handler {}", name));
+        return;
+    }
+    handlers.push_back(handler);
+    handler->DoHandlerState(*this);
+}
+
+void StateWrap::DoHandlerSessions() {
+    if (reading && !Failed()) {
+        for (auto& [object_id, object] : previous_objects) {
+            if (object->GetHandleType() != HandleType::ServerSession) {
+                continue;
+            }
+            auto session = std::static_pointer_cast<ServerSession>(object);
+            if (session->hle_handler != nullptr) {
+                session->hle_handler->ClientDisconnected(session);
+            }
+        }
+    }
+
+    // Restoring session data can reach new sessions and append to the list
+    for (std::size_t i = 0; i < handler_sessions.size() && !Failed(); ++i) {
+        HandlerSession entry = handler_sessions[i];
+        if (reading) {
+            if (entry.kind == HandlerKind::Port) {
+                const auto& parent = entry.session->parent;
+                if (parent != nullptr && parent->port != nullptr &&
+                    parent->port->GetServerPort() != nullptr) {
+                    entry.handler = parent->port->GetServerPort()->hle_handler;
+                }
+                if (entry.handler == nullptr) {
+                    Fail(fmt::format("port of session {} has no HLE handler",
+                                     entry.session->GetName()));
+                    break;
+                }
+            }
+            if (entry.previous_handler != entry.handler) {
+                if (entry.previous_handler != nullptr) {
+                    entry.previous_handler->ClientDisconnected(entry.session);
+                }
+                if (entry.handler != nullptr) {
+                    entry.handler->ClientConnected(entry.session);
+                }
+            }
+        }
+        if (entry.handler != nullptr) {
+            entry.handler->DoSessionState(*this, entry.session);
+        }
+    }
+}
+
+void StateWrap::Defer(std::function<void()> function) {
+    deferred.push_back(std::move(function));
+}
+
+void StateWrap::SetPreviousObjects(const std::vector<std::shared_ptr<Object>>& previous) {
+    previous_objects.clear();
+    for (const auto& object : previous) {
+        previous_objects.emplace(object->GetObjectId(), object);
+    }
+}
+
+void StateWrap::DetachStaleObject(Object& object) {
+    // Stale objects can still point to restored ones, which their destructors must not touch
+    switch (object.GetHandleType()) {
+    case HandleType::ClientSession: {
+        auto& session = static_cast<ClientSession&>(object);
+        if (session.parent != nullptr) {
+            session.parent->server = nullptr;
+            session.parent->port = nullptr;
+        }
+        break;
+    }
+    case HandleType::ServerSession: {
+        auto& session = static_cast<ServerSession&>(object);
+        if (session.parent != nullptr) {
+            session.parent->client = nullptr;
+            session.parent->port = nullptr;
+        }
+        break;
+    }
+    case HandleType::SharedMemory: {
+        // The memory it held belongs to the restored memory regions
+        auto& shared_memory = static_cast<SharedMemory&>(object);
+        shared_memory.owner_process = nullptr;
+        shared_memory.holding_memory.clear();
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void StateWrap::Finish() {
+    DoHandlerSessions();
+    if (!reading) {
+        return;
+    }
+
+    // A failed load is followed by loading a backup onto the same previous objects
+    if (!Failed()) {
+        for (auto& [object_id, object] : previous_objects) {
+            DetachStaleObject(*object);
+        }
+    }
+    previous_objects.clear();
+
+    if (!Failed()) {
+        for (auto& function : deferred) {
+            function();
+        }
+    }
+    deferred.clear();
+}
+
+} // namespace Kernel
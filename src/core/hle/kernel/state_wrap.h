@@ -0,0 +1,190 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "common/chunk_file.h"
+#include "common/common_types.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/object.h"
+
+namespace Kernel {
+
+class KernelSystem;
+class ServerSession;
+class Session;
+class SessionRequestHandler;
+
+/**
+ * Serializes the kernel object graph of a save state on top of a PointerWrap. An object is written
+ * in full the first time it is referenced and as an index afterwards, which preserves shared and
+ * cyclic references.
+ *
+ * States are loaded onto a kernel that booted the same title. A live object with the id and type
+ * of a saved one is restored in place, which keeps the references HLE services hold to it valid.
+ * The live objects are the ones a save of the current state would write, see GetObjects(). Those
+ * that the loaded state doesn't reference are detached from the restored ones by Finish().
+ */
+class StateWrap {
+public:
+    StateWrap(PointerWrap& p, KernelSystem& kernel);
+    ~StateWrap();
+
+    PointerWrap& Wrap() {
+        return p;
+    }
+
+    KernelSystem& Kernel() {
+        return kernel;
+    }
+
+    /// Whether a state is being loaded. Stays true after a failure, unlike the PointerWrap mode.
+    bool IsReading() const {
+        return reading;
+    }
+
+    bool Failed() const {
+        return p.error == PointerWrap::ERROR_FAILURE;
+    }
+
+    /// Marks the state as unusable, e.g. because it contains something that can't be saved.
+    void Fail(const std::string& reason);
+
+    template <typename T>
+    void Do(T& x) {
+        p.Do(x);
+    }
+
+    template <typename T>
+    void DoArray(T* x, std::size_t count) {
+        p.DoArray(x, static_cast<int>(count));
+    }
+
+    /// Saves or restores a reference to a kernel object, and the object itself on its first use.
+    template <typename T>
+    void DoObject(std::shared_ptr<T>& object) {
+        std::shared_ptr<Object> base = object;
+        DoObjectBase(base);
+        if (!IsReading()) {
+            return;
+        }
+        if constexpr (std::is_same_v<T, Object>) {
+            object = std::move(base);
+        } else {
+            object = DynamicObjectCast<T>(base);
+            if (base != nullptr && object == nullptr) {
+                Fail("object has an unexpected type");
+            }
+        }
+    }
+
+    /// Variant of DoObject for non-owning pointers. The object must be owned elsewhere.
+    template <typename T>
+    void DoObject(T*& object) {
+        std::shared_ptr<T> shared = SharedFrom(object);
+        DoObject(shared);
+        if (IsReading()) {
+            object = shared.get();
+        }
+    }
+
+    template <typename T>
+    void DoObjects(std::vector<std::shared_ptr<T>>& objects) {
+        u32 count = static_cast<u32>(objects.size());
+        p.Do(count);
+        if (IsReading()) {
+            objects.assign(Failed() ? 0 : count, nullptr);
+        }
+        for (auto& object : objects) {
+            DoObject(object);
+        }
+    }
+
+    void DoIntervalSet(MemoryRegionInfo::IntervalSet& set);
+
+    /// Saves or restores a session shared between a client and a server endpoint.
+    void DoSession(std::shared_ptr<Session>& session);
+
+    /**
+     * Saves or restores a pointer into emulated memory, which is stored as a physical address or as
+     * a reference to the config memory or the shared page.
+     */
+    void DoMemoryPointer(u8*& pointer);
+
+    /**
+     * Saves or restores the HLE handler of a server session. Handlers of service ports are found
+     * again through the port, other handlers are recreated by the loader they registered with
+     * KernelSystem::RegisterHandlerLoader.
+     */
+    void DoSessionHandler(ServerSession& session);
+
+    /// Runs a function at the end of Finish when a state has been loaded successfully.
+    void Defer(std::function<void()> function);
+
+    /// Sets the objects that were alive before loading, which can be restored in place.
+    void SetPreviousObjects(const std::vector<std::shared_ptr<Object>>& previous);
+
+    /// Returns the objects that have been saved or restored so far.
+    const std::vector<std::shared_ptr<Object>>& GetObjects() const {
+        return objects;
+    }
+
+    /**
+     * Saves or restores the data the HLE handlers keep for the server sessions of the state, which
+     * are connected to their handlers when loading. Then releases the objects that the loaded state
+     * doesn't reference and runs the deferred functions. Must be called once, after every object of
+     * the state has been processed.
+     */
+    void Finish();
+
+private:
+    enum class HandlerKind : u8 {
+        None,
+        Port,
+        Loader,
+    };
+
+    struct HandlerSession {
+        std::shared_ptr<ServerSession> session;
+        HandlerKind kind;
+        std::shared_ptr<SessionRequestHandler> handler;
+        /// Loading: the handler of the session before it was restored
+        std::shared_ptr<SessionRequestHandler> previous_handler;
+    };
+
+    void DoObjectBase(std::shared_ptr<Object>& object);
+    void DoHandlerSessions();
+    void DoHandler(std::shared_ptr<SessionRequestHandler>& handler);
+    std::shared_ptr<Object> MakeObject(HandleType type);
+    void DetachStaleObject(Object& object);
+
+    PointerWrap& p;
+    KernelSystem& kernel;
+    const bool reading;
+
+    /// Objects saved or restored so far, in order. Indices in the state start at 1.
+    std::vector<std::shared_ptr<Object>> objects;
+    /// Saving: index of each object written so far.
+    std::unordered_map<const Object*, u32> object_indices;
+    /// Loading: the objects that were alive before the state was loaded and haven't been restored
+    /// yet, by id.
+    std::unordered_map<u32, std::shared_ptr<Object>> previous_objects;
+
+    std::unordered_map<const Session*, u32> session_indices;
+    std::vector<std::shared_ptr<Session>> sessions;
+
+    std::unordered_map<const SessionRequestHandler*, u32> handler_indices;
+    std::vector<std::shared_ptr<SessionRequestHandler>> handlers;
+    std::vector<HandlerSession> handler_sessions;
+
+    std::vector<std::function<void()>> deferred;
+};
+
+} // namespace Kernel
@@ -419,21 +419,8 @@ ResultCode SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = [](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
-                                     std::shared_ptr<WaitObject> object) {
-            ASSERT(thread->status == ThreadStatus::WaitSynchAny);
-
-            if (reason == ThreadWakeupReason::Timeout) {
-                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
-                return;
-            }
-
-            ASSERT(reason == ThreadWakeupReason::Signal);
-            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
-
-            // WaitSynchronization1 doesn't have an output index like WaitSynchronizationN, so we
-            // don't have to do anything else here.
-        };
+        thread->SetWakeupCallback(ThreadWakeupKind::WaitSynch1,
+                                  MakeWakeupCallback(memory, ThreadWakeupKind::WaitSynch1));
 
         system.PrepareReschedule();
 
@@ -508,20 +495,8 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = [](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
-                                     std::shared_ptr<WaitObject> object) {
-            ASSERT(thread->status == ThreadStatus::WaitSynchAll);
-
-            if (reason == ThreadWakeupReason::Timeout) {
-                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
-                return;
-            }
-
-            ASSERT(reason == ThreadWakeupReason::Signal);
-
-            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
-            // The wait_all case does not update the output index.
-        };
+        thread->SetWakeupCallback(ThreadWakeupKind::WaitSynchAll,
+                                  MakeWakeupCallback(memory, ThreadWakeupKind::WaitSynchAll));
 
         system.PrepareReschedule();
 
@@ -568,20 +543,8 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
-        thread->wakeup_callback = [](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
-                                     std::shared_ptr<WaitObject> object) {
-            ASSERT(thread->status == ThreadStatus::WaitSynchAny);
-
-            if (reason == ThreadWakeupReason::Timeout) {
-                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
-                return;
-            }
-
-            ASSERT(reason == ThreadWakeupReason::Signal);
-
-            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
-            thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
-        };
+        thread->SetWakeupCallback(ThreadWakeupKind::WaitSynchAny,
+                                  MakeWakeupCallback(memory, ThreadWakeupKind::WaitSynchAny));
 
         system.PrepareReschedule();
 
@@ -622,6 +585,76 @@ static ResultCode ReceiveIPCRequest(Memory::MemorySystem& memory,
     return translation_result;
 }
 
+std::function<Thread::WakeupCallback> MakeWakeupCallback(Memory::MemorySystem& memory,
+                                                         ThreadWakeupKind kind) {
+    switch (kind) {
+    case ThreadWakeupKind::WaitSynch1:
+        return [](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                  std::shared_ptr<WaitObject> object) {
+            ASSERT(thread->status == ThreadStatus::WaitSynchAny);
+
+            if (reason == ThreadWakeupReason::Timeout) {
+                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
+                return;
+            }
+
+            ASSERT(reason == ThreadWakeupReason::Signal);
+            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
+
+            // WaitSynchronization1 doesn't have an output index like WaitSynchronizationN, so we
+            // don't have to do anything else here.
+        };
+    case ThreadWakeupKind::WaitSynchAll:
+        return [](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                  std::shared_ptr<WaitObject> object) {
+            ASSERT(thread->status == ThreadStatus::WaitSynchAll);
+
+            if (reason == ThreadWakeupReason::Timeout) {
+                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
+                return;
+            }
+
+            ASSERT(reason == ThreadWakeupReason::Signal);
+
+            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
+            // The wait_all case does not update the output index.
+        };
+    case ThreadWakeupKind::WaitSynchAny:
+        return [](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                  std::shared_ptr<WaitObject> object) {
+            ASSERT(thread->status == ThreadStatus::WaitSynchAny);
+
+            if (reason == ThreadWakeupReason::Timeout) {
+                thread->SetWaitSynchronizationResult(RESULT_TIMEOUT);
+                return;
+            }
+
+            ASSERT(reason == ThreadWakeupReason::Signal);
+
+            thread->SetWaitSynchronizationResult(RESULT_SUCCESS);
+            thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
+        };
+    case ThreadWakeupKind::ReplyAndReceive:
+        return [&memory](ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                         std::shared_ptr<WaitObject> object) {
+            ASSERT(thread->status == ThreadStatus::WaitSynchAny);
+            ASSERT(reason == ThreadWakeupReason::Signal);
+
+            ResultCode result = RESULT_SUCCESS;
+
+            if (object->GetHandleType() == HandleType::ServerSession) {
+                auto server_session = DynamicObjectCast<ServerSession>(object);
+                result = ReceiveIPCRequest(memory, server_session, thread);
+            }
+
+            thread->SetWaitSynchronizationResult(result);
+            thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
+        };
+    default:
+        return nullptr;
+    }
+}
+
 /// In a single operation, sends a IPC reply and waits for a new request.
 ResultCode SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_count,
                                 Handle reply_target) {
@@ -723,22 +756,8 @@ ResultCode SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_co
 
     thread->wait_objects = std::move(objects);
 
-    thread->wakeup_callback = [& memory = this->memory](ThreadWakeupReason reason,
-                                                        std::shared_ptr<Thread> thread,
-                                                        std::shared_ptr<WaitObject> object) {
-        ASSERT(thread->status == ThreadStatus::WaitSynchAny);
-        ASSERT(reason == ThreadWakeupReason::Signal);
-
-        ResultCode result = RESULT_SUCCESS;
-
-        if (object->GetHandleType() == HandleType::ServerSession) {
-            auto server_session = DynamicObjectCast<ServerSession>(object);
-            result = ReceiveIPCRequest(memory, server_session, thread);
-        }
-
-        thread->SetWaitSynchronizationResult(result);
-        thread->SetWaitSynchronizationOutput(thread->GetWaitObjectIndex(object.get()));
-    };
+    thread->SetWakeupCallback(ThreadWakeupKind::ReplyAndReceive,
+                              MakeWakeupCallback(memory, ThreadWakeupKind::ReplyAndReceive));
 
     system.PrepareReschedule();
 
@@ -4,13 +4,19 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include "common/common_types.h"
+#include "core/hle/kernel/thread.h"
 
 namespace Core {
 class System;
 } // namespace Core
 
+namespace Memory {
+class MemorySystem;
+} // namespace Memory
+
 namespace Kernel {
 
 class SVC;
@@ -25,4 +31,11 @@ private:
     std::unique_ptr<SVC> impl;
 };
 
+/**
+ * Creates the wakeup callback that the SVCs install on waiting threads.
+ * @param kind The SVC that put the thread to wait, ThreadWakeupKind::None for no callback
+ */
+std::function<Thread::WakeupCallback> MakeWakeupCallback(Memory::MemorySystem& memory,
+                                                         ThreadWakeupKind kind);
+
 } // namespace Kernel
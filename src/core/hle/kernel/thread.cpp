@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <list>
 #include <unordered_map>
 #include <vector>
+#include <fmt/format.h>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -19,6 +21,8 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/state_wrap.h"
+#include "core/hle/kernel/svc.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
@@ -48,7 +52,7 @@ Thread* ThreadManager::GetCurrentThread() const {
 
 void Thread::Stop() {
     // Cancel any outstanding wakeup events for this thread
-    thread_manager.kernel.timing.UnscheduleEvent(thread_manager.ThreadWakeupEventType, thread_id);
+    thread_manager.kernel.timing.UnscheduleEvent(wakeup_event);
     thread_manager.wakeup_callback_table.erase(thread_id);
 
     // Clean up thread from ready queue
@@ -101,7 +105,7 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
                    "Thread must be ready to become running.");
 
         // Cancel any outstanding wakeup events for this thread
-        timing.UnscheduleEvent(ThreadWakeupEventType, new_thread->thread_id);
+        timing.UnscheduleEvent(new_thread->wakeup_event);
 
         auto previous_process = kernel.GetCurrentProcess();
 
@@ -184,8 +188,11 @@ void Thread::WakeAfterDelay(s64 nanoseconds) {
     if (nanoseconds == -1)
         return;
 
-    thread_manager.kernel.timing.ScheduleEvent(nsToCycles(nanoseconds),
-                                               thread_manager.ThreadWakeupEventType, thread_id);
+    // A thread only waits for one wakeup at a time
+    Core::Timing& timing = thread_manager.kernel.timing;
+    timing.UnscheduleEvent(wakeup_event);
+    wakeup_event = timing.ScheduleEvent(nsToCycles(nanoseconds),
+                                        thread_manager.ThreadWakeupEventType, thread_id);
 }
 
 void Thread::ResumeFromWait() {
@@ -220,6 +227,7 @@ void Thread::ResumeFromWait() {
     }
 
     wakeup_callback = nullptr;
+    wakeup_kind = ThreadWakeupKind::None;
 
     thread_manager.ready_queue.push_back(current_priority, this);
     status = ThreadStatus::Ready;
@@ -448,6 +456,11 @@ void Thread::SetWaitSynchronizationOutput(s32 output) {
     context->SetCpuRegister(1, output);
 }
 
+void Thread::SetWakeupCallback(ThreadWakeupKind kind, std::function<WakeupCallback> callback) {
+    wakeup_kind = kind;
+    wakeup_callback = std::move(callback);
+}
+
 s32 Thread::GetWaitObjectIndex(const WaitObject* object) const {
     ASSERT_MSG(!wait_objects.empty(), "Thread is not waiting for anything");
     const auto match = std::find_if(wait_objects.rbegin(), wait_objects.rend(),
@@ -478,4 +491,137 @@ const std::vector<std::shared_ptr<Thread>>& ThreadManager::GetThreadList() {
     return thread_list;
 }
 
+void Thread::DoState(StateWrap& state) {
+    if (state.IsReading() && context == nullptr) {
+        state.Fail("no CPU to restore the thread context");
+        return;
+    }
+    if (!state.IsReading() && wakeup_callback != nullptr &&
+        (wakeup_kind == ThreadWakeupKind::None || wakeup_kind == ThreadWakeupKind::HleEvent)) {
+        state.Fail(fmt::format("thread {} is waiting on an HLE event", name));
+        return;
+    }
+
+    state.Do(thread_id);
+    state.Do(status);
+    state.Do(entry_point);
+    state.Do(stack_top);
+    state.Do(nominal_priority);
+    state.Do(current_priority);
+    state.Do(last_running_ticks);
+    state.Do(processor_id);
+    state.Do(tls_address);
+    state.Do(wait_address);
+    state.Do(wakeup_event.slot);
+    state.Do(wakeup_event.generation);
+    state.Do(name);
+
+    std::array<u32, 16> cpu_registers;
+    std::array<u32, 64> fpu_registers;
+    u32 cpsr = context->GetCpsr();
+    u32 fpscr = context->GetFpscr();
+    u32 fpexc = context->GetFpexc();
+    for (std::size_t i = 0; i < cpu_registers.size(); ++i) {
+        cpu_registers[i] = context->GetCpuRegister(i);
+    }
+    for (std::size_t i = 0; i < fpu_registers.size(); ++i) {
+        fpu_registers[i] = context->GetFpuRegister(i);
+    }
+    state.Do(cpu_registers);
+    state.Do(fpu_registers);
+    state.Do(cpsr);
+    state.Do(fpscr);
+    state.Do(fpexc);
+    if (state.IsReading()) {
+        for (std::size_t i = 0; i < cpu_registers.size(); ++i) {
+            context->SetCpuRegister(i, cpu_registers[i]);
+        }
+        for (std::size_t i = 0; i < fpu_registers.size(); ++i) {
+            context->SetFpuRegister(i, fpu_registers[i]);
+        }
+        context->SetCpsr(cpsr);
+        context->SetFpscr(fpscr);
+        context->SetFpexc(fpexc);
+    }
+
+    // Wakeup callbacks of arbiters are restored by the AddressArbiter, which owns their state
+    state.Do(wakeup_kind);
+    if (state.IsReading() && wakeup_kind != ThreadWakeupKind::ArbitrateTimeout) {
+        wakeup_callback = MakeWakeupCallback(thread_manager.kernel.memory, wakeup_kind);
+    }
+
+    DoWaitObjectState(state);
+    state.DoObject(owner_process);
+    state.DoObjects(wait_objects);
+
+    for (auto* mutexes : {&held_mutexes, &pending_mutexes}) {
+        std::vector<std::shared_ptr<Mutex>> list(mutexes->begin(), mutexes->end());
+        state.DoObjects(list);
+        if (state.IsReading()) {
+            mutexes->clear();
+            mutexes->insert(list.begin(), list.end());
+        }
+    }
+}
+
+void ThreadManager::DoState(StateWrap& state) {
+    if (!state.IsReading() && current_thread != nullptr && cpu != nullptr) {
+        cpu->SaveContext(current_thread->context);
+    }
+
+    state.Do(next_thread_id);
+    state.DoObjects(thread_list);
+    state.DoObject(current_thread);
+
+    // Only the priority levels that hold ready threads are stored
+    std::vector<u32> levels;
+    if (!state.IsReading()) {
+        for (u32 priority = ThreadPrioHighest; priority <= ThreadPrioLowest; ++priority) {
+            if (!ready_queue.empty(priority)) {
+                levels.push_back(priority);
+            }
+        }
+    }
+    state.Do(levels);
+    if (state.IsReading()) {
+        ready_queue.clear();
+        for (const auto& thread : thread_list) {
+            ready_queue.prepare(thread->current_priority);
+        }
+    }
+    for (u32 priority : levels) {
+        if (priority > ThreadPrioLowest) {
+            state.Fail("invalid thread priority");
+            return;
+        }
+        std::vector<std::shared_ptr<Thread>> queue;
+        for (Thread* thread : ready_queue.get_queue(priority)) {
+            queue.push_back(SharedFrom(thread));
+        }
+        state.DoObjects(queue);
+        if (state.IsReading()) {
+            ready_queue.prepare(priority);
+            for (const auto& thread : queue) {
+                ready_queue.push_back(priority, thread.get());
+            }
+        }
+    }
+
+    if (!state.IsReading() || state.Failed()) {
+        return;
+    }
+
+    wakeup_callback_table.clear();
+    for (const auto& thread : thread_list) {
+        if (thread->status != ThreadStatus::Dead) {
+            wakeup_callback_table[thread->thread_id] = thread.get();
+        }
+    }
+
+    if (current_thread != nullptr && cpu != nullptr) {
+        cpu->LoadContext(current_thread->context);
+        cpu->SetCP15Register(CP15_THREAD_URO, current_thread->GetTLSAddress());
+    }
+}
+
 } // namespace Kernel
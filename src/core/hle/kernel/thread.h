@@ -56,6 +56,17 @@ enum class ThreadWakeupReason {
     Timeout // The thread was woken up due to a wait timeout.
 };
 
+/// Identifies the wakeup callback of a thread, so that it can be recreated when loading a state.
+enum class ThreadWakeupKind : u8 {
+    None,
+    WaitSynch1,       ///< svcWaitSynchronization1
+    WaitSynchAll,     ///< svcWaitSynchronizationN with wait_all = true
+    WaitSynchAny,     ///< svcWaitSynchronizationN with wait_all = false
+    ReplyAndReceive,  ///< svcReplyAndReceive
+    ArbitrateTimeout, ///< svcArbitrateAddress with a timeout, recreated by the AddressArbiter
+    HleEvent,         ///< An HLE handler paused the thread, can't be saved
+};
+
 class ThreadManager {
 public:
     explicit ThreadManager(Kernel::KernelSystem& kernel);
@@ -102,6 +113,9 @@ public:
      */
     const std::vector<std::shared_ptr<Thread>>& GetThreadList();
 
+    /// Saves or restores the thread list and the scheduler state, including the CPU context.
+    void DoState(StateWrap& state);
+
     void SetCPU(ARM_Interface& cpu) {
         this->cpu = &cpu;
     }
@@ -131,7 +145,7 @@ private:
     void ThreadWakeupCallback(u64 thread_id, s64 cycles_late);
 
     Kernel::KernelSystem& kernel;
-    ARM_Interface* cpu;
+    ARM_Interface* cpu = nullptr;
 
     u32 next_thread_id = 1;
     std::shared_ptr<Thread> current_thread;
@@ -153,6 +167,9 @@ public:
     explicit Thread(KernelSystem&);
     ~Thread() override;
 
+    using WakeupCallback = void(ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                                std::shared_ptr<WaitObject> object);
+
     std::string GetName() const override {
         return name;
     }
@@ -165,6 +182,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     bool ShouldWait(const Thread* thread) const override;
     void Acquire(Thread* thread) override;
 
@@ -225,6 +244,13 @@ public:
      */
     void SetWaitSynchronizationOutput(s32 output);
 
+    /**
+     * Sets the callback that will be invoked when the thread is resumed from its wait
+     * @param kind Identifies the callback in save states
+     * @param callback The callback to invoke
+     */
+    void SetWakeupCallback(ThreadWakeupKind kind, std::function<WakeupCallback> callback);
+
     /**
      * Retrieves the index that this particular object occupies in the list of objects
      * that the thread passed to WaitSynchronizationN, starting the search from the last element.
@@ -295,14 +321,15 @@ public:
 
     VAddr wait_address; ///< If waiting on an AddressArbiter, this is the arbitration address
 
+    Core::TimingEventToken wakeup_event; ///< The event that wakes up the thread, if scheduled
+
     std::string name;
 
-    using WakeupCallback = void(ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
-                                std::shared_ptr<WaitObject> object);
     // Callback that will be invoked when the thread is resumed from a waiting state. If the thread
     // was waiting via WaitSynchronizationN then the object will be the last object that became
     // available. In case of a timeout, the object will be nullptr.
     std::function<WakeupCallback> wakeup_callback;
+    ThreadWakeupKind wakeup_kind = ThreadWakeupKind::None;
 
 private:
     ThreadManager& thread_manager;
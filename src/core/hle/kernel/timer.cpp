@@ -9,6 +9,7 @@
 #include "core/core.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 
@@ -17,8 +18,12 @@ namespace Kernel {
 Timer::Timer(KernelSystem& kernel)
     : WaitObject(kernel), kernel(kernel), timer_manager(kernel.GetTimerManager()) {}
 Timer::~Timer() {
-    Cancel();
-    timer_manager.timer_callback_table.erase(callback_id);
+    // A timer replaced by a loaded state may share its callback id with the restored one
+    auto itr = timer_manager.timer_callback_table.find(callback_id);
+    if (itr != timer_manager.timer_callback_table.end() && itr->second == this) {
+        Cancel();
+        timer_manager.timer_callback_table.erase(itr);
+    }
 }
 
 std::shared_ptr<Timer> KernelSystem::CreateTimer(ResetType reset_type, std::string name) {
@@ -57,13 +62,13 @@ void Timer::Set(s64 initial, s64 interval) {
         // Immediately invoke the callback
         Signal(0);
     } else {
-        kernel.timing.ScheduleEvent(nsToCycles(initial), timer_manager.timer_callback_event_type,
-                                    callback_id);
+        callback_event = kernel.timing.ScheduleEvent(
+            nsToCycles(initial), timer_manager.timer_callback_event_type, callback_id);
     }
 }
 
 void Timer::Cancel() {
-    kernel.timing.UnscheduleEvent(timer_manager.timer_callback_event_type, callback_id);
+    kernel.timing.UnscheduleEvent(callback_event);
 }
 
 void Timer::Clear() {
@@ -87,12 +92,36 @@ void Timer::Signal(s64 cycles_late) {
 
     if (interval_delay != 0) {
         // Reschedule the timer with the interval delay
-        kernel.timing.ScheduleEvent(nsToCycles(interval_delay) - cycles_late,
-                                    timer_manager.timer_callback_event_type, callback_id);
+        callback_event =
+            kernel.timing.ScheduleEvent(nsToCycles(interval_delay) - cycles_late,
+                                        timer_manager.timer_callback_event_type, callback_id);
     }
 }
 
 /// The timer callback event, called when a timer is fired
+void Timer::DoState(StateWrap& state) {
+    auto& table = timer_manager.timer_callback_table;
+    if (state.IsReading()) {
+        auto itr = table.find(callback_id);
+        if (itr != table.end() && itr->second == this) {
+            table.erase(itr);
+        }
+    }
+
+    state.Do(reset_type);
+    state.Do(initial_delay);
+    state.Do(interval_delay);
+    state.Do(signaled);
+    state.Do(name);
+    state.Do(callback_id);
+    state.Do(callback_event.slot);
+    state.Do(callback_event.generation);
+    if (state.IsReading()) {
+        table[callback_id] = this;
+    }
+    DoWaitObjectState(state);
+}
+
 void TimerManager::TimerCallback(u64 callback_id, s64 cycles_late) {
     std::shared_ptr<Timer> timer = SharedFrom(timer_callback_table.at(callback_id));
 
@@ -111,4 +140,8 @@ TimerManager::TimerManager(Core::Timing& timing) : timing(timing) {
         });
 }
 
+void TimerManager::DoState(StateWrap& state) {
+    state.Do(next_timer_callback_id);
+}
+
 } // namespace Kernel
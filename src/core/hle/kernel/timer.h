@@ -19,6 +19,8 @@ class TimerManager {
 public:
     TimerManager(Core::Timing& timing);
 
+    void DoState(StateWrap& state);
+
 private:
     /// The timer callback event, called when a timer is fired
     void TimerCallback(u64 callback_id, s64 cycles_late);
@@ -52,6 +54,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(StateWrap& state) override;
+
     ResetType GetResetType() const {
         return reset_type;
     }
@@ -97,7 +101,9 @@ private:
     std::string name; ///< Name of timer (optional)
 
     /// ID used as userdata to reference this object when inserting into the CoreTiming queue.
-    u64 callback_id;
+    u64 callback_id = 0;
+    /// The event that fires the timer next, if scheduled
+    Core::TimingEventToken callback_event;
 
     KernelSystem& kernel;
     TimerManager& timer_manager;
@@ -6,6 +6,7 @@
 #include <iterator>
 #include "common/assert.h"
 #include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
 #include "core/mmio.h"
@@ -379,4 +380,49 @@ ResultVal<std::vector<std::pair<u8*, u32>>> VMManager::GetBackingBlocksForRange(
     }
     return MakeResult(backing_blocks);
 }
+void VMManager::DoState(StateWrap& state) {
+    u32 count = static_cast<u32>(vma_map.size());
+    state.Do(count);
+
+    if (!state.IsReading()) {
+        for (auto& [base, vma] : vma_map) {
+            if (vma.type == VMAType::MMIO) {
+                state.Fail("MMIO mappings can't be saved");
+                return;
+            }
+            state.Do(vma.base);
+            state.Do(vma.size);
+            state.Do(vma.type);
+            state.Do(vma.permissions);
+            state.Do(vma.meminfo_state);
+            state.DoMemoryPointer(vma.backing_memory);
+        }
+        return;
+    }
+
+    std::map<VAddr, VirtualMemoryArea> loaded_map;
+    for (u32 i = 0; i < count && !state.Failed(); ++i) {
+        VirtualMemoryArea vma;
+        state.Do(vma.base);
+        state.Do(vma.size);
+        state.Do(vma.type);
+        state.Do(vma.permissions);
+        state.Do(vma.meminfo_state);
+        state.DoMemoryPointer(vma.backing_memory);
+        loaded_map.emplace(vma.base, vma);
+    }
+    if (state.Failed()) {
+        return;
+    }
+
+    vma_map = std::move(loaded_map);
+    page_table.pointers.fill(nullptr);
+    page_table.attributes.fill(Memory::PageType::Unmapped);
+    for (const auto& [base, vma] : vma_map) {
+        if (vma.type == VMAType::BackingMemory) {
+            UpdatePageTableForVMA(vma);
+        }
+    }
+}
+
 } // namespace Kernel
@@ -15,6 +15,8 @@
 
 namespace Kernel {
 
+class StateWrap;
+
 enum class VMAType : u8 {
     /// VMA represents an unmapped region of the address space.
     Free,
@@ -119,6 +121,9 @@ public:
     /// Clears the address space map, re-initializing with a single free area.
     void Reset();
 
+    /// Saves or restores the address space map and rebuilds the page table when loading.
+    void DoState(StateWrap& state);
+
     /// Finds the VMA in which the given address is included in, or `vma_map.end()`.
     VMAHandle FindVMA(VAddr target) const;
 
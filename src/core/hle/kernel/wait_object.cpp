@@ -11,6 +11,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 
@@ -101,4 +102,8 @@ void WaitObject::SetHLENotifier(std::function<void()> callback) {
     hle_notifier = std::move(callback);
 }
 
+void WaitObject::DoWaitObjectState(StateWrap& state) {
+    state.DoObjects(waiting_threads);
+}
+
 } // namespace Kernel
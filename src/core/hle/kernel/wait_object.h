@@ -57,6 +57,10 @@ public:
     /// Sets a callback which is called when the object becomes available
     void SetHLENotifier(std::function<void()> callback);
 
+protected:
+    /// Saves or restores the list of waiting threads. The HLE notifier is kept as is.
+    void DoWaitObjectState(StateWrap& state);
+
 private:
     /// Threads waiting for this object to become available
     std::vector<std::shared_ptr<Thread>> waiting_threads;
@@ -3,15 +3,22 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstddef>
 #include <cstring>
+#include <map>
+#include <thread>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/thread.h"
+#include "common/thread_pool.h"
+#include "common/threadsafe_queue.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
@@ -79,8 +86,33 @@ static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong")
 class CIAFile::DecryptionState {
 public:
     std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    std::vector<CryptoPP::SHA256> hash;
 };
 
+constexpr ResultCode ERROR_TRUNCATED_CIA(ErrCodes::InvalidCIAHeader, ErrorModule::AM,
+                                         ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
+constexpr ResultCode ERROR_CONTENT_HASH_MISMATCH(ErrCodes::InvalidCIAHeader, ErrorModule::AM,
+                                                 ErrorSummary::InvalidState,
+                                                 ErrorLevel::Permanent);
+
+// The content pipeline of InstallContents passes this many buffers of this size between its stages
+constexpr std::size_t PIPELINE_CHUNK_COUNT = 8;
+constexpr std::size_t PIPELINE_CHUNK_SIZE = 0x100000;
+
+namespace {
+/// A part of a content, in one of the buffers of the content pipeline
+struct ContentChunk {
+    u16 index = 0;
+    u64 offset = 0;
+    std::size_t size = 0;
+    std::vector<u8> data = std::vector<u8>(PIPELINE_CHUNK_SIZE);
+};
+
+/// Queue between two stages of the content pipeline, a null chunk marks the end of the contents
+using ContentChunkQueue =
+    Common::BoundedQueue<std::unique_ptr<ContentChunk>, PIPELINE_CHUNK_COUNT + 1>;
+} // namespace
+
 CIAFile::CIAFile(Service::FS::MediaType media_type)
     : media_type(media_type), decryption_state(std::make_unique<DecryptionState>()) {}
 
@@ -131,6 +163,7 @@ ResultCode CIAFile::WriteTitleMetadata() {
 
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
+    decryption_state->hash.resize(content_count);
 
     if (auto title_key = container.GetTicket().GetTitleKey()) {
         decryption_state->content.resize(content_count);
@@ -151,7 +184,7 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
     // has been written since we might get a written buffer which contains multiple .app
     // contents or only part of a larger .app's contents.
     u64 offset_max = offset + length;
-    for (int i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
+    for (u16 i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(i)) {
             // The size, minimum unwritten offset, and maximum unwritten offset of this content
             u64 size = container.GetContentSize(i);
@@ -160,7 +193,7 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // The unwritten range for this content is beyond the buffered data we have
             // or comes before the buffered data we have, so skip this content ID.
-            if (range_min > offset_max || range_max < offset)
+            if (range_min >= offset_max || range_max <= offset)
                 continue;
 
             // Figure out how much of this content ID we have just recieved/can write out
@@ -175,15 +208,19 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
             if (!file.IsOpen())
                 return FileSys::ERROR_INSUFFICIENT_SPACE;
 
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-
-            if (tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
-                FileSys::TMDContentTypeFlag::Encrypted) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+            const u8* content_data = buffer + (range_min - offset);
+            if (tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) {
+                content_buffer.resize(available_to_write);
+                DecryptContentData(i, content_buffer.data(), content_data, available_to_write);
+                content_data = content_buffer.data();
             }
 
-            file.WriteBytes(temp.data(), temp.size());
+            // The end of a content that doesn't match its hash isn't written, so that the install
+            // is aborted when the file is closed
+            if (!HashContentData(i, content_written[i], content_data, available_to_write))
+                return ERROR_CONTENT_HASH_MISMATCH;
+
+            file.WriteBytes(content_data, available_to_write);
 
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
@@ -196,6 +233,137 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
     return MakeResult<std::size_t>(length);
 }
 
+ResultCode CIAFile::InstallContents(FileUtil::IOFile& file,
+                                   const std::function<ProgressCallback>& update_callback) {
+    const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
+    const u16 content_count = static_cast<u16>(tmd.GetContentCount());
+    const u64 content_offset = container.GetContentOffset();
+    const u64 total_size = content_offset + container.GetTotalContentSize();
+
+    // The reader takes free buffers, the writer gives them back, so the queues never hold more
+    // buffers than there are
+    ContentChunkQueue free_chunks;
+    ContentChunkQueue decrypt_queue;
+    ContentChunkQueue hash_queue;
+    ContentChunkQueue write_queue;
+    for (std::size_t i = 0; i < PIPELINE_CHUNK_COUNT; ++i) {
+        free_chunks.Push(std::make_unique<ContentChunk>());
+    }
+
+    // Once a stage fails the others stop processing, but still pass the buffers on to the end
+    std::atomic_bool failed{false};
+    std::atomic<u64> bytes_written{0};
+    ResultCode read_result = RESULT_SUCCESS;
+    ResultCode hash_result = RESULT_SUCCESS;
+    ResultCode write_result = RESULT_SUCCESS;
+
+    std::thread decrypt_thread([&] {
+        Common::SetCurrentThreadName("CIADecrypt");
+        while (auto chunk = decrypt_queue.PopWait()) {
+            if (!failed && (tmd.GetContentTypeByIndex(chunk->index) &
+                            FileSys::TMDContentTypeFlag::Encrypted)) {
+                DecryptContentData(chunk->index, chunk->data.data(), chunk->data.data(),
+                                   chunk->size);
+            }
+            hash_queue.Push(std::move(chunk));
+        }
+        hash_queue.Push(nullptr);
+    });
+
+    std::thread hash_thread([&] {
+        Common::SetCurrentThreadName("CIAHash");
+        while (auto chunk = hash_queue.PopWait()) {
+            if (!failed &&
+                !HashContentData(chunk->index, chunk->offset, chunk->data.data(), chunk->size)) {
+                hash_result = ERROR_CONTENT_HASH_MISMATCH;
+                failed = true;
+            }
+            write_queue.Push(std::move(chunk));
+        }
+        write_queue.Push(nullptr);
+    });
+
+    std::thread write_thread([&] {
+        Common::SetCurrentThreadName("CIAWrite");
+        FileUtil::IOFile content_file;
+        while (auto chunk = write_queue.PopWait()) {
+            if (!failed) {
+                if (chunk->offset == 0) {
+                    content_file.Open(GetTitleContentPath(media_type, tmd.GetTitleID(),
+                                                          chunk->index, is_update),
+                                      "wb");
+                }
+                if (content_file.WriteBytes(chunk->data.data(), chunk->size) != chunk->size) {
+                    write_result = FileSys::ERROR_INSUFFICIENT_SPACE;
+                    failed = true;
+                } else {
+                    content_written[chunk->index] += chunk->size;
+                    bytes_written += chunk->size;
+                }
+            }
+            free_chunks.Push(std::move(chunk));
+        }
+    });
+
+    for (u16 i = 0; i < content_count && !failed; ++i) {
+        const u64 size = container.GetContentSize(i);
+        if (!file.Seek(container.GetContentOffset(i), SEEK_SET)) {
+            read_result = ERROR_TRUNCATED_CIA;
+            failed = true;
+            break;
+        }
+        for (u64 offset = 0; offset < size && !failed; offset += PIPELINE_CHUNK_SIZE) {
+            auto chunk = free_chunks.PopWait();
+            chunk->index = i;
+            chunk->offset = offset;
+            chunk->size =
+                static_cast<std::size_t>(std::min<u64>(size - offset, chunk->data.size()));
+            if (file.ReadBytes(chunk->data.data(), chunk->size) != chunk->size) {
+                read_result = ERROR_TRUNCATED_CIA;
+                failed = true;
+                break;
+            }
+            decrypt_queue.Push(std::move(chunk));
+
+            if (update_callback)
+                update_callback(content_offset + bytes_written, total_size);
+        }
+    }
+    decrypt_queue.Push(nullptr);
+
+    decrypt_thread.join();
+    hash_thread.join();
+    write_thread.join();
+
+    if (update_callback)
+        update_callback(content_offset + bytes_written, total_size);
+
+    for (const ResultCode& result : {read_result, hash_result, write_result}) {
+        if (result.IsError())
+            return result;
+    }
+    return RESULT_SUCCESS;
+}
+
+void CIAFile::DecryptContentData(u16 index, u8* out, const u8* in, std::size_t size) {
+    decryption_state->content[index].ProcessData(out, in, size);
+}
+
+bool CIAFile::HashContentData(u16 index, u64 offset, const u8* data, std::size_t size) {
+    CryptoPP::SHA256& hash = decryption_state->hash[index];
+    hash.Update(data, size);
+    if (offset + size < container.GetContentSize(index))
+        return true;
+
+    std::array<u8, CryptoPP::SHA256::DIGESTSIZE> digest;
+    hash.Final(digest.data());
+    if (digest != container.GetTitleMetadata().GetContentHashByIndex(index)) {
+        LOG_ERROR(Service_AM, "Content {} doesn't match its hash", index);
+        return false;
+    }
+    return true;
+}
+
 ResultVal<std::size_t> CIAFile::Write(u64 offset, std::size_t length, bool flush,
                                       const u8* buffer) {
     written += length;
@@ -354,23 +522,32 @@ InstallStatus InstallCIA(const std::string& path,
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
 
-        std::array<u8, 0x10000> buffer;
-        std::size_t total_bytes_read = 0;
-        while (total_bytes_read != file.GetSize()) {
-            std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
-            auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            static_cast<u8*>(buffer.data()));
-
-            if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
-            if (result.Failed()) {
-                LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
-                          result.Code().raw);
-                return InstallStatus::ErrorAborted;
-            }
-            total_bytes_read += bytes_read;
+        // Everything before the contents is written as the AM service would, which loads the
+        // ticket and the TMD. The contents are then installed by the content pipeline.
+        std::vector<u8> buffer(container.GetContentOffset());
+        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
+            LOG_ERROR(Service_AM, "CIA file {} is truncated!", path);
+            return InstallStatus::ErrorInvalid;
+        }
+        auto result = installFile.Write(0, buffer.size(), true, buffer.data());
+        if (result.Failed()) {
+            LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
+                      result.Code().raw);
+            return InstallStatus::ErrorAborted;
         }
+
+        const ResultCode content_result = installFile.InstallContents(file, update_callback);
         installFile.Close();
+        if (content_result == ERROR_TRUNCATED_CIA ||
+            content_result == ERROR_CONTENT_HASH_MISMATCH) {
+            LOG_ERROR(Service_AM, "CIA file {} is invalid!", path);
+            return InstallStatus::ErrorInvalid;
+        }
+        if (content_result.IsError()) {
+            LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
+                      content_result.raw);
+            return InstallStatus::ErrorAborted;
+        }
 
         LOG_INFO(Service_AM, "Installed {} successfully.", path);
         return InstallStatus::Success;
@@ -380,6 +557,46 @@ InstallStatus InstallCIA(const std::string& path,
     return InstallStatus::ErrorInvalid;
 }
 
+std::vector<InstallStatus> InstallCIAs(const std::vector<std::string>& paths,
+                                       std::function<BatchProgressCallback>&& update_callback) {
+    // CIAs of the same title write to the same directory, so they are grouped to be installed one
+    // after another. CIAs that can't be loaded are left to InstallCIA to report.
+    std::vector<std::vector<std::size_t>> groups;
+    std::map<u64, std::size_t> title_groups;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        FileSys::CIAContainer container;
+        if (container.Load(paths[i]) != Loader::ResultStatus::Success) {
+            groups.push_back({i});
+            continue;
+        }
+        const u64 title_id = container.GetTitleMetadata().GetTitleID();
+        const auto [it, inserted] = title_groups.emplace(title_id, groups.size());
+        if (inserted)
+            groups.emplace_back();
+        groups[it->second].push_back(i);
+    }
+
+    std::vector<InstallStatus> statuses(paths.size(), InstallStatus::ErrorAborted);
+    if (groups.empty())
+        return statuses;
+
+    // Each install runs its own content pipeline, so the pool only needs one thread per install
+    Common::ThreadPool pool(
+        std::min(groups.size(), Common::ThreadPool::DefaultThreadCount()) - 1, "CIAInstall");
+    pool.ParallelFor(groups.size(), [&](std::size_t group) {
+        for (const std::size_t i : groups[group]) {
+            std::function<ProgressCallback> callback;
+            if (update_callback) {
+                callback = [&update_callback, i](std::size_t written, std::size_t total) {
+                    update_callback(i, written, total);
+                };
+            }
+            statuses[i] = InstallCIA(paths[i], std::move(callback));
+        }
+    });
+    return statuses;
+}
+
 Service::FS::MediaType GetTitleMediaType(u64 titleId) {
     u16 platform = static_cast<u16>(titleId >> 48);
     u16 category = static_cast<u16>((titleId >> 32) & 0xFFFF);
@@ -20,6 +20,10 @@ namespace Core {
 class System;
 }
 
+namespace FileUtil {
+class IOFile;
+}
+
 namespace Service::FS {
 enum class MediaType : u32;
 }
@@ -61,6 +65,9 @@ constexpr std::size_t TITLE_ID_VALID_LENGTH = 16;
 // Progress callback for InstallCIA, receives bytes written and total bytes
 using ProgressCallback = void(std::size_t, std::size_t);
 
+// Progress callback for InstallCIAs, receives the index of the CIA, bytes written and total bytes
+using BatchProgressCallback = void(std::size_t, std::size_t, std::size_t);
+
 // A file handled returned for CIAs to be written into and subsequently installed.
 class CIAFile final : public FileSys::FileBackend {
 public:
@@ -71,6 +78,18 @@ public:
     ResultCode WriteTicket();
     ResultCode WriteTitleMetadata();
     ResultVal<std::size_t> WriteContentData(u64 offset, std::size_t length, const u8* buffer);
+
+    /**
+     * Installs all the contents of the CIA from a file, once everything before the contents has
+     * been written. The contents are read, decrypted, hashed and written by separate threads,
+     * which hand the same buffers to each other.
+     * @param file the CIA file to read the contents from
+     * @param update_callback callback function called as the contents are read
+     * @returns the result of the first stage that failed, if any
+     */
+    ResultCode InstallContents(FileUtil::IOFile& file,
+                               const std::function<ProgressCallback>& update_callback);
+
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override;
     u64 GetSize() const override;
@@ -79,6 +98,16 @@ public:
     void Flush() const override;
 
 private:
+    /// Decrypts data of a content into out, which can be the same as in
+    void DecryptContentData(u16 index, u8* out, const u8* in, std::size_t size);
+
+    /**
+     * Adds data of a content to its hash, and checks the hash against the TMD once the content is
+     * complete.
+     * @returns false if the content is complete and its hash doesn't match
+     */
+    bool HashContentData(u16 index, u64 offset, const u8* data, std::size_t size);
+
     // Whether it's installing an update, and what step of installation it is at
     bool is_update = false;
     CIAInstallState install_state = CIAInstallState::InstallStarted;
@@ -92,6 +121,9 @@ private:
     std::vector<u64> content_written;
     Service::FS::MediaType media_type;
 
+    // Buffer the content data written by the AM service is decrypted to
+    std::vector<u8> content_buffer;
+
     class DecryptionState;
     std::unique_ptr<DecryptionState> decryption_state;
 };
@@ -105,6 +137,17 @@ private:
 InstallStatus InstallCIA(const std::string& path,
                          std::function<ProgressCallback>&& update_callback = nullptr);
 
+/**
+ * Installs CIA files from the specified file paths, several at a time. CIAs of the same title are
+ * installed one after another, in the order of their paths.
+ * @param paths file paths of the CIA files to install
+ * @param update_callback callback function called during filesystem writes, from any thread
+ * @returns the status of the install of each CIA, in the order of their paths
+ */
+std::vector<InstallStatus> InstallCIAs(
+    const std::vector<std::string>& paths,
+    std::function<BatchProgressCallback>&& update_callback = nullptr);
+
 /**
  * Get the mediatype for an installed title
  * @param titleId the installed title ID
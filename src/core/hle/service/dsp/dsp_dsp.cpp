@@ -8,6 +8,7 @@
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/service/dsp/dsp_dsp.h"
 
 using DspPipe = AudioCore::DspPipe;
@@ -390,6 +391,16 @@ DSP_DSP::~DSP_DSP() {
     pipes = {};
 }
 
+void DSP_DSP::DoHandlerState(Kernel::StateWrap& state) {
+    // The semaphore event is created at boot and restored in place
+    state.Do(preset_semaphore);
+    state.DoObject(interrupt_zero);
+    state.DoObject(interrupt_one);
+    for (auto& pipe : pipes) {
+        state.DoObject(pipe);
+    }
+}
+
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
     auto dsp = std::make_shared<DSP_DSP>(system);
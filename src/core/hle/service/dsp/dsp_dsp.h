@@ -31,6 +31,8 @@ public:
     /// Signal interrupt on pipe
     void SignalInterrupt(InterruptType type, AudioCore::DspPipe pipe);
 
+    void DoHandlerState(Kernel::StateWrap& state) override;
+
 private:
     /**
      * DSP_DSP::RecvData service function
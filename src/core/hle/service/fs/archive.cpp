@@ -9,7 +9,9 @@
 #include <system_error>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
@@ -52,16 +54,87 @@ ResultVal<ArchiveHandle> ArchiveManager::OpenArchive(ArchiveIdCode id_code,
         ++next_handle;
     }
     handle_map.emplace(next_handle, std::move(res));
+    archive_infos.insert_or_assign(next_handle, ArchiveOpenInfo{id_code, archive_path, program_id});
     return MakeResult<ArchiveHandle>(next_handle++);
 }
 
 ResultCode ArchiveManager::CloseArchive(ArchiveHandle handle) {
+    archive_infos.erase(handle);
     if (handle_map.erase(handle) == 0)
         return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
     else
         return RESULT_SUCCESS;
 }
 
+ResultVal<std::unique_ptr<FileSys::FileBackend>> ArchiveManager::ReopenFile(
+    const ArchiveOpenInfo& archive_info, const FileSys::Path& path, FileSys::Mode mode) {
+    auto itr = id_code_map.find(archive_info.id_code);
+    if (itr == id_code_map.end()) {
+        return FileSys::ERROR_NOT_FOUND;
+    }
+
+    CASCADE_RESULT(std::unique_ptr<ArchiveBackend> archive,
+                   itr->second->Open(archive_info.path, archive_info.program_id));
+    return archive->OpenFile(path, mode);
+}
+
+void ArchiveOpenInfo::DoState(PointerWrap& p) {
+    p.Do(id_code);
+    path.DoState(p);
+    p.Do(program_id);
+}
+
+void ArchiveManager::DoState(PointerWrap& p) {
+    auto section = p.Section("ArchiveManager", 1);
+    if (!section) {
+        return;
+    }
+
+    p.Do(next_handle);
+
+    std::vector<ArchiveHandle> handles;
+    for (const auto& [handle, archive] : handle_map) {
+        handles.push_back(handle);
+    }
+    std::sort(handles.begin(), handles.end());
+    u32 num_archives = static_cast<u32>(handles.size());
+    p.Do(num_archives);
+
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (ArchiveHandle handle : handles) {
+            p.Do(handle);
+            archive_infos.at(handle).DoState(p);
+        }
+        return;
+    }
+
+    handle_map.clear();
+    archive_infos.clear();
+    for (u32 i = 0; i < num_archives && p.error != PointerWrap::ERROR_FAILURE; ++i) {
+        ArchiveHandle handle = 0;
+        ArchiveOpenInfo archive_info;
+        p.Do(handle);
+        archive_info.DoState(p);
+
+        auto itr = id_code_map.find(archive_info.id_code);
+        if (itr == id_code_map.end()) {
+            LOG_ERROR(Service_FS, "Save state has an unknown archive 0x{:08X}",
+                      static_cast<u32>(archive_info.id_code));
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            break;
+        }
+        auto archive = itr->second->Open(archive_info.path, archive_info.program_id);
+        if (archive.Failed()) {
+            LOG_ERROR(Service_FS, "Can't open archive {} of the save state",
+                      itr->second->GetName());
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            break;
+        }
+        handle_map.emplace(handle, std::move(archive).Unwrap());
+        archive_infos.emplace(handle, std::move(archive_info));
+    }
+}
+
 // TODO(yuriks): This might be what the fs:REG service is for. See the Register/Unregister calls in
 // http://3dbrew.org/wiki/Filesystem_services#ProgramRegistry_service_.22fs:REG.22
 ResultCode ArchiveManager::RegisterArchiveType(std::unique_ptr<FileSys::ArchiveFactory>&& factory,
@@ -91,6 +164,8 @@ ArchiveManager::OpenFileFromArchive(ArchiveHandle archive_handle, const FileSys:
         return std::make_tuple(backend.Code(), open_timeout_ns);
 
     auto file = std::shared_ptr<File>(new File(system, std::move(backend).Unwrap(), path));
+    file->archive_info = archive_infos.at(archive_handle);
+    file->mode = mode;
     return std::make_tuple(MakeResult<std::shared_ptr<File>>(std::move(file)), open_timeout_ns);
 }
 
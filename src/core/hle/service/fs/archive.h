@@ -56,6 +56,12 @@ class ArchiveManager {
 public:
     explicit ArchiveManager(Core::System& system);
 
+    /**
+     * Saves or restores the open archive handles. Archives are opened again when loading, their
+     * contents are not part of the state.
+     */
+    void DoState(PointerWrap& p);
+
     /**
      * Opens an archive
      * @param id_code IdCode of the archive to open
@@ -72,6 +78,15 @@ public:
      */
     ResultCode CloseArchive(ArchiveHandle handle);
 
+    /**
+     * Opens the backend of a file again, in a temporary instance of the archive it was opened from
+     * @param archive_info Arguments the archive was opened with
+     * @param path Path to the File inside of the Archive
+     * @param mode Mode under which to open the File
+     */
+    ResultVal<std::unique_ptr<FileSys::FileBackend>> ReopenFile(
+        const ArchiveOpenInfo& archive_info, const FileSys::Path& path, FileSys::Mode mode);
+
     /**
      * Open a File from an Archive
      * @param archive_handle Handle to an open Archive object
@@ -259,6 +274,8 @@ private:
      * Map of active archive handles to archive objects
      */
     std::unordered_map<ArchiveHandle, std::unique_ptr<ArchiveBackend>> handle_map;
+    /// Arguments each active archive handle was opened with
+    std::unordered_map<ArchiveHandle, ArchiveOpenInfo> archive_infos;
     ArchiveHandle next_handle = 1;
 };
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
@@ -11,13 +12,20 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/state_wrap.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
 
 namespace Service::FS {
 
 File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
            const FileSys::Path& path)
-    : ServiceFramework("", 1), path(path), backend(std::move(backend)), system(system) {
+    : File(system) {
+    this->path = path;
+    this->backend = std::move(backend);
+}
+
+File::File(Core::System& system) : ServiceFramework("", 1), system(system) {
     static const FunctionInfo functions[] = {
         {0x08010100, &File::OpenSubFile, "OpenSubFile"},
         {0x080200C2, &File::Read, "Read"},
@@ -281,4 +289,32 @@ std::size_t File::GetSessionFileSize(std::shared_ptr<Kernel::ServerSession> sess
     return slot->size;
 }
 
+void FileSessionSlot::DoState(Kernel::StateWrap& state) {
+    state.Do(priority);
+    state.Do(offset);
+    state.Do(size);
+    state.Do(subfile);
+}
+
+void File::DoHandlerState(Kernel::StateWrap& state) {
+    // The contents of the file are not part of the state, it is opened again from the host
+    if (!state.IsReading() && archive_info.id_code == ArchiveIdCode{}) {
+        state.Fail("file " + path.DebugStr() + " wasn't opened from an archive");
+        return;
+    }
+    path.DoState(state.Wrap());
+    archive_info.DoState(state.Wrap());
+    state.Do(mode.hex);
+    if (!state.IsReading() || state.Failed()) {
+        return;
+    }
+
+    auto file_backend = system.ArchiveManager().ReopenFile(archive_info, path, mode);
+    if (file_backend.Failed()) {
+        state.Fail("can't open file " + path.DebugStr());
+        return;
+    }
+    backend = std::move(file_backend).Unwrap();
+}
+
 } // namespace Service::FS
@@ -8,17 +8,32 @@
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/service/service.h"
 
+class PointerWrap;
+
 namespace Core {
 class System;
 }
 
 namespace Service::FS {
 
+enum class ArchiveIdCode : u32;
+
+/// Arguments an archive was opened with, to open it again when a save state is loaded.
+struct ArchiveOpenInfo {
+    ArchiveIdCode id_code{};
+    FileSys::Path path;
+    u64 program_id = 0;
+
+    void DoState(PointerWrap& p);
+};
+
 struct FileSessionSlot : public Kernel::SessionRequestHandler::SessionDataBase {
     u32 priority; ///< Priority of the file. TODO(Subv): Find out what this means
     u64 offset;   ///< Offset that this session will start reading from.
     u64 size;     ///< Max size of the file that this session is allowed to access
     bool subfile; ///< Whether this file was opened via OpenSubFile or not.
+
+    void DoState(Kernel::StateWrap& state) override;
 };
 
 // TODO: File is not a real service, but it can still utilize ServiceFramework::RegisterHandlers.
@@ -27,14 +42,26 @@ class File final : public ServiceFramework<File, FileSessionSlot> {
 public:
     File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
          const FileSys::Path& path);
+    /// Creates a File without a backend, which is opened again by DoHandlerState
+    explicit File(Core::System& system);
     ~File() = default;
 
+    static constexpr char StateLoaderName[] = "fs:File";
+
+    std::string GetStateLoaderName() const override {
+        return StateLoaderName;
+    }
+
+    void DoHandlerState(Kernel::StateWrap& state) override;
+
     std::string GetName() const {
         return "Path: " + path.DebugStr();
     }
 
     FileSys::Path path;                            ///< Path of the file
     std::unique_ptr<FileSys::FileBackend> backend; ///< File backend interface
+    ArchiveOpenInfo archive_info;                  ///< Archive that the file was opened from
+    FileSys::Mode mode{};                          ///< Mode that the file was opened with
 
     /// Creates a new session to this File and returns the ClientSession part of the connection.
     std::shared_ptr<Kernel::ClientSession> Connect();
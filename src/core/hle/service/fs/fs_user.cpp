@@ -19,6 +19,7 @@
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/result.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
@@ -892,8 +893,18 @@ FS_USER::FS_USER(Core::System& system)
     RegisterHandlers(functions);
 }
 
+void ClientSlot::DoState(Kernel::StateWrap& state) {
+    state.Do(program_id);
+}
+
+void FS_USER::DoHandlerState(Kernel::StateWrap& state) {
+    state.Do(priority);
+}
+
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
     std::make_shared<FS_USER>(system)->InstallAsService(service_manager);
+    system.Kernel().RegisterHandlerLoader(File::StateLoaderName,
+                                          [&system] { return std::make_shared<File>(system); });
 }
 } // namespace Service::FS
@@ -22,12 +22,16 @@ struct ClientSlot : public Kernel::SessionRequestHandler::SessionDataBase {
     // behaviour is modified. Since we don't emulate fs:REG mechanism, we assume the program ID is
     // the same as codeset ID and fetch from there directly.
     u64 program_id = 0;
+
+    void DoState(Kernel::StateWrap& state) override;
 };
 
 class FS_USER final : public ServiceFramework<FS_USER, ClientSlot> {
 public:
     explicit FS_USER(Core::System& system);
 
+    void DoHandlerState(Kernel::StateWrap& state) override;
+
 private:
     void Initialize(Kernel::HLERequestContext& ctx);
 
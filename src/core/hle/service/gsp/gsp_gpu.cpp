@@ -12,6 +12,7 @@
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/kernel/shared_page.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/result.h"
 #include "core/hle/service/gsp/gsp_gpu.h"
 #include "core/hw/gpu.h"
@@ -836,4 +837,25 @@ SessionData::~SessionData() {
     gsp->used_thread_ids[thread_id] = false;
 }
 
+void SessionData::DoState(Kernel::StateWrap& state) {
+    // The slot of the session moves to the restored thread id
+    if (state.IsReading()) {
+        gsp->used_thread_ids[thread_id] = false;
+    }
+    state.Do(thread_id);
+    if (thread_id >= GSP_GPU::MaxGSPThreads) {
+        state.Fail("invalid GSP thread id");
+        thread_id = gsp->GetUnusedThreadId();
+    }
+    gsp->used_thread_ids[thread_id] = true;
+
+    state.Do(registered);
+    state.DoObject(interrupt_event);
+}
+
+void GSP_GPU::DoHandlerState(Kernel::StateWrap& state) {
+    state.Do(active_thread_id);
+    state.Do(first_initialization);
+}
+
 } // namespace Service::GSP
@@ -190,6 +190,8 @@ struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
     SessionData(GSP_GPU* gsp);
     ~SessionData();
 
+    void DoState(Kernel::StateWrap& state) override;
+
     GSP_GPU* gsp;
 
     /// Event triggered when GSP interrupt has been signalled
@@ -207,6 +209,8 @@ public:
 
     void ClientDisconnected(std::shared_ptr<Kernel::ServerSession> server_session) override;
 
+    void DoHandlerState(Kernel::StateWrap& state) override;
+
     /**
      * Signals that the specified interrupt type has occurred to userland code
      * @param interrupt_id ID of interrupt that is being signalled
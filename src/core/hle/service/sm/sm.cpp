@@ -2,10 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <tuple>
+#include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "core/core.h"
 #include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/result.h"
 #include "core/hle/service/sm/sm.h"
 #include "core/hle/service/sm/srv.h"
@@ -65,4 +70,36 @@ ResultVal<std::shared_ptr<Kernel::ClientSession>> ServiceManager::ConnectToServi
     return client_port->Connect();
 }
 
+void ServiceManager::DoState(Kernel::StateWrap& state) {
+    std::vector<std::pair<std::string, std::shared_ptr<Kernel::ClientPort>>> services(
+        registered_services.begin(), registered_services.end());
+    std::sort(services.begin(), services.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    u32 num_services = static_cast<u32>(services.size());
+    state.Do(num_services);
+    if (state.IsReading()) {
+        services.assign(state.Failed() ? 0 : num_services, {});
+    }
+    for (auto& [name, port] : services) {
+        state.Do(name);
+        state.DoObject(port);
+    }
+    if (state.IsReading() && !state.Failed()) {
+        registered_services = {services.begin(), services.end()};
+    }
+
+    for (const auto& [name, port] : services) {
+        if (port == nullptr || port->GetServerPort() == nullptr) {
+            continue;
+        }
+        if (const auto& handler = port->GetServerPort()->hle_handler) {
+            handler->DoHandlerState(state);
+        }
+    }
+    if (auto srv = srv_interface.lock()) {
+        srv->DoHandlerState(state);
+    }
+}
+
 } // namespace Service::SM
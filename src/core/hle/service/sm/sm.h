@@ -21,6 +21,7 @@ class System;
 namespace Kernel {
 class ClientSession;
 class SessionRequestHandler;
+class StateWrap;
 } // namespace Kernel
 
 namespace Service::SM {
@@ -52,6 +53,12 @@ public:
     ResultVal<std::shared_ptr<Kernel::ClientPort>> GetServicePort(const std::string& name);
     ResultVal<std::shared_ptr<Kernel::ClientSession>> ConnectToService(const std::string& name);
 
+    /**
+     * Saves or restores the registered service ports and the state of the HLE services behind
+     * them, which must match the services of the loaded state.
+     */
+    void DoState(Kernel::StateWrap& state);
+
     template <typename T>
     std::shared_ptr<T> GetService(const std::string& service_name) const {
         static_assert(std::is_base_of_v<Kernel::SessionRequestHandler, T>,
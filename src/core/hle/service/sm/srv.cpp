@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <tuple>
+#include <vector>
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -16,6 +18,7 @@
 #include "core/hle/kernel/semaphore.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/state_wrap.h"
 #include "core/hle/lock.h"
 #include "core/hle/service/sm/sm.h"
 #include "core/hle/service/sm/srv.h"
@@ -265,4 +268,24 @@ SRV::SRV(Core::System& system) : ServiceFramework("srv:", 4), system(system) {
 
 SRV::~SRV() = default;
 
+void SRV::DoHandlerState(Kernel::StateWrap& state) {
+    state.DoObject(notification_semaphore);
+
+    std::vector<std::string> names;
+    for (const auto& [name, event] : get_service_handle_delayed_map) {
+        names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    u32 num_delayed = static_cast<u32>(names.size());
+    state.Do(num_delayed);
+    if (state.IsReading()) {
+        names.assign(state.Failed() ? 0 : num_delayed, {});
+        get_service_handle_delayed_map.clear();
+    }
+    for (auto& name : names) {
+        state.Do(name);
+        state.DoObject(get_service_handle_delayed_map[name]);
+    }
+}
+
 } // namespace Service::SM
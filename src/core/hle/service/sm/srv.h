@@ -25,6 +25,8 @@ public:
     explicit SRV(Core::System& system);
     ~SRV();
 
+    void DoHandlerState(Kernel::StateWrap& state) override;
+
 private:
     void RegisterClient(Kernel::HLERequestContext& ctx);
     void EnableNotification(Kernel::HLERequestContext& ctx);
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -88,6 +89,10 @@ struct KeySlot {
 std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
 std::array<std::optional<AESKey>, 6> common_key_y_slots;
 
+// Guards key_slots and common_key_y_slots
+std::mutex key_mutex;
+std::once_flag keys_initialized;
+
 enum class FirmwareType : u32 {
     ARM9 = 0,  // uses NDMA
     ARM11 = 1, // uses XDMA
@@ -440,38 +445,52 @@ void LoadPresetKeys() {
 } // namespace
 
 void InitKeys() {
-    static bool initialized = false;
-    if (initialized)
-        return;
-    LoadBootromKeys();
-    LoadNativeFirmKeysOld3DS();
-    LoadNativeFirmKeysNew3DS();
-    LoadPresetKeys();
-    initialized = true;
+    std::call_once(keys_initialized, [] {
+        std::lock_guard lock{key_mutex};
+        LoadBootromKeys();
+        LoadNativeFirmKeysOld3DS();
+        LoadNativeFirmKeysNew3DS();
+        LoadPresetKeys();
+    });
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetKeyX(key);
 }
 
 void SetKeyY(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetKeyY(key);
 }
 
 void SetNormalKey(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard lock{key_mutex};
     key_slots.at(slot_id).SetNormalKey(key);
 }
 
 bool IsNormalKeyAvailable(std::size_t slot_id) {
+    std::lock_guard lock{key_mutex};
     return key_slots.at(slot_id).normal.has_value();
 }
 
 AESKey GetNormalKey(std::size_t slot_id) {
+    std::lock_guard lock{key_mutex};
     return key_slots.at(slot_id).normal.value_or(AESKey{});
 }
 
-void SelectCommonKeyIndex(u8 index) {
-    key_slots[KeySlotID::TicketCommonKey].SetKeyY(common_key_y_slots.at(index));
+std::optional<AESKey> DeriveNormalKey(std::size_t slot_id, const AESKey& key_y) {
+    std::lock_guard lock{key_mutex};
+    KeySlot& slot = key_slots.at(slot_id);
+    slot.SetKeyY(key_y);
+    return slot.normal;
+}
+
+std::optional<AESKey> DeriveTicketCommonKey(u8 index) {
+    std::lock_guard lock{key_mutex};
+    KeySlot& slot = key_slots[KeySlotID::TicketCommonKey];
+    slot.SetKeyY(common_key_y_slots.at(index));
+    return slot.normal;
 }
 
 } // namespace HW::AES
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <optional>
 #include "common/common_types.h"
 
 namespace HW::AES {
@@ -52,6 +53,9 @@ constexpr std::size_t AES_BLOCK_SIZE = 16;
 
 using AESKey = std::array<u8, AES_BLOCK_SIZE>;
 
+// The key slots are global, and can be used from several threads: the functions below take a
+// lock, and InitKeys only loads the keys once.
+
 void InitKeys();
 
 void SetGeneratorConstant(const AESKey& key);
@@ -62,6 +66,18 @@ void SetNormalKey(std::size_t slot_id, const AESKey& key);
 bool IsNormalKeyAvailable(std::size_t slot_id);
 AESKey GetNormalKey(std::size_t slot_id);
 
-void SelectCommonKeyIndex(u8 index);
+/**
+ * Sets the KeyY of a slot and returns the resulting normal key, without another thread being able
+ * to change the slot in between.
+ * @returns the normal key, or nothing if the KeyX of the slot is missing
+ */
+std::optional<AESKey> DeriveNormalKey(std::size_t slot_id, const AESKey& key_y);
+
+/**
+ * Selects the common key used to decrypt ticket title keys and returns the resulting normal key,
+ * without another thread being able to change the slot in between.
+ * @returns the normal key, or nothing if the KeyX or the common key is missing
+ */
+std::optional<AESKey> DeriveTicketCommonKey(u8 index);
 
 } // namespace HW::AES
@@ -0,0 +1,261 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include <vector>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+#include "common/color.h"
+#include "common/microprofile.h"
+#include "common/thread_pool.h"
+#include "common/vector_math.h"
+#include "core/hw/display_transfer.h"
+
+namespace GPU {
+
+MICROPROFILE_DEFINE(GPU_DisplayTransferKernel, "GPU", "DisplayTransfer Kernel",
+                    MP_RGB(100, 100, 255));
+
+namespace {
+
+using PixelFormat = Regs::PixelFormat;
+using ScalingMode = Regs::DisplayTransferConfig::ScalingMode;
+
+constexpr std::size_t NUM_FORMATS = 5;
+constexpr std::size_t NUM_SCALING_MODES = 3;
+
+/// Transfers with at least this many output pixels are split between threads
+constexpr u32 PARALLEL_MIN_PIXELS = 240 * 240;
+
+// Tiled images are made of 8x8 tiles, whose pixels are stored in Morton order. The offset of a
+// pixel in its tile is the sum of a part depending only on x and another depending only on y.
+constexpr std::array<u32, 8> morton_x = {0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15};
+constexpr std::array<u32, 8> morton_y = {0x00, 0x02, 0x08, 0x0a, 0x20, 0x22, 0x28, 0x2a};
+
+constexpr u32 BytesPerPixel(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return 4;
+    case PixelFormat::RGB8:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+/// Offset of the pixel column x in a row, for an image of the given layout
+u32 ColumnOffset(bool tiled, u32 x, u32 bytes_per_pixel) {
+    return (tiled ? (x & ~7u) * 8 + morton_x[x & 7] : x) * bytes_per_pixel;
+}
+
+/// Offset of the pixel row y in an image of the given layout and width
+u32 RowOffset(bool tiled, u32 y, u32 width, u32 bytes_per_pixel) {
+    return (tiled ? (y & ~7u) * width + morton_y[y & 7] : y * width) * bytes_per_pixel;
+}
+
+/// Addressing of a transfer, shared by all the rows
+struct TransferLayout {
+    const u8* src;
+    u8* dst;
+    u32 input_width;
+    u32 output_width;
+    u32 output_height;
+    u32 src_bytes_per_pixel;
+    u32 dst_bytes_per_pixel;
+    u32 vertical_scale;
+    bool src_tiled;
+    bool dst_tiled;
+    bool flip_vertically;
+    /// Offsets of the pixels read or written for each output column, within their row
+    std::vector<u32> src_columns;
+    std::vector<u32> dst_columns;
+
+    const u8* SourceRow(u32 y) const {
+        return src + RowOffset(src_tiled, y << vertical_scale, input_width, src_bytes_per_pixel);
+    }
+
+    u8* DestRow(u32 y) const {
+        const u32 output_y = flip_vertically ? output_height - y - 1 : y;
+        return dst + RowOffset(dst_tiled, output_y, output_width, dst_bytes_per_pixel);
+    }
+};
+
+template <PixelFormat format>
+Common::Vec4<u8> DecodePixel(const u8* src) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        return Color::DecodeRGBA8(src);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        return Color::DecodeRGB8(src);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        return Color::DecodeRGB565(src);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        return Color::DecodeRGB5A1(src);
+    } else {
+        return Color::DecodeRGBA4(src);
+    }
+}
+
+template <PixelFormat format>
+void EncodePixel(const Common::Vec4<u8>& color, u8* dst) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        Color::EncodeRGBA8(color, dst);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        Color::EncodeRGB8(color, dst);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        Color::EncodeRGB565(color, dst);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        Color::EncodeRGB5A1(color, dst);
+    } else {
+        Color::EncodeRGBA4(color, dst);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+/// Box filters the count consecutive RGBA8 pixels at src, which must be 2 or 4
+template <u32 count>
+Common::Vec4<u8> AverageRGBA8(const u8* src) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i average;
+    if constexpr (count == 2) {
+        const __m128i pixels =
+            _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), zero);
+        average = _mm_srli_epi16(_mm_add_epi16(pixels, _mm_srli_si128(pixels, 8)), 1);
+    } else {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i pairs =
+            _mm_add_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero));
+        average = _mm_srli_epi16(_mm_add_epi16(pairs, _mm_srli_si128(pairs, 8)), 2);
+    }
+    const u32 value = static_cast<u32>(_mm_cvtsi128_si32(_mm_packus_epi16(average, average)));
+    u8 bytes[4];
+    std::memcpy(bytes, &value, sizeof(value));
+    return Color::DecodeRGBA8(bytes);
+}
+#endif
+
+/// Reads the output color of a pixel, box filtering the input pixels for the scaling modes
+template <PixelFormat format, ScalingMode scaling>
+Common::Vec4<u8> ReadPixel(const u8* src) {
+    constexpr u32 bytes_per_pixel = BytesPerPixel(format);
+
+    if constexpr (scaling == ScalingMode::NoScale) {
+        return DecodePixel<format>(src);
+    }
+#ifdef ARCHITECTURE_x86_64
+    if constexpr (format == PixelFormat::RGBA8) {
+        return AverageRGBA8<scaling == ScalingMode::ScaleX ? 2 : 4>(src);
+    }
+#endif
+    // The pixels averaged are the ones that follow in memory, i.e. the 2x2 block in tiled images
+    const auto pixel0 = DecodePixel<format>(src);
+    const auto pixel1 = DecodePixel<format>(src + bytes_per_pixel);
+    if constexpr (scaling == ScalingMode::ScaleX) {
+        return ((pixel0 + pixel1) / 2).template Cast<u8>();
+    } else {
+        const auto pixel2 = DecodePixel<format>(src + 2 * bytes_per_pixel);
+        const auto pixel3 = DecodePixel<format>(src + 3 * bytes_per_pixel);
+        return (((pixel0 + pixel1) + (pixel2 + pixel3)) / 4).template Cast<u8>();
+    }
+}
+
+template <PixelFormat input_format, PixelFormat output_format, ScalingMode scaling>
+void ConvertRows(const TransferLayout& layout, u32 row_begin, u32 row_end) {
+    constexpr bool same_format = input_format == output_format;
+    constexpr u32 bytes_per_pixel = BytesPerPixel(output_format);
+    const u32* const src_columns = layout.src_columns.data();
+    const u32* const dst_columns = layout.dst_columns.data();
+
+    for (u32 y = row_begin; y < row_end; ++y) {
+        const u8* const src_row = layout.SourceRow(y);
+        u8* const dst_row = layout.DestRow(y);
+
+        if constexpr (same_format && scaling == ScalingMode::NoScale) {
+            if (!layout.src_tiled && !layout.dst_tiled) {
+                std::memcpy(dst_row, src_row, layout.output_width * bytes_per_pixel);
+                continue;
+            }
+        }
+
+        for (u32 x = 0; x < layout.output_width; ++x) {
+            const u8* const src_pixel = src_row + src_columns[x];
+            u8* const dst_pixel = dst_row + dst_columns[x];
+            if constexpr (same_format && scaling == ScalingMode::NoScale) {
+                // Converting to the same format is lossless, the pixel is copied as is
+                std::memcpy(dst_pixel, src_pixel, bytes_per_pixel);
+            } else {
+                EncodePixel<output_format>(ReadPixel<input_format, scaling>(src_pixel), dst_pixel);
+            }
+        }
+    }
+}
+
+using ConvertRowsFn = void (*)(const TransferLayout&, u32, u32);
+
+template <std::size_t... indices>
+constexpr std::array<ConvertRowsFn, sizeof...(indices)> MakeKernels(
+    std::index_sequence<indices...>) {
+    return {&ConvertRows<static_cast<PixelFormat>(indices / (NUM_FORMATS * NUM_SCALING_MODES)),
+                         static_cast<PixelFormat>(indices / NUM_SCALING_MODES % NUM_FORMATS),
+                         static_cast<ScalingMode>(indices % NUM_SCALING_MODES)>...};
+}
+
+/// Kernels for every input format, output format and scaling mode, in this order of indexing
+constexpr auto kernels =
+    MakeKernels(std::make_index_sequence<NUM_FORMATS * NUM_FORMATS * NUM_SCALING_MODES>{});
+
+} // Anonymous namespace
+
+void PerformDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst,
+                            Common::ThreadPool* pool) {
+    MICROPROFILE_SCOPE(GPU_DisplayTransferKernel);
+
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+
+    TransferLayout layout;
+    layout.src = src;
+    layout.dst = dst;
+    layout.input_width = config.input_width;
+    layout.output_width = config.output_width >> horizontal_scale;
+    layout.output_height = config.output_height >> (config.scaling == config.ScaleXY ? 1 : 0);
+    layout.src_bytes_per_pixel = BytesPerPixel(config.input_format);
+    layout.dst_bytes_per_pixel = BytesPerPixel(config.output_format);
+    layout.vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    // Linear input is converted to tiled output and conversely, unless swizzling is disabled
+    layout.src_tiled = !config.input_linear;
+    layout.dst_tiled = config.dont_swizzle ? layout.src_tiled : !layout.src_tiled;
+    layout.flip_vertically = config.flip_vertically != 0;
+
+    layout.src_columns.resize(layout.output_width);
+    layout.dst_columns.resize(layout.output_width);
+    for (u32 x = 0; x < layout.output_width; ++x) {
+        layout.src_columns[x] =
+            ColumnOffset(layout.src_tiled, x << horizontal_scale, layout.src_bytes_per_pixel);
+        layout.dst_columns[x] = ColumnOffset(layout.dst_tiled, x, layout.dst_bytes_per_pixel);
+    }
+
+    const std::size_t kernel_index =
+        (static_cast<std::size_t>(config.input_format.Value()) * NUM_FORMATS +
+         static_cast<std::size_t>(config.output_format.Value())) *
+            NUM_SCALING_MODES +
+        static_cast<std::size_t>(config.scaling.Value());
+    const ConvertRowsFn convert_rows = kernels[kernel_index];
+
+    if (pool == nullptr || layout.output_width * layout.output_height < PARALLEL_MIN_PIXELS) {
+        convert_rows(layout, 0, layout.output_height);
+        return;
+    }
+
+    // Rows are split in bands of whole tiles, which are contiguous in tiled images
+    const u32 num_bands = (layout.output_height + 7) / 8;
+    pool->ParallelFor(num_bands, [&layout, convert_rows](std::size_t band) {
+        const u32 row_begin = static_cast<u32>(band) * 8;
+        convert_rows(layout, row_begin, std::min(row_begin + 8, layout.output_height));
+    });
+}
+
+} // namespace GPU
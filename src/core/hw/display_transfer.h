@@ -0,0 +1,26 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+
+namespace Common {
+class ThreadPool;
+}
+
+namespace GPU {
+
+/**
+ * Converts the pixels of a display transfer in software. The formats, layouts and scaling mode
+ * are described by the config, whose sizes must have been validated.
+ * @param src Input image, of config.input_width x config.input_height pixels
+ * @param dst Output image, of the output size reduced by the scaling mode
+ * @param pool If not null, large transfers are split between its workers and the calling thread
+ */
+void PerformDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst,
+                            Common::ThreadPool* pool);
+
+} // namespace GPU
@@ -14,6 +14,7 @@
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/core.h"
+#include "core/file_sys/compressed_image.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/title_metadata.h"
 #include "core/hle/kernel/process.h"
@@ -35,9 +36,13 @@ static const u64 UPDATE_MASK = 0x0000000e00000000;
 
 FileType AppLoader_NCCH::IdentifyType(FileUtil::IOFile& file) {
     u32 magic;
-    file.Seek(0x100, SEEK_SET);
-    if (1 != file.ReadArray<u32>(&magic, 1))
-        return FileType::Error;
+    if (const auto content_magic = FileSys::CompressedImage::ReadContentMagic(file)) {
+        magic = *content_magic;
+    } else {
+        file.Seek(0x100, SEEK_SET);
+        if (1 != file.ReadArray<u32>(&magic, 1))
+            return FileType::Error;
+    }
 
     if (MakeMagic('N', 'C', 'S', 'D') == magic)
         return FileType::CCI;
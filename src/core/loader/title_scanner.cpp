@@ -0,0 +1,272 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include "common/chunk_file.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/swap.h"
+#include "core/hle/service/am/am.h"
+#include "core/hle/service/fs/archive.h"
+#include "core/loader/title_scanner.h"
+
+namespace Loader {
+
+/// Version of the cache data, to be increased whenever the layout of an entry changes
+constexpr u32 CacheVersion = 1;
+
+constexpr std::array<u8, 4> CacheMagic{{'C', 'T', 'C', 0x1A}};
+
+#pragma pack(push, 1)
+struct CacheHeader {
+    std::array<u8, 4> magic;       ///< Identifies the file type (always "CTC"0x1A)
+    u32_le version;                ///< Version of the cache data
+    std::array<char, 40> revision; ///< Git hash of the revision the cache was made by
+    u64_le data_size;              ///< Size of the cache data following the header
+    u64_le data_hash;              ///< Hash of the cache data
+};
+static_assert(sizeof(CacheHeader) == 64, "CacheHeader should be 64 bytes");
+#pragma pack(pop)
+
+static std::array<char, 40> GetRevision() {
+    std::array<char, 40> revision{};
+    std::strncpy(revision.data(), Common::g_scm_rev, revision.size());
+    return revision;
+}
+
+/// Applications are the only titles that have updates
+static bool IsApplication(u64 program_id) {
+    return program_id >= 0x0004000000000000 && program_id <= 0x00040000FFFFFFFF;
+}
+
+static u64 GetUpdateId(u64 program_id) {
+    return program_id + 0x0000000E00000000;
+}
+
+/// Returns the directory the contents of an update are installed to
+static std::string GetUpdateContentDir(u64 program_id) {
+    return Service::AM::GetTitlePath(Service::FS::MediaType::SDMC, GetUpdateId(program_id)) +
+           "content";
+}
+
+void TitleScanner::CacheEntry::DoState(PointerWrap& p) {
+    p.Do(size);
+    p.Do(modification_time);
+    p.Do(update_dir_time);
+    p.Do(update_path);
+    p.Do(update_size);
+    p.Do(update_modification_time);
+    p.Do(is_title);
+    p.Do(info.path);
+    p.Do(info.file_type);
+    p.Do(info.size);
+    p.Do(info.program_id);
+    p.Do(info.extdata_id);
+    p.Do(info.smdh);
+}
+
+TitleScanner::TitleScanner(std::string cache_path_)
+    : cache_path(std::move(cache_path_)),
+      pool(Common::ThreadPool::DefaultThreadCount(), "TitleScanner") {}
+
+TitleScanner::~TitleScanner() = default;
+
+std::vector<TitleInfo> TitleScanner::Scan(const std::vector<std::string>& paths,
+                                          const std::atomic_bool& stop) {
+    std::lock_guard lock{mutex};
+    if (!cache_loaded) {
+        LoadCache();
+        cache_loaded = true;
+    }
+
+    // Only the files that aren't in the cache, or that changed, are read
+    std::vector<std::pair<std::string, CacheEntry>> changed;
+    for (const std::string& path : paths) {
+        const u64 size = FileUtil::GetSize(path);
+        const u64 modification_time = FileUtil::GetModificationTime(path);
+        const auto cached = cache.find(path);
+        if (cached != cache.end() && IsUpToDate(cached->second, size, modification_time)) {
+            cached->second.seen = true;
+            continue;
+        }
+
+        CacheEntry entry;
+        entry.size = size;
+        entry.modification_time = modification_time;
+        changed.emplace_back(path, std::move(entry));
+    }
+
+    // Not a vector<bool>, as the workers set elements at the same time
+    std::vector<u8> is_read(changed.size());
+    pool.ParallelFor(changed.size(), [&changed, &is_read, &stop](std::size_t i) {
+        if (stop)
+            return;
+        ReadTitle(changed[i].first, changed[i].second);
+        is_read[i] = true;
+    });
+
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        if (!is_read[i])
+            continue;
+        changed[i].second.seen = true;
+        cache[changed[i].first] = std::move(changed[i].second);
+        cache_modified = true;
+    }
+    if (stop)
+        return {};
+
+    std::vector<TitleInfo> titles;
+    for (const std::string& path : paths) {
+        const auto cached = cache.find(path);
+        if (cached != cache.end() && cached->second.is_title)
+            titles.push_back(cached->second.info);
+    }
+    return titles;
+}
+
+void TitleScanner::ReadTitle(const std::string& path, CacheEntry& entry) {
+    std::unique_ptr<AppLoader> loader = GetLoader(path);
+    if (!loader)
+        return;
+
+    TitleInfo& info = entry.info;
+    info.path = path;
+    info.file_type = loader->GetFileType();
+    info.size = entry.size;
+    loader->ReadProgramId(info.program_id);
+    loader->ReadExtdataId(info.extdata_id);
+    loader->ReadIcon(info.smdh);
+    entry.is_title = true;
+
+    if (!IsApplication(info.program_id))
+        return;
+
+    // The icon and title of an installed update take precedence
+    entry.update_dir_time = FileUtil::GetModificationTime(GetUpdateContentDir(info.program_id));
+    const std::string update_path = Service::AM::GetTitleContentPath(
+        Service::FS::MediaType::SDMC, GetUpdateId(info.program_id));
+    if (!FileUtil::Exists(update_path))
+        return;
+
+    std::unique_ptr<AppLoader> update_loader = GetLoader(update_path);
+    if (!update_loader)
+        return;
+
+    std::vector<u8> update_smdh;
+    update_loader->ReadIcon(update_smdh);
+    info.smdh = std::move(update_smdh);
+    entry.update_path = update_path;
+    entry.update_size = FileUtil::GetSize(update_path);
+    entry.update_modification_time = FileUtil::GetModificationTime(update_path);
+}
+
+bool TitleScanner::IsUpToDate(const CacheEntry& entry, u64 size, u64 modification_time) {
+    if (entry.size != size || entry.modification_time != modification_time)
+        return false;
+    if (!entry.is_title || !IsApplication(entry.info.program_id))
+        return true;
+
+    // Installing or removing an update changes the directory of its contents
+    if (FileUtil::GetModificationTime(GetUpdateContentDir(entry.info.program_id)) !=
+        entry.update_dir_time)
+        return false;
+    if (entry.update_path.empty())
+        return true;
+    const u64 update_modification_time = FileUtil::GetModificationTime(entry.update_path);
+    return update_modification_time == entry.update_modification_time &&
+           FileUtil::GetSize(entry.update_path) == entry.update_size;
+}
+
+void TitleScanner::LoadCache() {
+    if (cache_path.empty() || !FileUtil::Exists(cache_path))
+        return;
+
+    FileUtil::IOFile file(cache_path, "rb");
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_WARNING(Loader, "Failed to read the title cache {}", cache_path);
+        return;
+    }
+
+    CacheHeader header;
+    if (data.size() < sizeof(header)) {
+        LOG_WARNING(Loader, "Title cache is too small");
+        return;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    u8* ptr = data.data() + sizeof(header);
+    const std::size_t size = data.size() - sizeof(header);
+    if (header.magic != CacheMagic || header.data_size != size ||
+        header.data_hash != Common::ComputeHash64(ptr, size)) {
+        LOG_WARNING(Loader, "Title cache is corrupted");
+        return;
+    }
+    // Other revisions can read titles differently
+    if (header.version != CacheVersion || header.revision != GetRevision()) {
+        LOG_INFO(Loader, "Title cache was made by another version");
+        return;
+    }
+
+    PointerWrap p(&ptr, ptr + size, PointerWrap::MODE_READ);
+    p.Do(cache);
+    if (p.error == PointerWrap::ERROR_FAILURE || ptr != data.data() + data.size()) {
+        LOG_WARNING(Loader, "Failed to load the title cache");
+        cache.clear();
+        return;
+    }
+    LOG_DEBUG(Loader, "Loaded {} titles from the title cache", cache.size());
+}
+
+bool TitleScanner::SaveCache() {
+    std::lock_guard lock{mutex};
+    if (cache_path.empty())
+        return false;
+
+    // The next scans tell again which files still exist
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.seen) {
+            it->second.seen = false;
+            ++it;
+        } else {
+            it = cache.erase(it);
+            cache_modified = true;
+        }
+    }
+    if (!cache_modified)
+        return true;
+
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    measure.Do(cache);
+
+    std::vector<u8> data(sizeof(CacheHeader) + reinterpret_cast<std::size_t>(ptr));
+    ptr = data.data() + sizeof(CacheHeader);
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    p.Do(cache);
+
+    CacheHeader header{};
+    header.magic = CacheMagic;
+    header.version = CacheVersion;
+    header.revision = GetRevision();
+    header.data_size = data.size() - sizeof(header);
+    header.data_hash = Common::ComputeHash64(data.data() + sizeof(header), header.data_size);
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    FileUtil::CreateFullPath(cache_path);
+    FileUtil::IOFile file(cache_path, "wb");
+    if (!file.IsOpen() || file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Loader, "Failed to write the title cache {}", cache_path);
+        return false;
+    }
+    cache_modified = false;
+    return true;
+}
+
+} // namespace Loader
@@ -0,0 +1,99 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_pool.h"
+#include "core/loader/loader.h"
+
+class PointerWrap;
+
+namespace Loader {
+
+/// Metadata of a title file, as shown by the game lists of the frontends
+struct TitleInfo {
+    std::string path;
+    FileType file_type = FileType::Unknown;
+    u64 size = 0;
+    u64 program_id = 0;
+    u64 extdata_id = 0;
+    /// SMDH of the title, or of its installed update when there is one
+    std::vector<u8> smdh;
+};
+
+/**
+ * Reads the metadata of title files for the game lists, opening the files on a thread pool.
+ *
+ * The metadata is kept in a cache on disk, keyed by the path, size and modification time of the
+ * files, so that only new and modified files are opened. Installed updates are taken into account
+ * through the modification time of the directory they are installed to, and of their contents.
+ * The cache is loaded by the first scan, so a scanner can be kept and constructed cheaply. Scans
+ * and saves can be called from any thread, they run one at a time.
+ */
+class TitleScanner {
+public:
+    /// @param cache_path Path of the cache file, or an empty string to not keep a cache
+    explicit TitleScanner(std::string cache_path);
+    ~TitleScanner();
+
+    /**
+     * Reads the metadata of files. Blocks until all the files have been read.
+     * @param paths Paths of the files to read
+     * @param stop Makes the scan return early when set, from another thread
+     * @return The metadata of the files that are titles, in the order of their paths
+     */
+    std::vector<TitleInfo> Scan(const std::vector<std::string>& paths,
+                                const std::atomic_bool& stop);
+
+    /**
+     * Writes the cache to disk, if any entry was added, changed or dropped. Only the files seen by
+     * the scans since the last save are kept, so that the cache doesn't grow with files that were
+     * removed.
+     * @return Whether the cache on disk is up to date
+     */
+    bool SaveCache();
+
+private:
+    struct CacheEntry {
+        u64 size = 0;
+        u64 modification_time = 0;
+        /// Modification time of the content directory of the update, 0 if it doesn't exist
+        u64 update_dir_time = 0;
+        /// Path, size and modification time of the update, empty if there is none
+        std::string update_path;
+        u64 update_size = 0;
+        u64 update_modification_time = 0;
+        /// Whether the file is a title, non-titles are cached to not open them again either
+        bool is_title = false;
+        TitleInfo info;
+        /// Whether a scan has seen the file since the cache was last saved, not saved
+        bool seen = false;
+
+        void DoState(PointerWrap& p);
+    };
+
+    /// Reads a file, filling the metadata and the update fields of its entry
+    static void ReadTitle(const std::string& path, CacheEntry& entry);
+
+    /// Whether the file and its update are unchanged since the entry was made
+    static bool IsUpToDate(const CacheEntry& entry, u64 size, u64 modification_time);
+
+    void LoadCache();
+
+    std::mutex mutex;
+    std::string cache_path;
+    std::map<std::string, CacheEntry> cache;
+    bool cache_loaded = false;
+    /// Whether the cache changed since it was loaded or saved
+    bool cache_modified = false;
+    Common::ThreadPool pool;
+};
+
+} // namespace Loader
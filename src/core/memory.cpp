@@ -4,11 +4,14 @@
 
 #include <array>
 #include <cstring>
+#include <utility>
 #include "audio_core/dsp_interface.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
+#include "common/write_tracked_memory.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/hle/kernel/memory.h"
@@ -57,10 +60,15 @@ private:
 class MemorySystem::Impl {
 public:
     // Visual Studio would try to allocate these on compile time if they are std::array, which would
-    // exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    // exceed the memory limit. Their writes are tracked to take snapshots quickly.
+    Common::WriteTrackedMemory fcram{Memory::FCRAM_N3DS_SIZE};
+    Common::WriteTrackedMemory vram{Memory::VRAM_SIZE};
+    Common::WriteTrackedMemory n3ds_extra_ram{Memory::N3DS_EXTRA_RAM_SIZE};
+
+    /// Returns the memory areas snapshots cover, in the order of their pages
+    std::array<Common::WriteTrackedMemory*, 3> GetSnapshotAreas() {
+        return {{&fcram, &vram, &n3ds_extra_ram}};
+    }
 
     PageTable* current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
@@ -129,13 +137,13 @@ void MemorySystem::UnmapRegion(PageTable& page_table, VAddr base, u32 size) {
 
 u8* MemorySystem::GetPointerForRasterizerCache(VAddr addr) {
     if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
-        return impl->fcram.get() + (addr - LINEAR_HEAP_VADDR);
+        return impl->fcram.Data() + (addr - LINEAR_HEAP_VADDR);
     }
     if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
-        return impl->fcram.get() + (addr - NEW_LINEAR_HEAP_VADDR);
+        return impl->fcram.Data() + (addr - NEW_LINEAR_HEAP_VADDR);
     }
     if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
-        return impl->vram.get() + (addr - VRAM_VADDR);
+        return impl->vram.Data() + (addr - VRAM_VADDR);
     }
     UNREACHABLE();
 }
@@ -315,16 +323,16 @@ u8* MemorySystem::GetPhysicalPointer(PAddr address) {
     u8* target_pointer = nullptr;
     switch (area->paddr_base) {
     case VRAM_PADDR:
-        target_pointer = impl->vram.get() + offset_into_region;
+        target_pointer = impl->vram.Data() + offset_into_region;
         break;
     case DSP_RAM_PADDR:
         target_pointer = impl->dsp->GetDspMemory().data() + offset_into_region;
         break;
     case FCRAM_PADDR:
-        target_pointer = impl->fcram.get() + offset_into_region;
+        target_pointer = impl->fcram.Data() + offset_into_region;
         break;
     case N3DS_EXTRA_RAM_PADDR:
-        target_pointer = impl->n3ds_extra_ram.get() + offset_into_region;
+        target_pointer = impl->n3ds_extra_ram.Data() + offset_into_region;
         break;
     default:
         UNREACHABLE();
@@ -745,17 +753,185 @@ void WriteMMIO<u64>(MMIORegionPointer mmio_handler, VAddr addr, const u64 data)
 }
 
 u32 MemorySystem::GetFCRAMOffset(u8* pointer) {
-    ASSERT(pointer >= impl->fcram.get() && pointer <= impl->fcram.get() + Memory::FCRAM_N3DS_SIZE);
-    return pointer - impl->fcram.get();
+    ASSERT(pointer >= impl->fcram.Data() &&
+           pointer <= impl->fcram.Data() + Memory::FCRAM_N3DS_SIZE);
+    return pointer - impl->fcram.Data();
 }
 
 u8* MemorySystem::GetFCRAMPointer(u32 offset) {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram.Data() + offset;
 }
 
 void MemorySystem::SetDSP(AudioCore::DspInterface& dsp) {
     impl->dsp = &dsp;
 }
 
+std::optional<PAddr> MemorySystem::GetPhysicalAddress(const u8* pointer) const {
+    struct MemoryArea {
+        PAddr paddr_base;
+        const u8* base;
+        u32 size;
+    };
+
+    const MemoryArea memory_areas[] = {
+        {VRAM_PADDR, impl->vram.Data(), VRAM_SIZE},
+        {DSP_RAM_PADDR, impl->dsp != nullptr ? impl->dsp->GetDspMemory().data() : nullptr,
+         DSP_RAM_SIZE},
+        {FCRAM_PADDR, impl->fcram.Data(), FCRAM_N3DS_SIZE},
+        {N3DS_EXTRA_RAM_PADDR, impl->n3ds_extra_ram.Data(), N3DS_EXTRA_RAM_SIZE},
+    };
+
+    for (const auto& area : memory_areas) {
+        // The end is inclusive, as for GetPhysicalPointer
+        if (area.base != nullptr && pointer >= area.base && pointer <= area.base + area.size) {
+            return area.paddr_base + static_cast<u32>(pointer - area.base);
+        }
+    }
+    return std::nullopt;
+}
+
+static const std::array<u8, PAGE_SIZE> zero_page{};
+
+static void DoMemoryArea(PointerWrap& p, u8* data, std::size_t size) {
+    const std::size_t num_pages = size / PAGE_SIZE;
+
+    // One bit per page, set for the pages that hold anything but zeroes
+    std::vector<u8> present((num_pages + 7) / 8);
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (std::size_t page = 0; page < num_pages; ++page) {
+            if (std::memcmp(data + page * PAGE_SIZE, zero_page.data(), PAGE_SIZE) != 0) {
+                present[page / 8] |= 1 << (page % 8);
+            }
+        }
+    }
+    p.DoArray(present.data(), static_cast<int>(present.size()));
+
+    for (std::size_t page = 0; page < num_pages; ++page) {
+        u8* page_data = data + page * PAGE_SIZE;
+        if (present[page / 8] & (1 << (page % 8))) {
+            p.DoArray(page_data, PAGE_SIZE);
+        } else if (p.GetMode() == PointerWrap::MODE_READ) {
+            std::memset(page_data, 0, PAGE_SIZE);
+        }
+    }
+}
+
+void MemorySystem::DoState(PointerWrap& p) {
+    auto s = p.Section("Memory", 1);
+    if (!s) {
+        return;
+    }
+    DoMemoryArea(p, impl->fcram.Data(), FCRAM_N3DS_SIZE);
+    DoMemoryArea(p, impl->vram.Data(), VRAM_SIZE);
+    DoMemoryArea(p, impl->n3ds_extra_ram.Data(), N3DS_EXTRA_RAM_SIZE);
+}
+
+/// Returns whether any host page overlapping the emulated page at the offset was written
+static bool IsPageWritten(const std::vector<bool>& written_pages, std::size_t offset) {
+    const std::size_t host_page_size = Common::WriteTrackedMemory::GetPageSize();
+    const std::size_t last = (offset + PAGE_SIZE - 1) / host_page_size;
+    for (std::size_t host_page = offset / host_page_size; host_page <= last; ++host_page) {
+        if (written_pages[host_page]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MemorySystem::RestartWriteTracking() {
+    const auto areas = impl->GetSnapshotAreas();
+    for (Common::WriteTrackedMemory* area : areas) {
+        if (area->IsTracking()) {
+            area->TakeWrittenPages();
+        } else if (!area->StartTracking()) {
+            for (Common::WriteTrackedMemory* other : areas) {
+                other->StopTracking();
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+MemorySnapshot MemorySystem::TakeSnapshot(const MemorySnapshot* previous) {
+    const auto areas = impl->GetSnapshotAreas();
+
+    // When the previous snapshot is what the memory was tracked from, only the written pages can
+    // differ from it. Otherwise every page is compared.
+    const bool tracked = previous != nullptr && tracked_pages != nullptr &&
+                         previous->pages == tracked_pages;
+
+    auto pages = std::make_shared<MemorySnapshot::PageList>();
+    pages->reserve((FCRAM_N3DS_SIZE + VRAM_SIZE + N3DS_EXTRA_RAM_SIZE) / PAGE_SIZE);
+    MemorySnapshot snapshot;
+    for (Common::WriteTrackedMemory* area : areas) {
+        std::vector<bool> written_pages;
+        if (tracked) {
+            written_pages = area->TakeWrittenPages();
+        }
+
+        for (std::size_t offset = 0; offset < area->Size(); offset += PAGE_SIZE) {
+            const u8* page_data = area->Data() + offset;
+            std::shared_ptr<const MemorySnapshot::Page> page;
+            if (previous != nullptr) {
+                page = (*previous->pages)[pages->size()];
+            }
+            if (tracked && !IsPageWritten(written_pages, offset)) {
+                pages->push_back(std::move(page));
+                continue;
+            }
+
+            const u8* reference = page != nullptr ? page->data() : zero_page.data();
+            if (std::memcmp(page_data, reference, PAGE_SIZE) != 0) {
+                if (page != nullptr && std::memcmp(page_data, zero_page.data(), PAGE_SIZE) == 0) {
+                    page = nullptr;
+                } else {
+                    auto copy = std::make_shared<MemorySnapshot::Page>();
+                    std::memcpy(copy->data(), page_data, PAGE_SIZE);
+                    page = std::move(copy);
+                    ++snapshot.copied_pages;
+                }
+            }
+            pages->push_back(std::move(page));
+        }
+    }
+
+    snapshot.pages = std::move(pages);
+    tracked_pages = RestartWriteTracking() ? snapshot.pages : nullptr;
+    return snapshot;
+}
+
+void MemorySystem::RestoreSnapshot(const MemorySnapshot& snapshot) {
+    const auto areas = impl->GetSnapshotAreas();
+
+    // While tracked, the memory holds the tracked pages except for the written ones, so only those
+    // and the pages the snapshot doesn't share with them need restoring
+    const bool tracked = tracked_pages != nullptr;
+
+    std::size_t index = 0;
+    for (Common::WriteTrackedMemory* area : areas) {
+        std::vector<bool> written_pages;
+        if (tracked) {
+            written_pages = area->TakeWrittenPages();
+        }
+
+        for (std::size_t offset = 0; offset < area->Size(); offset += PAGE_SIZE, ++index) {
+            u8* page_data = area->Data() + offset;
+            const auto& page = (*snapshot.pages)[index];
+            const u8* source = page != nullptr ? page->data() : zero_page.data();
+            if (tracked) {
+                if (IsPageWritten(written_pages, offset) || (*tracked_pages)[index] != page) {
+                    std::memcpy(page_data, source, PAGE_SIZE);
+                }
+            } else if (std::memcmp(page_data, source, PAGE_SIZE) != 0) {
+                // Comparing first leaves the host pages that didn't change untouched
+                std::memcpy(page_data, source, PAGE_SIZE);
+            }
+        }
+    }
+
+    tracked_pages = RestartWriteTracking() ? snapshot.pages : nullptr;
+}
+
 } // namespace Memory
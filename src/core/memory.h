@@ -7,12 +7,14 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
 #include "core/mmio.h"
 
 class ARM_Interface;
+class PointerWrap;
 
 // On Android, PAGE_SIZE and PAGE_MASK are predefined macros, conflicting with identifiers here.
 #ifdef ANDROID
@@ -225,6 +227,28 @@ enum class FlushMode {
  */
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
+/**
+ * Copy of FCRAM, VRAM and the New 3DS memory, taken by MemorySystem::TakeSnapshot. The pages that
+ * didn't change between two snapshots are shared by them.
+ */
+class MemorySnapshot {
+public:
+    /// Returns the number of pages that were copied when taking the snapshot.
+    std::size_t GetCopiedPageCount() const {
+        return copied_pages;
+    }
+
+private:
+    using Page = std::array<u8, PAGE_SIZE>;
+    using PageList = std::vector<std::shared_ptr<const Page>>;
+
+    /// Pages of every memory area in order, null for pages of zeroes
+    std::shared_ptr<const PageList> pages;
+    std::size_t copied_pages = 0;
+
+    friend class MemorySystem;
+};
+
 class MemorySystem {
 public:
     MemorySystem();
@@ -292,6 +316,9 @@ public:
     /// Gets pointer in FCRAM with given offset
     u8* GetFCRAMPointer(u32 offset);
 
+    /// Gets the physical address of a pointer into emulated memory, if it points to any.
+    std::optional<PAddr> GetPhysicalAddress(const u8* pointer) const;
+
     /**
      * Mark each page touching the region as cached.
      */
@@ -305,6 +332,24 @@ public:
 
     void SetDSP(AudioCore::DspInterface& dsp);
 
+    /// Saves or restores FCRAM, VRAM and the New 3DS memory. Pages of zeroes aren't stored.
+    void DoState(PointerWrap& p);
+
+    /**
+     * Takes a snapshot of FCRAM, VRAM and the New 3DS memory. Only the pages that differ from the
+     * previous snapshot are copied, the others are shared with it. The writes to the memory are
+     * tracked from the first snapshot on, so when the previous snapshot is the last one taken or
+     * restored, only the pages written since are compared.
+     * @param previous The snapshot to share pages with, or nullptr to copy every page
+     */
+    MemorySnapshot TakeSnapshot(const MemorySnapshot* previous);
+
+    /**
+     * Restores the memory of a snapshot. Only the pages that differ from it are written, which are
+     * found from the tracked writes when possible.
+     */
+    void RestoreSnapshot(const MemorySnapshot& snapshot);
+
 private:
     template <typename T>
     T Read(const VAddr vaddr);
@@ -322,9 +367,21 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
+    /**
+     * Starts tracking the writes to the memory snapshots cover from now on.
+     * @return false if the writes can't be tracked on this host
+     */
+    bool RestartWriteTracking();
+
     class Impl;
 
     std::unique_ptr<Impl> impl;
+
+    /**
+     * Pages of the last snapshot taken or restored, the memory only differs from them in the pages
+     * written since. Null while the writes aren't tracked.
+     */
+    std::shared_ptr<const MemorySnapshot::PageList> tracked_pages;
 };
 
 /// Determines if the given VAddr is valid for the specified process.
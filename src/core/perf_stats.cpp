@@ -40,6 +40,26 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddShaderCompilation(microseconds latency) {
+    std::lock_guard lock{object_mutex};
+
+    accumulated_shader_latency += latency;
+    compiled_shaders += 1;
+}
+
+void PerfStats::SetShaderQueueDepth(u32 depth) {
+    std::lock_guard lock{object_mutex};
+
+    shader_queue_depth = depth;
+}
+
+void PerfStats::AddTextureHashHit(std::size_t avoided_upload_size) {
+    std::lock_guard lock{object_mutex};
+
+    texture_hash_hits += 1;
+    texture_upload_bytes_avoided += avoided_upload_size;
+}
+
 PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::lock_guard lock(object_mutex);
 
@@ -55,6 +75,13 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    results.shader_queue_depth = shader_queue_depth;
+    if (compiled_shaders != 0) {
+        results.shader_compile_latency =
+            duration_cast<DoubleSecs>(accumulated_shader_latency).count() / compiled_shaders;
+    }
+    results.texture_hash_hits = texture_hash_hits;
+    results.texture_upload_bytes_avoided = texture_upload_bytes_avoided;
 
     // Reset counters
     reset_point = now;
@@ -62,6 +89,10 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    accumulated_shader_latency = microseconds::zero();
+    compiled_shaders = 0;
+    texture_hash_hits = 0;
+    texture_upload_bytes_avoided = 0;
 
     return results;
 }
@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <mutex>
 #include "common/common_types.h"
 #include "common/thread.h"
@@ -29,12 +30,31 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Number of shaders waiting to be compiled in the background
+        u32 shader_queue_depth;
+        /// Average time from queueing a background shader compilation to its end, in seconds
+        double shader_compile_latency;
+        /// Number of textures whose contents were found in the cache by hash, instead of decoded
+        u32 texture_hash_hits;
+        /// Bytes of decoded texture data that did not need to be uploaded thanks to these hits
+        u64 texture_upload_bytes_avoided;
+        /// Largest number of timing events from other threads waiting to be queued at once
+        u32 threadsafe_event_queue_depth;
+        /// Average time from scheduling a timing event from another thread to its queueing, in
+        /// seconds
+        double threadsafe_event_latency;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
+    /// Records a shader compiled in the background, along with how long it took since queueing
+    void AddShaderCompilation(std::chrono::microseconds latency);
+    void SetShaderQueueDepth(u32 depth);
+    /// Records a texture load avoided by finding its contents by hash
+    void AddTextureHashHit(std::size_t avoided_upload_size);
+
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
     /**
@@ -57,6 +77,16 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Cumulative latency of the background shader compilations since last reset
+    std::chrono::microseconds accumulated_shader_latency{0};
+    /// Cumulative number of background shader compilations since last reset
+    u32 compiled_shaders = 0;
+    /// Current number of shaders waiting to be compiled in the background
+    u32 shader_queue_depth = 0;
+    /// Cumulative number of texture loads avoided by content hash since last reset
+    u32 texture_hash_hits = 0;
+    /// Cumulative size of the texture uploads avoided by content hash since last reset
+    u64 texture_upload_bytes_avoided = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
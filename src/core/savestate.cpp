@@ -0,0 +1,254 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include "audio_core/dsp_interface.h"
+#include "common/assert.h"
+#include "common/chunk_file.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/swap.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/state_wrap.h"
+#include "core/hle/service/fs/archive.h"
+#include "core/hle/service/sm/sm.h"
+#include "core/hw/hw.h"
+#include "core/memory.h"
+#include "core/savestate.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace Core {
+
+/// Version of the state data, to be increased whenever the layout of a section changes
+constexpr u32 StateVersion = 2;
+
+constexpr std::array<u8, 4> StateMagic{{'C', 'S', 'T', 0x1B}};
+
+#pragma pack(push, 1)
+struct StateHeader {
+    std::array<u8, 4> magic;       ///< Identifies the file type (always "CST"0x1B)
+    u32_le version;                ///< Version of the state data
+    u64_le program_id;             ///< ID of the title the state was saved from
+    std::array<char, 40> revision; ///< Git hash of the revision the state was saved with
+    u64_le data_size;              ///< Size of the state data following the header
+    u64_le data_hash;              ///< Hash of the state data
+};
+static_assert(sizeof(StateHeader) == 72, "StateHeader should be 72 bytes");
+#pragma pack(pop)
+
+using ObjectList = std::vector<std::shared_ptr<Kernel::Object>>;
+
+static u64 GetProgramId(System& system) {
+    const auto process = system.Kernel().GetCurrentProcess();
+    return process != nullptr ? process->codeset->program_id : 0;
+}
+
+static std::array<char, 40> GetRevision() {
+    std::array<char, 40> revision{};
+    std::strncpy(revision.data(), Common::g_scm_rev, revision.size());
+    return revision;
+}
+
+/**
+ * Saves, measures or loads the state data.
+ * @param previous_objects When loading, the kernel objects that are alive before the load
+ * @param with_memory Whether the state includes FCRAM, VRAM and the New 3DS memory
+ * @return The kernel objects of the state
+ */
+static ObjectList DoState(System& system, PointerWrap& p, const ObjectList& previous_objects,
+                          bool with_memory) {
+    Kernel::StateWrap state(p, system.Kernel());
+    state.SetPreviousObjects(previous_objects);
+
+    system.CoreTiming().DoState(p);
+    if (with_memory) {
+        system.Memory().DoState(p);
+    }
+    HW::DoState(p);
+    Pica::g_state.DoState(p);
+    system.DSP().DoState(p);
+    system.Kernel().DoState(state);
+    system.ServiceManager().DoState(state);
+    system.ArchiveManager().DoState(p);
+
+    state.Finish();
+    p.DoMarker("State");
+    return state.GetObjects();
+}
+
+/**
+ * Appends the state data to a buffer.
+ * @param objects If not null, receives the kernel objects of the state
+ */
+static bool SaveStateData(System& system, std::vector<u8>& buffer, bool with_memory,
+                          ObjectList* objects) {
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    DoState(system, measure, {}, with_memory);
+    if (measure.error == PointerWrap::ERROR_FAILURE) {
+        return false;
+    }
+
+    const std::size_t offset = buffer.size();
+    const std::size_t size = reinterpret_cast<std::size_t>(ptr);
+    buffer.resize(offset + size);
+
+    ptr = buffer.data() + offset;
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    ObjectList saved = DoState(system, p, {}, with_memory);
+    ASSERT_MSG(p.error != PointerWrap::ERROR_FAILURE && ptr == buffer.data() + buffer.size(),
+               "State changed between measuring and saving it");
+
+    if (objects != nullptr) {
+        *objects = std::move(saved);
+    }
+    return true;
+}
+
+static bool LoadStateData(System& system, const u8* data, std::size_t size, bool with_memory,
+                          const ObjectList& previous_objects) {
+    u8* ptr = const_cast<u8*>(data);
+    PointerWrap p(&ptr, ptr + size, PointerWrap::MODE_READ);
+    DoState(system, p, previous_objects, with_memory);
+    return p.error != PointerWrap::ERROR_FAILURE && ptr == data + size;
+}
+
+static bool SaveState(System& system, std::vector<u8>& state, bool with_memory) {
+    if (VideoCore::g_renderer != nullptr) {
+        VideoCore::g_renderer->Rasterizer()->FlushAll();
+    }
+
+    state.resize(sizeof(StateHeader));
+    if (!SaveStateData(system, state, with_memory, nullptr)) {
+        state.clear();
+        return false;
+    }
+
+    const u8* data = state.data() + sizeof(StateHeader);
+    const std::size_t size = state.size() - sizeof(StateHeader);
+
+    StateHeader header{};
+    header.magic = StateMagic;
+    header.version = StateVersion;
+    header.program_id = GetProgramId(system);
+    header.revision = GetRevision();
+    header.data_size = size;
+    header.data_hash = Common::ComputeHash64(data, size);
+    std::memcpy(state.data(), &header, sizeof(header));
+    return true;
+}
+
+static bool LoadState(System& system, const std::vector<u8>& state, bool with_memory) {
+    StateHeader header;
+    if (state.size() < sizeof(header)) {
+        LOG_ERROR(Core, "State is too small");
+        return false;
+    }
+    std::memcpy(&header, state.data(), sizeof(header));
+
+    const u8* data = state.data() + sizeof(header);
+    const std::size_t size = state.size() - sizeof(header);
+    if (header.magic != StateMagic || header.data_size != size) {
+        LOG_ERROR(Core, "State has an invalid header");
+        return false;
+    }
+    if (header.version != StateVersion || header.revision != GetRevision()) {
+        LOG_ERROR(Core, "State was saved by another version");
+        return false;
+    }
+    if (header.program_id != GetProgramId(system)) {
+        LOG_ERROR(Core, "State was saved from another title ({:016X})", header.program_id);
+        return false;
+    }
+    if (header.data_hash != Common::ComputeHash64(data, size)) {
+        LOG_ERROR(Core, "State is corrupted");
+        return false;
+    }
+
+    // Cached surfaces are written back and dropped, as the memory beneath them is replaced
+    if (VideoCore::g_renderer != nullptr) {
+        auto& rasterizer = *VideoCore::g_renderer->Rasterizer();
+        rasterizer.FlushAndInvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+        rasterizer.FlushAndInvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+    }
+
+    // The current state is saved first, to go back to it if the state fails to load. This also
+    // collects the kernel objects that are alive, which are restored in place.
+    std::vector<u8> backup;
+    ObjectList objects;
+    if (!SaveStateData(system, backup, with_memory, &objects)) {
+        LOG_ERROR(Core, "Can't load a state while the current state can't be saved");
+        return false;
+    }
+
+    const bool loaded = LoadStateData(system, data, size, with_memory, objects);
+    if (!loaded) {
+        LOG_ERROR(Core, "Failed to load the state, restoring the previous state");
+        const bool restored =
+            LoadStateData(system, backup.data(), backup.size(), with_memory, objects);
+        ASSERT_MSG(restored, "Failed to restore the previous state");
+    }
+
+    rasterizer.NotifyPicaStateReplaced();
+    system.CPU().ClearInstructionCache();
+    return loaded;
+}
+
+bool SaveState(System& system, std::vector<u8>& state) {
+    return SaveState(system, state, true);
+}
+
+bool LoadState(System& system, const std::vector<u8>& state) {
+    return LoadState(system, state, true);
+}
+
+bool SaveStateWithoutMemory(System& system, std::vector<u8>& state) {
+    return SaveState(system, state, false);
+}
+
+bool LoadStateWithoutMemory(System& system, const std::vector<u8>& state) {
+    return LoadState(system, state, false);
+}
+
+bool SaveStateToFile(System& system, const std::string& path) {
+    std::vector<u8> state;
+    if (!SaveState(system, state)) {
+        return false;
+    }
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen() || file.WriteBytes(state.data(), state.size()) != state.size()) {
+        LOG_ERROR(Core, "Failed to write the state to {}", path);
+        return false;
+    }
+    return true;
+}
+
+bool LoadStateFromFile(System& system, const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to open the state {}", path);
+        return false;
+    }
+
+    std::vector<u8> state(file.GetSize());
+    if (file.ReadBytes(state.data(), state.size()) != state.size()) {
+        LOG_ERROR(Core, "Failed to read the state {}", path);
+        return false;
+    }
+    return LoadState(system, state);
+}
+
+} // namespace Core
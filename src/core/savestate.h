@@ -0,0 +1,50 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+class System;
+
+/**
+ * Saves the emulated state of the system: memory, the kernel objects, the scheduled events, the
+ * CPU context, the GPU and DSP state and the state of the services that support it. Must be called
+ * from the emulation thread between two runs of the CPU.
+ *
+ * A state can only be loaded after booting the title it was saved from, and only by the revision
+ * that saved it. Saving fails when the system is in a state that can't be restored, e.g. while an
+ * HLE service is pausing a thread.
+ *
+ * @param system The system to save
+ * @param state Receives the state, with a header that identifies the title
+ * @return Whether the state could be saved
+ */
+bool SaveState(System& system, std::vector<u8>& state);
+
+/**
+ * Loads a state made by SaveState. The current state is kept when the state can't be loaded.
+ * @return Whether the state has been loaded
+ */
+bool LoadState(System& system, const std::vector<u8>& state);
+
+/**
+ * Variants of SaveState and LoadState that leave FCRAM, VRAM and the New 3DS memory out of the
+ * state, for callers that keep the memory separately, see Memory::MemorySystem::TakeSnapshot. The
+ * memory must be restored after the rest of the state has been loaded successfully.
+ */
+bool SaveStateWithoutMemory(System& system, std::vector<u8>& state);
+bool LoadStateWithoutMemory(System& system, const std::vector<u8>& state);
+
+/// Saves the state of the system to a file, see SaveState.
+bool SaveStateToFile(System& system, const std::string& path);
+
+/// Loads the state of the system from a file, see LoadState.
+bool LoadStateFromFile(System& system, const std::string& path);
+
+} // namespace Core
@@ -73,9 +73,16 @@ void LogSettings() {
     LogSetting("Renderer_UseGLES", Settings::values.use_gles);
     LogSetting("Renderer_UseHwRenderer", Settings::values.use_hw_renderer);
     LogSetting("Renderer_UseHwShader", Settings::values.use_hw_shader);
+    LogSetting("Renderer_UseDiskShaderCache", Settings::values.use_disk_shader_cache);
+    LogSetting("Renderer_AsyncShaderCompilation", Settings::values.async_shader_compilation);
+    LogSetting("Renderer_AsyncShaderSkipDraws", Settings::values.async_shader_skip_draws);
+    LogSetting("Renderer_TextureContentHashing", Settings::values.texture_content_hashing);
+    LogSetting("Renderer_AsyncSurfaceDownloads", Settings::values.async_surface_downloads);
     LogSetting("Renderer_ShadersAccurateGs", Settings::values.shaders_accurate_gs);
     LogSetting("Renderer_ShadersAccurateMul", Settings::values.shaders_accurate_mul);
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
+    LogSetting("Renderer_SwRendererThreads", Settings::values.sw_renderer_threads);
+    LogSetting("Renderer_SwShaderThreads", Settings::values.sw_shader_threads);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_VsyncEnabled", Settings::values.vsync_enabled);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
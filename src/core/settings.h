@@ -139,9 +139,16 @@ struct Values {
     bool use_gles;
     bool use_hw_renderer;
     bool use_hw_shader;
+    bool use_disk_shader_cache;
+    bool async_shader_compilation;
+    bool async_shader_skip_draws;
+    bool texture_content_hashing;
+    bool async_surface_downloads;
     bool shaders_accurate_gs;
     bool shaders_accurate_mul;
     bool use_shader_jit;
+    u16 sw_renderer_threads;
+    u16 sw_shader_threads;
     u16 resolution_factor;
     bool vsync_enabled;
     bool use_frame_limit;
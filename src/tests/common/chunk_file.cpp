@@ -0,0 +1,76 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/chunk_file.h"
+
+struct TestState {
+    u32 value = 0;
+    std::string name;
+    std::vector<u16> data;
+
+    void DoState(PointerWrap& p) {
+        p.Do(value);
+        p.Do(name);
+        p.Do(data);
+    }
+};
+
+static std::vector<u8> Save(TestState& state) {
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    state.DoState(measure);
+
+    std::vector<u8> buffer(reinterpret_cast<std::size_t>(ptr));
+    ptr = buffer.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    state.DoState(p);
+    REQUIRE(ptr == buffer.data() + buffer.size());
+    return buffer;
+}
+
+static bool Load(std::vector<u8>& buffer, TestState& state) {
+    u8* ptr = buffer.data();
+    PointerWrap p(&ptr, buffer.data() + buffer.size(), PointerWrap::MODE_READ);
+    state.DoState(p);
+    return p.error != PointerWrap::ERROR_FAILURE && ptr == buffer.data() + buffer.size();
+}
+
+TEST_CASE("PointerWrap: Reads are bounded by the buffer", "[common]") {
+    TestState saved{0x12345678, "state", {1, 2, 3}};
+    std::vector<u8> buffer = Save(saved);
+
+    SECTION("reads a complete buffer") {
+        TestState loaded;
+        REQUIRE(Load(buffer, loaded));
+        REQUIRE(loaded.value == saved.value);
+        REQUIRE(loaded.name == saved.name);
+        REQUIRE(loaded.data == saved.data);
+    }
+
+    SECTION("fails on a truncated buffer") {
+        buffer.resize(buffer.size() - 1);
+        TestState loaded;
+        REQUIRE(!Load(buffer, loaded));
+    }
+
+    SECTION("fails on a string longer than the buffer") {
+        const int length = 0x7FFFFFFF;
+        std::memcpy(buffer.data() + sizeof(u32), &length, sizeof(length));
+        TestState loaded;
+        REQUIRE(!Load(buffer, loaded));
+    }
+
+    SECTION("fails on a vector longer than the buffer, without allocating it") {
+        const u32 count = 0xFFFFFFFF;
+        std::memcpy(buffer.data() + buffer.size() - 3 * sizeof(u16) - sizeof(u32), &count,
+                    sizeof(count));
+        TestState loaded;
+        REQUIRE(!Load(buffer, loaded));
+        REQUIRE(loaded.data.empty());
+    }
+}
@@ -0,0 +1,94 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/lz4.h"
+#include "tests/random_data.h"
+
+namespace Common::LZ4 {
+
+static std::vector<u8> CompressData(const std::vector<u8>& data) {
+    std::vector<u8> compressed(CompressBound(data.size()));
+    compressed.resize(Compress(data.data(), data.size(), compressed.data(), compressed.size()));
+    REQUIRE(!compressed.empty());
+    return compressed;
+}
+
+static void CheckRoundTrip(const std::vector<u8>& data) {
+    const std::vector<u8> compressed = CompressData(data);
+    std::vector<u8> decompressed(data.size());
+    REQUIRE(Decompress(compressed.data(), compressed.size(), decompressed.data(),
+                       decompressed.size()));
+    REQUIRE(decompressed == data);
+}
+
+TEST_CASE("LZ4::Compress round trips", "[common]") {
+    std::mt19937 random(0x4C5A34);
+
+    SECTION("empty and small data") {
+        for (std::size_t size = 0; size < 40; ++size) {
+            CheckRoundTrip(std::vector<u8>(size, 0x5A));
+        }
+    }
+
+    SECTION("data that doesn't compress") {
+        const std::vector<u8> data = Tests::RandomData(0x10000, 0x4C5A34);
+        CheckRoundTrip(data);
+        REQUIRE(CompressData(data).size() <= CompressBound(data.size()));
+    }
+
+    SECTION("data that compresses") {
+        std::vector<u8> data(0x10000);
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            // Runs of a byte, repeated patterns and some noise, with long and short matches
+            data[i] = (i / 0x1000) % 2 ? static_cast<u8>(i % 7) : static_cast<u8>(i >> 9);
+            if (random() % 64 == 0) {
+                data[i] = static_cast<u8>(random());
+            }
+        }
+        CheckRoundTrip(data);
+        REQUIRE(CompressData(data).size() < data.size() / 4);
+    }
+
+    SECTION("zeros") {
+        const std::vector<u8> data(0x10000);
+        CheckRoundTrip(data);
+        REQUIRE(CompressData(data).size() < 0x200);
+    }
+}
+
+TEST_CASE("LZ4::Compress fails when the destination is too small", "[common]") {
+    const std::vector<u8> data = Tests::RandomData(0x1000, 1);
+    std::vector<u8> compressed(data.size() / 2);
+    REQUIRE(Compress(data.data(), data.size(), compressed.data(), compressed.size()) == 0);
+}
+
+TEST_CASE("LZ4::Decompress rejects invalid blocks", "[common]") {
+    std::vector<u8> data(0x1000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i % 13);
+    }
+    std::vector<u8> compressed = CompressData(data);
+    std::vector<u8> decompressed(data.size());
+
+    // Wrong sizes
+    REQUIRE(!Decompress(compressed.data(), compressed.size(), decompressed.data(),
+                        decompressed.size() - 1));
+    decompressed.resize(data.size() + 1);
+    REQUIRE(!Decompress(compressed.data(), compressed.size(), decompressed.data(),
+                        decompressed.size()));
+    decompressed.resize(data.size());
+
+    // Truncated block
+    REQUIRE(!Decompress(compressed.data(), compressed.size() / 2, decompressed.data(),
+                        decompressed.size()));
+
+    // Match before the start of the data
+    const std::vector<u8> bad_offset{0x10, 0xAA, 0x10, 0x00, 0x00};
+    REQUIRE(!Decompress(bad_offset.data(), bad_offset.size(), decompressed.data(), 6));
+}
+
+} // namespace Common::LZ4
@@ -0,0 +1,49 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/write_tracked_memory.h"
+
+TEST_CASE("WriteTrackedMemory: Records the written pages", "[common]") {
+    const std::size_t page_size = Common::WriteTrackedMemory::GetPageSize();
+    Common::WriteTrackedMemory memory(8 * page_size);
+    REQUIRE(memory.Data()[0] == 0);
+    REQUIRE(memory.Data()[memory.Size() - 1] == 0);
+
+    if (!memory.StartTracking()) {
+        WARN("Writes can't be tracked on this host");
+        return;
+    }
+
+    memory.Data()[page_size + 1] = 1;
+    std::memset(memory.Data() + 3 * page_size - 1, 2, 2);
+    memory.Data()[5 * page_size] = 3;
+    memory.Data()[5 * page_size + 2] = 4;
+
+    const std::vector<bool> expected{false, true, true, true, false, true, false, false};
+    REQUIRE(memory.TakeWrittenPages() == expected);
+    REQUIRE(memory.Data()[page_size + 1] == 1);
+    REQUIRE(memory.Data()[3 * page_size] == 2);
+    REQUIRE(memory.Data()[5 * page_size + 2] == 4);
+
+    SECTION("forgets the pages once taken") {
+        REQUIRE(memory.TakeWrittenPages() == std::vector<bool>(8));
+    }
+
+    SECTION("tracks the pages again once taken") {
+        memory.Data()[page_size] = 5;
+        memory.Data()[7 * page_size + 3] = 6;
+        const std::vector<bool> written{false, true, false, false, false, false, false, true};
+        REQUIRE(memory.TakeWrittenPages() == written);
+    }
+
+    SECTION("makes the memory writable when stopped") {
+        memory.StopTracking();
+        REQUIRE(!memory.IsTracking());
+        memory.Data()[0] = 7;
+        REQUIRE(memory.Data()[0] == 7);
+    }
+}
@@ -0,0 +1,114 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <catch2/catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace ArmTests {
+
+TEST_CASE("BlockCache: Lookup and invalidation", "[arm_dyncom]") {
+    // Too large for the stack
+    auto cache = std::make_unique<BlockCache>();
+    REQUIRE(cache->Find(0x00100000) == BlockCache::NO_BLOCK);
+
+    cache->Insert(0x00100000, 0x10);
+    cache->Insert(0x00100002, 0x20);
+    cache->Insert(0x00101FFE, 0x30);
+    REQUIRE(cache->Find(0x00100000) == 0x10);
+    REQUIRE(cache->Find(0x00100002) == 0x20);
+    REQUIRE(cache->Find(0x00100004) == BlockCache::NO_BLOCK);
+    REQUIRE(cache->Find(0x00101FFE) == 0x30);
+
+    u32 link = BlockCache::NO_BLOCK;
+    cache->Link(0x00100002, &link);
+    REQUIRE(link == 0x20);
+
+    SECTION("invalidates the pages overlapping a range") {
+        cache->InvalidateRange(0x00101000, 1);
+        REQUIRE(cache->Find(0x00100002) == 0x20);
+        REQUIRE(cache->Find(0x00101FFE) == BlockCache::NO_BLOCK);
+        REQUIRE(link == 0x20);
+
+        cache->InvalidateRange(0x000FFFFC, 8);
+        REQUIRE(cache->Find(0x00100000) == BlockCache::NO_BLOCK);
+        REQUIRE(cache->Find(0x00100002) == BlockCache::NO_BLOCK);
+        REQUIRE(link == BlockCache::NO_BLOCK);
+    }
+
+    SECTION("clamps ranges to the address space") {
+        cache->Insert(0xFFFFF000, 0x40);
+        cache->InvalidateRange(0xFFFFF800, 0x10000);
+        REQUIRE(cache->Find(0xFFFFF000) == BlockCache::NO_BLOCK);
+        REQUIRE(cache->Find(0x00100000) == 0x10);
+    }
+
+    SECTION("clears every page") {
+        cache->Clear();
+        REQUIRE(cache->Find(0x00100000) == BlockCache::NO_BLOCK);
+        REQUIRE(cache->Find(0x00101FFE) == BlockCache::NO_BLOCK);
+
+        cache->Insert(0x00100000, 0x50);
+        REQUIRE(cache->Find(0x00100000) == 0x50);
+        REQUIRE(cache->Find(0x00100002) == BlockCache::NO_BLOCK);
+    }
+}
+
+TEST_CASE("ARM_DynCom: Chained branches see modified code", "[arm_dyncom]") {
+    TestEnvironment test_env(false);
+    test_env.SetMemory32(0, 0xE2800001); // add r0, r0, #1
+    test_env.SetMemory32(4, 0xEAFFFFFD); // b #0
+
+    ARM_DynCom dyncom(nullptr, test_env.GetMemory(), USER32MODE);
+    dyncom.SetPC(0);
+    dyncom.SetReg(0, 0);
+
+    // The branch is chained to the add the second time it's taken
+    for (int i = 0; i < 2; ++i) {
+        dyncom.Step();
+        REQUIRE(dyncom.GetPC() == 4);
+        dyncom.Step();
+        REQUIRE(dyncom.GetPC() == 0);
+    }
+    REQUIRE(dyncom.GetReg(0) == 2);
+
+    test_env.SetMemory32(0, 0xE2800002); // add r0, r0, #2
+    dyncom.InvalidateCacheRange(0, 4);
+
+    for (int i = 0; i < 2; ++i) {
+        dyncom.Step();
+        dyncom.Step();
+    }
+    REQUIRE(dyncom.GetPC() == 0);
+    REQUIRE(dyncom.GetReg(0) == 6);
+}
+
+TEST_CASE("ARM_DynCom: Chained branches see modified code in a run", "[arm_dyncom]") {
+    TestEnvironment test_env(false);
+    test_env.SetMemory32(0x0000, 0xE2800001); // add r0, r0, #1
+    test_env.SetMemory32(0x0004, 0xEA0003FD); // b #0x1000
+    test_env.SetMemory32(0x1000, 0xEAFFFBFE); // b #0
+
+    ARM_DynCom dyncom(nullptr, test_env.GetMemory(), USER32MODE);
+    dyncom.SetPC(0);
+    dyncom.SetReg(0, 0);
+
+    // Loops through the two blocks, chained to each other, as Run does within a time slice. Run
+    // needs the timing of a system, so the number of instructions is given instead.
+    dyncom.ExecuteInstructions(3000);
+    REQUIRE(dyncom.GetPC() == 0);
+    REQUIRE(dyncom.GetReg(0) == 1000);
+
+    // The block on the other page stays cached, but its branch must not jump to the old code
+    test_env.SetMemory32(0x0000, 0xE2800002); // add r0, r0, #2
+    dyncom.InvalidateCacheRange(0, 4);
+
+    dyncom.ExecuteInstructions(3000);
+    REQUIRE(dyncom.GetPC() == 0);
+    REQUIRE(dyncom.GetReg(0) == 3000);
+}
+
+} // namespace ArmTests
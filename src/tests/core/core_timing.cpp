@@ -4,9 +4,12 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <string>
+#include <thread>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -226,3 +229,99 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == timing.GetDowncount());
 }
+
+TEST_CASE("CoreTiming[UnscheduleToken]", "[core]") {
+    Core::Timing timing;
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    Core::TimingEventType* cb_c = timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+
+    const Core::TimingEventToken token_a = timing.ScheduleEvent(100, cb_a, CB_IDS[0]);
+    timing.ScheduleEvent(200, cb_b, CB_IDS[1]);
+    const Core::TimingEventToken token_c = timing.ScheduleEvent(300, cb_c, CB_IDS[2]);
+    timing.UnscheduleEvent(token_a);
+
+    // Enter slice 0
+    timing.Advance();
+    REQUIRE(200 == timing.GetDowncount());
+
+    AdvanceAndCheck(timing, 1, 100);
+
+    // The slot of an unscheduled event is reused, but the old token doesn't refer to the new event
+    timing.ScheduleEvent(50, cb_a, CB_IDS[0]);
+    timing.UnscheduleEvent(token_a);
+    AdvanceAndCheck(timing, 0, 50);
+
+    timing.UnscheduleEvent(token_c);
+    callbacks_ran_flags = 0;
+    timing.AddTicks(timing.GetDowncount());
+    timing.Advance();
+    REQUIRE(callbacks_ran_flags.none());
+    REQUIRE(MAX_SLICE_LENGTH == timing.GetDowncount());
+}
+
+TEST_CASE("CoreTiming[ThreadsafeMultipleWriters]", "[core]") {
+    Core::Timing timing;
+
+    constexpr int num_threads = 4;
+    // More events than the lock-free queue holds, so that some of them overflow
+    constexpr int events_per_thread = 1000;
+    std::array<int, num_threads> fired{};
+    Core::TimingEventType* cb = timing.RegisterEvent(
+        "callback", [&fired](u64 userdata, s64 cycles_late) { ++fired[userdata]; });
+
+    // Enter slice 0
+    timing.Advance();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&timing, cb, i] {
+            for (int j = 0; j < events_per_thread; ++j) {
+                timing.ScheduleEventThreadsafe(100, cb, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    timing.AddTicks(timing.GetDowncount());
+    timing.Advance();
+    for (int count : fired) {
+        REQUIRE(count == events_per_thread);
+    }
+
+    const auto stats = timing.GetAndResetThreadsafeEventStats();
+    REQUIRE(stats.events == num_threads * events_per_thread);
+    REQUIRE(stats.max_queue_depth == num_threads * events_per_thread);
+    REQUIRE(stats.overflowed_events > 0);
+    REQUIRE(timing.GetAndResetThreadsafeEventStats().events == 0);
+}
+
+TEST_CASE("CoreTiming[ThreadsafeOrder]", "[core]") {
+    Core::Timing timing;
+
+    // More events than the lock-free queue holds, moved while they are being scheduled
+    constexpr u64 num_events = 100000;
+    std::vector<u64> fired;
+    Core::TimingEventType* cb = timing.RegisterEvent(
+        "callback", [&fired](u64 userdata, s64 cycles_late) { fired.push_back(userdata); });
+
+    // Enter slice 0
+    timing.Advance();
+
+    std::thread thread([&timing, cb] {
+        for (u64 i = 0; i < num_events; ++i) {
+            timing.ScheduleEventThreadsafe(0, cb, i);
+        }
+    });
+    while (fired.size() < num_events) {
+        timing.AddTicks(timing.GetDowncount());
+        timing.Advance();
+    }
+    thread.join();
+
+    REQUIRE(fired.size() == num_events);
+    REQUIRE(std::is_sorted(fired.begin(), fired.end()));
+}
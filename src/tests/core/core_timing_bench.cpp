@@ -0,0 +1,78 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <benchmark/benchmark.h>
+#include "core/core_timing.h"
+
+// Microbenchmarks of the event queue of Core::Timing. Each benchmark keeps state.range(0) events
+// scheduled in the background, like the periodic events of the HLE services and the wakeups of
+// sleeping threads, while it schedules and cancels another one.
+
+namespace {
+
+constexpr s64 BACKGROUND_DELAY = 1000000;
+
+void ScheduleBackground(Core::Timing& timing, const Core::TimingEventType* type, s64 count) {
+    for (s64 i = 0; i < count; ++i) {
+        timing.ScheduleEvent(BACKGROUND_DELAY + i * 97 % 1000, type, static_cast<u64>(i));
+    }
+}
+
+void UnscheduleByToken(benchmark::State& state) {
+    Core::Timing timing;
+    auto* background = timing.RegisterEvent("background", [](u64, s64) {});
+    auto* wakeup = timing.RegisterEvent("wakeup", [](u64, s64) {});
+    ScheduleBackground(timing, background, state.range(0));
+
+    for (auto _ : state) {
+        const auto token = timing.ScheduleEvent(500, wakeup, 1);
+        timing.UnscheduleEvent(token);
+    }
+}
+
+void UnscheduleByType(benchmark::State& state) {
+    Core::Timing timing;
+    auto* background = timing.RegisterEvent("background", [](u64, s64) {});
+    auto* wakeup = timing.RegisterEvent("wakeup", [](u64, s64) {});
+    ScheduleBackground(timing, background, state.range(0));
+
+    for (auto _ : state) {
+        timing.ScheduleEvent(500, wakeup, 1);
+        timing.UnscheduleEvent(wakeup, 1);
+    }
+}
+
+void ScheduleAndFire(benchmark::State& state) {
+    Core::Timing timing;
+    auto* background = timing.RegisterEvent("background", [](u64, s64) {});
+    auto* tick = timing.RegisterEvent("tick", [](u64, s64) {});
+    ScheduleBackground(timing, background, state.range(0));
+    timing.Advance();
+
+    for (auto _ : state) {
+        timing.ScheduleEvent(100, tick);
+        timing.AddTicks(timing.GetDowncount());
+        timing.Advance();
+    }
+}
+
+void ScheduleThreadsafeAndMove(benchmark::State& state) {
+    Core::Timing timing;
+    auto* background = timing.RegisterEvent("background", [](u64, s64) {});
+    auto* input = timing.RegisterEvent("input", [](u64, s64) {});
+    ScheduleBackground(timing, background, state.range(0));
+
+    for (auto _ : state) {
+        timing.ScheduleEventThreadsafe(BACKGROUND_DELAY * 2, input, 0);
+        timing.MoveEvents();
+        timing.RemoveEvent(input);
+    }
+}
+
+} // Anonymous namespace
+
+BENCHMARK(UnscheduleByToken)->Arg(8)->Arg(64)->Arg(512);
+BENCHMARK(UnscheduleByType)->Arg(8)->Arg(64)->Arg(512);
+BENCHMARK(ScheduleAndFire)->Arg(8)->Arg(64)->Arg(512);
+BENCHMARK(ScheduleThreadsafeAndMove)->Arg(8)->Arg(64);
@@ -0,0 +1,68 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/file_sys/block_cache.h"
+
+namespace FileSys {
+
+TEST_CASE("BlockCache::Get", "[core][file_sys]") {
+    BlockCache cache(2);
+    std::vector<std::size_t> filled;
+    std::vector<bool> sequential_fills;
+    const auto fill = [&](std::size_t index, bool sequential) {
+        filled.push_back(index);
+        sequential_fills.push_back(sequential);
+        std::vector<BlockCache::Block> blocks;
+        if (index != 9)
+            blocks.push_back(std::make_shared<const std::vector<u8>>(1, static_cast<u8>(index)));
+        return blocks;
+    };
+
+    SECTION("blocks are read once while cached") {
+        REQUIRE(cache.Get(1, fill)->at(0) == 1);
+        REQUIRE(cache.Get(2, fill)->at(0) == 2);
+        REQUIRE(cache.Get(1, fill)->at(0) == 1);
+        REQUIRE(filled == std::vector<std::size_t>{1, 2});
+    }
+
+    SECTION("the least recently used block is dropped") {
+        cache.Get(1, fill);
+        cache.Get(2, fill);
+        cache.Get(1, fill);
+        cache.Get(3, fill);
+        cache.Get(1, fill);
+        cache.Get(2, fill);
+        REQUIRE(filled == std::vector<std::size_t>{1, 2, 3, 2});
+    }
+
+    SECTION("sequential reads are told apart") {
+        cache.Get(4, fill);
+        cache.Get(5, fill);
+        cache.Get(7, fill);
+        REQUIRE(sequential_fills == std::vector<bool>{false, true, false});
+    }
+
+    SECTION("blocks read ahead are kept") {
+        const auto fill_ahead = [&](std::size_t index, bool) {
+            filled.push_back(index);
+            return std::vector<BlockCache::Block>{
+                std::make_shared<const std::vector<u8>>(1, static_cast<u8>(index)),
+                std::make_shared<const std::vector<u8>>(1, static_cast<u8>(index + 1))};
+        };
+        REQUIRE(cache.Get(4, fill_ahead)->at(0) == 4);
+        REQUIRE(cache.Get(5, fill_ahead)->at(0) == 5);
+        REQUIRE(filled == std::vector<std::size_t>{4});
+    }
+
+    SECTION("blocks that can't be read aren't kept") {
+        REQUIRE(cache.Get(9, fill) == nullptr);
+        REQUIRE(cache.Get(9, fill) == nullptr);
+        REQUIRE(filled == std::vector<std::size_t>{9, 9});
+    }
+}
+
+} // namespace FileSys
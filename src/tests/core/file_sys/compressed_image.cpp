@@ -0,0 +1,190 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/file_util.h"
+#include "core/file_sys/compressed_image.h"
+#include "core/file_sys/ncch_container.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+constexpr char SourceFile[] = "compressed_image_test.cxi";
+constexpr char ImageFile[] = "compressed_image_test.zcxi";
+
+constexpr u64 ProgramId = 0x0004000000123400;
+constexpr std::size_t ExHeaderOffset = 0x200;
+constexpr std::size_t ExeFSOffset = 0xC00;
+constexpr std::size_t CodeSize = 0x400;
+constexpr std::size_t IconSize = 0x200;
+constexpr std::size_t RomFSOffset = 0x2000;
+constexpr std::size_t RomFSSize = 0x31000;
+constexpr std::size_t NCCHSize = RomFSOffset + RomFSSize;
+
+/// Makes a CXI whose sections are random, except for the second half of the RomFS which is zero
+static std::vector<u8> MakeNCCH(bool encrypted) {
+    std::mt19937 random(0x4E434348);
+    std::vector<u8> ncch(NCCHSize);
+    for (std::size_t i = 0; i < RomFSOffset + RomFSSize / 2; ++i) {
+        ncch[i] = static_cast<u8>(random());
+    }
+
+    NCCH_Header header;
+    std::memcpy(&header, ncch.data(), sizeof(header));
+    header.magic = Loader::MakeMagic('N', 'C', 'C', 'H');
+    header.content_size = NCCHSize / 0x200;
+    header.version = 0;
+    header.program_id = ProgramId;
+    header.extended_header_size = 0x400;
+    header.fixed_key.Assign(encrypted);
+    header.no_romfs.Assign(0);
+    header.no_crypto.Assign(!encrypted);
+    header.seed_crypto.Assign(0);
+    header.logo_region_offset = 0;
+    header.logo_region_size = 0;
+    header.exefs_offset = ExeFSOffset / 0x200;
+    header.exefs_size = (sizeof(ExeFs_Header) + CodeSize + IconSize) / 0x200;
+    header.romfs_offset = RomFSOffset / 0x200;
+    header.romfs_size = RomFSSize / 0x200;
+    std::memcpy(ncch.data(), &header, sizeof(header));
+
+    ExHeader_Header exheader{};
+    exheader.codeset_info.flags.flag = 0;
+    exheader.system_info.jump_id = ProgramId;
+    std::memcpy(ncch.data() + ExHeaderOffset, &exheader, sizeof(exheader));
+
+    ExeFs_Header exefs_header{};
+    std::strcpy(exefs_header.section[0].name, ".code");
+    exefs_header.section[0].offset = 0;
+    exefs_header.section[0].size = CodeSize;
+    std::strcpy(exefs_header.section[1].name, "icon");
+    exefs_header.section[1].offset = CodeSize;
+    exefs_header.section[1].size = IconSize;
+    std::memcpy(ncch.data() + ExeFSOffset, &exefs_header, sizeof(exefs_header));
+    return ncch;
+}
+
+/// Encrypts the sections of a CXI made by MakeNCCH, with the fixed key of NCCH version 0
+static std::vector<u8> EncryptNCCH(std::vector<u8> ncch) {
+    NCCH_Header header;
+    std::memcpy(&header, ncch.data(), sizeof(header));
+
+    const auto encrypt = [&ncch, &header](std::size_t offset, std::size_t size, u8 section) {
+        const std::array<u8, 16> key{};
+        std::array<u8, 16> ctr{};
+        std::reverse_copy(header.partition_id, header.partition_id + 8, ctr.begin());
+        ctr[8] = section;
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption e(key.data(), key.size(), ctr.data());
+        e.ProcessData(ncch.data() + offset, ncch.data() + offset, size);
+    };
+    encrypt(ExHeaderOffset, sizeof(ExHeader_Header), 1);
+    encrypt(ExeFSOffset, sizeof(ExeFs_Header) + CodeSize + IconSize, 2);
+    encrypt(RomFSOffset, RomFSSize, 3);
+    return ncch;
+}
+
+TEST_CASE("CompressImage", "[core][file_sys]") {
+    const bool encrypted = GENERATE(false, true);
+    std::vector<u8> ncch = MakeNCCH(encrypted);
+    {
+        const std::vector<u8> source = encrypted ? EncryptNCCH(ncch) : ncch;
+        FileUtil::IOFile file(SourceFile, "wb");
+        REQUIRE(file.WriteBytes(source.data(), source.size()) == source.size());
+    }
+
+    std::size_t progress = 0;
+    const auto callback = [&progress](std::size_t written, std::size_t total) {
+        REQUIRE(written > progress);
+        REQUIRE(total == NCCHSize);
+        progress = written;
+    };
+    REQUIRE(CompressImage(SourceFile, ImageFile, callback) == Loader::ResultStatus::Success);
+    REQUIRE(progress == NCCHSize);
+    REQUIRE(FileUtil::GetSize(ImageFile) < NCCHSize * 3 / 4);
+
+    // The image is the decrypted CXI, marked as such
+    NCCH_Header header;
+    std::memcpy(&header, ncch.data(), sizeof(header));
+    header.no_crypto.Assign(1);
+    std::memcpy(ncch.data(), &header, sizeof(header));
+
+    SECTION("reads the image") {
+        auto image = std::make_shared<CompressedImage>(FileUtil::IOFile(ImageFile, "rb"));
+        REQUIRE(image->IsValid());
+        REQUIRE(image->GetContentMagic() == Loader::MakeMagic('N', 'C', 'C', 'H'));
+        REQUIRE(image->GetSize() == NCCHSize);
+
+        std::vector<u8> data(NCCHSize);
+        REQUIRE(image->Read(0, data.size(), data.data()) == NCCHSize);
+        REQUIRE(data == ncch);
+
+        std::mt19937 random(0);
+        for (int i = 0; i < 100; ++i) {
+            const std::size_t offset = random() % NCCHSize;
+            const std::size_t length = random() % 0x20000;
+            const std::size_t expected = std::min(length, NCCHSize - offset);
+            std::vector<u8> buffer(length);
+            REQUIRE(image->Read(offset, length, buffer.data()) == expected);
+            REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected, ncch.begin() + offset));
+        }
+    }
+
+    SECTION("loads the image as an NCCH") {
+        NCCHContainer container(ImageFile);
+        REQUIRE(container.Load() == Loader::ResultStatus::Success);
+
+        u64_le program_id;
+        REQUIRE(container.ReadProgramId(program_id) == Loader::ResultStatus::Success);
+        REQUIRE(program_id == ProgramId);
+
+        const std::size_t code_offset = ExeFSOffset + sizeof(ExeFs_Header);
+        std::vector<u8> section;
+        REQUIRE(container.LoadSectionExeFS(".code", section) == Loader::ResultStatus::Success);
+        REQUIRE(std::equal(section.begin(), section.end(), ncch.begin() + code_offset,
+                           ncch.begin() + code_offset + CodeSize));
+        REQUIRE(container.LoadSectionExeFS("icon", section) == Loader::ResultStatus::Success);
+        REQUIRE(std::equal(section.begin(), section.end(), ncch.begin() + code_offset + CodeSize,
+                           ncch.begin() + code_offset + CodeSize + IconSize));
+
+        // The RomFS starts after its level 3 header
+        std::shared_ptr<RomFSReader> romfs;
+        REQUIRE(container.ReadRomFS(romfs) == Loader::ResultStatus::Success);
+        REQUIRE(romfs->GetSize() == RomFSSize - 0x1000);
+        std::vector<u8> data(romfs->GetSize());
+        REQUIRE(romfs->ReadFile(0, data.size(), data.data()) == data.size());
+        REQUIRE(std::equal(data.begin(), data.end(), ncch.begin() + RomFSOffset + 0x1000));
+    }
+
+    SECTION("rejects a header whose image size overflows") {
+        constexpr char CorruptFile[] = "compressed_image_test_corrupt.zcxi";
+        REQUIRE(FileUtil::Copy(ImageFile, CorruptFile));
+        {
+            // The number of blocks computed from this size wraps around to 0
+            const u64_le image_size = 0xFFFFFFFFFFFFFFFF;
+            const u64_le num_blocks = 0;
+            FileUtil::IOFile file(CorruptFile, "r+b");
+            REQUIRE(file.Seek(16, SEEK_SET));
+            REQUIRE(file.WriteObject(image_size) == 1);
+            REQUIRE(file.WriteObject(num_blocks) == 1);
+        }
+        REQUIRE(!CompressedImage(FileUtil::IOFile(CorruptFile, "rb")).IsValid());
+        FileUtil::Delete(CorruptFile);
+    }
+
+    REQUIRE(CompressImage(ImageFile, "compressed_image_test_twice.zcxi") ==
+            Loader::ResultStatus::ErrorInvalidFormat);
+
+    FileUtil::Delete(SourceFile);
+    FileUtil::Delete(ImageFile);
+}
+
+} // namespace FileSys
@@ -0,0 +1,118 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/file_util.h"
+#include "core/file_sys/romfs_reader.h"
+
+namespace FileSys {
+
+constexpr char TestFile[] = "romfs_reader_test.bin";
+constexpr std::size_t FileOffset = 0x200;
+constexpr std::size_t CryptoOffset = 0x1000;
+constexpr std::size_t DataSize = 0x10000 * 5 + 0x123;
+constexpr std::array<u8, 16> Key{{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA,
+                                  0xBB, 0xCC, 0xDD, 0xEE, 0xFF}};
+constexpr std::array<u8, 16> Ctr{{0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+                                  0x0C, 0x0D, 0x0E, 0x0F, 0x10}};
+
+/// Writes the data after some padding, encrypting it if asked to
+static void WriteTestFile(const std::vector<u8>& data, bool encrypted) {
+    std::vector<u8> contents(FileOffset, 0xCD);
+    contents.insert(contents.end(), data.begin(), data.end());
+    if (encrypted) {
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption e(Key.data(), Key.size(), Ctr.data());
+        e.Seek(CryptoOffset);
+        e.ProcessData(contents.data() + FileOffset, contents.data() + FileOffset, data.size());
+    }
+
+    FileUtil::IOFile file(TestFile, "wb");
+    REQUIRE(file.WriteBytes(contents.data(), contents.size()) == contents.size());
+}
+
+static void CheckRead(RomFSReader& reader, const std::vector<u8>& data, std::size_t offset,
+                      std::size_t length) {
+    std::vector<u8> buffer(length);
+    const std::size_t expected = offset < data.size() ? std::min(length, data.size() - offset) : 0;
+    REQUIRE(reader.ReadFile(offset, length, buffer.data()) == expected);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected, data.begin() + offset));
+}
+
+TEST_CASE("RomFSReader::ReadFile", "[core][file_sys]") {
+    std::mt19937 random(0x524F4D46);
+    std::vector<u8> data(DataSize);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(random());
+    }
+
+    const bool encrypted = GENERATE(false, true);
+    WriteTestFile(data, encrypted);
+
+    std::unique_ptr<RomFSReader> reader;
+    if (encrypted) {
+        reader = std::make_unique<RomFSReader>(FileUtil::IOFile(TestFile, "rb"), FileOffset,
+                                               DataSize, Key, Ctr, CryptoOffset);
+    } else {
+        reader = std::make_unique<RomFSReader>(FileUtil::IOFile(TestFile, "rb"), FileOffset,
+                                               DataSize);
+    }
+    REQUIRE(reader->GetSize() == DataSize);
+
+    SECTION("reads ranges of any size") {
+        CheckRead(*reader, data, 0, 16);
+        CheckRead(*reader, data, 0xFFF0, 0x20);
+        CheckRead(*reader, data, 0x10000, 0x20000);
+        CheckRead(*reader, data, 0x8000, 0x30000);
+        CheckRead(*reader, data, 0, DataSize);
+        CheckRead(*reader, data, DataSize - 0x10, 0x100);
+        CheckRead(*reader, data, DataSize, 0x10);
+    }
+
+    SECTION("reads sequentially") {
+        for (std::size_t offset = 0; offset < DataSize; offset += 0x1234) {
+            CheckRead(*reader, data, offset, 0x1234);
+        }
+    }
+
+    SECTION("reads from several threads at once") {
+        // Catch assertions aren't thread-safe, the threads count their failures instead
+        std::atomic<u32> failures{0};
+        std::vector<std::thread> threads;
+        for (u32 seed = 0; seed < 4; ++seed) {
+            threads.emplace_back([&reader, &data, &failures, seed] {
+                std::mt19937 thread_random(seed);
+                for (int i = 0; i < 200; ++i) {
+                    const std::size_t offset = thread_random() % DataSize;
+                    const std::size_t length = thread_random() % 0x4000;
+                    std::vector<u8> buffer(length);
+                    const std::size_t read = reader->ReadFile(offset, length, buffer.data());
+                    if (read != std::min(length, DataSize - offset) ||
+                        !std::equal(buffer.begin(), buffer.begin() + read,
+                                    data.begin() + offset)) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(failures == 0);
+    }
+
+    reader.reset();
+    FileUtil::Delete(TestFile);
+}
+
+} // namespace FileSys
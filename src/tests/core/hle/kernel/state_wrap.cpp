@@ -0,0 +1,98 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/chunk_file.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/state_wrap.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+using ObjectList = std::vector<std::shared_ptr<Object>>;
+
+static std::vector<u8> Save(KernelSystem& kernel, ObjectList& objects) {
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    {
+        StateWrap state(measure, kernel);
+        state.DoObjects(objects);
+        state.Finish();
+    }
+    REQUIRE(measure.error == PointerWrap::ERROR_NONE);
+
+    std::vector<u8> buffer(reinterpret_cast<std::size_t>(ptr));
+    ptr = buffer.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    StateWrap state(p, kernel);
+    state.DoObjects(objects);
+    state.Finish();
+    REQUIRE(ptr == buffer.data() + buffer.size());
+    return buffer;
+}
+
+template <typename T>
+static bool Load(KernelSystem& kernel, std::vector<u8>& buffer,
+                 std::vector<std::shared_ptr<T>>& objects, const ObjectList& previous_objects) {
+    u8* ptr = buffer.data();
+    PointerWrap p(&ptr, buffer.data() + buffer.size(), PointerWrap::MODE_READ);
+    StateWrap state(p, kernel);
+    state.SetPreviousObjects(previous_objects);
+    state.DoObjects(objects);
+    state.Finish();
+    return !state.Failed();
+}
+
+TEST_CASE("StateWrap::DoObject", "[core][kernel]") {
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    KernelSystem kernel(memory, timing, [] {}, 0);
+
+    auto event = kernel.CreateEvent(ResetType::Sticky, "event");
+    auto semaphore = kernel.CreateSemaphore(1, 5, "semaphore").Unwrap();
+    ObjectList objects{event, semaphore, event, nullptr};
+    auto buffer = Save(kernel, objects);
+
+    SECTION("restores live objects in place") {
+        event->Signal();
+        semaphore->available_count = 4;
+
+        ObjectList loaded;
+        REQUIRE(Load(kernel, buffer, loaded, {event, semaphore}));
+        REQUIRE(loaded == objects);
+        REQUIRE(event->ShouldWait(nullptr));
+        REQUIRE(semaphore->available_count == 1);
+    }
+
+    SECTION("recreates objects that are gone") {
+        ObjectList loaded;
+        REQUIRE(Load(kernel, buffer, loaded, {}));
+        REQUIRE(loaded.size() == 4);
+        REQUIRE(loaded[0] != event);
+        REQUIRE(loaded[0] == loaded[2]);
+        REQUIRE(loaded[3] == nullptr);
+        REQUIRE(loaded[0]->GetObjectId() == event->GetObjectId());
+
+        auto loaded_event = DynamicObjectCast<Event>(loaded[0]);
+        REQUIRE(loaded_event != nullptr);
+        REQUIRE(loaded_event->GetName() == "event");
+        REQUIRE(loaded_event->GetResetType() == ResetType::Sticky);
+
+        auto loaded_semaphore = DynamicObjectCast<Semaphore>(loaded[1]);
+        REQUIRE(loaded_semaphore != nullptr);
+        REQUIRE(loaded_semaphore->max_count == 5);
+        REQUIRE(loaded_semaphore->available_count == 1);
+    }
+
+    SECTION("fails on objects of another type") {
+        std::vector<std::shared_ptr<Semaphore>> loaded;
+        REQUIRE(!Load(kernel, buffer, loaded, {}));
+    }
+}
+
+} // namespace Kernel
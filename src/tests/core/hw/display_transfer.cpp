@@ -0,0 +1,171 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/color.h"
+#include "common/thread_pool.h"
+#include "common/vector_math.h"
+#include "core/hw/display_transfer.h"
+#include "core/hw/gpu.h"
+#include "tests/random_data.h"
+#include "video_core/utils.h"
+
+using GPU::Regs;
+using PixelFormat = Regs::PixelFormat;
+using TransferConfig = Regs::DisplayTransferConfig;
+using Tests::RandomData;
+
+namespace {
+
+constexpr std::array<PixelFormat, 5> formats = {
+    PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB565, PixelFormat::RGB5A1,
+    PixelFormat::RGBA4,
+};
+
+Common::Vec4<u8> DecodePixel(PixelFormat format, const u8* src) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(src);
+    case PixelFormat::RGB8:
+        return Color::DecodeRGB8(src);
+    case PixelFormat::RGB565:
+        return Color::DecodeRGB565(src);
+    case PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(src);
+    default:
+        return Color::DecodeRGBA4(src);
+    }
+}
+
+void EncodePixel(PixelFormat format, const Common::Vec4<u8>& color, u8* dst) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::EncodeRGBA8(color, dst);
+    case PixelFormat::RGB8:
+        return Color::EncodeRGB8(color, dst);
+    case PixelFormat::RGB565:
+        return Color::EncodeRGB565(color, dst);
+    case PixelFormat::RGB5A1:
+        return Color::EncodeRGB5A1(color, dst);
+    default:
+        return Color::EncodeRGBA4(color, dst);
+    }
+}
+
+u32 TiledOffset(u32 x, u32 y, u32 width, u32 bytes_per_pixel) {
+    return VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + (y & ~7) * width * bytes_per_pixel;
+}
+
+/// Pixel by pixel transfer, as it was done before the kernels
+void ReferenceTransfer(const TransferConfig& config, const u8* src, u8* dst) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    const u32 src_bytes_per_pixel = Regs::BytesPerPixel(config.input_format);
+    const u32 dst_bytes_per_pixel = Regs::BytesPerPixel(config.output_format);
+    const bool src_tiled = !config.input_linear;
+    const bool dst_tiled = config.dont_swizzle ? src_tiled : !src_tiled;
+
+    for (u32 y = 0; y < output_height; ++y) {
+        for (u32 x = 0; x < output_width; ++x) {
+            const u32 input_x = x << horizontal_scale;
+            const u32 input_y = y << vertical_scale;
+            const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            const u32 src_offset =
+                src_tiled ? TiledOffset(input_x, input_y, config.input_width, src_bytes_per_pixel)
+                          : (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+            const u32 dst_offset = dst_tiled
+                                       ? TiledOffset(x, output_y, output_width, dst_bytes_per_pixel)
+                                       : (x + output_y * output_width) * dst_bytes_per_pixel;
+
+            const u8* src_pixel = src + src_offset;
+            auto color = DecodePixel(config.input_format, src_pixel);
+            if (config.scaling == config.ScaleX) {
+                const auto pixel =
+                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
+                color = ((color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                const auto pixel1 =
+                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
+                const auto pixel2 =
+                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
+                const auto pixel3 =
+                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
+                color = (((color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+            EncodePixel(config.output_format, color, dst + dst_offset);
+        }
+    }
+}
+
+TransferConfig MakeConfig(u32 width, u32 height, PixelFormat input_format,
+                          PixelFormat output_format, TransferConfig::ScalingMode scaling,
+                          bool input_linear, bool dont_swizzle, bool flip_vertically) {
+    TransferConfig config{};
+    config.input_width.Assign(width);
+    config.input_height.Assign(height);
+    config.output_width.Assign(width);
+    config.output_height.Assign(height);
+    config.input_format.Assign(input_format);
+    config.output_format.Assign(output_format);
+    config.scaling.Assign(scaling);
+    config.input_linear.Assign(input_linear);
+    config.dont_swizzle.Assign(dont_swizzle);
+    config.flip_vertically.Assign(flip_vertically);
+    return config;
+}
+
+void CheckTransfer(const TransferConfig& config, Common::ThreadPool* pool) {
+    // Sized for the largest input format
+    const std::vector<u8> src = RandomData(config.input_width * config.input_height * 4);
+    const std::size_t dst_size =
+        config.output_width * config.output_height * Regs::BytesPerPixel(config.output_format);
+    std::vector<u8> expected(dst_size);
+    std::vector<u8> result(dst_size);
+
+    ReferenceTransfer(config, src.data(), expected.data());
+    GPU::PerformDisplayTransfer(config, src.data(), result.data(), pool);
+    REQUIRE(result == expected);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PerformDisplayTransfer matches the per-pixel conversion", "[core][hw][gpu]") {
+    for (const PixelFormat input_format : formats) {
+        for (const PixelFormat output_format : formats) {
+            for (const bool dont_swizzle : {false, true}) {
+                for (const bool flip_vertically : {false, true}) {
+                    CheckTransfer(MakeConfig(64, 32, input_format, output_format,
+                                             TransferConfig::NoScale, true, dont_swizzle,
+                                             flip_vertically),
+                                  nullptr);
+                    for (const auto scaling : {TransferConfig::NoScale, TransferConfig::ScaleX,
+                                               TransferConfig::ScaleXY}) {
+                        CheckTransfer(MakeConfig(64, 32, input_format, output_format, scaling,
+                                                 false, dont_swizzle, flip_vertically),
+                                      nullptr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("PerformDisplayTransfer splits large transfers between threads", "[core][hw][gpu]") {
+    Common::ThreadPool pool(3, "DisplayTransferTest");
+    for (const bool input_linear : {false, true}) {
+        for (const bool flip_vertically : {false, true}) {
+            CheckTransfer(MakeConfig(400, 240, PixelFormat::RGBA8, PixelFormat::RGB8,
+                                     TransferConfig::NoScale, input_linear, false, flip_vertically),
+                          &pool);
+        }
+    }
+    CheckTransfer(MakeConfig(800, 480, PixelFormat::RGBA8, PixelFormat::RGB565,
+                             TransferConfig::ScaleXY, false, false, true),
+                  &pool);
+}
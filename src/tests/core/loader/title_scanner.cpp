@@ -0,0 +1,114 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/ncch_container.h"
+#include "core/loader/loader.h"
+#include "core/loader/title_scanner.h"
+
+namespace Loader {
+
+constexpr char CacheFile[] = "title_scanner_test.bin";
+
+/// Writes a CXI that only has a RomFS, which is enough for the loader to read its program ID
+static void WriteTitle(const std::string& path, u64 program_id, std::size_t romfs_units) {
+    std::vector<u8> data(0x400 + romfs_units * 0x200);
+    NCCH_Header header{};
+    header.magic = MakeMagic('N', 'C', 'C', 'H');
+    header.content_size = static_cast<u32>(data.size() / 0x200);
+    header.program_id = program_id;
+    header.no_crypto.Assign(1);
+    header.romfs_offset = 2;
+    header.romfs_size = static_cast<u32>(romfs_units);
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+}
+
+TEST_CASE("TitleScanner", "[core][loader]") {
+    // System titles, which don't have updates
+    const std::vector<std::string> paths{"title_scanner_test_a.cxi", "title_scanner_test_b.cxi",
+                                         "title_scanner_test_c.bin"};
+    WriteTitle(paths[0], 0x0004001000021000, 8);
+    WriteTitle(paths[1], 0x0004001000022000, 16);
+    {
+        FileUtil::IOFile file(paths[2], "wb");
+        REQUIRE(file.WriteBytes("not a title", 11) == 11);
+    }
+    FileUtil::Delete(CacheFile);
+
+    const auto check_titles = [&paths](const std::vector<TitleInfo>& titles) {
+        REQUIRE(titles.size() == 2);
+        REQUIRE(titles[0].path == paths[0]);
+        REQUIRE(titles[0].program_id == 0x0004001000021000);
+        REQUIRE(titles[0].file_type == FileType::CXI);
+        REQUIRE(titles[0].size == 0x1400);
+        REQUIRE(titles[1].path == paths[1]);
+        REQUIRE(titles[1].program_id == 0x0004001000022000);
+    };
+
+    std::atomic_bool stop{false};
+    {
+        TitleScanner scanner(CacheFile);
+        check_titles(scanner.Scan(paths, stop));
+        REQUIRE(scanner.SaveCache());
+    }
+
+    SECTION("titles are read from the cache") {
+        TitleScanner scanner(CacheFile);
+        check_titles(scanner.Scan(paths, stop));
+    }
+
+    SECTION("modified files are read again") {
+        WriteTitle(paths[1], 0x0004001000023000, 24);
+        TitleScanner scanner(CacheFile);
+        const std::vector<TitleInfo> titles = scanner.Scan(paths, stop);
+        REQUIRE(titles.size() == 2);
+        REQUIRE(titles[1].program_id == 0x0004001000023000);
+        REQUIRE(titles[1].size == 0x3400);
+    }
+
+    SECTION("a corrupted cache is ignored") {
+        {
+            FileUtil::IOFile file(CacheFile, "r+b");
+            file.Seek(-1, SEEK_END);
+            const u8 byte = 0xFF;
+            REQUIRE(file.WriteBytes(&byte, 1) == 1);
+        }
+        TitleScanner scanner(CacheFile);
+        check_titles(scanner.Scan(paths, stop));
+    }
+
+    SECTION("an unchanged cache isn't written again") {
+        TitleScanner scanner(CacheFile);
+        check_titles(scanner.Scan(paths, stop));
+        FileUtil::Delete(CacheFile);
+        REQUIRE(scanner.SaveCache());
+        REQUIRE(!FileUtil::Exists(CacheFile));
+
+        // Files that weren't seen since the last save are dropped
+        scanner.Scan({paths[0]}, stop);
+        REQUIRE(scanner.SaveCache());
+        REQUIRE(FileUtil::Exists(CacheFile));
+    }
+
+    SECTION("a stopped scan returns nothing") {
+        stop = true;
+        TitleScanner scanner("");
+        REQUIRE(scanner.Scan(paths, stop).empty());
+    }
+
+    for (const std::string& path : paths) {
+        FileUtil::Delete(path);
+    }
+    FileUtil::Delete(CacheFile);
+}
+
+} // namespace Loader
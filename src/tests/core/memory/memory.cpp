@@ -54,3 +54,49 @@ TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
         CHECK(Memory::IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("Memory::MemorySystem::TakeSnapshot", "[core][memory]") {
+    Memory::MemorySystem memory;
+    u8* fcram = memory.GetFCRAMPointer(0);
+    u8* vram = memory.GetPhysicalPointer(Memory::VRAM_PADDR);
+
+    fcram[0] = 1;
+    vram[Memory::PAGE_SIZE] = 2;
+    const auto first = memory.TakeSnapshot(nullptr);
+    CHECK(first.GetCopiedPageCount() == 2);
+
+    SECTION("only pages that changed are copied") {
+        fcram[1] = 3;
+        vram[Memory::PAGE_SIZE] = 0;
+        const auto second = memory.TakeSnapshot(&first);
+        CHECK(second.GetCopiedPageCount() == 1);
+
+        memory.RestoreSnapshot(first);
+        CHECK(fcram[0] == 1);
+        CHECK(fcram[1] == 0);
+        CHECK(vram[Memory::PAGE_SIZE] == 2);
+
+        memory.RestoreSnapshot(second);
+        CHECK(fcram[1] == 3);
+        CHECK(vram[Memory::PAGE_SIZE] == 0);
+    }
+
+    SECTION("pages written after the snapshot are reverted") {
+        fcram[Memory::PAGE_SIZE * 7] = 4;
+        memory.RestoreSnapshot(first);
+        CHECK(fcram[Memory::PAGE_SIZE * 7] == 0);
+        CHECK(memory.TakeSnapshot(&first).GetCopiedPageCount() == 0);
+    }
+
+    SECTION("pages are compared to a snapshot older than the last one") {
+        fcram[1] = 3;
+        const auto second = memory.TakeSnapshot(&first);
+        fcram[Memory::PAGE_SIZE * 2] = 5;
+        const auto third = memory.TakeSnapshot(&first);
+        CHECK(third.GetCopiedPageCount() == 2);
+
+        memory.RestoreSnapshot(second);
+        CHECK(fcram[1] == 3);
+        CHECK(fcram[Memory::PAGE_SIZE * 2] == 0);
+    }
+}
@@ -0,0 +1,25 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Tests {
+
+/// Returns bytes of pseudo-random data, the same on every run for a given seed
+inline std::vector<u8> RandomData(std::size_t size, u32 seed = 0x7E57) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> distribution(0, 0xFF);
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(distribution(rng));
+    }
+    return data;
+}
+
+} // namespace Tests
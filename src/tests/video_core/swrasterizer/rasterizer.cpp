@@ -0,0 +1,135 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/memory.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/video_core.h"
+
+using Pica::float24;
+using Pica::FramebufferRegs;
+using Pica::RasterizerRegs;
+using Pica::Rasterizer::Vertex;
+
+constexpr u32 FB_WIDTH = 240;
+constexpr u32 FB_HEIGHT = 400;
+constexpr PAddr COLOR_BUFFER_ADDR = Memory::VRAM_PADDR;
+constexpr PAddr DEPTH_BUFFER_ADDR = Memory::VRAM_PADDR + 0x100000;
+constexpr u32 BUFFER_SIZE = FB_WIDTH * FB_HEIGHT * 4;
+
+static void SetupRegisters() {
+    std::memset(&Pica::g_state.regs, 0, sizeof(Pica::g_state.regs));
+    auto& framebuffer = Pica::g_state.regs.framebuffer.framebuffer;
+    framebuffer.color_buffer_address.Assign(COLOR_BUFFER_ADDR / 8);
+    framebuffer.depth_buffer_address.Assign(DEPTH_BUFFER_ADDR / 8);
+    framebuffer.width.Assign(FB_WIDTH);
+    framebuffer.height.Assign(FB_HEIGHT - 1);
+    framebuffer.color_format.Assign(FramebufferRegs::ColorFormat::RGBA8);
+    framebuffer.depth_format.Assign(FramebufferRegs::DepthFormat::D24S8);
+    framebuffer.allow_color_write.Assign(1);
+    framebuffer.allow_depth_stencil_write.Assign(1);
+
+    auto& output_merger = Pica::g_state.regs.framebuffer.output_merger;
+    output_merger.logic_op.Assign(FramebufferRegs::LogicOp::Copy);
+    output_merger.depth_test_enable.Assign(1);
+    output_merger.depth_test_func.Assign(FramebufferRegs::CompareFunc::LessThanOrEqual);
+    output_merger.depth_write_enable.Assign(1);
+    output_merger.red_enable.Assign(1);
+    output_merger.green_enable.Assign(1);
+    output_merger.blue_enable.Assign(1);
+    output_merger.alpha_enable.Assign(1);
+
+    auto& rasterizer = Pica::g_state.regs.rasterizer;
+    rasterizer.cull_mode.Assign(RasterizerRegs::CullMode::KeepAll);
+    // float24 encoding of 1.0
+    rasterizer.viewport_depth_range.Assign(0x3F0000);
+}
+
+static std::vector<Vertex> GenerateTriangles(unsigned seed, std::size_t count) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x_dist(0.0f, static_cast<float>(FB_WIDTH));
+    std::uniform_real_distribution<float> y_dist(0.0f, static_cast<float>(FB_HEIGHT));
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> w_dist(0.5f, 2.0f);
+
+    std::vector<Vertex> vertices;
+    for (std::size_t i = 0; i < count * 3; ++i) {
+        Vertex vertex{Pica::Shader::OutputVertex{}};
+        vertex.pos.w = float24::FromFloat32(w_dist(rng));
+        for (int c = 0; c < 4; ++c) {
+            vertex.color[c] = float24::FromFloat32(unit_dist(rng));
+        }
+        vertex.screenpos = Common::MakeVec(float24::FromFloat32(x_dist(rng)),
+                                           float24::FromFloat32(y_dist(rng)),
+                                           float24::FromFloat32(unit_dist(rng)));
+        vertices.push_back(vertex);
+    }
+    return vertices;
+}
+
+static std::vector<u8> Rasterize(Memory::MemorySystem& memory, const std::vector<Vertex>& vertices,
+                                 bool use_simd) {
+    u8* color_buffer = memory.GetPhysicalPointer(COLOR_BUFFER_ADDR);
+    u8* depth_buffer = memory.GetPhysicalPointer(DEPTH_BUFFER_ADDR);
+    std::memset(color_buffer, 0, BUFFER_SIZE);
+    std::memset(depth_buffer, 0xFF, BUFFER_SIZE);
+
+    Pica::Rasterizer::SetSimdRasterizationEnabled(use_simd);
+    for (std::size_t i = 0; i + 2 < vertices.size(); i += 3) {
+        Pica::Rasterizer::ProcessTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+    }
+    Pica::Rasterizer::SetSimdRasterizationEnabled(true);
+
+    std::vector<u8> result(color_buffer, color_buffer + BUFFER_SIZE);
+    result.insert(result.end(), depth_buffer, depth_buffer + BUFFER_SIZE);
+    return result;
+}
+
+TEST_CASE("SIMD coverage matches the scalar rasterizer", "[video_core][swrasterizer]") {
+    Memory::MemorySystem memory;
+    VideoCore::g_memory = &memory;
+    SetupRegisters();
+
+    SECTION("default state") {}
+
+    SECTION("scissor include") {
+        auto& scissor = Pica::g_state.regs.rasterizer.scissor_test;
+        scissor.mode.Assign(RasterizerRegs::ScissorMode::Include);
+        scissor.x1.Assign(13);
+        scissor.y1.Assign(29);
+        scissor.x2.Assign(170);
+        scissor.y2.Assign(301);
+    }
+
+    SECTION("scissor exclude") {
+        auto& scissor = Pica::g_state.regs.rasterizer.scissor_test;
+        scissor.mode.Assign(RasterizerRegs::ScissorMode::Exclude);
+        scissor.x1.Assign(50);
+        scissor.y1.Assign(61);
+        scissor.x2.Assign(127);
+        scissor.y2.Assign(250);
+    }
+
+    SECTION("cull clockwise") {
+        Pica::g_state.regs.rasterizer.cull_mode.Assign(RasterizerRegs::CullMode::KeepClockWise);
+    }
+
+    for (unsigned seed = 0; seed < 4; ++seed) {
+        const auto vertices = GenerateTriangles(seed, 16);
+        const auto scalar_result = Rasterize(memory, vertices, false);
+        const auto simd_result = Rasterize(memory, vertices, true);
+        REQUIRE(std::any_of(scalar_result.begin(), scalar_result.begin() + BUFFER_SIZE,
+                            [](u8 value) { return value != 0; }));
+        // Compare outside of REQUIRE to avoid stringifying the buffers on failure
+        const bool identical = scalar_result == simd_result;
+        REQUIRE(identical);
+    }
+
+    VideoCore::g_memory = nullptr;
+}
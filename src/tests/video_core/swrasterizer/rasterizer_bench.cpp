@@ -0,0 +1,348 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "core/memory.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/video_core.h"
+
+// Microbenchmarks of the software rasterizer fragment pipeline. Every benchmark draws the same
+// set of screen-aligned quads with a different register configuration and reports the fill rate
+// as the "Mpixels" rate counter.
+
+using Pica::float24;
+using Pica::FramebufferRegs;
+using Pica::LightingRegs;
+using Pica::RasterizerRegs;
+using Pica::TexturingRegs;
+using Pica::Rasterizer::Vertex;
+
+namespace {
+
+constexpr u32 FB_WIDTH = 240;
+constexpr u32 FB_HEIGHT = 400;
+constexpr u32 TEXTURE_SIZE = 128;
+constexpr PAddr COLOR_BUFFER_ADDR = Memory::VRAM_PADDR;
+constexpr PAddr DEPTH_BUFFER_ADDR = Memory::VRAM_PADDR + 0x100000;
+constexpr PAddr TEXTURE_ADDR = Memory::VRAM_PADDR + 0x200000;
+
+// float16 encodings of some constants
+constexpr u32 FLOAT16_0_3 = 0x34CD;
+constexpr u32 FLOAT16_0_5 = 0x3800;
+constexpr u32 FLOAT16_1_0 = 0x3C00;
+
+struct Scene {
+    std::vector<Vertex> vertices;
+    /// Number of fragments produced by rasterizing all vertices once
+    u64 num_pixels = 0;
+};
+
+/**
+ * Builds a fixed set of overlapping quads with integer corners. Thanks to the fill rule, each of
+ * them covers exactly width * height pixels, so the fill rate can be computed without counting.
+ */
+Scene BuildScene() {
+    std::mt19937 rng(0xC17A);
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+    auto RandomInt = [&rng](u32 min, u32 max) {
+        return std::uniform_int_distribution<u32>(min, max)(rng);
+    };
+
+    Scene scene;
+    for (int quad = 0; quad < 48; ++quad) {
+        const u32 x0 = RandomInt(0, FB_WIDTH - 16);
+        const u32 y0 = RandomInt(0, FB_HEIGHT - 16);
+        const u32 x1 = std::min(FB_WIDTH, x0 + RandomInt(16, 160));
+        const u32 y1 = std::min(FB_HEIGHT, y0 + RandomInt(16, 160));
+        scene.num_pixels += (x1 - x0) * (y1 - y0);
+
+        auto MakeVertex = [&](u32 x, u32 y, float u, float v) {
+            Vertex vertex{Pica::Shader::OutputVertex{}};
+            vertex.pos.w = float24::FromFloat32(1.0f);
+            vertex.quat = Common::MakeVec(float24::FromFloat32(unit_dist(rng) * 0.5f),
+                                          float24::FromFloat32(0.0f), float24::FromFloat32(0.0f),
+                                          float24::FromFloat32(1.0f));
+            for (int c = 0; c < 4; ++c) {
+                vertex.color[c] = float24::FromFloat32(unit_dist(rng));
+            }
+            vertex.tc0 = Common::MakeVec(float24::FromFloat32(u), float24::FromFloat32(v));
+            vertex.tc0_w = float24::FromFloat32(1.0f);
+            vertex.view = Common::MakeVec(float24::FromFloat32(unit_dist(rng) - 0.5f),
+                                          float24::FromFloat32(unit_dist(rng) - 0.5f),
+                                          float24::FromFloat32(-1.0f));
+            vertex.screenpos = Common::MakeVec(float24::FromFloat32(static_cast<float>(x)),
+                                               float24::FromFloat32(static_cast<float>(y)),
+                                               float24::FromFloat32(unit_dist(rng)));
+            return vertex;
+        };
+
+        const float uv_scale = unit_dist(rng) * 4.0f;
+        const Vertex v00 = MakeVertex(x0, y0, 0.0f, 0.0f);
+        const Vertex v10 = MakeVertex(x1, y0, uv_scale, 0.0f);
+        const Vertex v11 = MakeVertex(x1, y1, uv_scale, uv_scale);
+        const Vertex v01 = MakeVertex(x0, y1, 0.0f, uv_scale);
+        scene.vertices.insert(scene.vertices.end(), {v00, v10, v11, v00, v11, v01});
+    }
+    return scene;
+}
+
+Memory::MemorySystem& GetMemory() {
+    static Memory::MemorySystem memory;
+    return memory;
+}
+
+void SetTevStage(TexturingRegs::TevStageConfig& stage, u32 sources, u32 modifiers, u32 ops) {
+    stage.sources_raw = sources;
+    stage.modifiers_raw = modifiers;
+    stage.ops_raw = ops;
+}
+
+/// Configures a 240x400 RGBA8/D24S8 framebuffer and a pipeline outputting the vertex color
+void SetupBaseState() {
+    auto& regs = Pica::g_state.regs;
+    std::memset(&regs, 0, sizeof(regs));
+
+    auto& framebuffer = regs.framebuffer.framebuffer;
+    framebuffer.color_buffer_address.Assign(COLOR_BUFFER_ADDR / 8);
+    framebuffer.depth_buffer_address.Assign(DEPTH_BUFFER_ADDR / 8);
+    framebuffer.width.Assign(FB_WIDTH);
+    framebuffer.height.Assign(FB_HEIGHT - 1);
+    framebuffer.color_format.Assign(FramebufferRegs::ColorFormat::RGBA8);
+    framebuffer.depth_format.Assign(FramebufferRegs::DepthFormat::D24S8);
+    framebuffer.allow_color_write.Assign(1);
+    framebuffer.allow_depth_stencil_write.Assign(1);
+
+    // Every fragment passes the depth test, so that all of them run through the whole pipeline
+    auto& output_merger = regs.framebuffer.output_merger;
+    output_merger.logic_op.Assign(FramebufferRegs::LogicOp::Copy);
+    output_merger.depth_test_enable.Assign(1);
+    output_merger.depth_test_func.Assign(FramebufferRegs::CompareFunc::Always);
+    output_merger.depth_write_enable.Assign(1);
+    output_merger.red_enable.Assign(1);
+    output_merger.green_enable.Assign(1);
+    output_merger.blue_enable.Assign(1);
+    output_merger.alpha_enable.Assign(1);
+
+    regs.rasterizer.cull_mode.Assign(RasterizerRegs::CullMode::KeepAll);
+    // float24 encoding of 1.0
+    regs.rasterizer.viewport_depth_range.Assign(0x3F0000);
+
+    regs.lighting.disable.Assign(1);
+
+    // Stages 1-5 pass the previous result through
+    auto& texturing = regs.texturing;
+    SetTevStage(texturing.tev_stage0, 0x000, 0x0, 0x0);
+    for (auto* stage : {&texturing.tev_stage1, &texturing.tev_stage2, &texturing.tev_stage3,
+                        &texturing.tev_stage4, &texturing.tev_stage5}) {
+        SetTevStage(*stage, 0xF000F, 0x0, 0x0);
+    }
+}
+
+void ConfigureFlat() {}
+
+/// Samples texture 0 and modulates it with the vertex color. The software rasterizer ignores the
+/// texture filters and always samples the nearest texel, so there are no cases per filter.
+void ConfigureTextured(TexturingRegs::TextureFormat format) {
+    auto& texturing = Pica::g_state.regs.texturing;
+    texturing.main_config.texture0_enable.Assign(1);
+    texturing.texture0.address.Assign(TEXTURE_ADDR / 8);
+    texturing.texture0.width.Assign(TEXTURE_SIZE);
+    texturing.texture0.height.Assign(TEXTURE_SIZE);
+    texturing.texture0.mag_filter.Assign(TexturingRegs::TextureConfig::Nearest);
+    texturing.texture0.min_filter.Assign(TexturingRegs::TextureConfig::Nearest);
+    texturing.texture0.wrap_s.Assign(TexturingRegs::TextureConfig::Repeat);
+    texturing.texture0.wrap_t.Assign(TexturingRegs::TextureConfig::Repeat);
+    texturing.texture0.type.Assign(TexturingRegs::TextureConfig::Texture2D);
+    texturing.texture0_format.Assign(format);
+
+    // Texture0 * PrimaryColor
+    SetTevStage(texturing.tev_stage0, 0x30030, 0x0, 0x10001);
+}
+
+/// One positional light, combined as PrimaryFragmentColor * Texture0 + SecondaryFragmentColor
+void ConfigureLit() {
+    ConfigureTextured(TexturingRegs::TextureFormat::RGBA8);
+
+    auto& lighting = Pica::g_state.regs.lighting;
+    lighting.disable.Assign(0);
+    lighting.max_light_index.Assign(0);
+    lighting.config0.config.Assign(LightingRegs::LightingConfig::Config7);
+    lighting.global_ambient.r.Assign(0x40);
+    lighting.global_ambient.g.Assign(0x40);
+    lighting.global_ambient.b.Assign(0x40);
+
+    auto& light = lighting.light[0];
+    light.diffuse.r.Assign(0x300);
+    light.diffuse.g.Assign(0x300);
+    light.diffuse.b.Assign(0x300);
+    light.specular_0.r.Assign(0x200);
+    light.specular_0.g.Assign(0x200);
+    light.specular_0.b.Assign(0x200);
+    light.x.Assign(FLOAT16_0_5);
+    light.y.Assign(FLOAT16_0_5);
+    light.z.Assign(FLOAT16_1_0);
+
+    for (auto& lut : Pica::g_state.lighting.luts) {
+        for (std::size_t i = 0; i < lut.size(); ++i) {
+            lut[i].raw = 0;
+            lut[i].value.Assign(static_cast<u32>(i * 4095 / (lut.size() - 1)));
+        }
+    }
+
+    auto& texturing = Pica::g_state.regs.texturing;
+    SetTevStage(texturing.tev_stage0, 0x231, 0x0, 0x80008);
+}
+
+/// Procedural texture with noise, output directly
+void ConfigureProcTex() {
+    auto& texturing = Pica::g_state.regs.texturing;
+    texturing.main_config.texture3_enable.Assign(1);
+    texturing.main_config.texture3_coordinates.Assign(0);
+    texturing.proctex.u_clamp.Assign(TexturingRegs::ProcTexClamp::MirroredRepeat);
+    texturing.proctex.v_clamp.Assign(TexturingRegs::ProcTexClamp::MirroredRepeat);
+    texturing.proctex.color_combiner.Assign(TexturingRegs::ProcTexCombiner::SqrtAdd2);
+    texturing.proctex.alpha_combiner.Assign(TexturingRegs::ProcTexCombiner::Max);
+    texturing.proctex.separate_alpha.Assign(1);
+    texturing.proctex.noise_enable.Assign(1);
+    texturing.proctex_noise_u.amplitude.Assign(0x800);
+    texturing.proctex_noise_v.amplitude.Assign(0x800);
+    texturing.proctex_noise_frequency.u.Assign(FLOAT16_0_3);
+    texturing.proctex_noise_frequency.v.Assign(FLOAT16_0_3);
+    texturing.proctex_lut.filter.Assign(TexturingRegs::ProcTexFilter::Linear);
+    texturing.proctex_lut.width.Assign(0xFF);
+
+    auto& proctex = Pica::g_state.proctex;
+    for (std::size_t i = 0; i < proctex.noise_table.size(); ++i) {
+        const u32 value = static_cast<u32>(i * 4095 / proctex.noise_table.size());
+        for (auto* table : {&proctex.noise_table, &proctex.color_map_table,
+                            &proctex.alpha_map_table}) {
+            (*table)[i].raw = 0;
+            (*table)[i].value.Assign(value);
+            (*table)[i].difference.Assign(32);
+        }
+    }
+    for (std::size_t i = 0; i < proctex.color_table.size(); ++i) {
+        proctex.color_table[i].raw = static_cast<u32>(i * 0x01010101);
+        proctex.color_diff_table[i].raw = 0;
+    }
+
+    // Texture3
+    SetTevStage(texturing.tev_stage0, 0x60006, 0x0, 0x0);
+}
+
+/// Vertex color blended with a linear fog LUT
+void ConfigureFog() {
+    auto& texturing = Pica::g_state.regs.texturing;
+    texturing.fog_mode.Assign(TexturingRegs::FogMode::Fog);
+    texturing.fog_color.r.Assign(0x80);
+    texturing.fog_color.g.Assign(0x90);
+    texturing.fog_color.b.Assign(0xA0);
+
+    auto& lut = Pica::g_state.fog.lut;
+    for (std::size_t i = 0; i < lut.size(); ++i) {
+        lut[i].raw = 0;
+        lut[i].value.Assign(static_cast<u32>(2047 - i * 2047 / (lut.size() - 1)));
+        lut[i].difference.Assign(-16);
+    }
+}
+
+/// Writes depth and the green channel into a shadow map
+void ConfigureShadow() {
+    auto& framebuffer = Pica::g_state.regs.framebuffer;
+    framebuffer.output_merger.fragment_operation_mode.Assign(
+        FramebufferRegs::FragmentOperationMode::Shadow);
+    framebuffer.shadow.constant.Assign(FLOAT16_1_0);
+    framebuffer.shadow.linear.Assign(FLOAT16_0_5);
+}
+
+void ConfigureAlphaBlend(FramebufferRegs::BlendEquation equation) {
+    auto& output_merger = Pica::g_state.regs.framebuffer.output_merger;
+    output_merger.alphablend_enable.Assign(1);
+    auto& alpha_blending = output_merger.alpha_blending;
+    alpha_blending.blend_equation_rgb.Assign(equation);
+    alpha_blending.blend_equation_a.Assign(equation);
+    alpha_blending.factor_source_rgb.Assign(FramebufferRegs::BlendFactor::SourceAlpha);
+    alpha_blending.factor_dest_rgb.Assign(FramebufferRegs::BlendFactor::OneMinusSourceAlpha);
+    alpha_blending.factor_source_a.Assign(FramebufferRegs::BlendFactor::One);
+    alpha_blending.factor_dest_a.Assign(FramebufferRegs::BlendFactor::Zero);
+}
+
+void ConfigureLogicOp(FramebufferRegs::LogicOp op) {
+    Pica::g_state.regs.framebuffer.output_merger.logic_op.Assign(op);
+}
+
+/// Stencil test against a reference value, incrementing on pass
+void ConfigureStencil() {
+    auto& stencil_test = Pica::g_state.regs.framebuffer.output_merger.stencil_test;
+    stencil_test.enable.Assign(1);
+    stencil_test.func.Assign(FramebufferRegs::CompareFunc::GreaterThanOrEqual);
+    stencil_test.reference_value.Assign(0x80);
+    stencil_test.input_mask.Assign(0xFF);
+    stencil_test.write_mask.Assign(0xFF);
+    stencil_test.action_depth_pass.Assign(FramebufferRegs::StencilAction::IncrementWrap);
+}
+
+template <typename Configure>
+void RasterizeScene(benchmark::State& state, Configure configure, bool use_simd = true) {
+    static const Scene scene = BuildScene();
+
+    auto& memory = GetMemory();
+    VideoCore::g_memory = &memory;
+
+    // Random texture data, so that samples are not trivially uniform
+    std::mt19937 rng(0x7E47);
+    u8* texture = memory.GetPhysicalPointer(TEXTURE_ADDR);
+    std::generate_n(texture, TEXTURE_SIZE * TEXTURE_SIZE * 4, [&rng] { return rng() & 0xFF; });
+    std::memset(memory.GetPhysicalPointer(COLOR_BUFFER_ADDR), 0, FB_WIDTH * FB_HEIGHT * 4);
+    std::memset(memory.GetPhysicalPointer(DEPTH_BUFFER_ADDR), 0, FB_WIDTH * FB_HEIGHT * 4);
+
+    SetupBaseState();
+    configure();
+    Pica::Rasterizer::SetSimdRasterizationEnabled(use_simd);
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i + 2 < scene.vertices.size(); i += 3) {
+            Pica::Rasterizer::ProcessTriangle(scene.vertices[i], scene.vertices[i + 1],
+                                              scene.vertices[i + 2]);
+        }
+        benchmark::ClobberMemory();
+    }
+
+    Pica::Rasterizer::SetSimdRasterizationEnabled(true);
+    VideoCore::g_memory = nullptr;
+
+    state.counters["Mpixels"] =
+        benchmark::Counter(static_cast<double>(scene.num_pixels * state.iterations()) / 1e6,
+                           benchmark::Counter::kIsRate);
+}
+
+using TextureFormat = TexturingRegs::TextureFormat;
+
+} // Anonymous namespace
+
+BENCHMARK_CAPTURE(RasterizeScene, Flat, ConfigureFlat);
+BENCHMARK_CAPTURE(RasterizeScene, FlatScalarCoverage, ConfigureFlat, false);
+BENCHMARK_CAPTURE(RasterizeScene, TexturedRGBA8, [] { ConfigureTextured(TextureFormat::RGBA8); });
+BENCHMARK_CAPTURE(RasterizeScene, TexturedRGB565, [] { ConfigureTextured(TextureFormat::RGB565); });
+BENCHMARK_CAPTURE(RasterizeScene, TexturedETC1, [] { ConfigureTextured(TextureFormat::ETC1); });
+BENCHMARK_CAPTURE(RasterizeScene, Lit, ConfigureLit);
+BENCHMARK_CAPTURE(RasterizeScene, ProcTex, ConfigureProcTex);
+BENCHMARK_CAPTURE(RasterizeScene, Fog, ConfigureFog);
+BENCHMARK_CAPTURE(RasterizeScene, Shadow, ConfigureShadow);
+BENCHMARK_CAPTURE(RasterizeScene, Stencil, ConfigureStencil);
+BENCHMARK_CAPTURE(RasterizeScene, BlendAdd,
+                  [] { ConfigureAlphaBlend(FramebufferRegs::BlendEquation::Add); });
+BENCHMARK_CAPTURE(RasterizeScene, BlendReverseSubtract,
+                  [] { ConfigureAlphaBlend(FramebufferRegs::BlendEquation::ReverseSubtract); });
+BENCHMARK_CAPTURE(RasterizeScene, BlendMax,
+                  [] { ConfigureAlphaBlend(FramebufferRegs::BlendEquation::Max); });
+BENCHMARK_CAPTURE(RasterizeScene, LogicOpXor,
+                  [] { ConfigureLogicOp(FramebufferRegs::LogicOp::Xor); });
+BENCHMARK_CAPTURE(RasterizeScene, LogicOpNand,
+                  [] { ConfigureLogicOp(FramebufferRegs::LogicOp::Nand); });
@@ -0,0 +1,174 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <catch2/catch.hpp>
+#include "video_core/regs_texturing.h"
+#include "video_core/swrasterizer/tev_program.h"
+#include "video_core/swrasterizer/texturing.h"
+
+using Pica::TexturingRegs;
+using TevStageConfig = Pica::TexturingRegs::TevStageConfig;
+
+namespace {
+
+struct Fragment {
+    Common::Vec4<u8> primary_color;
+    Common::Vec4<u8> primary_fragment_color;
+    Common::Vec4<u8> secondary_fragment_color;
+    Common::Vec4<u8> texture_color[4];
+};
+
+/// Straightforward per-stage evaluation of the texture environment, used as the reference
+Common::Vec4<u8> RunReference(const TexturingRegs& regs, const Fragment& fragment) {
+    using namespace Pica::Rasterizer;
+    using Source = TevStageConfig::Source;
+
+    Common::Vec4<u8> combiner_output = {0, 0, 0, 0};
+    Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
+    Common::Vec4<u8> next_combiner_buffer =
+        Common::MakeVec(regs.tev_combiner_buffer_color.r.Value(),
+                        regs.tev_combiner_buffer_color.g.Value(),
+                        regs.tev_combiner_buffer_color.b.Value(),
+                        regs.tev_combiner_buffer_color.a.Value())
+            .Cast<u8>();
+
+    const auto tev_stages = regs.GetTevStages();
+    for (unsigned stage_index = 0; stage_index < tev_stages.size(); ++stage_index) {
+        const auto& tev_stage = tev_stages[stage_index];
+
+        auto GetSource = [&](Source source) -> Common::Vec4<u8> {
+            switch (source) {
+            case Source::PrimaryColor:
+                return fragment.primary_color;
+            case Source::PrimaryFragmentColor:
+                return fragment.primary_fragment_color;
+            case Source::SecondaryFragmentColor:
+                return fragment.secondary_fragment_color;
+            case Source::Texture0:
+            case Source::Texture1:
+            case Source::Texture2:
+            case Source::Texture3:
+                return fragment.texture_color[static_cast<u32>(source) -
+                                              static_cast<u32>(Source::Texture0)];
+            case Source::PreviousBuffer:
+                return combiner_buffer;
+            case Source::Constant:
+                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                    .Cast<u8>();
+            case Source::Previous:
+                return combiner_output;
+            default:
+                return {0, 0, 0, 0};
+            }
+        };
+
+        Common::Vec3<u8> color_result[3] = {
+            GetColorModifier(tev_stage.color_modifier1, GetSource(tev_stage.color_source1)),
+            GetColorModifier(tev_stage.color_modifier2, GetSource(tev_stage.color_source2)),
+            GetColorModifier(tev_stage.color_modifier3, GetSource(tev_stage.color_source3)),
+        };
+        auto color_output = ColorCombine(tev_stage.color_op, color_result);
+
+        u8 alpha_output;
+        if (tev_stage.color_op == TevStageConfig::Operation::Dot3_RGBA) {
+            alpha_output = color_output.x;
+        } else {
+            std::array<u8, 3> alpha_result = {{
+                GetAlphaModifier(tev_stage.alpha_modifier1, GetSource(tev_stage.alpha_source1)),
+                GetAlphaModifier(tev_stage.alpha_modifier2, GetSource(tev_stage.alpha_source2)),
+                GetAlphaModifier(tev_stage.alpha_modifier3, GetSource(tev_stage.alpha_source3)),
+            }};
+            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            combiner_output[i] = std::min(255u, color_output[i] * tev_stage.GetColorMultiplier());
+        }
+        combiner_output[3] = std::min(255u, alpha_output * tev_stage.GetAlphaMultiplier());
+
+        combiner_buffer = next_combiner_buffer;
+        if (regs.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(stage_index)) {
+            next_combiner_buffer.r() = combiner_output.r();
+            next_combiner_buffer.g() = combiner_output.g();
+            next_combiner_buffer.b() = combiner_output.b();
+        }
+        if (regs.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(stage_index)) {
+            next_combiner_buffer.a() = combiner_output.a();
+        }
+    }
+
+    return combiner_output;
+}
+
+void RandomizeStage(std::mt19937& rng, TevStageConfig& stage, bool pass_through) {
+    constexpr std::array<u32, 10> sources = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0xd, 0xe, 0xf};
+    constexpr std::array<u32, 10> color_modifiers = {0x0, 0x1, 0x2, 0x3, 0x4,
+                                                     0x5, 0x8, 0x9, 0xc, 0xd};
+    auto Pick = [&rng](const auto& values) {
+        return values[std::uniform_int_distribution<std::size_t>(0, values.size() - 1)(rng)];
+    };
+    auto Random = [&rng](u32 max) { return std::uniform_int_distribution<u32>(0, max)(rng); };
+
+    stage.sources_raw = Pick(sources) | Pick(sources) << 4 | Pick(sources) << 8 |
+                        Pick(sources) << 16 | Pick(sources) << 20 | Pick(sources) << 24;
+    stage.modifiers_raw = Pick(color_modifiers) | Pick(color_modifiers) << 4 |
+                          Pick(color_modifiers) << 8 | Random(7) << 12 | Random(7) << 16 |
+                          Random(7) << 20;
+    stage.ops_raw = Random(9) | Random(9) << 16;
+    stage.const_color = Random(0xFFFFFFFF);
+    stage.scales_raw = Random(3) | Random(3) << 16;
+
+    if (pass_through) {
+        stage.sources_raw = 0xf | 0xf << 16;
+        stage.modifiers_raw = 0;
+        stage.ops_raw = 0;
+        stage.scales_raw = 0;
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TEV program matches per-stage evaluation", "[video_core][swrasterizer]") {
+    std::mt19937 rng(0x7E5);
+    auto RandomColor = [&rng] {
+        std::uniform_int_distribution<u32> dist(0, 255);
+        return Common::MakeVec<u32>(dist(rng), dist(rng), dist(rng), dist(rng)).Cast<u8>();
+    };
+
+    for (int config = 0; config < 2000; ++config) {
+        TexturingRegs regs;
+        std::memset(&regs, 0, sizeof(regs));
+        TevStageConfig* const stages[] = {&regs.tev_stage0, &regs.tev_stage1, &regs.tev_stage2,
+                                          &regs.tev_stage3, &regs.tev_stage4, &regs.tev_stage5};
+        for (TevStageConfig* stage : stages) {
+            RandomizeStage(rng, *stage, std::uniform_int_distribution<int>(0, 3)(rng) == 0);
+        }
+        regs.tev_combiner_buffer_input.update_mask_rgb.Assign(rng() & 0xF);
+        regs.tev_combiner_buffer_input.update_mask_a.Assign(rng() & 0xF);
+        regs.tev_combiner_buffer_color.raw = static_cast<u32>(rng());
+
+        const Pica::Rasterizer::TevProgram program(regs);
+        for (int i = 0; i < 16; ++i) {
+            Fragment fragment;
+            fragment.primary_color = RandomColor();
+            fragment.primary_fragment_color = RandomColor();
+            fragment.secondary_fragment_color = RandomColor();
+            for (auto& color : fragment.texture_color) {
+                color = RandomColor();
+            }
+
+            const auto expected = RunReference(regs, fragment);
+            const auto result =
+                program.Run(fragment.primary_color, fragment.primary_fragment_color,
+                            fragment.secondary_fragment_color, fragment.texture_color);
+            for (int c = 0; c < 4; ++c) {
+                REQUIRE(result[c] == expected[c]);
+            }
+        }
+    }
+}
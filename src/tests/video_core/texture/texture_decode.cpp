@@ -0,0 +1,107 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "tests/random_data.h"
+#include "video_core/texture/texture_decode.h"
+
+using Pica::TexturingRegs;
+using TextureFormat = TexturingRegs::TextureFormat;
+using Tests::RandomData;
+
+namespace {
+
+constexpr std::array<TextureFormat, 14> formats = {
+    TextureFormat::RGBA8, TextureFormat::RGB8,  TextureFormat::RGB5A1, TextureFormat::RGB565,
+    TextureFormat::RGBA4, TextureFormat::IA8,   TextureFormat::RG8,    TextureFormat::I8,
+    TextureFormat::A8,    TextureFormat::IA4,   TextureFormat::I4,     TextureFormat::A4,
+    TextureFormat::ETC1,  TextureFormat::ETC1A4,
+};
+
+bool Equal(const Common::Vec4<u8>& a, const Common::Vec4<u8>& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+Pica::Texture::TextureInfo MakeInfo(TextureFormat format, unsigned width, unsigned height) {
+    Pica::Texture::TextureInfo info{};
+    info.width = width;
+    info.height = height;
+    info.format = format;
+    info.SetDefaultStride();
+    return info;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DecodeTile matches LookupTexelInTile", "[video_core][texture_decode]") {
+    const std::vector<u8> data = RandomData(16 * 8 * 8 * 4);
+
+    for (const TextureFormat format : formats) {
+        const auto info = MakeInfo(format, 8, 8);
+        const std::size_t tile_size = Pica::Texture::CalculateTileSize(format);
+        for (std::size_t offset = 0; offset + tile_size <= data.size(); offset += tile_size) {
+            std::array<Common::Vec4<u8>, 64> texels;
+            Pica::Texture::DecodeTile(data.data() + offset, format, texels.data());
+            for (unsigned y = 0; y < 8; ++y) {
+                for (unsigned x = 0; x < 8; ++x) {
+                    const auto expected = Pica::Texture::LookupTexelInTile(
+                        data.data() + offset, x, y, info, false);
+                    INFO("format " << static_cast<u32>(format) << ", texel " << x << ", " << y);
+                    REQUIRE(Equal(texels[y * 8 + x], expected));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("DecodeTexture decodes a flipped sub-rectangle", "[video_core][texture_decode]") {
+    constexpr unsigned width = 32;
+    constexpr unsigned height = 24;
+    const std::vector<u8> data = RandomData(width * height * 4);
+
+    for (const TextureFormat format : formats) {
+        const auto info = MakeInfo(format, width, height);
+        std::vector<u8> result(width * height * 4, 0xCD);
+        // Rows are stored bottom to top, like the OpenGL rasterizer cache does
+        u8* const last_row = result.data() + (height - 1) * width * 4;
+        Pica::Texture::DecodeTexture(data.data(), info, 3, 5, 29, 19, last_row,
+                                     -static_cast<std::ptrdiff_t>(width * 4));
+
+        for (unsigned y = 0; y < height; ++y) {
+            for (unsigned x = 0; x < width; ++x) {
+                const u8* texel = last_row - static_cast<std::ptrdiff_t>(y * width * 4) + x * 4;
+                INFO("format " << static_cast<u32>(format) << ", texel " << x << ", " << y);
+                if (x >= 3 && x < 29 && y >= 5 && y < 19) {
+                    const auto expected = Pica::Texture::LookupTexture(data.data(), x, y, info);
+                    REQUIRE(Equal(Common::MakeVec(texel[0], texel[1], texel[2], texel[3]),
+                                  expected));
+                } else {
+                    REQUIRE(Equal(Common::MakeVec(texel[0], texel[1], texel[2], texel[3]),
+                                  Common::MakeVec<u8>(0xCD, 0xCD, 0xCD, 0xCD)));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("TileCache matches LookupTexture", "[video_core][texture_decode]") {
+    constexpr unsigned width = 16;
+    constexpr unsigned height = 16;
+    const std::vector<u8> data = RandomData(width * height * 4);
+    std::mt19937 rng(0xCAC4E);
+
+    for (const TextureFormat format : formats) {
+        const auto info = MakeInfo(format, width, height);
+        Pica::Texture::TileCache cache;
+        for (int i = 0; i < 1000; ++i) {
+            const unsigned x = rng() % width;
+            const unsigned y = rng() % height;
+            REQUIRE(Equal(cache.LookupTexture(data.data(), x, y, info),
+                          Pica::Texture::LookupTexture(data.data(), x, y, info)));
+        }
+    }
+}
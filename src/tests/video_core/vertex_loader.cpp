@@ -0,0 +1,178 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/memory.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs_pipeline.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader.h"
+#include "video_core/video_core.h"
+
+using Pica::float24;
+using Pica::PipelineRegs;
+using Format = PipelineRegs::VertexAttributeFormat;
+
+constexpr PAddr VERTEX_DATA_ADDR = Memory::VRAM_PADDR;
+constexpr u32 VERTEX_DATA_SIZE = 0x10000;
+
+namespace {
+
+/// Raw access to the vertex attribute registers, which mostly consist of anonymous bit fields
+class AttributeConfig {
+public:
+    explicit AttributeConfig(PipelineRegs& regs)
+        : words(reinterpret_cast<u32*>(&regs.vertex_attributes)) {
+        std::memset(&regs, 0, sizeof(regs));
+        regs.vertex_attributes.base_address.Assign(VERTEX_DATA_ADDR / 16);
+    }
+
+    void SetFormat(unsigned attribute, Format format, u32 elements) {
+        u32& word = words[1 + attribute / 8];
+        const unsigned shift = (attribute % 8) * 4;
+        word &= ~(0xF << shift);
+        word |= (static_cast<u32>(format) | ((elements - 1) << 2)) << shift;
+    }
+
+    void SetDefaultMaskAndCount(u32 mask, u32 num_total_attributes) {
+        words[2] = (words[2] & 0xFFFF) | (mask << 16) | ((num_total_attributes - 1) << 28);
+    }
+
+    void SetLoader(unsigned loader, u32 data_offset, const std::vector<u32>& components,
+                   u32 byte_count) {
+        u32* loader_words = &words[3 + loader * 3];
+        loader_words[0] = data_offset;
+        loader_words[1] = 0;
+        loader_words[2] = (byte_count << 16) | (static_cast<u32>(components.size()) << 28);
+        for (std::size_t i = 0; i < components.size(); ++i) {
+            loader_words[1 + i / 8] |= components[i] << ((i % 8) * 4);
+        }
+    }
+
+private:
+    u32* words;
+};
+
+Pica::Shader::AttributeBuffer LoadVertex(const PipelineRegs& regs, int vertex) {
+    Pica::Shader::AttributeBuffer input;
+    std::memset(&input, 0xAB, sizeof(input));
+    Pica::DebugUtils::MemoryAccessTracker memory_accesses;
+    Pica::VertexLoader(regs).LoadVertex(vertex, vertex, input, memory_accesses);
+    return input;
+}
+
+bool MatchesFloats(const Common::Vec4<float24>& attribute, float x, float y, float z, float w) {
+    return attribute.x.ToFloat32() == x && attribute.y.ToFloat32() == y &&
+           attribute.z.ToFloat32() == z && attribute.w.ToFloat32() == w;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("VertexLoader loads all attribute formats", "[video_core]") {
+    Memory::MemorySystem memory;
+    VideoCore::g_memory = &memory;
+    u8* data = memory.GetPhysicalPointer(VERTEX_DATA_ADDR);
+
+    PipelineRegs regs;
+    AttributeConfig config(regs);
+    config.SetFormat(0, Format::FLOAT, 3);
+    config.SetFormat(1, Format::UBYTE, 4);
+    config.SetFormat(2, Format::SHORT, 2);
+    config.SetFormat(3, Format::BYTE, 1);
+    config.SetFormat(5, Format::FLOAT, 4);
+    // Attribute 4 uses its default value, attribute 6 is not loaded at all
+    config.SetDefaultMaskAndCount(1 << 4, 7);
+    // Component 12 is a 4-byte padding
+    config.SetLoader(0, 0, {0, 1, 12, 2}, 24);
+    config.SetLoader(1, 0x1000, {3}, 1);
+    config.SetLoader(2, 0x2000, {5}, 16);
+
+    for (int vertex = 0; vertex < 8; ++vertex) {
+        const float position[3] = {vertex + 0.5f, -vertex * 2.0f, 100.0f};
+        const u8 color[4] = {static_cast<u8>(vertex), 0x80, 0xFF, 0x01};
+        const s16 texcoord[2] = {static_cast<s16>(-vertex), 0x7FFF};
+        const s8 weight = static_cast<s8>(-vertex - 1);
+        const float normal[4] = {1.0f, 2.0f, 3.0f, static_cast<float>(vertex)};
+        std::memcpy(data + vertex * 24, position, sizeof(position));
+        std::memcpy(data + vertex * 24 + 12, color, sizeof(color));
+        std::memcpy(data + vertex * 24 + 20, texcoord, sizeof(texcoord));
+        std::memcpy(data + 0x1000 + vertex, &weight, sizeof(weight));
+        std::memcpy(data + 0x2000 + vertex * 16, normal, sizeof(normal));
+    }
+    Pica::g_state.input_default_attributes.attr[4] =
+        Common::MakeVec(float24::FromFloat32(4.0f), float24::FromFloat32(3.0f),
+                        float24::FromFloat32(2.0f), float24::FromFloat32(1.0f));
+
+    for (const bool use_jit : {false, true}) {
+#ifndef ARCHITECTURE_x86_64
+        if (use_jit) {
+            continue;
+        }
+#endif
+        VideoCore::g_shader_jit_enabled = use_jit;
+        for (int vertex = 0; vertex < 8; ++vertex) {
+            const auto input = LoadVertex(regs, vertex);
+            const float v = static_cast<float>(vertex);
+            REQUIRE(MatchesFloats(input.attr[0], v + 0.5f, -v * 2.0f, 100.0f, 1.0f));
+            REQUIRE(MatchesFloats(input.attr[1], v, 128.0f, 255.0f, 1.0f));
+            REQUIRE(MatchesFloats(input.attr[2], -v, 32767.0f, 0.0f, 1.0f));
+            REQUIRE(MatchesFloats(input.attr[3], -v - 1.0f, 0.0f, 0.0f, 1.0f));
+            REQUIRE(MatchesFloats(input.attr[4], 4.0f, 3.0f, 2.0f, 1.0f));
+            REQUIRE(MatchesFloats(input.attr[5], 1.0f, 2.0f, 3.0f, v));
+        }
+    }
+
+    VideoCore::g_shader_jit_enabled = false;
+    VideoCore::g_memory = nullptr;
+}
+
+#ifdef ARCHITECTURE_x86_64
+TEST_CASE("VertexLoader JIT matches the template loader", "[video_core][vertex_loader_jit]") {
+    Memory::MemorySystem memory;
+    VideoCore::g_memory = &memory;
+    u8* data = memory.GetPhysicalPointer(VERTEX_DATA_ADDR);
+
+    std::mt19937 rng(0x10AD);
+    auto Random = [&rng](u32 max) { return std::uniform_int_distribution<u32>(0, max)(rng); };
+    for (u32 i = 0; i < VERTEX_DATA_SIZE; ++i) {
+        data[i] = static_cast<u8>(Random(0xFF));
+    }
+    for (auto& attribute : Pica::g_state.input_default_attributes.attr) {
+        for (int comp = 0; comp < 4; ++comp) {
+            attribute[comp] = float24::FromFloat32(static_cast<float>(Random(100)));
+        }
+    }
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        PipelineRegs regs;
+        AttributeConfig config(regs);
+        for (unsigned attribute = 0; attribute < 12; ++attribute) {
+            config.SetFormat(attribute, static_cast<Format>(Random(3)), Random(3) + 1);
+        }
+        config.SetDefaultMaskAndCount(Random(0xFFF), Random(15) + 1);
+        for (unsigned loader = 0; loader < 3; ++loader) {
+            std::vector<u32> components(Random(12));
+            for (u32& component : components) {
+                component = Random(15);
+            }
+            config.SetLoader(loader, Random(0x100), components, Random(0xFF));
+        }
+
+        for (int vertex = 0; vertex < 64; ++vertex) {
+            VideoCore::g_shader_jit_enabled = false;
+            const auto expected = LoadVertex(regs, vertex);
+            VideoCore::g_shader_jit_enabled = true;
+            const auto result = LoadVertex(regs, vertex);
+            REQUIRE(std::memcmp(&expected, &result, sizeof(result)) == 0);
+        }
+    }
+
+    VideoCore::g_shader_jit_enabled = false;
+    VideoCore::g_memory = nullptr;
+}
+#endif // ARCHITECTURE_x86_64
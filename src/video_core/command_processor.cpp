@@ -2,13 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
@@ -38,6 +41,92 @@ static const u32 expand_bits_to_bytes[] = {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+namespace {
+
+/**
+ * Set-associative post-transform vertex cache used by indexed draws.
+ *
+ * Entries are tagged with the vertex index and the generation of the vertex processing state
+ * (vertex attribute layout, default attributes and vertex shader setup) they were shaded with.
+ * The cache persists across draw calls, so consecutive draws sharing the same vertex buffers and
+ * shader setup reuse each other's vertices. Any change to that state bumps the generation, which
+ * invalidates all entries at once.
+ */
+class VertexCache {
+public:
+    /// Returns the cached shader output of the given vertex, or nullptr if it is not cached
+    const Shader::AttributeBuffer* Lookup(u32 vertex) const {
+        const Set& set = sets[vertex % NUM_SETS];
+        for (std::size_t way = 0; way < NUM_WAYS; ++way) {
+            if (set.tags[way] == vertex && set.generations[way] == generation) {
+                return &set.outputs[way];
+            }
+        }
+        return nullptr;
+    }
+
+    void Insert(u32 vertex, const Shader::AttributeBuffer& output) {
+        Set& set = sets[vertex % NUM_SETS];
+        const std::size_t way = set.next_way;
+        set.next_way = (set.next_way + 1) % NUM_WAYS;
+        set.tags[way] = vertex;
+        set.generations[way] = generation;
+        set.outputs[way] = output;
+    }
+
+    void Invalidate() {
+        if (++generation == 0) {
+            // Stale entries must not become valid again once the counter wraps around
+            for (Set& set : sets) {
+                set.generations.fill(0);
+            }
+            generation = 1;
+        }
+    }
+
+private:
+    // Indices are mostly local within a mesh, so mapping them to sets directly spreads them well
+    static constexpr std::size_t NUM_SETS = 256;
+    static constexpr std::size_t NUM_WAYS = 4;
+
+    struct Set {
+        // Tags are kept apart from the outputs so that a lookup only touches a single cache line
+        std::array<u32, NUM_WAYS> tags{};
+        std::array<u32, NUM_WAYS> generations{};
+        std::size_t next_way = 0;
+        std::array<Shader::AttributeBuffer, NUM_WAYS> outputs;
+    };
+
+    std::array<Set, NUM_SETS> sets{};
+    u32 generation = 1;
+};
+
+} // Anonymous namespace
+
+static VertexCache vertex_cache;
+
+/// Returns true if writing the register may change the vertices produced by the vertex shader
+static bool IsVertexProcessingReg(u32 id) {
+    constexpr std::size_t shader_regs_size = sizeof(ShaderRegs) / sizeof(u32);
+    return (id >= PICA_REG_INDEX(pipeline.vertex_attributes) &&
+            id < PICA_REG_INDEX(pipeline.index_array)) ||
+           (id >= PICA_REG_INDEX(pipeline.vs_default_attributes_setup) &&
+            id < PICA_REG_INDEX(pipeline.command_buffer)) ||
+           id == PICA_REG_INDEX(pipeline.max_input_attrib_index) ||
+           (id >= PICA_REG_INDEX(vs) && id < PICA_REG_INDEX(vs) + shader_regs_size);
+}
+
+/// Returns true if writing the register uploads data, even if the register value is unchanged
+static bool IsVertexProcessingDataPort(u32 id) {
+    auto InRange = [id](std::size_t first, std::size_t count) {
+        return id >= first && id < first + count;
+    };
+    return InRange(PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value), 3) ||
+           InRange(PICA_REG_INDEX(vs.uniform_setup.set_value), 8) ||
+           InRange(PICA_REG_INDEX(vs.program.set_word), 8) ||
+           InRange(PICA_REG_INDEX(vs.swizzle_patterns.set_word), 8);
+}
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -108,6 +197,37 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
+/// Minimum number of vertices a draw has to shade for the work to be split between threads
+constexpr std::size_t MIN_PARALLEL_VERTICES = 256;
+
+/// Number of consecutive vertices shaded by a single task
+constexpr std::size_t VERTEX_CHUNK_SIZE = 64;
+
+/**
+ * Loads the given vertices and runs the vertex shader on them. The vertices are split into chunks
+ * which are shaded concurrently on the worker pool, each using its own shader unit.
+ */
+static void ShadeVertices(Common::ThreadPool& pool, Shader::ShaderEngine& engine,
+                          const VertexLoader& loader, const std::vector<u32>& vertices,
+                          std::vector<Shader::AttributeBuffer>& outputs) {
+    outputs.resize(vertices.size());
+    const std::size_t num_chunks = (vertices.size() + VERTEX_CHUNK_SIZE - 1) / VERTEX_CHUNK_SIZE;
+    pool.ParallelFor(num_chunks, [&](std::size_t chunk) {
+        const std::size_t begin = chunk * VERTEX_CHUNK_SIZE;
+        const std::size_t end = std::min(begin + VERTEX_CHUNK_SIZE, vertices.size());
+
+        Shader::UnitState shader_unit;
+        DebugUtils::MemoryAccessTracker memory_accesses;
+        for (std::size_t i = begin; i < end; ++i) {
+            Shader::AttributeBuffer input;
+            loader.LoadVertex(static_cast<int>(i), vertices[i], input, memory_accesses);
+            shader_unit.LoadInput(g_state.regs.vs, input);
+            engine.Run(g_state.vs, shader_unit);
+            shader_unit.WriteOutput(g_state.regs.vs, outputs[i]);
+        }
+    });
+}
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -126,6 +246,11 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
     regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
 
+    if (IsVertexProcessingReg(id) &&
+        (regs.reg_array[id] != old_value || IsVertexProcessingDataPort(id))) {
+        vertex_cache.Invalidate();
+    }
+
     // Double check for is_pica_tracing to avoid call overhead
     if (DebugUtils::IsPicaTracing()) {
         DebugUtils::OnPicaRegWrite({(u16)id, (u16)mask, regs.reg_array[id]});
@@ -138,6 +263,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
+        VideoCore::g_renderer->Rasterizer()->NotifyCommandListEnd();
         Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
         break;
 
@@ -309,8 +435,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         }
 
         // Processes information about internal vertex attributes to figure out how a vertex is
-        // loaded.
-        // Later, these can be compiled and cached.
+        // loaded. The loader routine itself is compiled and cached per attribute layout.
         const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
         VertexLoader loader(regs.pipeline);
         Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
@@ -340,16 +465,14 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         DebugUtils::MemoryAccessTracker memory_accesses;
 
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const std::size_t VERTEX_CACHE_SIZE = 32;
-        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
+        // Vertices reused from a previous draw would not be reported to the recorder
+        if (g_debug_context && g_debug_context->recorder) {
+            vertex_cache.Invalidate();
+        }
+        unsigned int vertex_cache_hits = 0;
+        unsigned int vertex_cache_misses = 0;
         Shader::AttributeBuffer vs_output;
 
-        unsigned int vertex_cache_pos = 0;
-
         auto* shader_engine = Shader::GetEngine();
         Shader::UnitState shader_unit;
 
@@ -360,39 +483,102 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         if (g_state.geometry_pipeline.NeedIndexInput())
             ASSERT(is_indexed);
 
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
+        // Large draws are shaded in parallel up front and then submitted in order. This is skipped
+        // while debugging, since the debugger expects to observe each shader invocation.
+        Common::ThreadPool* const worker_pool = Shader::GetWorkerPool();
+        const bool shade_in_parallel = worker_pool != nullptr && !g_debug_context &&
+                                       !g_state.geometry_pipeline.NeedIndexInput() &&
+                                       regs.pipeline.num_vertices >= MIN_PARALLEL_VERTICES;
 
-            bool vertex_cache_hit = false;
+        auto GetVertex = [&](unsigned int index) -> u32 {
+            // Indexed rendering doesn't use the start offset
+            return is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                              : (index + regs.pipeline.vertex_offset);
+        };
+
+        if (shade_in_parallel) {
+            // Vertices that have to be shaded, and the cached output to use for each index if any
+            static std::vector<u32> pending_vertices;
+            static std::vector<Shader::AttributeBuffer> shaded_vertices;
+            static std::vector<const Shader::AttributeBuffer*> cached_outputs;
+            pending_vertices.clear();
+            cached_outputs.assign(regs.pipeline.num_vertices, nullptr);
+
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                const u32 vertex = GetVertex(index);
+                if (is_indexed) {
+                    cached_outputs[index] = vertex_cache.Lookup(vertex);
+                }
+                if (cached_outputs[index] == nullptr) {
+                    pending_vertices.push_back(vertex);
+                }
+            }
 
+            // Vertices referenced several times within the draw are only shaded once
             if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
+                std::sort(pending_vertices.begin(), pending_vertices.end());
+                pending_vertices.erase(
+                    std::unique(pending_vertices.begin(), pending_vertices.end()),
+                    pending_vertices.end());
+            }
+
+            ShadeVertices(*worker_pool, *shader_engine, loader, pending_vertices, shaded_vertices);
+
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                const Shader::AttributeBuffer* output = cached_outputs[index];
+                if (output == nullptr) {
+                    const std::size_t slot =
+                        is_indexed ? std::lower_bound(pending_vertices.begin(),
+                                                      pending_vertices.end(), GetVertex(index)) -
+                                         pending_vertices.begin()
+                                   : index;
+                    output = &shaded_vertices[slot];
                 }
 
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
+                // Send to geometry pipeline
+                g_state.geometry_pipeline.SubmitVertex(*output);
+            }
+
+            // The cache is only updated once all vertices have been submitted, since inserting
+            // may evict entries that are still referenced by cached_outputs
+            if (is_indexed) {
+                vertex_cache_misses = static_cast<unsigned int>(pending_vertices.size());
+                vertex_cache_hits = regs.pipeline.num_vertices - vertex_cache_misses;
+                for (std::size_t i = 0; i < pending_vertices.size(); ++i) {
+                    vertex_cache.Insert(pending_vertices[i], shaded_vertices[i]);
                 }
+            }
+        } else {
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                const u32 vertex = GetVertex(index);
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
+                const Shader::AttributeBuffer* cached_output = nullptr;
+
+                if (is_indexed) {
+                    if (g_state.geometry_pipeline.NeedIndexInput()) {
+                        g_state.geometry_pipeline.SubmitIndex(vertex);
+                        continue;
+                    }
+
+                    if (g_debug_context && Pica::g_debug_context->recorder) {
+                        int size = index_u16 ? 2 : 1;
+                        memory_accesses.AddAccess(base_address + index_info.offset + size * index,
+                                                  size);
                     }
+
+                    cached_output = vertex_cache.Lookup(vertex);
+                }
+
+                if (cached_output != nullptr) {
+                    ++vertex_cache_hits;
+                    // Send to geometry pipeline
+                    g_state.geometry_pipeline.SubmitVertex(*cached_output);
+                    continue;
                 }
-            }
 
-            if (!vertex_cache_hit) {
                 // Initialize data for the current vertex
                 Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+                loader.LoadVertex(index, vertex, input, memory_accesses);
 
                 // Send to vertex shader
                 if (g_debug_context)
@@ -403,17 +589,18 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                 shader_unit.WriteOutput(regs.vs, vs_output);
 
                 if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                    ++vertex_cache_misses;
+                    vertex_cache.Insert(vertex, vs_output);
                 }
-            }
 
-            // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
+                // Send to geometry pipeline
+                g_state.geometry_pipeline.SubmitVertex(vs_output);
+            }
         }
 
+        MICROPROFILE_META_CPU("Vertex cache hits", vertex_cache_hits);
+        MICROPROFILE_META_CPU("Vertex cache misses", vertex_cache_misses);
+
         for (auto& range : memory_accesses.ranges) {
             g_debug_context->recorder->MemoryAccessed(
                 VideoCore::g_memory->GetPhysicalPointer(range.first), range.second, range.first);
@@ -643,6 +830,9 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 }
 
 void ProcessCommandList(const u32* list, u32 size) {
+    // Vertex buffers may have been modified by the CPU since the last command list was processed
+    vertex_cache.Invalidate();
+
     g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
     g_state.cmd_list.length = size / sizeof(u32);
 
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include "common/chunk_file.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
@@ -57,4 +58,49 @@ void State::Reset() {
     default_attr_counter = 0;
     Zero(default_attr_write_buffer);
 }
+
+template <typename T>
+static void DoRaw(PointerWrap& p, T& o) {
+    p.DoArray(reinterpret_cast<u8*>(&o), sizeof(o));
+}
+
+static void DoShaderSetup(PointerWrap& p, Shader::ShaderSetup& setup) {
+    DoRaw(p, setup.uniforms);
+    DoRaw(p, setup.program_code);
+    DoRaw(p, setup.swizzle_data);
+    p.Do(setup.engine_data.entry_point);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        setup.engine_data.cached_shader = nullptr;
+        setup.MarkProgramCodeDirty();
+        setup.MarkSwizzleDataDirty();
+    }
+}
+
+void State::DoState(PointerWrap& p) {
+    auto section = p.Section("Pica", 1);
+    if (!section) {
+        return;
+    }
+
+    DoRaw(p, regs);
+    DoShaderSetup(p, vs);
+    DoShaderSetup(p, gs);
+    DoRaw(p, input_default_attributes);
+    DoRaw(p, proctex);
+    DoRaw(p, lighting);
+    DoRaw(p, fog);
+    DoRaw(p, immediate);
+
+    p.Do(vs_float_regs_counter);
+    DoRaw(p, vs_uniform_write_buffer);
+    p.Do(gs_float_regs_counter);
+    DoRaw(p, gs_uniform_write_buffer);
+    p.Do(default_attr_counter);
+    DoRaw(p, default_attr_write_buffer);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        Zero(cmd_list);
+        primitive_assembler.Reconfigure(regs.pipeline.triangle_topology);
+    }
+}
 } // namespace Pica
@@ -13,6 +13,8 @@
 #include "video_core/regs.h"
 #include "video_core/shader/shader.h"
 
+class PointerWrap;
+
 namespace Pica {
 
 /// Struct used to describe current Pica state
@@ -20,6 +22,13 @@ struct State {
     State();
     void Reset();
 
+    /**
+     * Saves or restores the registers, shaders and lookup tables. Vertices that are in flight in
+     * the primitive assembler or the geometry pipeline are not saved, states are only taken
+     * between command lists.
+     */
+    void DoState(PointerWrap& p);
+
     /// Pica registers
     Regs regs;
 
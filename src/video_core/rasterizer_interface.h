@@ -45,6 +45,12 @@ public:
     /// and invalidated
     virtual void FlushAndInvalidateRegion(PAddr addr, u32 size) = 0;
 
+    /// Notify rasterizer that a command list has been processed, its results may soon be read back
+    virtual void NotifyCommandListEnd() {}
+
+    /// Notify rasterizer that the whole Pica state has been replaced, e.g. by loading a save state
+    virtual void NotifyPicaStateReplaced() {}
+
     /// Attempt to use a faster method to perform a display transfer with is_texture_copy = 0
     virtual bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
         return false;
@@ -71,5 +77,8 @@ public:
     virtual bool AccelerateDrawBatch(bool is_indexed) {
         return false;
     }
+
+    /// Loads the resources stored on disk for the given title by previous runs
+    virtual void LoadDiskResources(u64 program_id) {}
 };
 } // namespace VideoCore
@@ -3,7 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <memory>
+#include "common/hash.h"
 #include "core/frontend/emu_window.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/swrasterizer/swrasterizer.h"
@@ -28,3 +33,52 @@ void RendererBase::RefreshRasterizerSetting() {
         }
     }
 }
+
+void RendererBase::NotifyFramePresented() {
+    if (frame_callback) {
+        frame_callback(HashPresentedFrame());
+    }
+}
+
+/// Hashes an image and the layout it's read with, or returns 0 if it's outside of memory
+static u64 HashFramebuffer(const GPU::Regs::FramebufferConfig& framebuffer, PAddr address) {
+    const u32 size = framebuffer.stride * framebuffer.height;
+    const u8* data = VideoCore::g_memory->GetPhysicalPointer(address);
+    if (size == 0 || data == nullptr ||
+        VideoCore::g_memory->GetPhysicalPointer(address + size - 1) != data + size - 1) {
+        return 0;
+    }
+
+    Memory::RasterizerFlushRegion(address, size);
+    const std::array<u64, 3> key{Common::ComputeHash64(data, size), framebuffer.size,
+                                 framebuffer.stride | u64{framebuffer.format} << 32};
+    return Common::ComputeStructHash64(key);
+}
+
+RendererBase::FrameHashes RendererBase::HashPresentedFrame() {
+    FrameHashes hashes{};
+    for (std::size_t i = 0; i < hashes.size(); ++i) {
+        const std::size_t fb_id = i == 2 ? 1 : 0;
+        const auto& framebuffer = GPU::g_regs.framebuffer_config[fb_id];
+
+        const u32 lcd_color_addr =
+            HW::VADDR_LCD + 4 * (fb_id == 0 ? LCD_REG_INDEX(color_fill_top)
+                                            : LCD_REG_INDEX(color_fill_bottom));
+        LCD::Regs::ColorFill color_fill{0};
+        LCD::Read(color_fill.raw, lcd_color_addr);
+        if (color_fill.is_enabled) {
+            hashes[i] = Common::ComputeStructHash64(color_fill.raw);
+            continue;
+        }
+
+        // Same choice of image as RendererOpenGL::LoadFBToScreenInfo
+        const bool right_eye =
+            i == 1 && framebuffer.address_right1 != 0 && framebuffer.address_right2 != 0;
+        const PAddr address =
+            framebuffer.active_fb == 0
+                ? (!right_eye ? framebuffer.address_left1 : framebuffer.address_right1)
+                : (!right_eye ? framebuffer.address_left2 : framebuffer.address_right2);
+        hashes[i] = HashFramebuffer(framebuffer, address);
+    }
+    return hashes;
+}
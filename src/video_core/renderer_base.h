@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <functional>
 #include <memory>
 #include "common/common_types.h"
 #include "core/core.h"
@@ -18,6 +20,12 @@ public:
     /// Used to reference a framebuffer
     enum kFramebuffer { kFramebuffer_VirtualXFB = 0, kFramebuffer_EFB, kFramebuffer_Texture };
 
+    /// Hashes of the images presented by a frame: top screen left eye, right eye, bottom screen
+    using FrameHashes = std::array<u64, 3>;
+
+    /// Called at the end of every presented frame
+    using FrameCallback = std::function<void(const FrameHashes&)>;
+
     explicit RendererBase(Frontend::EmuWindow& window);
     virtual ~RendererBase();
 
@@ -58,12 +66,28 @@ public:
 
     void RefreshRasterizerSetting();
 
+    /**
+     * Sets a function to call with the hashes of the presented images at the end of every frame.
+     * The images are only hashed while such a function is set, as this writes back the cached
+     * surfaces that hold them.
+     */
+    void SetFrameCallback(FrameCallback callback) {
+        frame_callback = std::move(callback);
+    }
+
 protected:
+    /// Calls the frame callback, if any. Must be called by the renderers when a frame is presented.
+    void NotifyFramePresented();
+
     Frontend::EmuWindow& render_window; ///< Reference to the render window handle.
     std::unique_ptr<VideoCore::RasterizerInterface> rasterizer;
     f32 m_current_fps = 0.0f; ///< Current framerate, should be set by the renderer
     int m_current_frame = 0;  ///< Current frame, should be set by the renderer
 
 private:
+    /// Hashes the images the screens display, as selected by the GPU and LCD registers
+    static FrameHashes HashPresentedFrame();
+
     bool opengl_rasterizer_active = false;
+    FrameCallback frame_callback;
 };
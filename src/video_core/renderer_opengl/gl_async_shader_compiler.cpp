@@ -0,0 +1,104 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread_pool.h"
+#include "core/core.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
+
+MICROPROFILE_DEFINE(OpenGL_AsyncShaderCompile, "OpenGL", "Async Shader Compile",
+                    MP_RGB(100, 100, 255));
+
+namespace OpenGL {
+
+AsyncShaderCompiler::Job::~Job() {
+    // Only reached on the renderer thread, for jobs finished but never taken
+    if (program != 0) {
+        glDeleteProgram(program);
+    }
+}
+
+AsyncShaderCompiler::AsyncShaderCompiler(const Frontend::EmuWindow& emu_window,
+                                         std::size_t num_threads) {
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        auto context = emu_window.CreateSharedContext();
+        if (context == nullptr) {
+            break;
+        }
+        free_contexts.push_back(context.get());
+        contexts.push_back(std::move(context));
+    }
+
+    if (contexts.empty()) {
+        LOG_WARNING(Render_OpenGL,
+                    "The frontend cannot share contexts, shaders are compiled synchronously");
+        return;
+    }
+    pool = std::make_unique<Common::ThreadPool>(contexts.size(), "ShaderCompiler");
+    LOG_INFO(Render_OpenGL, "Compiling shaders in the background on {} threads", contexts.size());
+}
+
+AsyncShaderCompiler::~AsyncShaderCompiler() {
+    // Drops the queued jobs and joins the workers before their contexts are destroyed
+    shutting_down = true;
+    pool.reset();
+}
+
+std::shared_ptr<AsyncShaderCompiler::Job> AsyncShaderCompiler::Queue(std::string source,
+                                                                     GLenum type) {
+    ASSERT(IsAvailable());
+
+    auto job = std::make_shared<Job>();
+    job->source = std::move(source);
+    job->type = type;
+    job->queue_time = std::chrono::steady_clock::now();
+
+    Core::System::GetInstance().perf_stats.SetShaderQueueDepth(++queue_depth);
+    pool->QueueWork([this, job] { Compile(*job); });
+    return job;
+}
+
+void AsyncShaderCompiler::Compile(Job& job) {
+    if (shutting_down) {
+        return;
+    }
+    MICROPROFILE_SCOPE(OpenGL_AsyncShaderCompile);
+
+    // There are as many contexts as workers, so one of them is always free here
+    Frontend::GraphicsContext* context;
+    {
+        std::lock_guard lock{context_mutex};
+        context = free_contexts.back();
+        free_contexts.pop_back();
+    }
+    context->MakeCurrent();
+
+    // The resource wrappers are avoided, as they update the state tracker of the renderer thread
+    const GLuint shader = LoadShader(job.source.c_str(), job.type);
+    job.program = LoadProgram(true, {shader});
+    glDeleteShader(shader);
+    // Makes the program complete before it becomes visible to the renderer context
+    glFinish();
+
+    context->DoneCurrent();
+    {
+        std::lock_guard lock{context_mutex};
+        free_contexts.push_back(context);
+    }
+
+    job.source.clear();
+    job.done.store(true, std::memory_order_release);
+
+    auto& perf_stats = Core::System::GetInstance().perf_stats;
+    perf_stats.AddShaderCompilation(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - job.queue_time));
+    perf_stats.SetShaderQueueDepth(--queue_depth);
+}
+
+} // namespace OpenGL
@@ -0,0 +1,83 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+
+namespace Common {
+class ThreadPool;
+}
+
+namespace Frontend {
+class EmuWindow;
+class GraphicsContext;
+} // namespace Frontend
+
+namespace OpenGL {
+
+/**
+ * Compiles and links separable programs on worker threads, each of them owning a graphics context
+ * shared with the one of the renderer.
+ */
+class AsyncShaderCompiler {
+public:
+    class Job {
+    public:
+        ~Job();
+
+        /// Returns true once the program has been linked
+        bool IsDone() const {
+            return done.load(std::memory_order_acquire);
+        }
+
+        /// Takes ownership of the linked program, must only be called once the job is done
+        GLuint TakeProgram() {
+            const GLuint result = program;
+            program = 0;
+            return result;
+        }
+
+    private:
+        friend class AsyncShaderCompiler;
+
+        std::string source;
+        GLenum type;
+        std::chrono::steady_clock::time_point queue_time;
+        GLuint program = 0;
+        std::atomic<bool> done{false};
+    };
+
+    /// Must be called while the context of the renderer is current
+    AsyncShaderCompiler(const Frontend::EmuWindow& emu_window, std::size_t num_threads);
+    ~AsyncShaderCompiler();
+
+    /// Returns false if no shared context could be created, in which case nothing can be queued
+    bool IsAvailable() const {
+        return !contexts.empty();
+    }
+
+    /// Queues the compilation of a separable program from a single shader source
+    std::shared_ptr<Job> Queue(std::string source, GLenum type);
+
+private:
+    void Compile(Job& job);
+
+    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts;
+    std::vector<Frontend::GraphicsContext*> free_contexts;
+    std::mutex context_mutex;
+    std::atomic<u32> queue_depth{0};
+    std::atomic<bool> shutting_down{false};
+    std::unique_ptr<Common::ThreadPool> pool;
+};
+
+} // namespace OpenGL
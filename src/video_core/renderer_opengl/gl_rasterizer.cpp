@@ -16,6 +16,7 @@
 #include "common/scope_exit.h"
 #include "common/vector_math.h"
 #include "core/hw/gpu.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/regs_rasterizer.h"
@@ -154,8 +155,8 @@ RasterizerOpenGL::RasterizerOpenGL(Frontend::EmuWindow& window)
     state.Apply();
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer.GetHandle());
 
-    shader_program_manager =
-        std::make_unique<ShaderProgramManager>(GLAD_GL_ARB_separate_shader_objects, is_amd);
+    shader_program_manager = std::make_unique<ShaderProgramManager>(
+        emu_window, GLAD_GL_ARB_separate_shader_objects, is_amd);
 
     glEnable(GL_BLEND);
 
@@ -388,6 +389,12 @@ bool RasterizerOpenGL::SetupGeometryShader() {
     }
 }
 
+void RasterizerOpenGL::LoadDiskResources(u64 program_id) {
+    if (Settings::values.use_disk_shader_cache) {
+        shader_program_manager->LoadDiskCache(program_id);
+    }
+}
+
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
     const auto& regs = Pica::g_state.regs;
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
@@ -500,6 +507,15 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     MICROPROFILE_SCOPE(OpenGL_Drawing);
     const auto& regs = Pica::g_state.regs;
 
+    // Sync and bind the shader, which is synced again until the generated one is ready
+    if (shader_dirty) {
+        shader_dirty = !SetShader();
+    }
+    if (!shader_program_manager->HasFragmentShader()) {
+        vertex_batch.clear();
+        return true;
+    }
+
     bool shadow_rendering = regs.framebuffer.output_merger.fragment_operation_mode ==
                             Pica::FramebufferRegs::FragmentOperationMode::Shadow;
 
@@ -762,12 +778,6 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         }
     }
 
-    // Sync and bind the shader
-    if (shader_dirty) {
-        SetShader();
-        shader_dirty = false;
-    }
-
     // Sync the LUTs within the texture buffer
     SyncAndUploadLUTs();
 
@@ -1370,6 +1380,27 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
+void RasterizerOpenGL::NotifyCommandListEnd() {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    res_cache.PrefetchDownloads();
+}
+
+void RasterizerOpenGL::NotifyPicaStateReplaced() {
+    shader_dirty = true;
+
+    uniform_block_data.dirty = true;
+    uniform_block_data.lighting_lut_dirty.fill(true);
+    uniform_block_data.lighting_lut_dirty_any = true;
+    uniform_block_data.fog_lut_dirty = true;
+    uniform_block_data.proctex_noise_lut_dirty = true;
+    uniform_block_data.proctex_color_map_dirty = true;
+    uniform_block_data.proctex_alpha_map_dirty = true;
+    uniform_block_data.proctex_lut_dirty = true;
+    uniform_block_data.proctex_diff_lut_dirty = true;
+
+    SyncEntireState();
+}
+
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
     MICROPROFILE_SCOPE(OpenGL_Blits);
 
@@ -1628,9 +1659,9 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(
     }
 }
 
-void RasterizerOpenGL::SetShader() {
+bool RasterizerOpenGL::SetShader() {
     auto config = PicaFSConfig::BuildFromRegs(Pica::g_state.regs);
-    shader_program_manager->UseFragmentShader(config);
+    return shader_program_manager->UseFragmentShader(config);
 }
 
 void RasterizerOpenGL::SyncClipEnabled() {
@@ -50,12 +50,15 @@ public:
     void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override;
     void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void NotifyCommandListEnd() override;
+    void NotifyPicaStateReplaced() override;
     bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
     bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr,
                            u32 pixel_stride, ScreenInfo& screen_info) override;
     bool AccelerateDrawBatch(bool is_indexed) override;
+    void LoadDiskResources(u64 program_id) override;
 
 private:
     struct SamplerInfo {
@@ -137,8 +140,11 @@ private:
     /// Syncs the clip coefficients to match the PICA register
     void SyncClipCoef();
 
-    /// Sets the OpenGL shader in accordance with the current PICA register state
-    void SetShader();
+    /**
+     * Sets the OpenGL shader in accordance with the current PICA register state
+     * @returns false if a fallback is used while the shader is compiled in the background
+     */
+    bool SetShader();
 
     /// Syncs the cull mode to match the PICA register
     void SyncCullMode();
@@ -16,18 +16,22 @@
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/bit_field.h"
+#include "common/cityhash.h"
 #include "common/color.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/frontend/emu_window.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_surface_downloader.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
@@ -201,8 +205,10 @@ static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     }
 }
 
+/// Converts the tiled data of [start, end), pointed to by tile_buffer, to or from gl_buffer
 template <bool morton_to_gl, PixelFormat format>
-static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr start, PAddr end) {
+static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr start, PAddr end,
+                       u8* tile_buffer) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
     constexpr u32 tile_size = bytes_per_pixel * 64;
 
@@ -231,8 +237,6 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
         }
     };
 
-    u8* tile_buffer = VideoCore::g_memory->GetPhysicalPointer(start);
-
     if (start < aligned_start && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
         MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
@@ -266,7 +270,9 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
     }
 }
 
-static constexpr std::array<void (*)(u32, u32, u8*, PAddr, PAddr, PAddr), 18> morton_to_gl_fns = {
+using MortonCopyFn = void (*)(u32, u32, u8*, PAddr, PAddr, PAddr, u8*);
+
+static constexpr std::array<MortonCopyFn, 18> morton_to_gl_fns = {
     MortonCopy<true, PixelFormat::RGBA8>,  // 0
     MortonCopy<true, PixelFormat::RGB8>,   // 1
     MortonCopy<true, PixelFormat::RGB5A1>, // 2
@@ -287,7 +293,7 @@ static constexpr std::array<void (*)(u32, u32, u8*, PAddr, PAddr, PAddr), 18> mo
     MortonCopy<true, PixelFormat::D24S8> // 17
 };
 
-static constexpr std::array<void (*)(u32, u32, u8*, PAddr, PAddr, PAddr), 18> gl_to_morton_fns = {
+static constexpr std::array<MortonCopyFn, 18> gl_to_morton_fns = {
     MortonCopy<false, PixelFormat::RGBA8>,  // 0
     MortonCopy<false, PixelFormat::RGB8>,   // 1
     MortonCopy<false, PixelFormat::RGB5A1>, // 2
@@ -790,17 +796,15 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
-                }
-            }
+            // The texture rows are stored from the bottom to the top of gl_buffer
+            Pica::Texture::DecodeTexture(texture_src_data, tex_info, rect.left, height - rect.top,
+                                         rect.right, height - rect.bottom,
+                                         &gl_buffer[(height - 1) * width * 4],
+                                         -static_cast<std::ptrdiff_t>(width * 4));
         } else {
-            morton_to_gl_fns[static_cast<std::size_t>(pixel_format)](stride, height, &gl_buffer[0],
-                                                                     addr, load_start, load_end);
+            morton_to_gl_fns[static_cast<std::size_t>(pixel_format)](
+                stride, height, &gl_buffer[0], addr, load_start, load_end,
+                VideoCore::g_memory->GetPhysicalPointer(load_start));
         }
     }
 }
@@ -841,12 +845,19 @@ void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
 
         if (backup_bytes)
             std::memcpy(&dst_buffer[coarse_start_offset], &backup_data[0], backup_bytes);
-    } else if (!is_tiled) {
-        ASSERT(type == SurfaceType::Color);
-        std::memcpy(dst_buffer + start_offset, &gl_buffer[start_offset], flush_end - flush_start);
     } else {
-        gl_to_morton_fns[static_cast<std::size_t>(pixel_format)](stride, height, &gl_buffer[0],
-                                                                 addr, flush_start, flush_end);
+        ConvertGLBuffer(*this, &gl_buffer[0], flush_start, flush_end, dst_buffer + start_offset);
+    }
+}
+
+void CachedSurface::ConvertGLBuffer(const SurfaceParams& params, u8* gl_data, PAddr start,
+                                    PAddr end, u8* dest) {
+    if (!params.is_tiled) {
+        ASSERT(params.type == SurfaceType::Color);
+        std::memcpy(dest, gl_data + (start - params.addr), end - start);
+    } else {
+        gl_to_morton_fns[static_cast<std::size_t>(params.pixel_format)](
+            params.stride, params.height, gl_data, params.addr, start, end, dest);
     }
 }
 
@@ -993,6 +1004,60 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint
     glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 }
 
+void CachedSurface::ReadPixelsToBuffer(const Common::Rectangle<u32>& rect, GLuint pack_buffer,
+                                       GLuint read_fb_handle, GLuint draw_fb_handle) {
+    ASSERT(type == SurfaceType::Color);
+    MICROPROFILE_SCOPE(OpenGL_TextureDL);
+
+    OpenGLState state = OpenGLState::GetCurState();
+    OpenGLState prev_state = state;
+    SCOPE_EXIT({ prev_state.Apply(); });
+
+    const FormatTuple& tuple = GetFormatTuple(pixel_format);
+    GLuint read_tex = texture.handle;
+    GLint x0 = static_cast<GLint>(rect.left);
+    GLint y0 = static_cast<GLint>(rect.bottom);
+
+    // If not 1x scale, blit scaled texture to a new 1x texture and read from that
+    OGLTexture unscaled_tex;
+    if (res_scale != 1) {
+        auto scaled_rect = rect;
+        scaled_rect.left *= res_scale;
+        scaled_rect.top *= res_scale;
+        scaled_rect.right *= res_scale;
+        scaled_rect.bottom *= res_scale;
+
+        unscaled_tex.Create();
+        Common::Rectangle<u32> unscaled_tex_rect{0, rect.GetHeight(), rect.GetWidth(), 0};
+        AllocateSurfaceTexture(unscaled_tex.handle, tuple, rect.GetWidth(), rect.GetHeight());
+        BlitTextures(texture.handle, scaled_rect, unscaled_tex.handle, unscaled_tex_rect, type,
+                     read_fb_handle, draw_fb_handle);
+        read_tex = unscaled_tex.handle;
+        x0 = 0;
+        y0 = 0;
+    }
+
+    state.ResetTexture(read_tex);
+    state.draw.read_framebuffer = read_fb_handle;
+    state.Apply();
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, read_tex, 0);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+
+    // Ensure no bad interactions with GL_PACK_ALIGNMENT
+    ASSERT(stride * GetGLBytesPerPixel(pixel_format) % 4 == 0);
+    const std::size_t buffer_offset =
+        (rect.bottom * stride + rect.left) * GetGLBytesPerPixel(pixel_format);
+
+    // The pixel pack buffer binding is not tracked by OpenGLState
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pack_buffer);
+    glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(stride));
+    glReadPixels(x0, y0, static_cast<GLsizei>(rect.GetWidth()),
+                 static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
+                 reinterpret_cast<void*>(buffer_offset));
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
 enum MatchFlags {
     Invalid = 1,      // Flag that can be applied to other match types, invalid matches require
                       // validation before they can be used
@@ -1097,6 +1162,11 @@ Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params
 }
 
 RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
+    content_hashing = Settings::values.texture_content_hashing;
+    if (Settings::values.async_surface_downloads) {
+        downloader = std::make_unique<SurfaceDownloader>();
+    }
+
     read_framebuffer.Create();
     draw_framebuffer.Create();
 
@@ -1163,6 +1233,10 @@ bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
         return false;
 
     dst_surface->InvalidateAllWatcher();
+    dst_surface->content_hash.reset();
+    if (downloader && downloader->Discard(dst_surface)) {
+        dst_surface->read_back = true;
+    }
 
     return BlitTextures(src_surface->texture.handle, src_rect, dst_surface->texture.handle,
                         dst_rect, src_surface->type, read_framebuffer.handle,
@@ -1751,6 +1825,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         if (copy_surface != nullptr) {
             SurfaceInterval copy_interval = params.GetCopyableInterval(copy_surface);
             CopySurface(copy_surface, surface, copy_interval);
+            surface->content_hash.reset();
             surface->invalid_regions.erase(copy_interval);
             continue;
         }
@@ -1771,6 +1846,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
                 ConvertD24S8toABGR(reinterpret_surface->texture.handle, src_rect,
                                    surface->texture.handle, dest_rect);
 
+                surface->content_hash.reset();
                 surface->invalid_regions.erase(convert_interval);
                 continue;
             }
@@ -1778,13 +1854,93 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
 
         // Load data from 3DS memory
         FlushRegion(params.addr, params.size);
-        surface->LoadGLBuffer(params.addr, params.end);
-        surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                 draw_framebuffer.handle);
+
+        // Only the textures loaded in one go are known to match the whole hashed region
+        std::optional<u64> content_hash;
+        if (content_hashing && params.GetInterval() == surface->GetInterval()) {
+            content_hash = GetContentHash(params);
+        }
+        if (!content_hash || !ReuseContents(surface, *content_hash)) {
+            surface->LoadGLBuffer(params.addr, params.end);
+            surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
+                                     draw_framebuffer.handle);
+        }
+        SetContentHash(surface, content_hash);
         surface->invalid_regions.erase(params.GetInterval());
     }
 }
 
+std::optional<u64> RasterizerCacheOpenGL::GetContentHash(const SurfaceParams& params) const {
+    // Partial loads are clamped to the VRAM boundaries, see LoadGLBuffer
+    if ((params.addr < Memory::VRAM_VADDR_END && params.end > Memory::VRAM_VADDR_END) ||
+        (params.addr < Memory::VRAM_VADDR && params.end > Memory::VRAM_VADDR)) {
+        return {};
+    }
+    const u8* const data = VideoCore::g_memory->GetPhysicalPointer(params.addr);
+    if (data == nullptr) {
+        return {};
+    }
+
+    // The same bytes only decode to the same texture under the same layout
+    std::size_t layout = 0;
+    boost::hash_combine(layout, static_cast<u32>(params.pixel_format));
+    boost::hash_combine(layout, params.width);
+    boost::hash_combine(layout, params.height);
+    boost::hash_combine(layout, params.stride);
+    boost::hash_combine(layout, params.is_tiled);
+    boost::hash_combine(layout, params.res_scale);
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(data), params.size, layout);
+}
+
+bool RasterizerCacheOpenGL::ReuseContents(const Surface& surface, u64 content_hash) {
+    const auto Matches = [content_hash](const CachedSurface& other) {
+        return other.content_hash == content_hash;
+    };
+
+    if (!Matches(*surface)) {
+        const auto it = content_hashes.find(content_hash);
+        if (it == content_hashes.end()) {
+            return false;
+        }
+        const Surface source = it->second.lock();
+        if (source == nullptr || !Matches(*source) ||
+            source->pixel_format != surface->pixel_format || source->width != surface->width ||
+            source->height != surface->height || source->res_scale != surface->res_scale) {
+            return false;
+        }
+        BlitSurfaces(source, source->GetScaledRect(), surface, surface->GetScaledRect());
+    }
+    // Otherwise the texture already holds these contents, e.g. when the same data was written again
+
+    const std::size_t upload_size =
+        surface->width * surface->height * CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    Core::System::GetInstance().perf_stats.AddTextureHashHit(upload_size);
+    return true;
+}
+
+void RasterizerCacheOpenGL::SetContentHash(const Surface& surface,
+                                           std::optional<u64> content_hash) {
+    surface->content_hash = content_hash;
+    if (!content_hash) {
+        return;
+    }
+    content_hashes[*content_hash] = surface;
+
+    constexpr std::size_t MAX_CONTENT_HASHES = 4096;
+    if (content_hashes.size() < MAX_CONTENT_HASHES) {
+        return;
+    }
+    // Drops the entries of the surfaces destroyed or written since they were hashed
+    for (auto it = content_hashes.begin(); it != content_hashes.end();) {
+        const Surface cached = it->second.lock();
+        if (cached == nullptr || cached->content_hash != it->first) {
+            it = content_hashes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surface) {
     if (size == 0)
         return;
@@ -1805,13 +1961,17 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surf
         // Sanity check, this surface is the last one that marked this region dirty
         ASSERT(surface->IsRegionValid(interval));
 
+        flushed_intervals += interval;
         if (surface->type != SurfaceType::Fill) {
+            surface->read_back = true;
+            if (downloader && downloader->Flush(surface, interval)) {
+                continue;
+            }
             SurfaceParams params = surface->FromInterval(interval);
             surface->DownloadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
                                        draw_framebuffer.handle);
         }
         surface->FlushGLBuffer(boost::icl::first(interval), boost::icl::last_next(interval));
-        flushed_intervals += interval;
     }
     // Reset dirty regions
     dirty_regions -= flushed_intervals;
@@ -1821,6 +1981,43 @@ void RasterizerCacheOpenGL::FlushAll() {
     FlushRegion(0, 0xFFFFFFFF);
 }
 
+void RasterizerCacheOpenGL::PrefetchDownloads() {
+    if (!downloader) {
+        return;
+    }
+
+    downloader->Poll();
+
+    // Only the surfaces flushed since they were last downloaded are downloaded again, and no more
+    // regions than the downloader holds at once. Surfaces stay marked until all their dirty
+    // regions are downloaded.
+    std::vector<Surface> queued_surfaces;
+    std::vector<Surface> missed_surfaces;
+    std::size_t num_tried = 0;
+    for (const auto& pair : dirty_regions) {
+        const Surface& surface = pair.second;
+        if (!surface->read_back || !SurfaceDownloader::IsSupported(*surface)) {
+            continue;
+        }
+        if (num_tried++ == SurfaceDownloader::NumSlots) {
+            missed_surfaces.push_back(surface);
+            break;
+        }
+        if (downloader->Queue(surface, pair.first, read_framebuffer.handle,
+                              draw_framebuffer.handle)) {
+            queued_surfaces.push_back(surface);
+        } else {
+            missed_surfaces.push_back(surface);
+        }
+    }
+    for (const Surface& surface : queued_surfaces) {
+        surface->read_back = false;
+    }
+    for (const Surface& surface : missed_surfaces) {
+        surface->read_back = true;
+    }
+}
+
 void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner) {
     if (size == 0)
         return;
@@ -1833,6 +2030,11 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
         region_owner->invalid_regions.erase(invalid_interval);
+        // The texture of the owner was written by the GPU
+        region_owner->content_hash.reset();
+        if (downloader && downloader->Discard(region_owner)) {
+            region_owner->read_back = true;
+        }
     }
 
     for (auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
@@ -7,6 +7,7 @@
 #include <array>
 #include <list>
 #include <memory>
+#include <optional>
 #include <set>
 #include <tuple>
 #ifdef __GNUC__
@@ -356,6 +357,13 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
 
     OGLTexture texture;
 
+    /// Set when the surface is flushed or its downloads are discarded, its dirty regions are then
+    /// downloaded ahead of the next flush
+    bool read_back = false;
+
+    /// Hash of the 3DS memory the whole texture was loaded from, reset by any other kind of write
+    std::optional<u64> content_hash;
+
     /// max mipmap level that has been attached to the texture
     u32 max_level = 0;
     /// level_watchers[i] watches the (i+1)-th level mipmap source surface
@@ -377,12 +385,21 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     void LoadGLBuffer(PAddr load_start, PAddr load_end);
     void FlushGLBuffer(PAddr flush_start, PAddr flush_end);
 
+    /// Converts [start, end) of data laid out as in gl_buffer to its 3DS memory layout in dest
+    static void ConvertGLBuffer(const SurfaceParams& params, u8* gl_data, PAddr start, PAddr end,
+                                u8* dest);
+
     // Upload/Download data in gl_buffer in/to this surface's texture
     void UploadGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
                          GLuint draw_fb_handle);
     void DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint read_fb_handle,
                            GLuint draw_fb_handle);
 
+    // Read pixels of a color surface to a pixel pack buffer, at the same offset as in gl_buffer,
+    // without waiting for them
+    void ReadPixelsToBuffer(const Common::Rectangle<u32>& rect, GLuint pack_buffer,
+                            GLuint read_fb_handle, GLuint draw_fb_handle);
+
     std::shared_ptr<SurfaceWatcher> CreateWatcher() {
         auto watcher = std::make_shared<SurfaceWatcher>(weak_from_this());
         watchers.push_front(watcher);
@@ -422,6 +439,8 @@ struct CachedTextureCube {
     std::shared_ptr<SurfaceWatcher> nz;
 };
 
+class SurfaceDownloader;
+
 class RasterizerCacheOpenGL : NonCopyable {
 public:
     RasterizerCacheOpenGL();
@@ -473,6 +492,9 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /// Start downloading the dirty regions of the surfaces flushed before, ahead of their flush
+    void PrefetchDownloads();
+
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
@@ -491,6 +513,14 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Hashes the 3DS memory backing the whole surface along with the layout of its texture
+    std::optional<u64> GetContentHash(const SurfaceParams& params) const;
+
+    /// Fills the texture of the surface from one already holding the hashed contents, if any
+    bool ReuseContents(const Surface& surface, u64 content_hash);
+
+    void SetContentHash(const Surface& surface, std::optional<u64> content_hash);
+
     SurfaceCache surface_cache;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
@@ -507,5 +537,11 @@ private:
     GLint d24s8_abgr_viewport_u_id;
 
     std::unordered_map<TextureCubeConfig, CachedTextureCube> texture_cube_cache;
+
+    std::unique_ptr<SurfaceDownloader> downloader;
+
+    bool content_hashing;
+    /// Surfaces whose whole texture was loaded from memory, by content hash
+    std::unordered_map<u64, std::weak_ptr<CachedSurface>> content_hashes;
 };
 } // namespace OpenGL
@@ -169,4 +169,19 @@ void OGLFramebuffer::Release() {
     handle = 0;
 }
 
+void OGLSync::Create() {
+    if (handle != nullptr)
+        return;
+
+    handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void OGLSync::Release() {
+    if (handle == nullptr)
+        return;
+
+    glDeleteSync(handle);
+    handle = nullptr;
+}
+
 } // namespace OpenGL
@@ -0,0 +1,202 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <map>
+#include <utility>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace OpenGL {
+
+// On disk, the value of a source entry is laid out as:
+//   u32 config_size; u8 config[config_size]; char source[];
+// and the value of a binary entry as:
+//   u64 driver_hash; u32 binary_format; u8 binary[];
+
+namespace {
+
+using EntryIndices = std::map<std::pair<ShaderDiskCacheType, u64>, std::size_t>;
+
+class SourceReader final : public LinearDiskCacheReader<ShaderDiskCacheKey, u8> {
+public:
+    SourceReader(bool separable, std::vector<ShaderDiskCacheEntry>& entries)
+        : separable(separable), entries(entries) {}
+
+    void Read(const ShaderDiskCacheKey& key, const u8* value, u32 value_size) override {
+        u32 config_size;
+        if (key.separable != separable || value_size < sizeof(config_size)) {
+            return;
+        }
+        std::memcpy(&config_size, value, sizeof(config_size));
+        if (value_size - sizeof(config_size) < config_size) {
+            return;
+        }
+        if (!indices.emplace(std::make_pair(key.type, key.config_hash), entries.size()).second) {
+            return;
+        }
+
+        const u8* config = value + sizeof(config_size);
+        const u8* source = config + config_size;
+        ShaderDiskCacheEntry entry;
+        entry.type = key.type;
+        entry.config.assign(config, source);
+        entry.source.assign(reinterpret_cast<const char*>(source),
+                            static_cast<std::size_t>(value + value_size - source));
+        entries.push_back(std::move(entry));
+    }
+
+    const EntryIndices& GetIndices() const {
+        return indices;
+    }
+
+private:
+    bool separable;
+    std::vector<ShaderDiskCacheEntry>& entries;
+    EntryIndices indices;
+};
+
+class BinaryReader final : public LinearDiskCacheReader<ShaderDiskCacheKey, u8> {
+public:
+    BinaryReader(u64 driver_hash, const EntryIndices& indices,
+                 std::vector<ShaderDiskCacheEntry>& entries)
+        : driver_hash(driver_hash), indices(indices), entries(entries) {}
+
+    void Read(const ShaderDiskCacheKey& key, const u8* value, u32 value_size) override {
+        u64 entry_driver_hash;
+        u32 binary_format;
+        constexpr u32 header_size = sizeof(entry_driver_hash) + sizeof(binary_format);
+        if (value_size < header_size) {
+            stale = true;
+            return;
+        }
+        std::memcpy(&entry_driver_hash, value, sizeof(entry_driver_hash));
+        std::memcpy(&binary_format, value + sizeof(entry_driver_hash), sizeof(binary_format));
+        if (entry_driver_hash != driver_hash) {
+            stale = true;
+            return;
+        }
+
+        const auto it = indices.find(std::make_pair(key.type, key.config_hash));
+        if (it == indices.end()) {
+            return;
+        }
+        ShaderDiskCacheEntry& entry = entries[it->second];
+        entry.binary_format = binary_format;
+        entry.binary.assign(value + header_size, value + value_size);
+    }
+
+    /// Returns true if some of the binaries were not created by the current driver
+    bool IsStale() const {
+        return stale;
+    }
+
+private:
+    u64 driver_hash;
+    const EntryIndices& indices;
+    std::vector<ShaderDiskCacheEntry>& entries;
+    bool stale = false;
+};
+
+u64 GetDriverHash() {
+    std::string driver;
+    for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const auto* string = reinterpret_cast<const char*>(glGetString(name));
+        if (string != nullptr) {
+            driver += string;
+        }
+    }
+    return Common::ComputeHash64(driver.data(), driver.size());
+}
+
+bool AreProgramBinariesSupported() {
+    if (!GLAD_GL_ARB_get_program_binary && !GLAD_GL_ES_VERSION_3_0) {
+        return false;
+    }
+    GLint num_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    return num_formats > 0;
+}
+
+} // Anonymous namespace
+
+ShaderDiskCache::ShaderDiskCache(u64 program_id, bool separable)
+    : separable(separable), binaries_supported(separable && AreProgramBinariesSupported()) {
+    const std::string dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) +
+                            "shader" DIR_SEP "opengl" DIR_SEP;
+    FileUtil::CreateFullPath(dir);
+    source_path = fmt::format("{}{:016X}.source", dir, program_id);
+    binary_path = fmt::format("{}{:016X}.binary", dir, program_id);
+
+    if (binaries_supported) {
+        driver_hash = GetDriverHash();
+    }
+}
+
+std::vector<ShaderDiskCacheEntry> ShaderDiskCache::Load() {
+    std::vector<ShaderDiskCacheEntry> entries;
+    SourceReader source_reader(separable, entries);
+    sources.OpenAndRead(source_path.c_str(), source_reader);
+
+    if (binaries_supported) {
+        BinaryReader binary_reader(driver_hash, source_reader.GetIndices(), entries);
+        binaries.OpenAndRead(binary_path.c_str(), binary_reader);
+        if (binary_reader.IsStale()) {
+            LOG_INFO(Render_OpenGL, "Driver changed, discarding the cached program binaries");
+            for (auto& entry : entries) {
+                entry.binary.clear();
+            }
+            binaries.Close();
+            FileUtil::Delete(binary_path);
+            binaries.OpenAndRead(binary_path.c_str(), binary_reader);
+        }
+    }
+
+    return entries;
+}
+
+void ShaderDiskCache::SaveSource(ShaderDiskCacheType type, u64 config_hash, const void* config,
+                                 std::size_t config_size, const std::string& source) {
+    const u32 size = static_cast<u32>(config_size);
+    std::vector<u8> value(sizeof(size) + config_size + source.size());
+    std::memcpy(value.data(), &size, sizeof(size));
+    std::memcpy(value.data() + sizeof(size), config, config_size);
+    std::memcpy(value.data() + sizeof(size) + config_size, source.data(), source.size());
+
+    sources.Append(MakeKey(type, config_hash), value.data(), static_cast<u32>(value.size()));
+    sources.Sync();
+}
+
+void ShaderDiskCache::SaveBinary(ShaderDiskCacheType type, u64 config_hash, GLuint program) {
+    if (!binaries_supported) {
+        return;
+    }
+
+    GLint binary_length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0) {
+        return;
+    }
+
+    constexpr std::size_t header_size = sizeof(driver_hash) + sizeof(u32);
+    std::vector<u8> value(header_size + binary_length);
+    GLenum format = 0;
+    glGetProgramBinary(program, binary_length, nullptr, &format, value.data() + header_size);
+    const u32 binary_format = static_cast<u32>(format);
+    std::memcpy(value.data(), &driver_hash, sizeof(driver_hash));
+    std::memcpy(value.data() + sizeof(driver_hash), &binary_format, sizeof(binary_format));
+
+    binaries.Append(MakeKey(type, config_hash), value.data(), static_cast<u32>(value.size()));
+    binaries.Sync();
+}
+
+ShaderDiskCacheKey ShaderDiskCache::MakeKey(ShaderDiskCacheType type, u64 config_hash) const {
+    return {type, separable ? 1u : 0u, config_hash};
+}
+
+} // namespace OpenGL
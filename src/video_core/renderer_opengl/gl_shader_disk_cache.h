@@ -0,0 +1,75 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/linear_disk_cache.h"
+
+namespace OpenGL {
+
+/// Kinds of generated shaders, each of them identified by a different config structure
+enum class ShaderDiskCacheType : u32 {
+    ProgrammableVertex,
+    ProgrammableGeometry,
+    FixedGeometry,
+    Fragment,
+};
+
+struct ShaderDiskCacheKey {
+    ShaderDiskCacheType type;
+    u32 separable;
+    u64 config_hash;
+};
+
+/// A shader stored in the disk cache by a previous run
+struct ShaderDiskCacheEntry {
+    ShaderDiskCacheType type;
+    /// Raw state of the config the shader was generated from
+    std::vector<u8> config;
+    std::string source;
+    /// Binary of the linked separable program, empty if none was stored for the current driver
+    std::vector<u8> binary;
+    GLenum binary_format = 0;
+};
+
+/**
+ * Per-title storage of the GLSL shaders generated from the PICA state. Each source is stored along
+ * with the config it was generated from, so that every shader seen in previous runs can be built
+ * again when the title boots. When the driver supports program binaries, separable programs are
+ * also stored linked, which skips compiling their sources altogether.
+ */
+class ShaderDiskCache {
+public:
+    ShaderDiskCache(u64 program_id, bool separable);
+
+    /// Opens the cache files of the title and reads all the shaders stored in them
+    std::vector<ShaderDiskCacheEntry> Load();
+
+    /// Stores the source of a newly generated shader
+    void SaveSource(ShaderDiskCacheType type, u64 config_hash, const void* config,
+                    std::size_t config_size, const std::string& source);
+
+    /// Stores the binary of a linked separable program, if program binaries are supported
+    void SaveBinary(ShaderDiskCacheType type, u64 config_hash, GLuint program);
+
+private:
+    ShaderDiskCacheKey MakeKey(ShaderDiskCacheType type, u64 config_hash) const;
+
+    std::string source_path;
+    std::string binary_path;
+    bool separable;
+    bool binaries_supported;
+    /// Identifies the driver the program binaries were created with
+    u64 driver_hash = 0;
+
+    LinearDiskCache<ShaderDiskCacheKey, u8> sources;
+    LinearDiskCache<ShaderDiskCacheKey, u8> binaries;
+};
+
+} // namespace OpenGL
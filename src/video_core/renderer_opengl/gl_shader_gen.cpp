@@ -1603,6 +1603,325 @@ do {
     return out;
 }
 
+std::string GenerateUberFragmentShader(bool separable_shader) {
+    std::string out;
+    if (separable_shader) {
+        out += "#extension GL_ARB_separate_shader_objects : enable\n";
+    }
+
+    if (GLES) {
+        out += fragment_shader_precision_OES;
+    }
+
+    out += GetVertexInterfaceDeclaration(false, separable_shader);
+
+    out += R"(
+#ifndef CITRA_GLES
+in vec4 gl_FragCoord;
+#endif // CITRA_GLES
+
+out vec4 color;
+
+uniform sampler2D tex0;
+uniform sampler2D tex1;
+uniform sampler2D tex2;
+uniform samplerCube tex_cube;
+)";
+
+    out += UniformBlockDef;
+
+    // The state baked into the generated fragment shaders is read from plain uniforms instead.
+    // Fragment lighting, procedural textures, fog and shadows are not emulated.
+    out += R"(
+// Raw sources, modifiers, operations and scales of each TEV stage
+uniform ivec4 tev_stages[NUM_TEV_STAGES];
+uniform int tev_combiner_buffer_input;
+uniform int alpha_test_func;
+uniform int scissor_test_mode;
+uniform int texture0_type;
+uniform bool texture2_use_coord1;
+uniform bool w_buffering;
+
+vec4 rounded_primary_color;
+vec4 texture_color[4];
+vec4 combiner_buffer;
+vec4 last_tex_env_out;
+
+float byteround(float x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec3 byteround(vec3 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec4 byteround(vec4 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+float getLod(vec2 coord) {
+    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
+    return log2(max(d.x, d.y));
+}
+
+vec4 GetSource(int source, int stage) {
+    switch (source) {
+    case 0:
+        return rounded_primary_color;
+    case 3:
+    case 4:
+    case 5:
+    case 6:
+        return texture_color[source - 3];
+    case 13:
+        return combiner_buffer;
+    case 14:
+        return const_color[stage];
+    case 15:
+        return last_tex_env_out;
+    default:
+        return vec4(0.0);
+    }
+}
+
+vec3 ColorModifier(int modifier, vec4 value) {
+    vec3 result;
+    switch (modifier >> 1) {
+    case 0:
+        result = value.rgb;
+        break;
+    case 1:
+        result = value.aaa;
+        break;
+    case 2:
+        result = value.rrr;
+        break;
+    case 4:
+        result = value.ggg;
+        break;
+    case 6:
+        result = value.bbb;
+        break;
+    default:
+        return vec3(0.0);
+    }
+    return (modifier & 1) != 0 ? vec3(1.0) - result : result;
+}
+
+float AlphaModifier(int modifier, vec4 value) {
+    float result;
+    switch (modifier >> 1) {
+    case 0:
+        result = value.a;
+        break;
+    case 1:
+        result = value.r;
+        break;
+    case 2:
+        result = value.g;
+        break;
+    default:
+        result = value.b;
+        break;
+    }
+    return (modifier & 1) != 0 ? 1.0 - result : result;
+}
+
+vec3 ColorCombine(int operation, vec3 i[3]) {
+    vec3 result;
+    switch (operation) {
+    case 0:
+        result = i[0];
+        break;
+    case 1:
+        result = i[0] * i[1];
+        break;
+    case 2:
+        result = i[0] + i[1];
+        break;
+    case 3:
+        result = i[0] + i[1] - vec3(0.5);
+        break;
+    case 4:
+        result = i[0] * i[2] + i[1] * (vec3(1.0) - i[2]);
+        break;
+    case 5:
+        result = i[0] - i[1];
+        break;
+    case 6:
+    case 7:
+        result = vec3(dot(i[0] - vec3(0.5), i[1] - vec3(0.5)) * 4.0);
+        break;
+    case 8:
+        result = i[0] * i[1] + i[2];
+        break;
+    case 9:
+        result = min(i[0] + i[1], vec3(1.0)) * i[2];
+        break;
+    default:
+        result = vec3(0.0);
+        break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float AlphaCombine(int operation, float i[3]) {
+    float result;
+    switch (operation) {
+    case 0:
+        result = i[0];
+        break;
+    case 1:
+        result = i[0] * i[1];
+        break;
+    case 2:
+        result = i[0] + i[1];
+        break;
+    case 3:
+        result = i[0] + i[1] - 0.5;
+        break;
+    case 4:
+        result = i[0] * i[2] + i[1] * (1.0 - i[2]);
+        break;
+    case 5:
+        result = i[0] - i[1];
+        break;
+    case 8:
+        result = i[0] * i[1] + i[2];
+        break;
+    case 9:
+        result = min(i[0] + i[1], 1.0) * i[2];
+        break;
+    default:
+        result = 0.0;
+        break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+float GetMultiplier(int scale) {
+    return scale < 3 ? float(1 << scale) : 1.0;
+}
+
+void main() {
+    rounded_primary_color = byteround(primary_color);
+
+    if (scissor_test_mode != 0) {
+        bool inside = gl_FragCoord.x >= float(scissor_x1) && gl_FragCoord.y >= float(scissor_y1) &&
+                      gl_FragCoord.x < float(scissor_x2) && gl_FragCoord.y < float(scissor_y2);
+        // Mode 3 keeps the pixels inside the scissor box, mode 1 the pixels outside of it
+        if (inside != (scissor_test_mode == 3))
+            discard;
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (w_buffering)
+        depth /= gl_FragCoord.w;
+
+    switch (texture0_type) {
+    case 0:
+        texture_color[0] = textureLod(tex0, texcoord0,
+                                      getLod(texcoord0 * vec2(textureSize(tex0, 0))));
+        break;
+    case 1:
+        texture_color[0] = texture(tex_cube, vec3(texcoord0, texcoord0_w));
+        break;
+    case 3:
+        texture_color[0] = textureProj(tex0, vec3(texcoord0, texcoord0_w));
+        break;
+    case 5:
+        texture_color[0] = vec4(0.0);
+        break;
+    default:
+        // Shadow textures are treated as fully lit
+        texture_color[0] = vec4(1.0);
+        break;
+    }
+    texture_color[1] = textureLod(tex1, texcoord1, getLod(texcoord1 * vec2(textureSize(tex1, 0))));
+    vec2 texcoord2_used = texture2_use_coord1 ? texcoord1 : texcoord2;
+    texture_color[2] = textureLod(tex2, texcoord2_used,
+                                  getLod(texcoord2_used * vec2(textureSize(tex2, 0))));
+    texture_color[3] = vec4(0.0);
+
+    combiner_buffer = vec4(0.0);
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    last_tex_env_out = vec4(0.0);
+
+    for (int stage = 0; stage < NUM_TEV_STAGES; ++stage) {
+        ivec4 config = tev_stages[stage];
+        int color_op = config.z & 0xF;
+
+        vec3 color_results[3] = vec3[3](
+            ColorModifier(config.y & 0xF, GetSource(config.x & 0xF, stage)),
+            ColorModifier((config.y >> 4) & 0xF, GetSource((config.x >> 4) & 0xF, stage)),
+            ColorModifier((config.y >> 8) & 0xF, GetSource((config.x >> 8) & 0xF, stage)));
+        vec3 color_output = byteround(ColorCombine(color_op, color_results));
+
+        float alpha_output;
+        if (color_op == 7) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output[0];
+        } else {
+            float alpha_results[3] = float[3](
+                AlphaModifier((config.y >> 12) & 0x7, GetSource((config.x >> 16) & 0xF, stage)),
+                AlphaModifier((config.y >> 16) & 0x7, GetSource((config.x >> 20) & 0xF, stage)),
+                AlphaModifier((config.y >> 20) & 0x7, GetSource((config.x >> 24) & 0xF, stage)));
+            alpha_output = byteround(AlphaCombine((config.z >> 16) & 0xF, alpha_results));
+        }
+
+        last_tex_env_out =
+            vec4(clamp(color_output * GetMultiplier(config.w & 0x3), vec3(0.0), vec3(1.0)),
+                 clamp(alpha_output * GetMultiplier((config.w >> 16) & 0x3), 0.0, 1.0));
+
+        combiner_buffer = next_combiner_buffer;
+        if (stage < 4) {
+            if (((tev_combiner_buffer_input >> stage) & 1) != 0)
+                next_combiner_buffer.rgb = last_tex_env_out.rgb;
+            if (((tev_combiner_buffer_input >> (stage + 4)) & 1) != 0)
+                next_combiner_buffer.a = last_tex_env_out.a;
+        }
+    }
+
+    int alpha = int(last_tex_env_out.a * 255.0);
+    bool alpha_test_fail;
+    switch (alpha_test_func) {
+    case 0:
+        alpha_test_fail = true;
+        break;
+    case 2:
+        alpha_test_fail = alpha != alphatest_ref;
+        break;
+    case 3:
+        alpha_test_fail = alpha == alphatest_ref;
+        break;
+    case 4:
+        alpha_test_fail = alpha >= alphatest_ref;
+        break;
+    case 5:
+        alpha_test_fail = alpha > alphatest_ref;
+        break;
+    case 6:
+        alpha_test_fail = alpha <= alphatest_ref;
+        break;
+    case 7:
+        alpha_test_fail = alpha < alphatest_ref;
+        break;
+    default:
+        alpha_test_fail = false;
+        break;
+    }
+    if (alpha_test_fail)
+        discard;
+
+    gl_FragDepth = depth;
+    color = byteround(last_tex_env_out);
+}
+)";
+
+    return out;
+}
+
 std::string GenerateTrivialVertexShader(bool separable_shader) {
     std::string out = "";
     if (separable_shader) {
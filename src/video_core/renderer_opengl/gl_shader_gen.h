@@ -165,6 +165,7 @@ struct PicaShaderConfigCommon {
  * shader.
  */
 struct PicaVSConfig : Common::HashableStruct<PicaShaderConfigCommon> {
+    PicaVSConfig() = default;
     explicit PicaVSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
         state.Init(regs.vs, setup);
     }
@@ -190,6 +191,7 @@ struct PicaGSConfigCommonRaw {
  * shader pipeline
  */
 struct PicaFixedGSConfig : Common::HashableStruct<PicaGSConfigCommonRaw> {
+    PicaFixedGSConfig() = default;
     explicit PicaFixedGSConfig(const Pica::Regs& regs) {
         state.Init(regs);
     }
@@ -210,6 +212,7 @@ struct PicaGSConfigRaw : PicaShaderConfigCommon, PicaGSConfigCommonRaw {
  * shader.
  */
 struct PicaGSConfig : Common::HashableStruct<PicaGSConfigRaw> {
+    PicaGSConfig() = default;
     explicit PicaGSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setups) {
         state.Init(regs, setups);
     }
@@ -254,6 +257,15 @@ std::optional<std::string> GenerateGeometryShader(const Pica::Shader::ShaderSetu
  */
 std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader);
 
+/**
+ * Generates the GLSL source code of a fragment shader emulating any texture environment, whose
+ * configuration is read from uniforms instead of being part of the code. It is used while the
+ * fragment shader generated for the current configuration is compiled in the background.
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+std::string GenerateUberFragmentShader(bool separable_shader);
+
 } // namespace OpenGL
 
 namespace std {
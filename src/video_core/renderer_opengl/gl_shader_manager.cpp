@@ -3,9 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <unordered_map>
 #include <boost/functional/hash.hpp>
 #include <boost/variant.hpp>
+#include "common/logging/log.h"
+#include "common/thread_pool.h"
+#include "core/settings.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 
 namespace OpenGL {
@@ -114,6 +121,63 @@ public:
         }
     }
 
+    /// Loads the stage from a program binary, returns false if the driver rejected it
+    bool CreateFromBinary(GLenum format, const std::vector<u8>& binary) {
+        if (shader_or_program.which() == 0) {
+            return false;
+        }
+        OGLProgram& program = boost::get<OGLProgram>(shader_or_program);
+        program.handle = glCreateProgram();
+        glProgramParameteri(program.handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        glProgramBinary(program.handle, format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint link_status = GL_FALSE;
+        glGetProgramiv(program.handle, GL_LINK_STATUS, &link_status);
+        if (link_status != GL_TRUE) {
+            program.Release();
+            return false;
+        }
+        // Uniform state is reset by glProgramBinary just like by linking
+        SetShaderUniformBlockBindings(program.handle);
+        SetShaderSamplerBindings(program.handle);
+        return true;
+    }
+
+    /// Queues the compilation of the stage, which must be a separable program
+    void CreateAsync(AsyncShaderCompiler& compiler, std::string source, GLenum type) {
+        ASSERT(IsProgram());
+        job = compiler.Queue(std::move(source), type);
+    }
+
+    /// Returns true until a queued compilation has been finished with TryFinishCompiling
+    bool IsCompiling() const {
+        return job != nullptr;
+    }
+
+    /// Takes the program of the queued compilation, returns false if it is not linked yet
+    bool TryFinishCompiling() {
+        if (!job->IsDone()) {
+            return false;
+        }
+        OGLProgram& program = boost::get<OGLProgram>(shader_or_program);
+        program.handle = job->TakeProgram();
+        job.reset();
+        // The bindings update the state of the renderer, so they are not set by the workers
+        SetShaderUniformBlockBindings(program.handle);
+        SetShaderSamplerBindings(program.handle);
+        return true;
+    }
+
+    /// Builds the stage from a shader stored in the disk cache
+    void CreateFromDiskCache(const ShaderDiskCacheEntry& entry, GLenum type) {
+        if (entry.binary.empty() || !CreateFromBinary(entry.binary_format, entry.binary)) {
+            Create(entry.source.c_str(), type);
+        }
+    }
+
+    bool IsProgram() const {
+        return shader_or_program.which() == 1;
+    }
+
     GLuint GetHandle() const {
         if (shader_or_program.which() == 0) {
             return boost::get<OGLShader>(shader_or_program).handle;
@@ -124,6 +188,7 @@ public:
 
 private:
     boost::variant<OGLShader, OGLProgram> shader_or_program;
+    std::shared_ptr<AsyncShaderCompiler::Job> job;
 };
 
 class TrivialVertexShader {
@@ -139,20 +204,86 @@ private:
     OGLShaderStage program;
 };
 
+/// Stores a newly generated shader, along with its binary when the stage is a separable program
+template <typename KeyConfigType>
+static void SaveToDiskCache(ShaderDiskCache& disk_cache, ShaderDiskCacheType type,
+                            const KeyConfigType& config, const std::string& source,
+                            const OGLShaderStage* stage) {
+    const u64 config_hash = config.Hash();
+    disk_cache.SaveSource(type, config_hash, &config.state, sizeof(config.state), source);
+    if (stage != nullptr && stage->IsProgram()) {
+        disk_cache.SaveBinary(type, config_hash, stage->GetHandle());
+    }
+}
+
+/// Restores the config a shader read from the disk cache was generated from
+template <typename KeyConfigType>
+static bool ReadDiskCacheConfig(const ShaderDiskCacheEntry& entry, KeyConfigType& config) {
+    if (entry.config.size() != sizeof(config.state)) {
+        return false;
+    }
+    std::memcpy(&config.state, entry.config.data(), sizeof(config.state));
+    return true;
+}
+
+/// Returns false while the stage is compiled in the background, and stores its binary once done
+template <typename KeyConfigType>
+static bool FinishCompiling(OGLShaderStage& stage, ShaderDiskCacheType type,
+                            const KeyConfigType& config, ShaderDiskCache* disk_cache) {
+    if (!stage.IsCompiling()) {
+        return true;
+    }
+    if (!stage.TryFinishCompiling()) {
+        return false;
+    }
+    if (disk_cache != nullptr) {
+        disk_cache->SaveBinary(type, config.Hash(), stage.GetHandle());
+    }
+    return true;
+}
+
 template <typename KeyConfigType, std::string (*CodeGenerator)(const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheType DiskCacheType>
 class ShaderCache {
 public:
     explicit ShaderCache(bool separable) : separable(separable) {}
-    GLuint Get(const KeyConfigType& config) {
+    /// Returns 0 while the shader is compiled in the background by the compiler, if any
+    GLuint Get(const KeyConfigType& config, ShaderDiskCache* disk_cache,
+               AsyncShaderCompiler* compiler) {
         auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
-            cached_shader.Create(CodeGenerator(config, separable).c_str(), ShaderType);
+            std::string source = CodeGenerator(config, separable);
+            if (compiler != nullptr) {
+                if (disk_cache != nullptr) {
+                    SaveToDiskCache(*disk_cache, DiskCacheType, config, source, nullptr);
+                }
+                cached_shader.CreateAsync(*compiler, std::move(source), ShaderType);
+            } else {
+                cached_shader.Create(source.c_str(), ShaderType);
+                if (disk_cache != nullptr) {
+                    SaveToDiskCache(*disk_cache, DiskCacheType, config, source, &cached_shader);
+                }
+            }
+        }
+        if (!FinishCompiling(cached_shader, DiskCacheType, config, disk_cache)) {
+            return 0;
         }
         return cached_shader.GetHandle();
     }
 
+    bool LoadFromDiskCache(const ShaderDiskCacheEntry& entry) {
+        KeyConfigType config;
+        if (!ReadDiskCacheConfig(entry, config)) {
+            return false;
+        }
+        auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
+        if (new_shader) {
+            iter->second.CreateFromDiskCache(entry, ShaderType);
+        }
+        return true;
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage> shaders;
@@ -166,11 +297,13 @@ private:
 template <typename KeyConfigType,
           std::optional<std::string> (*CodeGenerator)(const Pica::Shader::ShaderSetup&,
                                                       const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheType DiskCacheType>
 class ShaderDoubleCache {
 public:
     explicit ShaderDoubleCache(bool separable) : separable(separable) {}
-    GLuint Get(const KeyConfigType& key, const Pica::Shader::ShaderSetup& setup) {
+    /// Returns 0 if the PICA shader cannot be translated, or while it is compiled in the background
+    GLuint Get(const KeyConfigType& key, const Pica::Shader::ShaderSetup& setup,
+               ShaderDiskCache* disk_cache, AsyncShaderCompiler* compiler) {
         auto map_it = shader_map.find(key);
         if (map_it == shader_map.end()) {
             auto program_opt = CodeGenerator(setup, key, separable);
@@ -182,20 +315,42 @@ public:
             std::string& program = *program_opt;
             auto [iter, new_shader] = shader_cache.emplace(program, OGLShaderStage{separable});
             OGLShaderStage& cached_shader = iter->second;
-            if (new_shader) {
+            const bool compile_async = new_shader && compiler != nullptr;
+            if (new_shader && !compile_async) {
                 cached_shader.Create(program.c_str(), ShaderType);
             }
-            shader_map[key] = &cached_shader;
-            return cached_shader.GetHandle();
+            if (disk_cache != nullptr) {
+                SaveToDiskCache(*disk_cache, DiskCacheType, key, program,
+                                new_shader && !compile_async ? &cached_shader : nullptr);
+            }
+            if (compile_async) {
+                cached_shader.CreateAsync(*compiler, std::move(program), ShaderType);
+            }
+            map_it = shader_map.emplace(key, &cached_shader).first;
         }
 
-        if (map_it->second == nullptr) {
+        if (map_it->second == nullptr ||
+            !FinishCompiling(*map_it->second, DiskCacheType, key, disk_cache)) {
             return 0;
         }
 
         return map_it->second->GetHandle();
     }
 
+    bool LoadFromDiskCache(const ShaderDiskCacheEntry& entry) {
+        KeyConfigType key;
+        if (!ReadDiskCacheConfig(entry, key)) {
+            return false;
+        }
+        auto [iter, new_shader] = shader_cache.emplace(entry.source, OGLShaderStage{separable});
+        OGLShaderStage& cached_shader = iter->second;
+        if (new_shader) {
+            cached_shader.CreateFromDiskCache(entry, ShaderType);
+        }
+        shader_map[key] = &cached_shader;
+        return true;
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage*> shader_map;
@@ -203,24 +358,79 @@ private:
 };
 
 using ProgrammableVertexShaders =
-    ShaderDoubleCache<PicaVSConfig, &GenerateVertexShader, GL_VERTEX_SHADER>;
+    ShaderDoubleCache<PicaVSConfig, &GenerateVertexShader, GL_VERTEX_SHADER,
+                      ShaderDiskCacheType::ProgrammableVertex>;
 
 using ProgrammableGeometryShaders =
-    ShaderDoubleCache<PicaGSConfig, &GenerateGeometryShader, GL_GEOMETRY_SHADER>;
+    ShaderDoubleCache<PicaGSConfig, &GenerateGeometryShader, GL_GEOMETRY_SHADER,
+                      ShaderDiskCacheType::ProgrammableGeometry>;
 
 using FixedGeometryShaders =
-    ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER>;
+    ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER,
+                ShaderDiskCacheType::FixedGeometry>;
 
-using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER>;
+using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER,
+                                    ShaderDiskCacheType::Fragment>;
 
 class ShaderProgramManager::Impl {
 public:
-    explicit Impl(bool separable, bool is_amd)
+    explicit Impl(Frontend::EmuWindow& emu_window, bool separable, bool is_amd)
         : is_amd(is_amd), separable(separable), programmable_vertex_shaders(separable),
           trivial_vertex_shader(separable), programmable_geometry_shaders(separable),
           fixed_geometry_shaders(separable), fragment_shaders(separable) {
         if (separable)
             pipeline.Create();
+
+        // Each stage is a program of its own only with separable shaders, so that is the only
+        // mode where the compilation can be moved off the renderer thread
+        if (separable && Settings::values.async_shader_compilation) {
+            const std::size_t num_threads =
+                std::clamp<std::size_t>(Common::ThreadPool::DefaultThreadCount() / 2, 1, 4);
+            async_compiler = std::make_unique<AsyncShaderCompiler>(emu_window, num_threads);
+            if (async_compiler->IsAvailable()) {
+                uber_fragment_shader.Create(GenerateUberFragmentShader(true).c_str(),
+                                            GL_FRAGMENT_SHADER);
+                skip_pending_draws = Settings::values.async_shader_skip_draws;
+            } else {
+                async_compiler.reset();
+            }
+        }
+    }
+
+    /// Returns the compiler of the shader stages which can be built in the background
+    AsyncShaderCompiler* GetAsyncCompiler() const {
+        return async_compiler.get();
+    }
+
+    /// Configures the generic fragment shader to emulate the given config
+    void SetUberFragmentShaderUniforms(const PicaFSConfig& config) {
+        const GLuint handle = uber_fragment_shader.GetHandle();
+        const auto& state = config.state;
+        const auto location = [handle](const char* name) {
+            return glGetUniformLocation(handle, name);
+        };
+
+        std::array<GLint, 4 * 6> tev_stages;
+        for (std::size_t i = 0; i < state.tev_stages.size(); ++i) {
+            tev_stages[i * 4 + 0] = static_cast<GLint>(state.tev_stages[i].sources_raw);
+            tev_stages[i * 4 + 1] = static_cast<GLint>(state.tev_stages[i].modifiers_raw);
+            tev_stages[i * 4 + 2] = static_cast<GLint>(state.tev_stages[i].ops_raw);
+            tev_stages[i * 4 + 3] = static_cast<GLint>(state.tev_stages[i].scales_raw);
+        }
+        glProgramUniform4iv(handle, location("tev_stages"),
+                            static_cast<GLsizei>(state.tev_stages.size()), tev_stages.data());
+        glProgramUniform1i(handle, location("tev_combiner_buffer_input"),
+                           state.combiner_buffer_input);
+        glProgramUniform1i(handle, location("alpha_test_func"),
+                           static_cast<GLint>(state.alpha_test_func));
+        glProgramUniform1i(handle, location("scissor_test_mode"),
+                           static_cast<GLint>(state.scissor_test_mode));
+        glProgramUniform1i(handle, location("texture0_type"),
+                           static_cast<GLint>(state.texture0_type));
+        glProgramUniform1i(handle, location("texture2_use_coord1"), state.texture2_use_coord1);
+        glProgramUniform1i(handle, location("w_buffering"),
+                           state.depthmap_enable ==
+                               Pica::RasterizerRegs::DepthBuffering::WBuffering);
     }
 
     struct ShaderTuple {
@@ -262,16 +472,59 @@ public:
     bool separable;
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
+
+    std::unique_ptr<ShaderDiskCache> disk_cache;
+
+    OGLShaderStage uber_fragment_shader{true};
+    bool skip_pending_draws = false;
+    // Declared last, so that the workers are joined before anything else is destroyed
+    std::unique_ptr<AsyncShaderCompiler> async_compiler;
 };
 
-ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
-    : impl(std::make_unique<Impl>(separable, is_amd)) {}
+ShaderProgramManager::ShaderProgramManager(Frontend::EmuWindow& emu_window, bool separable,
+                                           bool is_amd)
+    : impl(std::make_unique<Impl>(emu_window, separable, is_amd)) {}
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
+void ShaderProgramManager::LoadDiskCache(u64 program_id) {
+    impl->disk_cache = std::make_unique<ShaderDiskCache>(program_id, impl->separable);
+    const std::vector<ShaderDiskCacheEntry> entries = impl->disk_cache->Load();
+
+    std::size_t num_loaded = 0;
+    std::size_t num_binaries = 0;
+    for (const ShaderDiskCacheEntry& entry : entries) {
+        bool loaded = false;
+        switch (entry.type) {
+        case ShaderDiskCacheType::ProgrammableVertex:
+            loaded = impl->programmable_vertex_shaders.LoadFromDiskCache(entry);
+            break;
+        case ShaderDiskCacheType::ProgrammableGeometry:
+            loaded = impl->programmable_geometry_shaders.LoadFromDiskCache(entry);
+            break;
+        case ShaderDiskCacheType::FixedGeometry:
+            loaded = impl->fixed_geometry_shaders.LoadFromDiskCache(entry);
+            break;
+        case ShaderDiskCacheType::Fragment:
+            loaded = impl->fragment_shaders.LoadFromDiskCache(entry);
+            break;
+        default:
+            break;
+        }
+        if (loaded) {
+            ++num_loaded;
+            num_binaries += entry.binary.empty() ? 0 : 1;
+        }
+    }
+
+    LOG_INFO(Render_OpenGL, "Loaded {} shaders ({} program binaries) for title {:016X}",
+             num_loaded, num_binaries, program_id);
+}
+
 bool ShaderProgramManager::UseProgrammableVertexShader(const PicaVSConfig& config,
                                                        const Pica::Shader::ShaderSetup setup) {
-    GLuint handle = impl->programmable_vertex_shaders.Get(config, setup);
+    GLuint handle = impl->programmable_vertex_shaders.Get(config, setup, impl->disk_cache.get(),
+                                                          impl->GetAsyncCompiler());
     if (handle == 0)
         return false;
     impl->current.vs = handle;
@@ -284,7 +537,8 @@ void ShaderProgramManager::UseTrivialVertexShader() {
 
 bool ShaderProgramManager::UseProgrammableGeometryShader(const PicaGSConfig& config,
                                                          const Pica::Shader::ShaderSetup setup) {
-    GLuint handle = impl->programmable_geometry_shaders.Get(config, setup);
+    GLuint handle =
+        impl->programmable_geometry_shaders.Get(config, setup, impl->disk_cache.get(), nullptr);
     if (handle == 0)
         return false;
     impl->current.gs = handle;
@@ -292,15 +546,34 @@ bool ShaderProgramManager::UseProgrammableGeometryShader(const PicaGSConfig& con
 }
 
 void ShaderProgramManager::UseFixedGeometryShader(const PicaFixedGSConfig& config) {
-    impl->current.gs = impl->fixed_geometry_shaders.Get(config);
+    impl->current.gs = impl->fixed_geometry_shaders.Get(config, impl->disk_cache.get(), nullptr);
 }
 
 void ShaderProgramManager::UseTrivialGeometryShader() {
     impl->current.gs = 0;
 }
 
-void ShaderProgramManager::UseFragmentShader(const PicaFSConfig& config) {
-    impl->current.fs = impl->fragment_shaders.Get(config);
+bool ShaderProgramManager::UseFragmentShader(const PicaFSConfig& config) {
+    const GLuint handle =
+        impl->fragment_shaders.Get(config, impl->disk_cache.get(), impl->GetAsyncCompiler());
+    if (handle != 0) {
+        impl->current.fs = handle;
+        return true;
+    }
+
+    // The generic shader emulates neither fragment lighting, fog nor procedural textures, and it
+    // cannot render shadows at all
+    if (impl->skip_pending_draws || config.state.shadow_rendering) {
+        impl->current.fs = 0;
+    } else {
+        impl->SetUberFragmentShaderUniforms(config);
+        impl->current.fs = impl->uber_fragment_shader.GetHandle();
+    }
+    return false;
+}
+
+bool ShaderProgramManager::HasFragmentShader() const {
+    return impl->current.fs != 0;
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
@@ -12,6 +12,10 @@
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 
+namespace Frontend {
+class EmuWindow;
+}
+
 namespace OpenGL {
 
 enum class UniformBindings : GLuint { Common, VS, GS };
@@ -103,9 +107,12 @@ static_assert(sizeof(GSUniformData) < 16384,
 /// A class that manage different shader stages and configures them with given config data.
 class ShaderProgramManager {
 public:
-    ShaderProgramManager(bool separable, bool is_amd);
+    ShaderProgramManager(Frontend::EmuWindow& emu_window, bool separable, bool is_amd);
     ~ShaderProgramManager();
 
+    /// Builds the shaders the title used in previous runs, and stores the new ones from now on
+    void LoadDiskCache(u64 program_id);
+
     bool UseProgrammableVertexShader(const PicaVSConfig& config,
                                      const Pica::Shader::ShaderSetup setup);
 
@@ -118,7 +125,15 @@ public:
 
     void UseTrivialGeometryShader();
 
-    void UseFragmentShader(const PicaFSConfig& config);
+    /**
+     * Uses the fragment shader generated for the config. While it is compiled in the background,
+     * the generic fragment shader is used instead, unless draws are to be skipped meanwhile.
+     * @returns false if the generated shader is not ready yet
+     */
+    bool UseFragmentShader(const PicaFSConfig& config);
+
+    /// Returns false if the current draws must be skipped, as no fragment shader can be used
+    bool HasFragmentShader() const;
 
     void ApplyTo(OpenGLState& state);
 
@@ -82,6 +82,10 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
 
     if (separable_program) {
         glProgramParameteri(program_id, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        if (GLAD_GL_ARB_get_program_binary || GLAD_GL_ES_VERSION_3_0) {
+            // Separable programs are stored in the shader disk cache
+            glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
     }
 
     glLinkProgram(program_id);
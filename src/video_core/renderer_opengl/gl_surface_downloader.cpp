@@ -0,0 +1,195 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+#include "video_core/renderer_opengl/gl_surface_downloader.h"
+#include "video_core/video_core.h"
+
+MICROPROFILE_DEFINE(OpenGL_DownloadWait, "OpenGL", "Surface Download Wait", MP_RGB(128, 64, 64));
+MICROPROFILE_DEFINE(OpenGL_DownloadConvert, "OpenGL", "Surface Download Convert",
+                    MP_RGB(128, 192, 64));
+
+namespace OpenGL {
+
+SurfaceDownloader::SurfaceDownloader() = default;
+
+SurfaceDownloader::~SurfaceDownloader() {
+    for (auto& slot : slots) {
+        Release(slot);
+    }
+}
+
+bool SurfaceDownloader::IsSupported(const CachedSurface& surface) {
+    // Depth surfaces cannot be read back on every GLES implementation, they are flushed as before
+    return surface.type == SurfaceParams::SurfaceType::Color;
+}
+
+bool SurfaceDownloader::Queue(const Surface& surface, SurfaceInterval interval,
+                              GLuint read_fb_handle, GLuint draw_fb_handle) {
+    ASSERT(IsSupported(*surface));
+
+    for (const auto& slot : slots) {
+        if (slot.state != SlotState::Empty && slot.surface.lock() == surface &&
+            boost::icl::contains(slot.interval, interval)) {
+            // Already downloaded since the surface was last written
+            return true;
+        }
+    }
+
+    // Flushes are clamped to the VRAM boundaries, leave these regions to the regular path
+    const PAddr start = boost::icl::first(interval);
+    const PAddr end = boost::icl::last_next(interval);
+    if ((start < Memory::VRAM_VADDR_END && end > Memory::VRAM_VADDR_END) ||
+        (start < Memory::VRAM_VADDR && end > Memory::VRAM_VADDR) ||
+        VideoCore::g_memory->GetPhysicalPointer(start) == nullptr) {
+        return false;
+    }
+
+    // Replacing a download the GPU or the worker thread is still busy with would waste it
+    std::size_t index = next_slot;
+    while (slots[index].state == SlotState::Reading ||
+           slots[index].state == SlotState::Converting) {
+        index = (index + 1) % slots.size();
+        if (index == next_slot) {
+            return false;
+        }
+    }
+    Slot& slot = slots[index];
+    next_slot = (index + 1) % slots.size();
+    Release(slot);
+
+    slot.surface = surface;
+    slot.params = *surface;
+    slot.interval = interval;
+
+    const GLsizeiptr buffer_size =
+        surface->width * surface->height * CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    slot.buffer.Create();
+    if (slot.buffer_size < buffer_size) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.handle);
+        glBufferData(GL_PIXEL_PACK_BUFFER, buffer_size, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.buffer_size = buffer_size;
+    }
+
+    surface->ReadPixelsToBuffer(surface->GetSubRect(surface->FromInterval(interval)),
+                                slot.buffer.handle, read_fb_handle, draw_fb_handle);
+    slot.fence.Create();
+    slot.state = SlotState::Reading;
+    return true;
+}
+
+void SurfaceDownloader::Poll() {
+    for (auto& slot : slots) {
+        if (slot.state == SlotState::Reading) {
+            const GLenum result = glClientWaitSync(slot.fence.handle, 0, 0);
+            if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+                StartConversion(slot);
+            }
+        } else if (slot.state == SlotState::Converting &&
+                   slot.conversion.wait_for(std::chrono::seconds(0)) ==
+                       std::future_status::ready) {
+            FinishConversion(slot);
+        }
+    }
+}
+
+bool SurfaceDownloader::Flush(const Surface& surface, SurfaceInterval interval) {
+    const auto it = std::find_if(slots.begin(), slots.end(), [&](const Slot& slot) {
+        return slot.state != SlotState::Empty && slot.surface.lock() == surface &&
+               boost::icl::contains(slot.interval, interval);
+    });
+    if (it == slots.end()) {
+        return false;
+    }
+    Slot& slot = *it;
+
+    if (slot.state == SlotState::Reading) {
+        MICROPROFILE_SCOPE(OpenGL_DownloadWait);
+        GLenum result;
+        do {
+            result = glClientWaitSync(slot.fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+        if (result == GL_WAIT_FAILED) {
+            Release(slot);
+            return false;
+        }
+        StartConversion(slot);
+    }
+    if (slot.state == SlotState::Converting) {
+        MICROPROFILE_SCOPE(OpenGL_DownloadWait);
+        FinishConversion(slot);
+    }
+    if (slot.state != SlotState::Ready) {
+        return false;
+    }
+
+    u8* const dest = VideoCore::g_memory->GetPhysicalPointer(boost::icl::first(interval));
+    if (dest != nullptr) {
+        std::memcpy(dest,
+                    &slot.data[boost::icl::first(interval) - boost::icl::first(slot.interval)],
+                    boost::icl::length(interval));
+    }
+    return true;
+}
+
+bool SurfaceDownloader::Discard(const Surface& surface) {
+    bool discarded = false;
+    for (auto& slot : slots) {
+        if (slot.state != SlotState::Empty && slot.surface.lock() == surface) {
+            Release(slot);
+            discarded = true;
+        }
+    }
+    return discarded;
+}
+
+void SurfaceDownloader::StartConversion(Slot& slot) {
+    slot.fence.Release();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.handle);
+    slot.mapped = static_cast<u8*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.buffer_size, GL_MAP_READ_BIT));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (slot.mapped == nullptr) {
+        Release(slot);
+        return;
+    }
+
+    slot.data.resize(boost::icl::length(slot.interval));
+    auto task = std::make_shared<std::packaged_task<void()>>([&slot] {
+        MICROPROFILE_SCOPE(OpenGL_DownloadConvert);
+        CachedSurface::ConvertGLBuffer(slot.params, slot.mapped, boost::icl::first(slot.interval),
+                                       boost::icl::last_next(slot.interval), slot.data.data());
+    });
+    slot.conversion = task->get_future();
+    worker.QueueWork([task] { (*task)(); });
+    slot.state = SlotState::Converting;
+}
+
+void SurfaceDownloader::FinishConversion(Slot& slot) {
+    slot.conversion.get();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.handle);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.mapped = nullptr;
+    slot.state = SlotState::Ready;
+}
+
+void SurfaceDownloader::Release(Slot& slot) {
+    if (slot.state == SlotState::Converting) {
+        FinishConversion(slot);
+    }
+    slot.fence.Release();
+    slot.surface.reset();
+    slot.state = SlotState::Empty;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,97 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/thread_pool.h"
+#include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Reads back the dirty regions of surfaces before they are flushed. The pixels are read into a
+ * ring of pixel pack buffers without waiting for the GPU, and are only waited for when the region
+ * actually gets flushed, by which time they are usually ready. Once the GPU is done with them, they
+ * are converted to the 3DS memory layout on a worker thread.
+ */
+class SurfaceDownloader : NonCopyable {
+public:
+    /// Number of downloads held at once
+    static constexpr std::size_t NumSlots = 8;
+
+    SurfaceDownloader();
+    ~SurfaceDownloader();
+
+    /// Returns true if the regions of the surface can be downloaded ahead of time
+    static bool IsSupported(const CachedSurface& surface);
+
+    /**
+     * Starts reading back an interval of the surface, which must be valid in its texture. The
+     * downloads still in flight are kept, nothing is read back if all of them are.
+     * @return true if the interval was already downloaded or started being read back
+     */
+    bool Queue(const Surface& surface, SurfaceInterval interval, GLuint read_fb_handle,
+               GLuint draw_fb_handle);
+
+    /// Starts converting the downloads the GPU is done with, without waiting for the others
+    void Poll();
+
+    /**
+     * Writes an interval of the surface to 3DS memory from a previous download.
+     * @return false if no download covers the interval, in which case nothing is written
+     */
+    bool Flush(const Surface& surface, SurfaceInterval interval);
+
+    /**
+     * Drops the downloads of the surface, as its texture has been written since.
+     * @return true if any download was dropped
+     */
+    bool Discard(const Surface& surface);
+
+private:
+    enum class SlotState {
+        Empty,
+        /// The pixels are being read by the GPU
+        Reading,
+        /// The buffer is mapped while the pixels are being converted on the worker thread
+        Converting,
+        /// The converted data is ready to be written to memory
+        Ready,
+    };
+
+    struct Slot {
+        SlotState state = SlotState::Empty;
+        std::weak_ptr<CachedSurface> surface;
+        /// Copy of the parameters of the surface, as read by the worker thread
+        SurfaceParams params;
+        SurfaceInterval interval;
+
+        OGLBuffer buffer;
+        GLsizeiptr buffer_size = 0;
+        OGLSync fence;
+        u8* mapped = nullptr;
+        std::future<void> conversion;
+        /// Contents of the interval in the 3DS memory layout
+        std::vector<u8> data;
+    };
+
+    void StartConversion(Slot& slot);
+    void FinishConversion(Slot& slot);
+    void Release(Slot& slot);
+
+    std::array<Slot, NumSlots> slots;
+    std::size_t next_slot = 0;
+    Common::ThreadPool worker{1, "SurfaceDownload"};
+};
+
+} // namespace OpenGL
@@ -171,6 +171,7 @@ void RendererOpenGL::SwapBuffers() {
 
     DrawScreens(render_window.GetFramebufferLayout());
 
+    NotifyFramePresented();
     Core::System::GetInstance().perf_stats.EndSystemFrame();
 
     // Swap buffers
@@ -4,9 +4,12 @@
 
 #include <cmath>
 #include <cstring>
+#include <memory>
 #include "common/bit_set.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread_pool.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_rasterizer.h"
 #include "video_core/regs_shader.h"
@@ -138,6 +141,7 @@ MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
 static std::unique_ptr<JitX64Engine> jit_engine;
 #endif // ARCHITECTURE_x86_64
 static InterpreterEngine interpreter_engine;
+static std::unique_ptr<Common::ThreadPool> worker_pool;
 
 ShaderEngine* GetEngine() {
 #ifdef ARCHITECTURE_x86_64
@@ -153,10 +157,27 @@ ShaderEngine* GetEngine() {
     return &interpreter_engine;
 }
 
+Common::ThreadPool* GetWorkerPool() {
+    const std::size_t num_threads = Settings::values.sw_shader_threads == 0
+                                        ? Common::ThreadPool::DefaultThreadCount()
+                                        : Settings::values.sw_shader_threads;
+    if (num_threads <= 1) {
+        worker_pool = nullptr;
+        return nullptr;
+    }
+
+    // The calling thread takes part in the work, so it is not counted as a worker
+    if (worker_pool == nullptr || worker_pool->NumThreads() != num_threads - 1) {
+        worker_pool = std::make_unique<Common::ThreadPool>(num_threads - 1, "VertexShader");
+    }
+    return worker_pool.get();
+}
+
 void Shutdown() {
 #ifdef ARCHITECTURE_x86_64
     jit_engine = nullptr;
 #endif // ARCHITECTURE_x86_64
+    worker_pool = nullptr;
 }
 
 } // namespace Pica::Shader
@@ -22,6 +22,10 @@ using nihstro::DestRegister;
 using nihstro::RegisterType;
 using nihstro::SourceRegister;
 
+namespace Common {
+class ThreadPool;
+}
+
 namespace Pica::Shader {
 
 constexpr unsigned MAX_PROGRAM_CODE_LENGTH = 4096;
@@ -258,6 +262,13 @@ public:
 
 // TODO(yuriks): Remove and make it non-global state somewhere
 ShaderEngine* GetEngine();
+
+/**
+ * Returns the pool used to run the vertex shader of large draws on several threads at once, or
+ * nullptr if vertex shading is configured to be single-threaded.
+ */
+Common::ThreadPool* GetWorkerPool();
+
 void Shutdown();
 
 } // namespace Pica::Shader
@@ -0,0 +1,101 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "common/math_util.h"
+#include "common/microprofile.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/binner.h"
+
+namespace Pica::Rasterizer {
+
+// Rasterizer coordinates are 12.4 fixed-point values, so no pixel can lie beyond this
+constexpr unsigned MAX_PIXEL_COORDINATE = 0x1000;
+
+MICROPROFILE_DEFINE(GPU_Binning, "GPU", "Binning", MP_RGB(50, 100, 240));
+
+TileBinner::TileBinner(std::size_t num_threads)
+    : workers(std::max<std::size_t>(num_threads, 1) - 1, "SWRasterizer") {}
+
+TileBinner::~TileBinner() = default;
+
+void TileBinner::SetupGrid() {
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    tiles_x = std::max((framebuffer.GetWidth() + TILE_SIZE - 1) / TILE_SIZE, 1u);
+    tiles_y = std::max((framebuffer.GetHeight() + TILE_SIZE - 1) / TILE_SIZE, 1u);
+    if (bins.size() < tiles_x * tiles_y) {
+        bins.resize(tiles_x * tiles_y);
+    }
+}
+
+void TileBinner::AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    MICROPROFILE_SCOPE(GPU_Binning);
+
+    if (triangles.empty()) {
+        SetupGrid();
+    }
+
+    // Same conversion to 12.4 fixed-point as done by the rasterizer
+    auto FloatToFix = [](float24 flt) {
+        return static_cast<u16>(std::round(flt.ToFloat32() * 16.0f));
+    };
+    const u16 x0 = FloatToFix(v0.screenpos.x), x1 = FloatToFix(v1.screenpos.x),
+              x2 = FloatToFix(v2.screenpos.x);
+    const u16 y0 = FloatToFix(v0.screenpos.y), y1 = FloatToFix(v1.screenpos.y),
+              y2 = FloatToFix(v2.screenpos.y);
+
+    // Conservative range of pixels touched by the triangle. Everything beyond the framebuffer is
+    // assigned to the tiles on the right and bottom border.
+    const unsigned min_tile_x = std::min(std::min({x0, x1, x2}) / 16u / TILE_SIZE, tiles_x - 1);
+    const unsigned min_tile_y = std::min(std::min({y0, y1, y2}) / 16u / TILE_SIZE, tiles_y - 1);
+    const unsigned max_tile_x =
+        std::min((std::max({x0, x1, x2}) + 15u) / 16u / TILE_SIZE, tiles_x - 1);
+    const unsigned max_tile_y =
+        std::min((std::max({y0, y1, y2}) + 15u) / 16u / TILE_SIZE, tiles_y - 1);
+
+    const u32 triangle_index = static_cast<u32>(triangles.size());
+    triangles.push_back({v0, v1, v2});
+
+    for (unsigned tile_y = min_tile_y; tile_y <= max_tile_y; ++tile_y) {
+        for (unsigned tile_x = min_tile_x; tile_x <= max_tile_x; ++tile_x) {
+            const u32 bin_index = tile_y * tiles_x + tile_x;
+            auto& bin = bins[bin_index];
+            if (bin.empty()) {
+                used_bins.push_back(bin_index);
+            }
+            bin.push_back(triangle_index);
+        }
+    }
+}
+
+void TileBinner::Flush() {
+    if (triangles.empty()) {
+        return;
+    }
+
+    workers.ParallelFor(used_bins.size(), [this](std::size_t i) {
+        const u32 bin_index = used_bins[i];
+        const unsigned tile_x = bin_index % tiles_x;
+        const unsigned tile_y = bin_index / tiles_x;
+        const Common::Rectangle<unsigned> bounds{
+            tile_x * TILE_SIZE,
+            tile_y * TILE_SIZE,
+            tile_x == tiles_x - 1 ? MAX_PIXEL_COORDINATE : (tile_x + 1) * TILE_SIZE,
+            tile_y == tiles_y - 1 ? MAX_PIXEL_COORDINATE : (tile_y + 1) * TILE_SIZE,
+        };
+
+        auto& bin = bins[bin_index];
+        for (u32 triangle_index : bin) {
+            const auto& triangle = triangles[triangle_index];
+            ProcessTriangle(triangle[0], triangle[1], triangle[2], bounds);
+        }
+        bin.clear();
+    });
+
+    used_bins.clear();
+    triangles.clear();
+}
+
+} // namespace Pica::Rasterizer
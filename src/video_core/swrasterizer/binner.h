@@ -0,0 +1,55 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_pool.h"
+#include "video_core/swrasterizer/rasterizer.h"
+
+namespace Pica::Rasterizer {
+
+/**
+ * Defers rasterization of screen-space triangles and shades them in parallel.
+ *
+ * Triangles are sorted into bins of TILE_SIZE x TILE_SIZE framebuffer pixels based on their
+ * bounding box. On Flush(), each tile is rasterized by a single thread, in submission order, so
+ * the result is identical to rasterizing the triangles one after another. Tiles never share any
+ * pixel, hence no synchronization is needed between them.
+ *
+ * The rasterizer reads the current PICA register state, so all queued triangles have to be
+ * flushed before any register affecting rasterization is changed.
+ */
+class TileBinner {
+public:
+    static constexpr unsigned TILE_SIZE = 16;
+
+    /// @param num_threads Total number of threads shading tiles, including the flushing thread
+    explicit TileBinner(std::size_t num_threads);
+    ~TileBinner();
+
+    /// Queues the triangle into every tile its bounding box overlaps
+    void AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
+    /// Rasterizes all queued triangles and blocks until they have been written to memory
+    void Flush();
+
+private:
+    /// Sizes the tile grid to cover the currently configured framebuffer
+    void SetupGrid();
+
+    std::vector<std::array<Vertex, 3>> triangles;
+    std::vector<std::vector<u32>> bins;
+    /// Indices of the bins that received at least one triangle since the last flush
+    std::vector<u32> used_bins;
+    unsigned tiles_x = 0;
+    unsigned tiles_y = 0;
+
+    Common::ThreadPool workers;
+};
+
+} // namespace Pica::Rasterizer
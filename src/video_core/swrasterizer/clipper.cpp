@@ -14,6 +14,7 @@
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
 #include "video_core/shader/shader.h"
+#include "video_core/swrasterizer/binner.h"
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/rasterizer.h"
 
@@ -85,7 +86,8 @@ static void InitScreenCoordinates(Vertex& vtx) {
     vtx.screenpos[2] = vtx.pos.z * inv_w;
 }
 
-void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2) {
+void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2,
+                     Rasterizer::TileBinner* binner) {
     using boost::container::static_vector;
 
     // Clipping a planar n-gon against a plane will remove at least 1 vertex and introduces 2 at
@@ -190,7 +192,11 @@ void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const Outpu
             vtx2.screenpos.x.ToFloat32(), vtx2.screenpos.y.ToFloat32(),
             vtx2.screenpos.z.ToFloat32());
 
-        Rasterizer::ProcessTriangle(vtx0, vtx1, vtx2);
+        if (binner) {
+            binner->AddTriangle(vtx0, vtx1, vtx2);
+        } else {
+            Rasterizer::ProcessTriangle(vtx0, vtx1, vtx2);
+        }
     }
 }
 
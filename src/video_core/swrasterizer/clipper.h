@@ -9,11 +9,20 @@ namespace Shader {
 struct OutputVertex;
 }
 
+namespace Rasterizer {
+class TileBinner;
+}
+
 namespace Clipper {
 
 using Shader::OutputVertex;
 
-void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2);
+/**
+ * Clips the triangle and passes the result on for rasterization. If a binner is given, the
+ * resulting triangles are queued into it instead of being rasterized immediately.
+ */
+void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2,
+                     Rasterizer::TileBinner* binner = nullptr);
 
 } // namespace Clipper
 } // namespace Pica
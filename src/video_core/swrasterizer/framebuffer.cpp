@@ -8,9 +8,7 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/vector_math.h"
-#include "core/hw/gpu.h"
 #include "core/memory.h"
-#include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/swrasterizer/framebuffer.h"
 #include "video_core/utils.h"
@@ -18,207 +16,112 @@
 
 namespace Pica::Rasterizer {
 
-void DrawPixel(int x, int y, const Common::Vec4<u8>& color) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
+static Common::Vec4<u8> DecodeUnknownColor(const u8* pixel) {
+    return {0, 0, 0, 0};
+}
+
+static void EncodeUnknownColor(const Common::Vec4<u8>& color, u8* pixel) {}
+
+static u32 DecodeUnknownDepth(const u8* pixel) {
+    return 0;
+}
+
+static void EncodeUnknownDepth(u32 value, u8* pixel) {}
 
-    // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
-    // NOTE: The framebuffer height register contains the actual FB height minus one.
-    y = framebuffer.height - y;
+FramebufferView::FramebufferView(const FramebufferRegs& regs) {
+    using ColorFormat = FramebufferRegs::ColorFormat;
+    using DepthFormat = FramebufferRegs::DepthFormat;
 
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + dst_offset;
+    const auto& framebuffer = regs.framebuffer;
+    width = framebuffer.width;
+    height = framebuffer.height;
 
+    color_buffer =
+        VideoCore::g_memory->GetPhysicalPointer(framebuffer.GetColorBufferPhysicalAddress());
     switch (framebuffer.color_format) {
-    case FramebufferRegs::ColorFormat::RGBA8:
-        Color::EncodeRGBA8(color, dst_pixel);
+    case ColorFormat::RGBA8:
+        decode_color = Rasterizer::DecodeColor<ColorFormat::RGBA8>;
+        encode_color = Rasterizer::EncodeColor<ColorFormat::RGBA8>;
+        color_bytes_per_pixel = 4;
         break;
-
-    case FramebufferRegs::ColorFormat::RGB8:
-        Color::EncodeRGB8(color, dst_pixel);
+    case ColorFormat::RGB8:
+        decode_color = Rasterizer::DecodeColor<ColorFormat::RGB8>;
+        encode_color = Rasterizer::EncodeColor<ColorFormat::RGB8>;
+        color_bytes_per_pixel = 3;
         break;
-
-    case FramebufferRegs::ColorFormat::RGB5A1:
-        Color::EncodeRGB5A1(color, dst_pixel);
+    case ColorFormat::RGB5A1:
+        decode_color = Rasterizer::DecodeColor<ColorFormat::RGB5A1>;
+        encode_color = Rasterizer::EncodeColor<ColorFormat::RGB5A1>;
+        color_bytes_per_pixel = 2;
         break;
-
-    case FramebufferRegs::ColorFormat::RGB565:
-        Color::EncodeRGB565(color, dst_pixel);
+    case ColorFormat::RGB565:
+        decode_color = Rasterizer::DecodeColor<ColorFormat::RGB565>;
+        encode_color = Rasterizer::EncodeColor<ColorFormat::RGB565>;
+        color_bytes_per_pixel = 2;
         break;
-
-    case FramebufferRegs::ColorFormat::RGBA4:
-        Color::EncodeRGBA4(color, dst_pixel);
+    case ColorFormat::RGBA4:
+        decode_color = Rasterizer::DecodeColor<ColorFormat::RGBA4>;
+        encode_color = Rasterizer::EncodeColor<ColorFormat::RGBA4>;
+        color_bytes_per_pixel = 2;
         break;
-
     default:
         LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
                      static_cast<u32>(framebuffer.color_format.Value()));
         UNIMPLEMENTED();
+        decode_color = DecodeUnknownColor;
+        encode_color = EncodeUnknownColor;
+        color_bytes_per_pixel = 0;
+        break;
     }
-}
-
-const Common::Vec4<u8> GetPixel(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* src_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + src_offset;
-
-    switch (framebuffer.color_format) {
-    case FramebufferRegs::ColorFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
-    case FramebufferRegs::ColorFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
-
-    default:
-        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format {:x}",
-                     static_cast<u32>(framebuffer.color_format.Value()));
-        UNIMPLEMENTED();
-    }
-
-    return {0, 0, 0, 0};
-}
-
-u32 GetDepth(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
-
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D16:
-        return Color::DecodeD16(src_pixel);
-    case FramebufferRegs::DepthFormat::D24:
-        return Color::DecodeD24(src_pixel);
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Color::DecodeD24S8(src_pixel).x;
-    default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
-        UNIMPLEMENTED();
-        return 0;
-    }
-}
-
-u8 GetStencil(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
-
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Color::DecodeD24S8(src_pixel).y;
-
-    default:
-        LOG_WARNING(
-            HW_GPU,
-            "GetStencil called for function which doesn't have a stencil component (format {})",
-            static_cast<u32>(framebuffer.depth_format.Value()));
-        return 0;
-    }
-}
-
-void SetDepth(int x, int y, u32 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
 
+    depth_buffer =
+        VideoCore::g_memory->GetPhysicalPointer(framebuffer.GetDepthBufferPhysicalAddress());
     switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D16:
-        Color::EncodeD16(value, dst_pixel);
+    case DepthFormat::D16:
+        decode_depth = Rasterizer::DecodeDepth<DepthFormat::D16>;
+        encode_depth = Rasterizer::EncodeDepth<DepthFormat::D16>;
+        depth_bytes_per_pixel = 2;
+        depth_bits = 16;
         break;
-
-    case FramebufferRegs::DepthFormat::D24:
-        Color::EncodeD24(value, dst_pixel);
+    case DepthFormat::D24:
+        decode_depth = Rasterizer::DecodeDepth<DepthFormat::D24>;
+        encode_depth = Rasterizer::EncodeDepth<DepthFormat::D24>;
+        depth_bytes_per_pixel = 3;
+        depth_bits = 24;
         break;
-
-    case FramebufferRegs::DepthFormat::D24S8:
-        Color::EncodeD24X8(value, dst_pixel);
+    case DepthFormat::D24S8:
+        decode_depth = Rasterizer::DecodeDepth<DepthFormat::D24S8>;
+        encode_depth = Rasterizer::EncodeDepth<DepthFormat::D24S8>;
+        depth_bytes_per_pixel = 4;
+        depth_bits = 24;
         break;
-
     default:
         LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
                      static_cast<u32>(framebuffer.depth_format.Value()));
         UNIMPLEMENTED();
+        decode_depth = DecodeUnknownDepth;
+        encode_depth = EncodeUnknownDepth;
+        depth_bytes_per_pixel = 0;
+        depth_bits = 0;
         break;
     }
-}
-
-void SetStencil(int x, int y, u8 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = VideoCore::g_memory->GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
+    has_stencil = framebuffer.depth_format == DepthFormat::D24S8;
 
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
-
-    switch (framebuffer.depth_format) {
-    case Pica::FramebufferRegs::DepthFormat::D16:
-    case Pica::FramebufferRegs::DepthFormat::D24:
-        // Nothing to do
-        break;
+    shadow_constant = float16::FromRaw(regs.shadow.constant);
+    shadow_linear = float16::FromRaw(regs.shadow.linear);
+}
 
-    case Pica::FramebufferRegs::DepthFormat::D24S8:
-        Color::EncodeX24S8(value, dst_pixel);
-        break;
+u8 FramebufferView::DecodeStencil(const u8* pixel) const {
+    if (!has_stencil) {
+        LOG_WARNING(HW_GPU, "Reading stencil from a depth buffer without stencil component");
+        return 0;
+    }
+    return Color::DecodeD24S8(pixel).y;
+}
 
-    default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format {}",
-                     static_cast<u32>(framebuffer.depth_format.Value()));
-        UNIMPLEMENTED();
-        break;
+void FramebufferView::EncodeStencil(u8 value, u8* pixel) const {
+    if (has_stencil) {
+        Color::EncodeX24S8(value, pixel);
     }
 }
 
@@ -375,18 +278,9 @@ static void EncodeX24S8Shadow(u8 stencil, u8* bytes) {
     bytes[3] = stencil;
 }
 
-void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const auto& shadow = g_state.regs.framebuffer.shadow;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = 4;
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = VideoCore::g_memory->GetPhysicalPointer(addr) + dst_offset;
+void FramebufferView::DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) const {
+    // The shadow map is always stored with four bytes per pixel
+    u8* dst_pixel = color_buffer + GetPixelOffset(x, y, 4);
 
     auto ref = DecodeD24S8Shadow(dst_pixel);
     u32 ref_z = ref.x;
@@ -396,10 +290,9 @@ void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) {
         if (stencil == 0) {
             EncodeD24X8Shadow(depth, dst_pixel);
         } else {
-            float16 constant = float16::FromRaw(shadow.constant);
-            float16 linear = float16::FromRaw(shadow.linear);
             float16 x = float16::FromFloat32(static_cast<float>(depth) / ref_z);
-            float16 stencil_new = float16::FromFloat32(stencil) / (constant + linear * x);
+            float16 stencil_new =
+                float16::FromFloat32(stencil) / (shadow_constant + shadow_linear * x);
             stencil = static_cast<u8>(std::clamp(stencil_new.ToFloat32(), 0.0f, 255.0f));
 
             if (stencil < ref_s)
@@ -4,18 +4,163 @@
 
 #pragma once
 
+#include "common/color.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
+#include "video_core/pica_types.h"
 #include "video_core/regs_framebuffer.h"
+#include "video_core/utils.h"
 
 namespace Pica::Rasterizer {
 
-void DrawPixel(int x, int y, const Common::Vec4<u8>& color);
-const Common::Vec4<u8> GetPixel(int x, int y);
-u32 GetDepth(int x, int y);
-u8 GetStencil(int x, int y);
-void SetDepth(int x, int y, u32 value);
-void SetStencil(int x, int y, u8 value);
+/// Decodes a pixel of a color buffer with the given format
+template <FramebufferRegs::ColorFormat format>
+Common::Vec4<u8> DecodeColor(const u8* pixel) {
+    using ColorFormat = FramebufferRegs::ColorFormat;
+    if constexpr (format == ColorFormat::RGBA8) {
+        return Color::DecodeRGBA8(pixel);
+    } else if constexpr (format == ColorFormat::RGB8) {
+        return Color::DecodeRGB8(pixel);
+    } else if constexpr (format == ColorFormat::RGB5A1) {
+        return Color::DecodeRGB5A1(pixel);
+    } else if constexpr (format == ColorFormat::RGB565) {
+        return Color::DecodeRGB565(pixel);
+    } else {
+        static_assert(format == ColorFormat::RGBA4, "Unknown color format");
+        return Color::DecodeRGBA4(pixel);
+    }
+}
+
+/// Encodes a pixel of a color buffer with the given format
+template <FramebufferRegs::ColorFormat format>
+void EncodeColor(const Common::Vec4<u8>& color, u8* pixel) {
+    using ColorFormat = FramebufferRegs::ColorFormat;
+    if constexpr (format == ColorFormat::RGBA8) {
+        Color::EncodeRGBA8(color, pixel);
+    } else if constexpr (format == ColorFormat::RGB8) {
+        Color::EncodeRGB8(color, pixel);
+    } else if constexpr (format == ColorFormat::RGB5A1) {
+        Color::EncodeRGB5A1(color, pixel);
+    } else if constexpr (format == ColorFormat::RGB565) {
+        Color::EncodeRGB565(color, pixel);
+    } else {
+        static_assert(format == ColorFormat::RGBA4, "Unknown color format");
+        Color::EncodeRGBA4(color, pixel);
+    }
+}
+
+/// Decodes the depth component of a pixel of a depth buffer with the given format
+template <FramebufferRegs::DepthFormat format>
+u32 DecodeDepth(const u8* pixel) {
+    using DepthFormat = FramebufferRegs::DepthFormat;
+    if constexpr (format == DepthFormat::D16) {
+        return Color::DecodeD16(pixel);
+    } else if constexpr (format == DepthFormat::D24) {
+        return Color::DecodeD24(pixel);
+    } else {
+        static_assert(format == DepthFormat::D24S8, "Unknown depth format");
+        return Color::DecodeD24S8(pixel).x;
+    }
+}
+
+/// Encodes the depth component of a pixel of a depth buffer with the given format
+template <FramebufferRegs::DepthFormat format>
+void EncodeDepth(u32 value, u8* pixel) {
+    using DepthFormat = FramebufferRegs::DepthFormat;
+    if constexpr (format == DepthFormat::D16) {
+        Color::EncodeD16(value, pixel);
+    } else if constexpr (format == DepthFormat::D24) {
+        Color::EncodeD24(value, pixel);
+    } else {
+        static_assert(format == DepthFormat::D24S8, "Unknown depth format");
+        Color::EncodeD24X8(value, pixel);
+    }
+}
+
+/**
+ * The color and depth/stencil buffers of the current framebuffer configuration.
+ *
+ * Buffer pointers, row strides and pixel formats are resolved once on construction. Accessing a
+ * pixel then only involves computing its offset in the tiled buffer and calling an accessor that
+ * is specialized for the buffer format. Coordinates are in pixels, relative to the bottom-left
+ * corner of the framebuffer as used by the rasterizer.
+ *
+ * The view has to be recreated whenever the framebuffer registers change.
+ */
+class FramebufferView {
+public:
+    explicit FramebufferView(const FramebufferRegs& regs);
+
+    /// Returns a pointer to the color buffer pixel at the given position
+    u8* GetColorPointer(int x, int y) const {
+        return color_buffer + GetPixelOffset(x, y, color_bytes_per_pixel);
+    }
+
+    /// Returns a pointer to the depth/stencil buffer pixel at the given position
+    u8* GetDepthPointer(int x, int y) const {
+        return depth_buffer + GetPixelOffset(x, y, depth_bytes_per_pixel);
+    }
+
+    Common::Vec4<u8> DecodeColor(const u8* pixel) const {
+        return decode_color(pixel);
+    }
+
+    void EncodeColor(const Common::Vec4<u8>& color, u8* pixel) const {
+        encode_color(color, pixel);
+    }
+
+    u32 DecodeDepth(const u8* pixel) const {
+        return decode_depth(pixel);
+    }
+
+    void EncodeDepth(u32 value, u8* pixel) const {
+        encode_depth(value, pixel);
+    }
+
+    /// Returns the stencil value of a depth buffer pixel, or 0 if the format has no stencil
+    u8 DecodeStencil(const u8* pixel) const;
+
+    /// Sets the stencil value of a depth buffer pixel, if the format has a stencil component
+    void EncodeStencil(u8 value, u8* pixel) const;
+
+    /// Returns the number of bits of the depth component of the depth buffer
+    u32 GetDepthBits() const {
+        return depth_bits;
+    }
+
+    /// Updates the shadow map stored in the color buffer with the given fragment
+    void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) const;
+
+private:
+    u32 GetPixelOffset(int x, int y, u32 bytes_per_pixel) const {
+        // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
+        // NOTE: The framebuffer height register contains the actual FB height minus one.
+        y = height - y;
+
+        const u32 coarse_y = y & ~7;
+        return VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
+               coarse_y * width * bytes_per_pixel;
+    }
+
+    u32 width;
+    u32 height;
+
+    u8* color_buffer;
+    u32 color_bytes_per_pixel;
+    Common::Vec4<u8> (*decode_color)(const u8* pixel);
+    void (*encode_color)(const Common::Vec4<u8>& color, u8* pixel);
+
+    u8* depth_buffer;
+    u32 depth_bytes_per_pixel;
+    u32 depth_bits;
+    u32 (*decode_depth)(const u8* pixel);
+    void (*encode_depth)(u32 value, u8* pixel);
+    bool has_stencil;
+
+    float16 shadow_constant;
+    float16 shadow_linear;
+};
+
 u8 PerformStencilAction(FramebufferRegs::StencilAction action, u8 old_stencil, u8 ref);
 
 Common::Vec4<u8> EvaluateBlendEquation(const Common::Vec4<u8>& src,
@@ -26,6 +171,4 @@ Common::Vec4<u8> EvaluateBlendEquation(const Common::Vec4<u8>& src,
 
 u8 LogicOp(u8 src, u8 dest, FramebufferRegs::LogicOp op);
 
-void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil);
-
 } // namespace Pica::Rasterizer
@@ -4,8 +4,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <tuple>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/color.h"
@@ -27,6 +31,7 @@
 #include "video_core/swrasterizer/lighting.h"
 #include "video_core/swrasterizer/proctex.h"
 #include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/swrasterizer/tev_program.h"
 #include "video_core/swrasterizer/texturing.h"
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
@@ -117,6 +122,111 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
     return std::make_tuple(x / z * half + half, y / z * half + half, z_abs, addr);
 }
 
+static std::atomic<bool> simd_rasterization_enabled{true};
+
+void SetSimdRasterizationEnabled(bool enabled) {
+    simd_rasterization_enabled = enabled;
+}
+
+#ifdef ARCHITECTURE_x86_64
+/**
+ * Block-based variant of the coverage loop. The bounding box is walked in blocks of 4x4 pixels.
+ * Since the edge functions are linear, a block lying completely outside of one edge is rejected
+ * by looking at its corners only, and a block lying inside of all edges needs no per-pixel test.
+ * For the remaining blocks, the edge functions of a row of 4 pixels are evaluated with SSE2.
+ *
+ * All edge function values are derived from the same integer arithmetic used by the per-pixel
+ * loop, so exactly the same pixels are passed to process_pixel with the same barycentric
+ * coordinates, i.e. the output is identical to the scalar path.
+ */
+template <typename PixelFunc>
+static void RasterizeBlocks(const Common::Vec3<Fix12P4> (&vtxpos)[3],
+                            const std::array<int, 3>& bias, u16 min_x, u16 min_y, u16 max_x,
+                            u16 max_y, PixelFunc&& process_pixel) {
+    constexpr int BLOCK_SIZE = 4;
+    constexpr int PIXEL_STEP = 0x10;
+
+    // Edge i is spanned by vertices (i + 1) % 3 and (i + 2) % 3. Its edge function changes by
+    // step_x[i] when moving one pixel right, and by step_y[i] when moving one pixel down.
+    std::array<int, 3> step_x;
+    std::array<int, 3> step_y;
+    __m128i lane_offsets[3];
+    for (int i = 0; i < 3; ++i) {
+        const auto& a = vtxpos[(i + 1) % 3];
+        const auto& b = vtxpos[(i + 2) % 3];
+        step_x[i] = -((int)b.y - (int)a.y) * PIXEL_STEP;
+        step_y[i] = ((int)b.x - (int)a.x) * PIXEL_STEP;
+        lane_offsets[i] = _mm_setr_epi32(0, step_x[i], 2 * step_x[i], 3 * step_x[i]);
+    }
+
+    for (int block_y = min_y + 8; block_y < max_y; block_y += BLOCK_SIZE * PIXEL_STEP) {
+        const int rows = std::min(BLOCK_SIZE, (max_y - block_y + PIXEL_STEP - 1) / PIXEL_STEP);
+
+        for (int block_x = min_x + 8; block_x < max_x; block_x += BLOCK_SIZE * PIXEL_STEP) {
+            const int columns =
+                std::min(BLOCK_SIZE, (max_x - block_x + PIXEL_STEP - 1) / PIXEL_STEP);
+            const Common::Vec2<Fix12P4> origin{static_cast<u16>(block_x),
+                                               static_cast<u16>(block_y)};
+
+            std::array<int, 3> w;
+            bool reject = false;
+            bool accept = true;
+            for (int i = 0; i < 3; ++i) {
+                w[i] = bias[i] + SignedArea(vtxpos[(i + 1) % 3].xy(), vtxpos[(i + 2) % 3].xy(),
+                                            origin);
+
+                const int last_x = (BLOCK_SIZE - 1) * step_x[i];
+                const int last_y = (BLOCK_SIZE - 1) * step_y[i];
+                const int corner_min = std::min({w[i], w[i] + last_x, w[i] + last_y,
+                                                 w[i] + last_x + last_y});
+                const int corner_max = std::max({w[i], w[i] + last_x, w[i] + last_y,
+                                                 w[i] + last_x + last_y});
+                reject |= corner_max < 0;
+                accept &= corner_min >= 0;
+            }
+
+            if (reject)
+                continue;
+
+            const int column_mask = (1 << columns) - 1;
+            for (int row = 0; row < rows; ++row) {
+                const __m128i w0 = _mm_add_epi32(_mm_set1_epi32(w[0] + row * step_y[0]),
+                                                 lane_offsets[0]);
+                const __m128i w1 = _mm_add_epi32(_mm_set1_epi32(w[1] + row * step_y[1]),
+                                                 lane_offsets[1]);
+                const __m128i w2 = _mm_add_epi32(_mm_set1_epi32(w[2] + row * step_y[2]),
+                                                 lane_offsets[2]);
+
+                int coverage = column_mask;
+                if (!accept) {
+                    // A pixel is not covered if any of its edge functions is negative
+                    const __m128i any_negative = _mm_or_si128(_mm_or_si128(w0, w1), w2);
+                    coverage &= ~_mm_movemask_ps(_mm_castsi128_ps(any_negative));
+                }
+
+                if (coverage == 0)
+                    continue;
+
+                alignas(16) std::array<s32, BLOCK_SIZE> w0_lanes;
+                alignas(16) std::array<s32, BLOCK_SIZE> w1_lanes;
+                alignas(16) std::array<s32, BLOCK_SIZE> w2_lanes;
+                _mm_store_si128(reinterpret_cast<__m128i*>(w0_lanes.data()), w0);
+                _mm_store_si128(reinterpret_cast<__m128i*>(w1_lanes.data()), w1);
+                _mm_store_si128(reinterpret_cast<__m128i*>(w2_lanes.data()), w2);
+
+                const u16 y = static_cast<u16>(block_y + row * PIXEL_STEP);
+                for (int lane = 0; lane < columns; ++lane) {
+                    if (coverage & (1 << lane)) {
+                        const u16 x = static_cast<u16>(block_x + lane * PIXEL_STEP);
+                        process_pixel(x, y, w0_lanes[lane], w1_lanes[lane], w2_lanes[lane]);
+                    }
+                }
+            }
+        }
+    }
+}
+#endif // ARCHITECTURE_x86_64
+
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
 /**
@@ -124,6 +234,7 @@ MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 24
  * culling via recursion.
  */
 static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                                    const Common::Rectangle<unsigned>& bounds,
                                     bool reversed = false) {
     const auto& regs = g_state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
@@ -145,13 +256,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, bounds, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, bounds, true);
             return;
         }
 
@@ -180,6 +291,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
         max_y = std::min(max_y, scissor_y2);
     }
 
+    // Restrict to the requested pixel bounds. These are pixel aligned, so they are not affected by
+    // the rounding below.
+    min_x = static_cast<u16>(std::max<unsigned>(min_x, bounds.left << 4));
+    min_y = static_cast<u16>(std::max<unsigned>(min_y, bounds.top << 4));
+    max_x = static_cast<u16>(std::min<unsigned>(max_x, bounds.right << 4));
+    max_y = static_cast<u16>(std::min<unsigned>(max_y, bounds.bottom << 4));
+
     min_x &= Fix12P4::IntMask();
     min_y &= Fix12P4::IntMask();
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
@@ -213,686 +331,604 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
 
     auto textures = regs.texturing.GetTextures();
-    auto tev_stages = regs.texturing.GetTevStages();
+    // Neighbouring pixels mostly sample the same texture tiles
+    std::array<Texture::TileCache, 3> texture_tiles;
+    const TevProgram& tev_program = GetTevProgram(regs.texturing);
+    const FramebufferView framebuffer(regs.framebuffer);
 
     bool stencil_action_enable =
         g_state.regs.framebuffer.output_merger.stencil_test.enable &&
         g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
     const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
 
-    // Enter rasterization loop, starting at the center of the topleft bounding box corner.
-    // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        for (u16 x = min_x + 8; x < max_x; x += 0x10) {
-
-            // Do not process the pixel if it's inside the scissor box and the scissor mode is set
-            // to Exclude
-            if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
-                if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2)
-                    continue;
-            }
+    // Shades a single pixel which is known to be covered by the triangle, given the (biased)
+    // barycentric coordinates w0, w1 and w2 of its center
+    auto ProcessPixel = [&](u16 x, u16 y, int w0, int w1, int w2) {
+        // Do not process the pixel if it's inside the scissor box and the scissor mode is set
+        // to Exclude
+        if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
+            if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2)
+                return;
+        }
 
-            // Calculate the barycentric coordinates w0, w1 and w2
-            int w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-            int w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-            int w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-            int wsum = w0 + w1 + w2;
+        int wsum = w0 + w1 + w2;
+
+        auto baricentric_coordinates =
+            Common::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
+                            float24::FromFloat32(static_cast<float>(w1)),
+                            float24::FromFloat32(static_cast<float>(w2)));
+        float24 interpolated_w_inverse =
+            float24::FromFloat32(1.0f) / Common::Dot(w_inverse, baricentric_coordinates);
+
+        // interpolated_z = z / w
+        float interpolated_z_over_w =
+            (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
+             v2.screenpos[2].ToFloat32() * w2) /
+            wsum;
+
+        // Not fully accurate. About 3 bits in precision are missing.
+        // Z-Buffer (z / w * scale + offset)
+        float depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+        float depth_offset =
+            float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+        float depth = interpolated_z_over_w * depth_scale + depth_offset;
+
+        // Potentially switch to W-Buffer
+        if (regs.rasterizer.depthmap_enable ==
+            Pica::RasterizerRegs::DepthBuffering::WBuffering) {
+            // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+            depth *= interpolated_w_inverse.ToFloat32() * wsum;
+        }
 
-            // If current pixel is not covered by the current primitive
-            if (w0 < 0 || w1 < 0 || w2 < 0)
+        // Clamp the result
+        depth = std::clamp(depth, 0.0f, 1.0f);
+
+        // Perspective correct attribute interpolation:
+        // Attribute values cannot be calculated by simple linear interpolation since
+        // they are not linear in screen space. For example, when interpolating a
+        // texture coordinate across two vertices, something simple like
+        //     u = (u0*w0 + u1*w1)/(w0+w1)
+        // will not work. However, the attribute value divided by the
+        // clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
+        // in screenspace. Hence, we can linearly interpolate these two independently and
+        // calculate the interpolated attribute by dividing the results.
+        // I.e.
+        //     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
+        //     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
+        //     u = u_over_w / one_over_w
+        //
+        // The generalization to three vertices is straightforward in baricentric coordinates.
+        auto GetInterpolatedAttribute = [&](float24 attr0, float24 attr1, float24 attr2) {
+            auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
+            float24 interpolated_attr_over_w =
+                Common::Dot(attr_over_w, baricentric_coordinates);
+            return interpolated_attr_over_w * interpolated_w_inverse;
+        };
+
+        Common::Vec4<u8> primary_color{
+            static_cast<u8>(round(
+                GetInterpolatedAttribute(v0.color.r(), v1.color.r(), v2.color.r()).ToFloat32() *
+                255)),
+            static_cast<u8>(round(
+                GetInterpolatedAttribute(v0.color.g(), v1.color.g(), v2.color.g()).ToFloat32() *
+                255)),
+            static_cast<u8>(round(
+                GetInterpolatedAttribute(v0.color.b(), v1.color.b(), v2.color.b()).ToFloat32() *
+                255)),
+            static_cast<u8>(round(
+                GetInterpolatedAttribute(v0.color.a(), v1.color.a(), v2.color.a()).ToFloat32() *
+                255)),
+        };
+
+        Common::Vec2<float24> uv[3];
+        uv[0].u() = GetInterpolatedAttribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
+        uv[0].v() = GetInterpolatedAttribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
+        uv[1].u() = GetInterpolatedAttribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
+        uv[1].v() = GetInterpolatedAttribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
+        uv[2].u() = GetInterpolatedAttribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
+        uv[2].v() = GetInterpolatedAttribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+
+        Common::Vec4<u8> texture_color[4]{};
+        for (int i = 0; i < 3; ++i) {
+            const auto& texture = textures[i];
+            if (!texture.enabled)
                 continue;
 
-            auto baricentric_coordinates =
-                Common::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
-                                float24::FromFloat32(static_cast<float>(w1)),
-                                float24::FromFloat32(static_cast<float>(w2)));
-            float24 interpolated_w_inverse =
-                float24::FromFloat32(1.0f) / Common::Dot(w_inverse, baricentric_coordinates);
-
-            // interpolated_z = z / w
-            float interpolated_z_over_w =
-                (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                 v2.screenpos[2].ToFloat32() * w2) /
-                wsum;
-
-            // Not fully accurate. About 3 bits in precision are missing.
-            // Z-Buffer (z / w * scale + offset)
-            float depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-            float depth_offset =
-                float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-            float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-            // Potentially switch to W-Buffer
-            if (regs.rasterizer.depthmap_enable ==
-                Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                depth *= interpolated_w_inverse.ToFloat32() * wsum;
-            }
-
-            // Clamp the result
-            depth = std::clamp(depth, 0.0f, 1.0f);
-
-            // Perspective correct attribute interpolation:
-            // Attribute values cannot be calculated by simple linear interpolation since
-            // they are not linear in screen space. For example, when interpolating a
-            // texture coordinate across two vertices, something simple like
-            //     u = (u0*w0 + u1*w1)/(w0+w1)
-            // will not work. However, the attribute value divided by the
-            // clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
-            // in screenspace. Hence, we can linearly interpolate these two independently and
-            // calculate the interpolated attribute by dividing the results.
-            // I.e.
-            //     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
-            //     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
-            //     u = u_over_w / one_over_w
-            //
-            // The generalization to three vertices is straightforward in baricentric coordinates.
-            auto GetInterpolatedAttribute = [&](float24 attr0, float24 attr1, float24 attr2) {
-                auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
-                float24 interpolated_attr_over_w =
-                    Common::Dot(attr_over_w, baricentric_coordinates);
-                return interpolated_attr_over_w * interpolated_w_inverse;
-            };
-
-            Common::Vec4<u8> primary_color{
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.r(), v1.color.r(), v2.color.r()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.g(), v1.color.g(), v2.color.g()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.b(), v1.color.b(), v2.color.b()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.a(), v1.color.a(), v2.color.a()).ToFloat32() *
-                    255)),
-            };
+            DEBUG_ASSERT(0 != texture.config.address);
 
-            Common::Vec2<float24> uv[3];
-            uv[0].u() = GetInterpolatedAttribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
-            uv[0].v() = GetInterpolatedAttribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
-            uv[1].u() = GetInterpolatedAttribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
-            uv[1].v() = GetInterpolatedAttribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
-            uv[2].u() = GetInterpolatedAttribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
-            uv[2].v() = GetInterpolatedAttribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+            int coordinate_i =
+                (i == 2 && regs.texturing.main_config.texture2_use_coord1) ? 1 : i;
+            float24 u = uv[coordinate_i].u();
+            float24 v = uv[coordinate_i].v();
 
-            Common::Vec4<u8> texture_color[4]{};
-            for (int i = 0; i < 3; ++i) {
-                const auto& texture = textures[i];
-                if (!texture.enabled)
-                    continue;
-
-                DEBUG_ASSERT(0 != texture.config.address);
-
-                int coordinate_i =
-                    (i == 2 && regs.texturing.main_config.texture2_use_coord1) ? 1 : i;
-                float24 u = uv[coordinate_i].u();
-                float24 v = uv[coordinate_i].v();
-
-                // Only unit 0 respects the texturing type (according to 3DBrew)
-                // TODO: Refactor so cubemaps and shadowmaps can be handled
-                PAddr texture_address = texture.config.GetPhysicalAddress();
-                float24 shadow_z;
-                if (i == 0) {
-                    switch (texture.config.type) {
-                    case TexturingRegs::TextureConfig::Texture2D:
-                        break;
-                    case TexturingRegs::TextureConfig::ShadowCube:
-                    case TexturingRegs::TextureConfig::TextureCube: {
-                        auto w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
-                        std::tie(u, v, shadow_z, texture_address) =
-                            ConvertCubeCoord(u, v, w, regs.texturing);
-                        break;
-                    }
-                    case TexturingRegs::TextureConfig::Projection2D: {
-                        auto tc0_w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+            // Only unit 0 respects the texturing type (according to 3DBrew)
+            // TODO: Refactor so cubemaps and shadowmaps can be handled
+            PAddr texture_address = texture.config.GetPhysicalAddress();
+            float24 shadow_z;
+            if (i == 0) {
+                switch (texture.config.type) {
+                case TexturingRegs::TextureConfig::Texture2D:
+                    break;
+                case TexturingRegs::TextureConfig::ShadowCube:
+                case TexturingRegs::TextureConfig::TextureCube: {
+                    auto w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+                    std::tie(u, v, shadow_z, texture_address) =
+                        ConvertCubeCoord(u, v, w, regs.texturing);
+                    break;
+                }
+                case TexturingRegs::TextureConfig::Projection2D: {
+                    auto tc0_w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+                    u /= tc0_w;
+                    v /= tc0_w;
+                    break;
+                }
+                case TexturingRegs::TextureConfig::Shadow2D: {
+                    auto tc0_w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+                    if (!regs.texturing.shadow.orthographic) {
                         u /= tc0_w;
                         v /= tc0_w;
-                        break;
                     }
-                    case TexturingRegs::TextureConfig::Shadow2D: {
-                        auto tc0_w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
-                        if (!regs.texturing.shadow.orthographic) {
-                            u /= tc0_w;
-                            v /= tc0_w;
-                        }
-
-                        shadow_z = float24::FromFloat32(std::abs(tc0_w.ToFloat32()));
-                        break;
-                    }
-                    case TexturingRegs::TextureConfig::Disabled:
-                        continue; // skip this unit and continue to the next unit
-                    default:
-                        LOG_ERROR(HW_GPU, "Unhandled texture type {:x}", (int)texture.config.type);
-                        UNIMPLEMENTED();
-                        break;
-                    }
-                }
 
-                int s = (int)(u * float24::FromFloat32(static_cast<float>(texture.config.width)))
-                            .ToFloat32();
-                int t = (int)(v * float24::FromFloat32(static_cast<float>(texture.config.height)))
-                            .ToFloat32();
-
-                bool use_border_s = false;
-                bool use_border_t = false;
-
-                if (texture.config.wrap_s == TexturingRegs::TextureConfig::ClampToBorder) {
-                    use_border_s = s < 0 || s >= static_cast<int>(texture.config.width);
-                } else if (texture.config.wrap_s == TexturingRegs::TextureConfig::ClampToBorder2) {
-                    use_border_s = s >= static_cast<int>(texture.config.width);
-                }
-
-                if (texture.config.wrap_t == TexturingRegs::TextureConfig::ClampToBorder) {
-                    use_border_t = t < 0 || t >= static_cast<int>(texture.config.height);
-                } else if (texture.config.wrap_t == TexturingRegs::TextureConfig::ClampToBorder2) {
-                    use_border_t = t >= static_cast<int>(texture.config.height);
-                }
-
-                if (use_border_s || use_border_t) {
-                    auto border_color = texture.config.border_color;
-                    texture_color[i] =
-                        Common::MakeVec(border_color.r.Value(), border_color.g.Value(),
-                                        border_color.b.Value(), border_color.a.Value())
-                            .Cast<u8>();
-                } else {
-                    // Textures are laid out from bottom to top, hence we invert the t coordinate.
-                    // NOTE: This may not be the right place for the inversion.
-                    // TODO: Check if this applies to ETC textures, too.
-                    s = GetWrappedTexCoord(texture.config.wrap_s, s, texture.config.width);
-                    t = texture.config.height - 1 -
-                        GetWrappedTexCoord(texture.config.wrap_t, t, texture.config.height);
-
-                    const u8* texture_data =
-                        VideoCore::g_memory->GetPhysicalPointer(texture_address);
-                    auto info =
-                        Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
-
-                    // TODO: Apply the min and mag filters to the texture
-                    texture_color[i] = Texture::LookupTexture(texture_data, s, t, info);
+                    shadow_z = float24::FromFloat32(std::abs(tc0_w.ToFloat32()));
+                    break;
                 }
-
-                if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
-                               texture.config.type == TexturingRegs::TextureConfig::ShadowCube)) {
-
-                    s32 z_int = static_cast<s32>(std::min(shadow_z.ToFloat32(), 1.0f) * 0xFFFFFF);
-                    z_int -= regs.texturing.shadow.bias << 1;
-                    auto& color = texture_color[i];
-                    s32 z_ref = (color.w << 16) | (color.z << 8) | color.y;
-                    u8 density;
-                    if (z_ref >= z_int) {
-                        density = color.x;
-                    } else {
-                        density = 0;
-                    }
-                    texture_color[i] = {density, density, density, density};
+                case TexturingRegs::TextureConfig::Disabled:
+                    continue; // skip this unit and continue to the next unit
+                default:
+                    LOG_ERROR(HW_GPU, "Unhandled texture type {:x}", (int)texture.config.type);
+                    UNIMPLEMENTED();
+                    break;
                 }
             }
 
-            // sample procedural texture
-            if (regs.texturing.main_config.texture3_enable) {
-                const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
-                texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
-                                           g_state.regs.texturing, g_state.proctex);
-            }
-
-            // Texture environment - consists of 6 stages of color and alpha combining.
-            //
-            // Color combiners take three input color values from some source (e.g. interpolated
-            // vertex color, texture color, previous stage, etc), perform some very simple
-            // operations on each of them (e.g. inversion) and then calculate the output color
-            // with some basic arithmetic. Alpha combiners can be configured separately but work
-            // analogously.
-            Common::Vec4<u8> combiner_output;
-            Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-            Common::Vec4<u8> next_combiner_buffer =
-                Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
-                                regs.texturing.tev_combiner_buffer_color.g.Value(),
-                                regs.texturing.tev_combiner_buffer_color.b.Value(),
-                                regs.texturing.tev_combiner_buffer_color.a.Value())
-                    .Cast<u8>();
+            int s = (int)(u * float24::FromFloat32(static_cast<float>(texture.config.width)))
+                        .ToFloat32();
+            int t = (int)(v * float24::FromFloat32(static_cast<float>(texture.config.height)))
+                        .ToFloat32();
 
-            Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
-            Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
+            bool use_border_s = false;
+            bool use_border_t = false;
 
-            if (!g_state.regs.lighting.disable) {
-                Common::Quaternion<float> normquat =
-                    Common::Quaternion<float>{
-                        {GetInterpolatedAttribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
-                         GetInterpolatedAttribute(v0.quat.y, v1.quat.y, v2.quat.y).ToFloat32(),
-                         GetInterpolatedAttribute(v0.quat.z, v1.quat.z, v2.quat.z).ToFloat32()},
-                        GetInterpolatedAttribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
-                    }
-                        .Normalized();
-
-                Common::Vec3<float> view{
-                    GetInterpolatedAttribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
-                    GetInterpolatedAttribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
-                    GetInterpolatedAttribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
-                };
-                std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
-                    g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
+            if (texture.config.wrap_s == TexturingRegs::TextureConfig::ClampToBorder) {
+                use_border_s = s < 0 || s >= static_cast<int>(texture.config.width);
+            } else if (texture.config.wrap_s == TexturingRegs::TextureConfig::ClampToBorder2) {
+                use_border_s = s >= static_cast<int>(texture.config.width);
             }
 
-            for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
-                 ++tev_stage_index) {
-                const auto& tev_stage = tev_stages[tev_stage_index];
-                using Source = TexturingRegs::TevStageConfig::Source;
-
-                auto GetSource = [&](Source source) -> Common::Vec4<u8> {
-                    switch (source) {
-                    case Source::PrimaryColor:
-                        return primary_color;
-
-                    case Source::PrimaryFragmentColor:
-                        return primary_fragment_color;
-
-                    case Source::SecondaryFragmentColor:
-                        return secondary_fragment_color;
-
-                    case Source::Texture0:
-                        return texture_color[0];
-
-                    case Source::Texture1:
-                        return texture_color[1];
-
-                    case Source::Texture2:
-                        return texture_color[2];
-
-                    case Source::Texture3:
-                        return texture_color[3];
-
-                    case Source::PreviousBuffer:
-                        return combiner_buffer;
+            if (texture.config.wrap_t == TexturingRegs::TextureConfig::ClampToBorder) {
+                use_border_t = t < 0 || t >= static_cast<int>(texture.config.height);
+            } else if (texture.config.wrap_t == TexturingRegs::TextureConfig::ClampToBorder2) {
+                use_border_t = t >= static_cast<int>(texture.config.height);
+            }
 
-                    case Source::Constant:
-                        return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                               tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                            .Cast<u8>();
+            if (use_border_s || use_border_t) {
+                auto border_color = texture.config.border_color;
+                texture_color[i] =
+                    Common::MakeVec(border_color.r.Value(), border_color.g.Value(),
+                                    border_color.b.Value(), border_color.a.Value())
+                        .Cast<u8>();
+            } else {
+                // Textures are laid out from bottom to top, hence we invert the t coordinate.
+                // NOTE: This may not be the right place for the inversion.
+                // TODO: Check if this applies to ETC textures, too.
+                s = GetWrappedTexCoord(texture.config.wrap_s, s, texture.config.width);
+                t = texture.config.height - 1 -
+                    GetWrappedTexCoord(texture.config.wrap_t, t, texture.config.height);
+
+                const u8* texture_data =
+                    VideoCore::g_memory->GetPhysicalPointer(texture_address);
+                auto info =
+                    Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
+
+                // TODO: Apply the min and mag filters to the texture
+                texture_color[i] = texture_tiles[i].LookupTexture(texture_data, s, t, info);
+            }
 
-                    case Source::Previous:
-                        return combiner_output;
+            if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
+                           texture.config.type == TexturingRegs::TextureConfig::ShadowCube)) {
 
-                    default:
-                        LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
-                        UNIMPLEMENTED();
-                        return {0, 0, 0, 0};
-                    }
-                };
-
-                // color combiner
-                // NOTE: Not sure if the alpha combiner might use the color output of the previous
-                //       stage as input. Hence, we currently don't directly write the result to
-                //       combiner_output.rgb(), but instead store it in a temporary variable until
-                //       alpha combining has been done.
-                Common::Vec3<u8> color_result[3] = {
-                    GetColorModifier(tev_stage.color_modifier1, GetSource(tev_stage.color_source1)),
-                    GetColorModifier(tev_stage.color_modifier2, GetSource(tev_stage.color_source2)),
-                    GetColorModifier(tev_stage.color_modifier3, GetSource(tev_stage.color_source3)),
-                };
-                auto color_output = ColorCombine(tev_stage.color_op, color_result);
-
-                u8 alpha_output;
-                if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
-                    // result of Dot3_RGBA operation is also placed to the alpha component
-                    alpha_output = color_output.x;
+                s32 z_int = static_cast<s32>(std::min(shadow_z.ToFloat32(), 1.0f) * 0xFFFFFF);
+                z_int -= regs.texturing.shadow.bias << 1;
+                auto& color = texture_color[i];
+                s32 z_ref = (color.w << 16) | (color.z << 8) | color.y;
+                u8 density;
+                if (z_ref >= z_int) {
+                    density = color.x;
                 } else {
-                    // alpha combiner
-                    std::array<u8, 3> alpha_result = {{
-                        GetAlphaModifier(tev_stage.alpha_modifier1,
-                                         GetSource(tev_stage.alpha_source1)),
-                        GetAlphaModifier(tev_stage.alpha_modifier2,
-                                         GetSource(tev_stage.alpha_source2)),
-                        GetAlphaModifier(tev_stage.alpha_modifier3,
-                                         GetSource(tev_stage.alpha_source3)),
-                    }};
-                    alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
-                }
-
-                combiner_output[0] =
-                    std::min((unsigned)255, color_output.r() * tev_stage.GetColorMultiplier());
-                combiner_output[1] =
-                    std::min((unsigned)255, color_output.g() * tev_stage.GetColorMultiplier());
-                combiner_output[2] =
-                    std::min((unsigned)255, color_output.b() * tev_stage.GetColorMultiplier());
-                combiner_output[3] =
-                    std::min((unsigned)255, alpha_output * tev_stage.GetAlphaMultiplier());
-
-                combiner_buffer = next_combiner_buffer;
-
-                if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                        tev_stage_index)) {
-                    next_combiner_buffer.r() = combiner_output.r();
-                    next_combiner_buffer.g() = combiner_output.g();
-                    next_combiner_buffer.b() = combiner_output.b();
-                }
-
-                if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                        tev_stage_index)) {
-                    next_combiner_buffer.a() = combiner_output.a();
+                    density = 0;
                 }
+                texture_color[i] = {density, density, density, density};
             }
+        }
 
-            const auto& output_merger = regs.framebuffer.output_merger;
-
-            if (output_merger.fragment_operation_mode ==
-                FramebufferRegs::FragmentOperationMode::Shadow) {
-                u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
-                // use green color as the shadow intensity
-                u8 stencil = combiner_output.y;
-                DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
-                // skip the normal output merger pipeline if it is in shadow mode
-                continue;
-            }
+        // sample procedural texture
+        if (regs.texturing.main_config.texture3_enable) {
+            const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
+            texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
+                                       g_state.regs.texturing, g_state.proctex);
+        }
 
-            // TODO: Does alpha testing happen before or after stencil?
-            if (output_merger.alpha_test.enable) {
-                bool pass = false;
+        Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
+        Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
 
-                switch (output_merger.alpha_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
+        if (!g_state.regs.lighting.disable && tev_program.UsesFragmentLighting()) {
+            Common::Quaternion<float> normquat =
+                Common::Quaternion<float>{
+                    {GetInterpolatedAttribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
+                     GetInterpolatedAttribute(v0.quat.y, v1.quat.y, v2.quat.y).ToFloat32(),
+                     GetInterpolatedAttribute(v0.quat.z, v1.quat.z, v2.quat.z).ToFloat32()},
+                    GetInterpolatedAttribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
+                }
+                    .Normalized();
 
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
+            Common::Vec3<float> view{
+                GetInterpolatedAttribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
+                GetInterpolatedAttribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
+                GetInterpolatedAttribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
+            };
+            std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
+                g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
+        }
 
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = combiner_output.a() == output_merger.alpha_test.ref;
-                    break;
+        // Texture environment - consists of 6 stages of color and alpha combining.
+        //
+        // Color combiners take three input color values from some source (e.g. interpolated
+        // vertex color, texture color, previous stage, etc), perform some very simple
+        // operations on each of them (e.g. inversion) and then calculate the output color
+        // with some basic arithmetic. Alpha combiners can be configured separately but work
+        // analogously.
+        Common::Vec4<u8> combiner_output = tev_program.Run(
+            primary_color, primary_fragment_color, secondary_fragment_color, texture_color);
+
+        const auto& output_merger = regs.framebuffer.output_merger;
+
+        if (output_merger.fragment_operation_mode ==
+            FramebufferRegs::FragmentOperationMode::Shadow) {
+            u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
+            // use green color as the shadow intensity
+            u8 stencil = combiner_output.y;
+            framebuffer.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
+            // skip the normal output merger pipeline if it is in shadow mode
+            return;
+        }
 
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = combiner_output.a() != output_merger.alpha_test.ref;
-                    break;
+        // TODO: Does alpha testing happen before or after stencil?
+        if (output_merger.alpha_test.enable) {
+            bool pass = false;
 
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = combiner_output.a() < output_merger.alpha_test.ref;
-                    break;
+            switch (output_merger.alpha_test.func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
 
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = combiner_output.a() <= output_merger.alpha_test.ref;
-                    break;
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
 
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = combiner_output.a() > output_merger.alpha_test.ref;
-                    break;
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = combiner_output.a() == output_merger.alpha_test.ref;
+                break;
 
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = combiner_output.a() >= output_merger.alpha_test.ref;
-                    break;
-                }
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = combiner_output.a() != output_merger.alpha_test.ref;
+                break;
 
-                if (!pass)
-                    continue;
-            }
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = combiner_output.a() < output_merger.alpha_test.ref;
+                break;
 
-            // Apply fog combiner
-            // Not fully accurate. We'd have to know what data type is used to
-            // store the depth etc. Using float for now until we know more
-            // about Pica datatypes
-            if (regs.texturing.fog_mode == TexturingRegs::FogMode::Fog) {
-                const Common::Vec3<u8> fog_color =
-                    Common::MakeVec(regs.texturing.fog_color.r.Value(),
-                                    regs.texturing.fog_color.g.Value(),
-                                    regs.texturing.fog_color.b.Value())
-                        .Cast<u8>();
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = combiner_output.a() <= output_merger.alpha_test.ref;
+                break;
 
-                // Get index into fog LUT
-                float fog_index;
-                if (g_state.regs.texturing.fog_flip) {
-                    fog_index = (1.0f - depth) * 128.0f;
-                } else {
-                    fog_index = depth * 128.0f;
-                }
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = combiner_output.a() > output_merger.alpha_test.ref;
+                break;
 
-                // Generate clamped fog factor from LUT for given fog index
-                float fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
-                float fog_f = fog_index - fog_i;
-                const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
-                float fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
-                fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
-
-                // Blend the fog
-                for (unsigned i = 0; i < 3; i++) {
-                    combiner_output[i] = static_cast<u8>(fog_factor * combiner_output[i] +
-                                                         (1.0f - fog_factor) * fog_color[i]);
-                }
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = combiner_output.a() >= output_merger.alpha_test.ref;
+                break;
             }
 
-            u8 old_stencil = 0;
-
-            auto UpdateStencil = [stencil_test, x, y,
-                                  &old_stencil](Pica::FramebufferRegs::StencilAction action) {
-                u8 new_stencil =
-                    PerformStencilAction(action, old_stencil, stencil_test.reference_value);
-                if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
-                    SetStencil(x >> 4, y >> 4,
-                               (new_stencil & stencil_test.write_mask) |
-                                   (old_stencil & ~stencil_test.write_mask));
-            };
+            if (!pass)
+                return;
+        }
 
-            if (stencil_action_enable) {
-                old_stencil = GetStencil(x >> 4, y >> 4);
-                u8 dest = old_stencil & stencil_test.input_mask;
-                u8 ref = stencil_test.reference_value & stencil_test.input_mask;
+        // Apply fog combiner
+        // Not fully accurate. We'd have to know what data type is used to
+        // store the depth etc. Using float for now until we know more
+        // about Pica datatypes
+        if (regs.texturing.fog_mode == TexturingRegs::FogMode::Fog) {
+            const Common::Vec3<u8> fog_color =
+                Common::MakeVec(regs.texturing.fog_color.r.Value(),
+                                regs.texturing.fog_color.g.Value(),
+                                regs.texturing.fog_color.b.Value())
+                    .Cast<u8>();
 
-                bool pass = false;
-                switch (stencil_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
+            // Get index into fog LUT
+            float fog_index;
+            if (g_state.regs.texturing.fog_flip) {
+                fog_index = (1.0f - depth) * 128.0f;
+            } else {
+                fog_index = depth * 128.0f;
+            }
 
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
+            // Generate clamped fog factor from LUT for given fog index
+            float fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
+            float fog_f = fog_index - fog_i;
+            const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
+            float fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
+            fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
+
+            // Blend the fog
+            for (unsigned i = 0; i < 3; i++) {
+                combiner_output[i] = static_cast<u8>(fog_factor * combiner_output[i] +
+                                                     (1.0f - fog_factor) * fog_color[i]);
+            }
+        }
 
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = (ref == dest);
-                    break;
+        u8* const depth_pixel = framebuffer.GetDepthPointer(x >> 4, y >> 4);
+        u8 old_stencil = 0;
+
+        auto UpdateStencil = [stencil_test, depth_pixel, &framebuffer,
+                              &old_stencil](Pica::FramebufferRegs::StencilAction action) {
+            u8 new_stencil =
+                PerformStencilAction(action, old_stencil, stencil_test.reference_value);
+            if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
+                framebuffer.EncodeStencil((new_stencil & stencil_test.write_mask) |
+                                              (old_stencil & ~stencil_test.write_mask),
+                                          depth_pixel);
+        };
+
+        if (stencil_action_enable) {
+            old_stencil = framebuffer.DecodeStencil(depth_pixel);
+            u8 dest = old_stencil & stencil_test.input_mask;
+            u8 ref = stencil_test.reference_value & stencil_test.input_mask;
+
+            bool pass = false;
+            switch (stencil_test.func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
+
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
+
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = (ref == dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = (ref != dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = (ref < dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = (ref <= dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = (ref > dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = (ref >= dest);
+                break;
+            }
 
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = (ref != dest);
-                    break;
+            if (!pass) {
+                UpdateStencil(stencil_test.action_stencil_fail);
+                return;
+            }
+        }
 
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = (ref < dest);
-                    break;
+        // Convert float to integer
+        u32 z = (u32)(depth * ((1 << framebuffer.GetDepthBits()) - 1));
 
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = (ref <= dest);
-                    break;
+        if (output_merger.depth_test_enable) {
+            u32 ref_z = framebuffer.DecodeDepth(depth_pixel);
 
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = (ref > dest);
-                    break;
+            bool pass = false;
 
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = (ref >= dest);
-                    break;
-                }
+            switch (output_merger.depth_test_func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
 
-                if (!pass) {
-                    UpdateStencil(stencil_test.action_stencil_fail);
-                    continue;
-                }
-            }
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
 
-            // Convert float to integer
-            unsigned num_bits =
-                FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format);
-            u32 z = (u32)(depth * ((1 << num_bits) - 1));
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = z == ref_z;
+                break;
 
-            if (output_merger.depth_test_enable) {
-                u32 ref_z = GetDepth(x >> 4, y >> 4);
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = z != ref_z;
+                break;
 
-                bool pass = false;
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = z < ref_z;
+                break;
 
-                switch (output_merger.depth_test_func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = z <= ref_z;
+                break;
 
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = z > ref_z;
+                break;
 
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = z == ref_z;
-                    break;
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = z >= ref_z;
+                break;
+            }
 
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = z != ref_z;
-                    break;
+            if (!pass) {
+                if (stencil_action_enable)
+                    UpdateStencil(stencil_test.action_depth_fail);
+                return;
+            }
+        }
 
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = z < ref_z;
-                    break;
+        if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
+            output_merger.depth_write_enable) {
 
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = z <= ref_z;
-                    break;
+            framebuffer.EncodeDepth(z, depth_pixel);
+        }
 
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = z > ref_z;
-                    break;
+        // The stencil depth_pass action is executed even if depth testing is disabled
+        if (stencil_action_enable)
+            UpdateStencil(stencil_test.action_depth_pass);
 
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = z >= ref_z;
-                    break;
-                }
+        u8* const color_pixel = framebuffer.GetColorPointer(x >> 4, y >> 4);
+        auto dest = framebuffer.DecodeColor(color_pixel);
+        Common::Vec4<u8> blend_output = combiner_output;
 
-                if (!pass) {
-                    if (stencil_action_enable)
-                        UpdateStencil(stencil_test.action_depth_fail);
-                    continue;
-                }
-            }
+        if (output_merger.alphablend_enable) {
+            auto params = output_merger.alpha_blending;
 
-            if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
-                output_merger.depth_write_enable) {
+            auto LookupFactor = [&](unsigned channel,
+                                    FramebufferRegs::BlendFactor factor) -> u8 {
+                DEBUG_ASSERT(channel < 4);
 
-                SetDepth(x >> 4, y >> 4, z);
-            }
+                const Common::Vec4<u8> blend_const =
+                    Common::MakeVec(output_merger.blend_const.r.Value(),
+                                    output_merger.blend_const.g.Value(),
+                                    output_merger.blend_const.b.Value(),
+                                    output_merger.blend_const.a.Value())
+                        .Cast<u8>();
 
-            // The stencil depth_pass action is executed even if depth testing is disabled
-            if (stencil_action_enable)
-                UpdateStencil(stencil_test.action_depth_pass);
+                switch (factor) {
+                case FramebufferRegs::BlendFactor::Zero:
+                    return 0;
 
-            auto dest = GetPixel(x >> 4, y >> 4);
-            Common::Vec4<u8> blend_output = combiner_output;
+                case FramebufferRegs::BlendFactor::One:
+                    return 255;
 
-            if (output_merger.alphablend_enable) {
-                auto params = output_merger.alpha_blending;
+                case FramebufferRegs::BlendFactor::SourceColor:
+                    return combiner_output[channel];
 
-                auto LookupFactor = [&](unsigned channel,
-                                        FramebufferRegs::BlendFactor factor) -> u8 {
-                    DEBUG_ASSERT(channel < 4);
+                case FramebufferRegs::BlendFactor::OneMinusSourceColor:
+                    return 255 - combiner_output[channel];
 
-                    const Common::Vec4<u8> blend_const =
-                        Common::MakeVec(output_merger.blend_const.r.Value(),
-                                        output_merger.blend_const.g.Value(),
-                                        output_merger.blend_const.b.Value(),
-                                        output_merger.blend_const.a.Value())
-                            .Cast<u8>();
+                case FramebufferRegs::BlendFactor::DestColor:
+                    return dest[channel];
 
-                    switch (factor) {
-                    case FramebufferRegs::BlendFactor::Zero:
-                        return 0;
+                case FramebufferRegs::BlendFactor::OneMinusDestColor:
+                    return 255 - dest[channel];
 
-                    case FramebufferRegs::BlendFactor::One:
-                        return 255;
+                case FramebufferRegs::BlendFactor::SourceAlpha:
+                    return combiner_output.a();
 
-                    case FramebufferRegs::BlendFactor::SourceColor:
-                        return combiner_output[channel];
+                case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
+                    return 255 - combiner_output.a();
 
-                    case FramebufferRegs::BlendFactor::OneMinusSourceColor:
-                        return 255 - combiner_output[channel];
+                case FramebufferRegs::BlendFactor::DestAlpha:
+                    return dest.a();
 
-                    case FramebufferRegs::BlendFactor::DestColor:
-                        return dest[channel];
+                case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
+                    return 255 - dest.a();
 
-                    case FramebufferRegs::BlendFactor::OneMinusDestColor:
-                        return 255 - dest[channel];
+                case FramebufferRegs::BlendFactor::ConstantColor:
+                    return blend_const[channel];
 
-                    case FramebufferRegs::BlendFactor::SourceAlpha:
-                        return combiner_output.a();
+                case FramebufferRegs::BlendFactor::OneMinusConstantColor:
+                    return 255 - blend_const[channel];
 
-                    case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
-                        return 255 - combiner_output.a();
+                case FramebufferRegs::BlendFactor::ConstantAlpha:
+                    return blend_const.a();
 
-                    case FramebufferRegs::BlendFactor::DestAlpha:
-                        return dest.a();
+                case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
+                    return 255 - blend_const.a();
 
-                    case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
-                        return 255 - dest.a();
+                case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
+                    // Returns 1.0 for the alpha channel
+                    if (channel == 3)
+                        return 255;
+                    return std::min(combiner_output.a(), static_cast<u8>(255 - dest.a()));
 
-                    case FramebufferRegs::BlendFactor::ConstantColor:
-                        return blend_const[channel];
+                default:
+                    LOG_CRITICAL(HW_GPU, "Unknown blend factor {:x}", static_cast<u32>(factor));
+                    UNIMPLEMENTED();
+                    break;
+                }
 
-                    case FramebufferRegs::BlendFactor::OneMinusConstantColor:
-                        return 255 - blend_const[channel];
+                return combiner_output[channel];
+            };
 
-                    case FramebufferRegs::BlendFactor::ConstantAlpha:
-                        return blend_const.a();
+            auto srcfactor = Common::MakeVec(LookupFactor(0, params.factor_source_rgb),
+                                             LookupFactor(1, params.factor_source_rgb),
+                                             LookupFactor(2, params.factor_source_rgb),
+                                             LookupFactor(3, params.factor_source_a));
+
+            auto dstfactor = Common::MakeVec(LookupFactor(0, params.factor_dest_rgb),
+                                             LookupFactor(1, params.factor_dest_rgb),
+                                             LookupFactor(2, params.factor_dest_rgb),
+                                             LookupFactor(3, params.factor_dest_a));
+
+            blend_output = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
+                                                 params.blend_equation_rgb);
+            blend_output.a() = EvaluateBlendEquation(combiner_output, srcfactor, dest,
+                                                     dstfactor, params.blend_equation_a)
+                                   .a();
+        } else {
+            blend_output =
+                Common::MakeVec(LogicOp(combiner_output.r(), dest.r(), output_merger.logic_op),
+                                LogicOp(combiner_output.g(), dest.g(), output_merger.logic_op),
+                                LogicOp(combiner_output.b(), dest.b(), output_merger.logic_op),
+                                LogicOp(combiner_output.a(), dest.a(), output_merger.logic_op));
+        }
 
-                    case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
-                        return 255 - blend_const.a();
+        const Common::Vec4<u8> result = {
+            output_merger.red_enable ? blend_output.r() : dest.r(),
+            output_merger.green_enable ? blend_output.g() : dest.g(),
+            output_merger.blue_enable ? blend_output.b() : dest.b(),
+            output_merger.alpha_enable ? blend_output.a() : dest.a(),
+        };
 
-                    case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
-                        // Returns 1.0 for the alpha channel
-                        if (channel == 3)
-                            return 255;
-                        return std::min(combiner_output.a(), static_cast<u8>(255 - dest.a()));
+        if (regs.framebuffer.framebuffer.allow_color_write != 0)
+            framebuffer.EncodeColor(result, color_pixel);
+    };
 
-                    default:
-                        LOG_CRITICAL(HW_GPU, "Unknown blend factor {:x}", static_cast<u32>(factor));
-                        UNIMPLEMENTED();
-                        break;
-                    }
+    // Enter rasterization loop, starting at the center of the topleft bounding box corner.
+#ifdef ARCHITECTURE_x86_64
+    if (simd_rasterization_enabled) {
+        RasterizeBlocks(vtxpos, {bias0, bias1, bias2}, min_x, min_y, max_x, max_y, ProcessPixel);
+        return;
+    }
+#endif
 
-                    return combiner_output[channel];
-                };
-
-                auto srcfactor = Common::MakeVec(LookupFactor(0, params.factor_source_rgb),
-                                                 LookupFactor(1, params.factor_source_rgb),
-                                                 LookupFactor(2, params.factor_source_rgb),
-                                                 LookupFactor(3, params.factor_source_a));
-
-                auto dstfactor = Common::MakeVec(LookupFactor(0, params.factor_dest_rgb),
-                                                 LookupFactor(1, params.factor_dest_rgb),
-                                                 LookupFactor(2, params.factor_dest_rgb),
-                                                 LookupFactor(3, params.factor_dest_a));
-
-                blend_output = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
-                                                     params.blend_equation_rgb);
-                blend_output.a() = EvaluateBlendEquation(combiner_output, srcfactor, dest,
-                                                         dstfactor, params.blend_equation_a)
-                                       .a();
-            } else {
-                blend_output =
-                    Common::MakeVec(LogicOp(combiner_output.r(), dest.r(), output_merger.logic_op),
-                                    LogicOp(combiner_output.g(), dest.g(), output_merger.logic_op),
-                                    LogicOp(combiner_output.b(), dest.b(), output_merger.logic_op),
-                                    LogicOp(combiner_output.a(), dest.a(), output_merger.logic_op));
-            }
+    // TODO: Not sure if looping through x first might be faster
+    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
+        for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+            // Calculate the barycentric coordinates w0, w1 and w2
+            int w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
+            int w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
+            int w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
 
-            const Common::Vec4<u8> result = {
-                output_merger.red_enable ? blend_output.r() : dest.r(),
-                output_merger.green_enable ? blend_output.g() : dest.g(),
-                output_merger.blue_enable ? blend_output.b() : dest.b(),
-                output_merger.alpha_enable ? blend_output.a() : dest.a(),
-            };
+            // If current pixel is not covered by the current primitive
+            if (w0 < 0 || w1 < 0 || w2 < 0)
+                continue;
 
-            if (regs.framebuffer.framebuffer.allow_color_write != 0)
-                DrawPixel(x >> 4, y >> 4, result);
+            ProcessPixel(x, y, w0, w1, w2);
         }
     }
 }
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
-    ProcessTriangleInternal(v0, v1, v2);
+    // Rasterizer coordinates are 12.4 fixed-point values, so this covers the whole coordinate range
+    static constexpr Common::Rectangle<unsigned> unbounded{0, 0, 0x1000, 0x1000};
+    ProcessTriangleInternal(v0, v1, v2, unbounded);
+}
+
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const Common::Rectangle<unsigned>& bounds) {
+    ProcessTriangleInternal(v0, v1, v2, bounds);
 }
 
 } // namespace Pica::Rasterizer
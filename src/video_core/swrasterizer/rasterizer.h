@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/math_util.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Rasterizer {
@@ -41,4 +42,17 @@ struct Vertex : Shader::OutputVertex {
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/**
+ * Rasterizes the given triangle, only touching pixels inside of the given bounds.
+ * The bounds are given in framebuffer pixel coordinates, with the right and bottom edges excluded.
+ */
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const Common::Rectangle<unsigned>& bounds);
+
+/**
+ * Selects whether the block-based SIMD coverage loop is used on hosts supporting it. The per-pixel
+ * loop is always kept as the reference implementation. Both produce identical results.
+ */
+void SetSimdRasterizationEnabled(bool enabled);
+
 } // namespace Pica::Rasterizer
@@ -2,15 +2,51 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/thread_pool.h"
+#include "core/settings.h"
+#include "video_core/swrasterizer/binner.h"
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/swrasterizer.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() {
+    const std::size_t num_threads = Settings::values.sw_renderer_threads == 0
+                                        ? Common::ThreadPool::DefaultThreadCount()
+                                        : Settings::values.sw_renderer_threads;
+    if (num_threads > 1) {
+        binner = std::make_unique<Pica::Rasterizer::TileBinner>(num_threads);
+    }
+}
+
+SWRasterizer::~SWRasterizer() = default;
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
-    Pica::Clipper::ProcessTriangle(v0, v1, v2);
+    Pica::Clipper::ProcessTriangle(v0, v1, v2, binner.get());
+}
+
+void SWRasterizer::DrawTriangles() {
+    FlushBinner();
+}
+
+void SWRasterizer::FlushAll() {
+    FlushBinner();
+}
+
+void SWRasterizer::FlushRegion(PAddr addr, u32 size) {
+    FlushBinner();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    FlushBinner();
+}
+
+void SWRasterizer::FlushBinner() {
+    if (binner) {
+        binner->Flush();
+    }
 }
 
 } // namespace VideoCore
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include "common/common_types.h"
 #include "video_core/rasterizer_interface.h"
 
@@ -11,17 +12,32 @@ namespace Pica::Shader {
 struct OutputVertex;
 } // namespace Pica::Shader
 
+namespace Pica::Rasterizer {
+class TileBinner;
+} // namespace Pica::Rasterizer
+
 namespace VideoCore {
 
 class SWRasterizer : public RasterizerInterface {
+public:
+    SWRasterizer();
+    ~SWRasterizer() override;
+
+private:
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
-    void DrawTriangles() override {}
+    void DrawTriangles() override;
     void NotifyPicaRegisterChanged(u32 id) override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
+    void FlushAll() override;
+    void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+
+    /// Flushes all triangles queued for multithreaded rasterization
+    void FlushBinner();
+
+    /// Only used when multithreaded rasterization is enabled
+    std::unique_ptr<Pica::Rasterizer::TileBinner> binner;
 };
 
 } // namespace VideoCore
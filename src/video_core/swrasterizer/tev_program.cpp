@@ -0,0 +1,273 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/swrasterizer/tev_program.h"
+
+namespace Pica::Rasterizer {
+
+using TevStageConfig = TexturingRegs::TevStageConfig;
+
+/// Number of inputs read by a combiner operation
+static u8 GetNumInputs(TevStageConfig::Operation op) {
+    using Operation = TevStageConfig::Operation;
+
+    switch (op) {
+    case Operation::Replace:
+        return 1;
+    case Operation::Modulate:
+    case Operation::Add:
+    case Operation::AddSigned:
+    case Operation::Subtract:
+    case Operation::Dot3_RGB:
+    case Operation::Dot3_RGBA:
+        return 2;
+    case Operation::Lerp:
+    case Operation::MultiplyThenAdd:
+    case Operation::AddThenMultiply:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+/// Returns true if the stage outputs the result of the previous stage unchanged
+static bool IsPassThrough(const TevStageConfig& stage) {
+    using Source = TevStageConfig::Source;
+    using Operation = TevStageConfig::Operation;
+
+    return stage.color_op == Operation::Replace && stage.alpha_op == Operation::Replace &&
+           stage.color_source1 == Source::Previous && stage.alpha_source1 == Source::Previous &&
+           stage.color_modifier1 == TevStageConfig::ColorModifier::SourceColor &&
+           stage.alpha_modifier1 == TevStageConfig::AlphaModifier::SourceAlpha &&
+           stage.GetColorMultiplier() == 1 && stage.GetAlphaMultiplier() == 1;
+}
+
+TevProgram::TevProgram(const TexturingRegs& regs) {
+    using Source = TevStageConfig::Source;
+
+    const auto& buffer_color = regs.tev_combiner_buffer_color;
+    initial_slots[BufferColor] = Common::MakeVec(buffer_color.r.Value(), buffer_color.g.Value(),
+                                                 buffer_color.b.Value(), buffer_color.a.Value())
+                                     .Cast<u8>();
+
+    // Slots holding the current and the upcoming contents of the combiner buffer, separately for
+    // the color and the alpha part
+    u8 buffer_color_slot = Zero;
+    u8 buffer_alpha_slot = Zero;
+    u8 next_buffer_color_slot = BufferColor;
+    u8 next_buffer_alpha_slot = BufferColor;
+    u8 previous_slot = Zero;
+
+    const auto tev_stages = regs.GetTevStages();
+    for (unsigned stage_index = 0; stage_index < tev_stages.size(); ++stage_index) {
+        const auto& tev_stage = tev_stages[stage_index];
+
+        u8 output = previous_slot;
+        if (!IsPassThrough(tev_stage)) {
+            Stage stage{};
+
+            auto GetSlot = [&](Source source) -> u8 {
+                switch (source) {
+                case Source::PrimaryColor:
+                case Source::PrimaryFragmentColor:
+                case Source::SecondaryFragmentColor:
+                    uses_fragment_lighting |= source != Source::PrimaryColor;
+                    return static_cast<u8>(source);
+
+                case Source::Texture0:
+                case Source::Texture1:
+                case Source::Texture2:
+                case Source::Texture3:
+                    return static_cast<u8>(source);
+
+                case Source::PreviousBuffer:
+                    if (buffer_color_slot == buffer_alpha_slot) {
+                        return buffer_color_slot;
+                    }
+                    stage.compose_buffer = true;
+                    stage.buffer_color_source = buffer_color_slot;
+                    stage.buffer_alpha_source = buffer_alpha_slot;
+                    return CombinerBuffer;
+
+                case Source::Constant:
+                    initial_slots[Constant0 + stage_index] =
+                        Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                        tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                            .Cast<u8>();
+                    return static_cast<u8>(Constant0 + stage_index);
+
+                case Source::Previous:
+                    return previous_slot;
+
+                default:
+                    LOG_ERROR(HW_GPU, "Unknown color combiner source {}", static_cast<u32>(source));
+                    UNIMPLEMENTED();
+                    return Zero;
+                }
+            };
+
+            const std::array<Source, 3> color_sources = {
+                tev_stage.color_source1, tev_stage.color_source2, tev_stage.color_source3};
+            const std::array<TevStageConfig::ColorModifier, 3> color_modifiers = {
+                tev_stage.color_modifier1, tev_stage.color_modifier2, tev_stage.color_modifier3};
+            stage.num_color_inputs = GetNumInputs(tev_stage.color_op);
+            for (unsigned i = 0; i < stage.num_color_inputs; ++i) {
+                stage.color_sources[i] = GetSlot(color_sources[i]);
+                stage.color_modifiers[i] = GetColorModifierFunc(color_modifiers[i]);
+            }
+            stage.color_combine = GetColorCombineFunc(tev_stage.color_op);
+
+            // The result of the Dot3_RGBA operation is also placed into the alpha component, in
+            // which case the alpha combiner is not evaluated at all
+            if (tev_stage.color_op != TevStageConfig::Operation::Dot3_RGBA) {
+                const std::array<Source, 3> alpha_sources = {
+                    tev_stage.alpha_source1, tev_stage.alpha_source2, tev_stage.alpha_source3};
+                const std::array<TevStageConfig::AlphaModifier, 3> alpha_modifiers = {
+                    tev_stage.alpha_modifier1, tev_stage.alpha_modifier2,
+                    tev_stage.alpha_modifier3};
+                stage.num_alpha_inputs = GetNumInputs(tev_stage.alpha_op);
+                for (unsigned i = 0; i < stage.num_alpha_inputs; ++i) {
+                    stage.alpha_sources[i] = GetSlot(alpha_sources[i]);
+                    stage.alpha_modifiers[i] = GetAlphaModifierFunc(alpha_modifiers[i]);
+                }
+                stage.alpha_combine = GetAlphaCombineFunc(tev_stage.alpha_op);
+            }
+
+            stage.color_multiplier = static_cast<u8>(tev_stage.GetColorMultiplier());
+            stage.alpha_multiplier = static_cast<u8>(tev_stage.GetAlphaMultiplier());
+            stage.output = static_cast<u8>(StageOutput0 + stage_index);
+            output = stage.output;
+            stages.push_back(stage);
+        }
+
+        // Each stage reads the combiner buffer as it was before the previous stage updated it
+        buffer_color_slot = next_buffer_color_slot;
+        buffer_alpha_slot = next_buffer_alpha_slot;
+        if (regs.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(stage_index)) {
+            next_buffer_color_slot = output;
+        }
+        if (regs.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(stage_index)) {
+            next_buffer_alpha_slot = output;
+        }
+
+        previous_slot = output;
+    }
+
+    output_slot = previous_slot;
+}
+
+Common::Vec4<u8> TevProgram::Run(const Common::Vec4<u8>& primary_color,
+                                 const Common::Vec4<u8>& primary_fragment_color,
+                                 const Common::Vec4<u8>& secondary_fragment_color,
+                                 const Common::Vec4<u8> (&texture_color)[4]) const {
+    auto slots = initial_slots;
+    slots[PrimaryColor] = primary_color;
+    slots[PrimaryFragmentColor] = primary_fragment_color;
+    slots[SecondaryFragmentColor] = secondary_fragment_color;
+    std::copy(std::begin(texture_color), std::end(texture_color), &slots[Texture0]);
+
+    for (const Stage& stage : stages) {
+        if (stage.compose_buffer) {
+            slots[CombinerBuffer] = Common::MakeVec(slots[stage.buffer_color_source].rgb(),
+                                                    slots[stage.buffer_alpha_source].a());
+        }
+
+        Common::Vec3<u8> color_result[3]{};
+        for (unsigned i = 0; i < stage.num_color_inputs; ++i) {
+            color_result[i] = stage.color_modifiers[i](slots[stage.color_sources[i]]);
+        }
+        const auto color_output = stage.color_combine(color_result);
+
+        u8 alpha_output = color_output.x;
+        if (stage.alpha_combine != nullptr) {
+            std::array<u8, 3> alpha_result{};
+            for (unsigned i = 0; i < stage.num_alpha_inputs; ++i) {
+                alpha_result[i] = stage.alpha_modifiers[i](slots[stage.alpha_sources[i]]);
+            }
+            alpha_output = stage.alpha_combine(alpha_result);
+        }
+
+        auto& output = slots[stage.output];
+        output.r() = std::min(255u, color_output.r() * unsigned{stage.color_multiplier});
+        output.g() = std::min(255u, color_output.g() * unsigned{stage.color_multiplier});
+        output.b() = std::min(255u, color_output.b() * unsigned{stage.color_multiplier});
+        output.a() = std::min(255u, alpha_output * unsigned{stage.alpha_multiplier});
+    }
+
+    return slots[output_slot];
+}
+
+namespace {
+
+/// Register state a TEV program is built from
+using TevProgramKey = std::array<u32, 32>;
+
+struct TevProgramKeyHash {
+    std::size_t operator()(const TevProgramKey& key) const {
+        return static_cast<std::size_t>(Common::ComputeHash64(key.data(), sizeof(key)));
+    }
+};
+
+TevProgramKey MakeTevProgramKey(const TexturingRegs& regs) {
+    TevProgramKey key;
+    std::size_t index = 0;
+    for (const auto& stage : regs.GetTevStages()) {
+        key[index++] = stage.sources_raw;
+        key[index++] = stage.modifiers_raw;
+        key[index++] = stage.ops_raw;
+        key[index++] = stage.const_color;
+        key[index++] = stage.scales_raw;
+    }
+    key[index++] = regs.tev_combiner_buffer_input.update_mask_rgb |
+                   (regs.tev_combiner_buffer_input.update_mask_a << 4);
+    key[index++] = regs.tev_combiner_buffer_color.raw;
+    return key;
+}
+
+} // Anonymous namespace
+
+/// Upper bound on the number of cached programs, the cache is reset once it is exceeded
+constexpr std::size_t MAX_CACHED_PROGRAMS = 512;
+
+const TevProgram& GetTevProgram(const TexturingRegs& regs) {
+    // Consecutive triangles almost always share the same configuration, so the last program used
+    // by each thread is checked first without taking the lock
+    struct CachedProgram {
+        TevProgramKey key;
+        std::shared_ptr<const TevProgram> program;
+    };
+    thread_local CachedProgram last_program;
+
+    const TevProgramKey key = MakeTevProgramKey(regs);
+    if (last_program.program && last_program.key == key) {
+        return *last_program.program;
+    }
+
+    static std::mutex cache_mutex;
+    static std::unordered_map<TevProgramKey, std::shared_ptr<const TevProgram>, TevProgramKeyHash>
+        cache;
+
+    std::lock_guard lock{cache_mutex};
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        if (cache.size() >= MAX_CACHED_PROGRAMS) {
+            cache.clear();
+        }
+        it = cache.emplace(key, std::make_shared<const TevProgram>(regs)).first;
+    }
+
+    last_program.key = key;
+    last_program.program = it->second;
+    return *last_program.program;
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,87 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/regs_texturing.h"
+#include "video_core/swrasterizer/texturing.h"
+
+namespace Pica::Rasterizer {
+
+/**
+ * The texture environment configuration of the PICA, resolved ahead of time.
+ *
+ * All six TEV stages are decoded once into a list of operations on a small register file of
+ * colors. Modifiers and combiners are called through function pointers specialized for the
+ * configured mode, stages passing the previous output through unchanged are dropped, and only the
+ * inputs actually consumed by a combiner operation are evaluated. Reads from the combiner buffer
+ * are resolved to the stage output they refer to when the program is built.
+ */
+class TevProgram {
+public:
+    explicit TevProgram(const TexturingRegs& regs);
+
+    /// Runs the texture environment for a single fragment and returns the combiner output
+    Common::Vec4<u8> Run(const Common::Vec4<u8>& primary_color,
+                         const Common::Vec4<u8>& primary_fragment_color,
+                         const Common::Vec4<u8>& secondary_fragment_color,
+                         const Common::Vec4<u8> (&texture_color)[4]) const;
+
+    /// Returns true if any stage reads the primary or secondary fragment (lighting) color
+    bool UsesFragmentLighting() const {
+        return uses_fragment_lighting;
+    }
+
+private:
+    // Indices into the color register file used while running the program
+    enum Slot : u8 {
+        PrimaryColor = 0,
+        PrimaryFragmentColor = 1,
+        SecondaryFragmentColor = 2,
+        Texture0 = 3,
+        Zero = 7,
+        BufferColor = 8,
+        Constant0 = 9,
+        StageOutput0 = 15,
+        CombinerBuffer = 21,
+        NumSlots = 22,
+    };
+
+    struct Stage {
+        std::array<u8, 3> color_sources;
+        std::array<u8, 3> alpha_sources;
+        std::array<ColorModifierFunc, 3> color_modifiers;
+        std::array<AlphaModifierFunc, 3> alpha_modifiers;
+        ColorCombineFunc color_combine;
+        /// nullptr if the alpha output is taken from the color output (Dot3_RGBA)
+        AlphaCombineFunc alpha_combine;
+        u8 num_color_inputs;
+        u8 num_alpha_inputs;
+        u8 color_multiplier;
+        u8 alpha_multiplier;
+        /// Whether the combiner buffer has to be assembled from two slots before the stage runs
+        bool compose_buffer;
+        u8 buffer_color_source;
+        u8 buffer_alpha_source;
+        u8 output;
+    };
+
+    std::vector<Stage> stages;
+    /// Register file contents which do not depend on the fragment
+    std::array<Common::Vec4<u8>, NumSlots> initial_slots{};
+    u8 output_slot = Zero;
+    bool uses_fragment_lighting = false;
+};
+
+/**
+ * Returns the TEV program for the given register state, building it on the first use. Lookups are
+ * thread-safe. The returned reference remains valid until the next call from the same thread.
+ */
+const TevProgram& GetTevProgram(const TexturingRegs& regs);
+
+} // namespace Pica::Rasterizer
@@ -237,4 +237,147 @@ u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
     }
 };
 
+template <TevStageConfig::ColorModifier factor>
+static Common::Vec3<u8> ColorModifierImpl(const Common::Vec4<u8>& values) {
+    return GetColorModifier(factor, values);
+}
+
+template <TevStageConfig::AlphaModifier factor>
+static u8 AlphaModifierImpl(const Common::Vec4<u8>& values) {
+    return GetAlphaModifier(factor, values);
+}
+
+template <TevStageConfig::Operation op>
+static Common::Vec3<u8> ColorCombineImpl(const Common::Vec3<u8> input[3]) {
+    return ColorCombine(op, input);
+}
+
+template <TevStageConfig::Operation op>
+static u8 AlphaCombineImpl(const std::array<u8, 3>& input) {
+    return AlphaCombine(op, input);
+}
+
+static Common::Vec3<u8> UnknownColorCombine(const Common::Vec3<u8> input[3]) {
+    return {0, 0, 0};
+}
+
+static u8 UnknownAlphaCombine(const std::array<u8, 3>& input) {
+    return 0;
+}
+
+ColorModifierFunc GetColorModifierFunc(TevStageConfig::ColorModifier factor) {
+    using ColorModifier = TevStageConfig::ColorModifier;
+
+    switch (factor) {
+    case ColorModifier::SourceColor:
+        return ColorModifierImpl<ColorModifier::SourceColor>;
+    case ColorModifier::OneMinusSourceColor:
+        return ColorModifierImpl<ColorModifier::OneMinusSourceColor>;
+    case ColorModifier::SourceAlpha:
+        return ColorModifierImpl<ColorModifier::SourceAlpha>;
+    case ColorModifier::OneMinusSourceAlpha:
+        return ColorModifierImpl<ColorModifier::OneMinusSourceAlpha>;
+    case ColorModifier::SourceRed:
+        return ColorModifierImpl<ColorModifier::SourceRed>;
+    case ColorModifier::OneMinusSourceRed:
+        return ColorModifierImpl<ColorModifier::OneMinusSourceRed>;
+    case ColorModifier::SourceGreen:
+        return ColorModifierImpl<ColorModifier::SourceGreen>;
+    case ColorModifier::OneMinusSourceGreen:
+        return ColorModifierImpl<ColorModifier::OneMinusSourceGreen>;
+    case ColorModifier::SourceBlue:
+        return ColorModifierImpl<ColorModifier::SourceBlue>;
+    case ColorModifier::OneMinusSourceBlue:
+        return ColorModifierImpl<ColorModifier::OneMinusSourceBlue>;
+    }
+
+    LOG_ERROR(HW_GPU, "Unknown color modifier {}", static_cast<u32>(factor));
+    UNIMPLEMENTED();
+    return ColorModifierImpl<ColorModifier::SourceColor>;
+}
+
+AlphaModifierFunc GetAlphaModifierFunc(TevStageConfig::AlphaModifier factor) {
+    using AlphaModifier = TevStageConfig::AlphaModifier;
+
+    switch (factor) {
+    case AlphaModifier::SourceAlpha:
+        return AlphaModifierImpl<AlphaModifier::SourceAlpha>;
+    case AlphaModifier::OneMinusSourceAlpha:
+        return AlphaModifierImpl<AlphaModifier::OneMinusSourceAlpha>;
+    case AlphaModifier::SourceRed:
+        return AlphaModifierImpl<AlphaModifier::SourceRed>;
+    case AlphaModifier::OneMinusSourceRed:
+        return AlphaModifierImpl<AlphaModifier::OneMinusSourceRed>;
+    case AlphaModifier::SourceGreen:
+        return AlphaModifierImpl<AlphaModifier::SourceGreen>;
+    case AlphaModifier::OneMinusSourceGreen:
+        return AlphaModifierImpl<AlphaModifier::OneMinusSourceGreen>;
+    case AlphaModifier::SourceBlue:
+        return AlphaModifierImpl<AlphaModifier::SourceBlue>;
+    case AlphaModifier::OneMinusSourceBlue:
+        return AlphaModifierImpl<AlphaModifier::OneMinusSourceBlue>;
+    }
+
+    LOG_ERROR(HW_GPU, "Unknown alpha modifier {}", static_cast<u32>(factor));
+    UNIMPLEMENTED();
+    return AlphaModifierImpl<AlphaModifier::SourceAlpha>;
+}
+
+ColorCombineFunc GetColorCombineFunc(TevStageConfig::Operation op) {
+    using Operation = TevStageConfig::Operation;
+
+    switch (op) {
+    case Operation::Replace:
+        return ColorCombineImpl<Operation::Replace>;
+    case Operation::Modulate:
+        return ColorCombineImpl<Operation::Modulate>;
+    case Operation::Add:
+        return ColorCombineImpl<Operation::Add>;
+    case Operation::AddSigned:
+        return ColorCombineImpl<Operation::AddSigned>;
+    case Operation::Lerp:
+        return ColorCombineImpl<Operation::Lerp>;
+    case Operation::Subtract:
+        return ColorCombineImpl<Operation::Subtract>;
+    case Operation::MultiplyThenAdd:
+        return ColorCombineImpl<Operation::MultiplyThenAdd>;
+    case Operation::AddThenMultiply:
+        return ColorCombineImpl<Operation::AddThenMultiply>;
+    case Operation::Dot3_RGB:
+    case Operation::Dot3_RGBA:
+        return ColorCombineImpl<Operation::Dot3_RGB>;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown color combiner operation {}", static_cast<u32>(op));
+        UNIMPLEMENTED();
+        return UnknownColorCombine;
+    }
+}
+
+AlphaCombineFunc GetAlphaCombineFunc(TevStageConfig::Operation op) {
+    using Operation = TevStageConfig::Operation;
+
+    switch (op) {
+    case Operation::Replace:
+        return AlphaCombineImpl<Operation::Replace>;
+    case Operation::Modulate:
+        return AlphaCombineImpl<Operation::Modulate>;
+    case Operation::Add:
+        return AlphaCombineImpl<Operation::Add>;
+    case Operation::AddSigned:
+        return AlphaCombineImpl<Operation::AddSigned>;
+    case Operation::Lerp:
+        return AlphaCombineImpl<Operation::Lerp>;
+    case Operation::Subtract:
+        return AlphaCombineImpl<Operation::Subtract>;
+    case Operation::MultiplyThenAdd:
+        return AlphaCombineImpl<Operation::MultiplyThenAdd>;
+    case Operation::AddThenMultiply:
+        return AlphaCombineImpl<Operation::AddThenMultiply>;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown alpha combiner operation {}", static_cast<u32>(op));
+        UNIMPLEMENTED();
+        return UnknownAlphaCombine;
+    }
+}
+
 } // namespace Pica::Rasterizer
@@ -23,4 +23,20 @@ Common::Vec3<u8> ColorCombine(TexturingRegs::TevStageConfig::Operation op,
 
 u8 AlphaCombine(TexturingRegs::TevStageConfig::Operation op, const std::array<u8, 3>& input);
 
+using ColorModifierFunc = Common::Vec3<u8> (*)(const Common::Vec4<u8>& values);
+using AlphaModifierFunc = u8 (*)(const Common::Vec4<u8>& values);
+using ColorCombineFunc = Common::Vec3<u8> (*)(const Common::Vec3<u8> input[3]);
+using AlphaCombineFunc = u8 (*)(const std::array<u8, 3>& input);
+
+// The following return versions of the functions above which are specialized for a single
+// modifier or operation, so that the switch over the configuration is resolved only once.
+
+ColorModifierFunc GetColorModifierFunc(TexturingRegs::TevStageConfig::ColorModifier factor);
+
+AlphaModifierFunc GetAlphaModifierFunc(TexturingRegs::TevStageConfig::AlphaModifier factor);
+
+ColorCombineFunc GetColorCombineFunc(TexturingRegs::TevStageConfig::Operation op);
+
+AlphaCombineFunc GetAlphaCombineFunc(TexturingRegs::TevStageConfig::Operation op);
+
 } // namespace Pica::Rasterizer
@@ -4,6 +4,9 @@
 
 #include <algorithm>
 #include <array>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "common/bit_field.h"
 #include "common/color.h"
 #include "common/common_types.h"
@@ -69,19 +72,14 @@ union ETC1Tile {
         BitField<60, 4, u64> r1;
     } separate;
 
-    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
-        int texel = 4 * x + y;
-
-        if (flip)
-            std::swap(x, y);
-
-        // Lookup base value
+    /// Returns the base color of the first (half == 0) or second half of the subtile
+    Common::Vec3<int> GetBaseColor(unsigned int half) const {
         Common::Vec3<int> ret;
         if (differential_mode) {
             ret.r() = static_cast<int>(differential.r);
             ret.g() = static_cast<int>(differential.g);
             ret.b() = static_cast<int>(differential.b);
-            if (x >= 2) {
+            if (half != 0) {
                 ret.r() += static_cast<int>(differential.dr);
                 ret.g() += static_cast<int>(differential.dg);
                 ret.b() += static_cast<int>(differential.db);
@@ -89,17 +87,26 @@ union ETC1Tile {
             ret.r() = Color::Convert5To8(ret.r());
             ret.g() = Color::Convert5To8(ret.g());
             ret.b() = Color::Convert5To8(ret.b());
+        } else if (half == 0) {
+            ret.r() = Color::Convert4To8(static_cast<u8>(separate.r1));
+            ret.g() = Color::Convert4To8(static_cast<u8>(separate.g1));
+            ret.b() = Color::Convert4To8(static_cast<u8>(separate.b1));
         } else {
-            if (x < 2) {
-                ret.r() = Color::Convert4To8(static_cast<u8>(separate.r1));
-                ret.g() = Color::Convert4To8(static_cast<u8>(separate.g1));
-                ret.b() = Color::Convert4To8(static_cast<u8>(separate.b1));
-            } else {
-                ret.r() = Color::Convert4To8(static_cast<u8>(separate.r2));
-                ret.g() = Color::Convert4To8(static_cast<u8>(separate.g2));
-                ret.b() = Color::Convert4To8(static_cast<u8>(separate.b2));
-            }
+            ret.r() = Color::Convert4To8(static_cast<u8>(separate.r2));
+            ret.g() = Color::Convert4To8(static_cast<u8>(separate.g2));
+            ret.b() = Color::Convert4To8(static_cast<u8>(separate.b2));
         }
+        return ret;
+    }
+
+    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
+        int texel = 4 * x + y;
+
+        if (flip)
+            std::swap(x, y);
+
+        // Lookup base value
+        Common::Vec3<int> ret = GetBaseColor(x < 2 ? 0 : 1);
 
         // Add modifier
         unsigned table_index =
@@ -124,4 +131,58 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, Common::Vec4<u8>* dest) {
+    const ETC1Tile tile{value};
+
+    // Each texel is one of the two base colors with its modifier added or subtracted. The base
+    // colors and the modifier tables only have to be looked up once for the whole subtile.
+    std::array<u32, 2> base_colors;
+    std::array<std::array<u8, 2>, 2> modifiers;
+    for (unsigned int half = 0; half < 2; ++half) {
+        const Common::Vec3<int> base = tile.GetBaseColor(half);
+        base_colors[half] = static_cast<u32>(base.r()) | static_cast<u32>(base.g()) << 8 |
+                            static_cast<u32>(base.b()) << 16 | 0xFF000000;
+        modifiers[half] = etc1_modifier_table[half == 0 ? tile.table_index_1.Value()
+                                                        : tile.table_index_2.Value()];
+    }
+
+    alignas(16) std::array<u32, 16> bases;
+    alignas(16) std::array<u32, 16> magnitudes;
+    alignas(16) std::array<u32, 16> negations;
+    for (unsigned int y = 0; y < 4; ++y) {
+        for (unsigned int x = 0; x < 4; ++x) {
+            const unsigned int texel = 4 * x + y;
+            const unsigned int half = (tile.flip ? y : x) < 2 ? 0 : 1;
+            const u32 modifier = modifiers[half][tile.GetTableSubIndex(texel)];
+            bases[y * 4 + x] = base_colors[half];
+            // The alpha channel is left unmodified
+            magnitudes[y * 4 + x] = modifier * 0x010101;
+            negations[y * 4 + x] = tile.GetNegationFlag(texel) ? 0xFFFFFFFF : 0;
+        }
+    }
+
+#ifdef ARCHITECTURE_x86_64
+    for (std::size_t i = 0; i < bases.size(); i += 4) {
+        const __m128i base = _mm_load_si128(reinterpret_cast<const __m128i*>(&bases[i]));
+        const __m128i magnitude =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(&magnitudes[i]));
+        const __m128i negation = _mm_load_si128(reinterpret_cast<const __m128i*>(&negations[i]));
+        // Saturating byte arithmetic clamps each channel to [0, 255]
+        const __m128i result = _mm_or_si128(
+            _mm_and_si128(negation, _mm_subs_epu8(base, magnitude)),
+            _mm_andnot_si128(negation, _mm_adds_epu8(base, magnitude)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), result);
+    }
+#else
+    for (std::size_t i = 0; i < bases.size(); ++i) {
+        const int sign = negations[i] != 0 ? -1 : 1;
+        const int modifier = sign * static_cast<int>(magnitudes[i] & 0xFF);
+        dest[i] = {static_cast<u8>(std::clamp(int(bases[i] & 0xFF) + modifier, 0, 255)),
+                   static_cast<u8>(std::clamp(int(bases[i] >> 8 & 0xFF) + modifier, 0, 255)),
+                   static_cast<u8>(std::clamp(int(bases[i] >> 16 & 0xFF) + modifier, 0, 255)),
+                   255};
+    }
+#endif
+}
+
 } // namespace Pica::Texture
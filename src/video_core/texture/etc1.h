@@ -11,4 +11,11 @@ namespace Pica::Texture {
 
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/**
+ * Decodes all the texels of a 4x4 ETC1 subtile at once.
+ * @param value Encoded subtile
+ * @param dest Receives the 16 texels with an alpha of 255, the texel (x, y) at index y * 4 + x
+ */
+void DecodeETC1Subtile(u64 value, Common::Vec4<u8>* dest);
+
 } // namespace Pica::Texture
@@ -2,6 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -20,6 +26,338 @@ namespace Pica::Texture {
 constexpr std::size_t TILE_SIZE = 8 * 8;
 constexpr std::size_t ETC1_SUBTILES = 2 * 2;
 
+namespace {
+
+/// Linear index (y * 8 + x) of each texel of a tile, in the Morton order texels are stored in
+constexpr std::array<u8, TILE_SIZE> morton_to_linear = [] {
+    std::array<u8, TILE_SIZE> table{};
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            table[VideoCore::MortonInterleave(x, y)] = static_cast<u8>(y * 8 + x);
+        }
+    }
+    return table;
+}();
+
+/// Decodes the texels of a tile of a non-ETC format, in the order they are stored in
+void DecodeMortonTexels(const u8* source, TextureFormat format, Common::Vec4<u8>* dest) {
+    switch (format) {
+    case TextureFormat::RGBA8:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = Color::DecodeRGBA8(source + i * 4);
+        }
+        break;
+    case TextureFormat::RGB8:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = Color::DecodeRGB8(source + i * 3);
+        }
+        break;
+    case TextureFormat::RGB5A1:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = Color::DecodeRGB5A1(source + i * 2);
+        }
+        break;
+    case TextureFormat::RGB565:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = Color::DecodeRGB565(source + i * 2);
+        }
+        break;
+    case TextureFormat::RGBA4:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = Color::DecodeRGBA4(source + i * 2);
+        }
+        break;
+    case TextureFormat::IA8:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            const u8 intensity = source[i * 2 + 1];
+            dest[i] = {intensity, intensity, intensity, source[i * 2]};
+        }
+        break;
+    case TextureFormat::RG8:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = Color::DecodeRG8(source + i * 2);
+        }
+        break;
+    case TextureFormat::I8:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = {source[i], source[i], source[i], 255};
+        }
+        break;
+    case TextureFormat::A8:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = {0, 0, 0, source[i]};
+        }
+        break;
+    case TextureFormat::IA4:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            const u8 intensity = Color::Convert4To8(source[i] >> 4);
+            dest[i] = {intensity, intensity, intensity, Color::Convert4To8(source[i] & 0xF)};
+        }
+        break;
+    case TextureFormat::I4:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            const u8 intensity = Color::Convert4To8((source[i / 2] >> (4 * (i % 2))) & 0xF);
+            dest[i] = {intensity, intensity, intensity, 255};
+        }
+        break;
+    case TextureFormat::A4:
+        for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+            dest[i] = {0, 0, 0, Color::Convert4To8((source[i / 2] >> (4 * (i % 2))) & 0xF)};
+        }
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown texture format: {:x}", static_cast<u32>(format));
+        DEBUG_ASSERT(false);
+        std::fill_n(dest, TILE_SIZE, Common::Vec4<u8>{});
+        break;
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+// The SSE2 kernels work on 16-bit lanes holding one texel each, and build the texels from their
+// (r | g << 8) and (b | a << 8) halves.
+
+__m128i Load(const u8* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+/// Stores 8 texels given their (r | g << 8) and (b | a << 8) lanes
+void StoreTexels(__m128i rg, __m128i ba, Common::Vec4<u8>* dest) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), _mm_unpackhi_epi16(rg, ba));
+}
+
+/// Vectorized Color::Convert4To8, Convert5To8 and Convert6To8 on 16-bit lanes
+__m128i Expand4(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 4), value);
+}
+
+__m128i Expand5(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+__m128i Expand6(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+}
+
+__m128i Field(__m128i pixels, int shift, u16 mask) {
+    return _mm_and_si128(_mm_srli_epi16(pixels, shift), _mm_set1_epi16(mask));
+}
+
+/// Stores 16 texels given as one intensity byte each, with the alpha bytes in alpha
+void StoreIntensity(__m128i intensity, __m128i alpha, Common::Vec4<u8>* dest) {
+    StoreTexels(_mm_unpacklo_epi8(intensity, intensity), _mm_unpacklo_epi8(intensity, alpha),
+                dest);
+    StoreTexels(_mm_unpackhi_epi8(intensity, intensity), _mm_unpackhi_epi8(intensity, alpha),
+                dest + 8);
+}
+
+/// Stores 16 texels given as one alpha byte each
+void StoreAlpha(__m128i alpha, Common::Vec4<u8>* dest) {
+    const __m128i zero = _mm_setzero_si128();
+    StoreTexels(zero, _mm_unpacklo_epi8(zero, alpha), dest);
+    StoreTexels(zero, _mm_unpackhi_epi8(zero, alpha), dest + 8);
+}
+
+/// Splits 16 bytes into the 32 nibbles they hold, expanded to 8 bits, in storage order
+void ExpandNibbles(__m128i bytes, __m128i& first, __m128i& second) {
+    const __m128i mask = _mm_set1_epi8(0xF);
+    const __m128i low = _mm_and_si128(bytes, mask);
+    const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+    // The values are below 16, so the 16-bit shift does not carry into the neighbouring byte
+    first = _mm_unpacklo_epi8(low, high);
+    second = _mm_unpackhi_epi8(low, high);
+    first = _mm_or_si128(first, _mm_slli_epi16(first, 4));
+    second = _mm_or_si128(second, _mm_slli_epi16(second, 4));
+}
+
+/// SSE2 variant of DecodeMortonTexels, returns false for the formats it does not handle
+bool DecodeMortonTexelsSSE2(const u8* source, TextureFormat format, Common::Vec4<u8>* dest) {
+    switch (format) {
+    case TextureFormat::RGBA8:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 4) {
+            // Reverse the bytes of each texel: swap the 16-bit halves, then the bytes in them
+            __m128i texels = Load(source + i * 4);
+            texels = _mm_shufflelo_epi16(texels, _MM_SHUFFLE(2, 3, 0, 1));
+            texels = _mm_shufflehi_epi16(texels, _MM_SHUFFLE(2, 3, 0, 1));
+            texels = _mm_or_si128(_mm_slli_epi16(texels, 8), _mm_srli_epi16(texels, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), texels);
+        }
+        return true;
+    case TextureFormat::RGB5A1:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+            const __m128i pixels = Load(source + i * 2);
+            const __m128i r = Expand5(_mm_srli_epi16(pixels, 11));
+            const __m128i g = Expand5(Field(pixels, 6, 0x1F));
+            const __m128i b = Expand5(Field(pixels, 1, 0x1F));
+            const __m128i a = _mm_sub_epi16(_mm_setzero_si128(), Field(pixels, 0, 0x1));
+            StoreTexels(_mm_or_si128(r, _mm_slli_epi16(g, 8)),
+                        _mm_or_si128(b, _mm_slli_epi16(a, 8)), dest + i);
+        }
+        return true;
+    case TextureFormat::RGB565:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+            const __m128i pixels = Load(source + i * 2);
+            const __m128i r = Expand5(_mm_srli_epi16(pixels, 11));
+            const __m128i g = Expand6(Field(pixels, 5, 0x3F));
+            const __m128i b = Expand5(Field(pixels, 0, 0x1F));
+            StoreTexels(_mm_or_si128(r, _mm_slli_epi16(g, 8)),
+                        _mm_or_si128(b, _mm_set1_epi16(static_cast<s16>(0xFF00))), dest + i);
+        }
+        return true;
+    case TextureFormat::RGBA4:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+            const __m128i pixels = Load(source + i * 2);
+            const __m128i r = Expand4(_mm_srli_epi16(pixels, 12));
+            const __m128i g = Expand4(Field(pixels, 8, 0xF));
+            const __m128i b = Expand4(Field(pixels, 4, 0xF));
+            const __m128i a = Expand4(Field(pixels, 0, 0xF));
+            StoreTexels(_mm_or_si128(r, _mm_slli_epi16(g, 8)),
+                        _mm_or_si128(b, _mm_slli_epi16(a, 8)), dest + i);
+        }
+        return true;
+    case TextureFormat::IA8:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+            // Each pixel is (a | i << 8)
+            const __m128i pixels = Load(source + i * 2);
+            const __m128i intensity = _mm_srli_epi16(pixels, 8);
+            StoreTexels(_mm_or_si128(intensity, _mm_slli_epi16(intensity, 8)),
+                        _mm_or_si128(intensity, _mm_slli_epi16(pixels, 8)), dest + i);
+        }
+        return true;
+    case TextureFormat::RG8:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+            const __m128i pixels = Load(source + i * 2);
+            StoreTexels(_mm_or_si128(_mm_srli_epi16(pixels, 8), _mm_slli_epi16(pixels, 8)),
+                        _mm_set1_epi16(static_cast<s16>(0xFF00)), dest + i);
+        }
+        return true;
+    case TextureFormat::I8:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+            StoreIntensity(Load(source + i), _mm_set1_epi8(static_cast<char>(0xFF)), dest + i);
+        }
+        return true;
+    case TextureFormat::A8:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+            StoreAlpha(Load(source + i), dest + i);
+        }
+        return true;
+    case TextureFormat::IA4:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+            // Each 16-bit lane holds the expanded alpha (low nibble) and intensity of a texel
+            __m128i first, second;
+            ExpandNibbles(Load(source + i), first, second);
+            const __m128i mask = _mm_set1_epi16(0xFF);
+            const __m128i intensity =
+                _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8));
+            const __m128i alpha =
+                _mm_packus_epi16(_mm_and_si128(first, mask), _mm_and_si128(second, mask));
+            StoreIntensity(intensity, alpha, dest + i);
+        }
+        return true;
+    case TextureFormat::I4:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 32) {
+            __m128i first, second;
+            ExpandNibbles(Load(source + i / 2), first, second);
+            const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+            StoreIntensity(first, alpha, dest + i);
+            StoreIntensity(second, alpha, dest + i + 16);
+        }
+        return true;
+    case TextureFormat::A4:
+        for (std::size_t i = 0; i < TILE_SIZE; i += 32) {
+            __m128i first, second;
+            ExpandNibbles(Load(source + i / 2), first, second);
+            StoreAlpha(first, dest + i);
+            StoreAlpha(second, dest + i + 16);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+#endif // ARCHITECTURE_x86_64
+
+void DecodeETC1Tile(const u8* source, bool has_alpha, Common::Vec4<u8>* dest) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+    std::array<Common::Vec4<u8>, 16> subtile_texels;
+
+    // ETC1 further subdivides each 8x8 tile into four 4x4 subtiles
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+
+        u64_le packed_alpha = 0;
+        if (has_alpha) {
+            std::memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        std::memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Subtile(subtile_data, subtile_texels.data());
+
+        const unsigned int subtile_x = (subtile_index % 2) * 4;
+        const unsigned int subtile_y = (subtile_index / 2) * 4;
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                Common::Vec4<u8>& texel = dest[(subtile_y + y) * 8 + subtile_x + x];
+                texel = subtile_texels[y * 4 + x];
+                if (has_alpha) {
+                    texel.a() = Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                }
+            }
+        }
+    }
+}
+
+} // Anonymous namespace
+
+void DecodeTile(const u8* source, TextureFormat format, Common::Vec4<u8>* dest) {
+    if (format == TextureFormat::ETC1 || format == TextureFormat::ETC1A4) {
+        DecodeETC1Tile(source, format == TextureFormat::ETC1A4, dest);
+        return;
+    }
+
+    std::array<Common::Vec4<u8>, TILE_SIZE> texels;
+#ifdef ARCHITECTURE_x86_64
+    const bool decoded = DecodeMortonTexelsSSE2(source, format, texels.data());
+#else
+    const bool decoded = false;
+#endif
+    if (!decoded) {
+        DecodeMortonTexels(source, format, texels.data());
+    }
+
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        dest[morton_to_linear[i]] = texels[i];
+    }
+}
+
+void DecodeTexture(const u8* source, const TextureInfo& info, unsigned int x_begin,
+                   unsigned int y_begin, unsigned int x_end, unsigned int y_end, u8* dest,
+                   std::ptrdiff_t dest_stride) {
+    const std::size_t tile_size = CalculateTileSize(info.format);
+    std::array<Common::Vec4<u8>, TILE_SIZE> texels;
+
+    for (unsigned int tile_y = y_begin & ~7u; tile_y < y_end; tile_y += 8) {
+        const u8* line = source + (tile_y / 8) * info.stride;
+        const unsigned int row_begin = std::max(tile_y, y_begin);
+        const unsigned int row_end = std::min(tile_y + 8, y_end);
+
+        for (unsigned int tile_x = x_begin & ~7u; tile_x < x_end; tile_x += 8) {
+            DecodeTile(line + (tile_x / 8) * tile_size, info.format, texels.data());
+
+            // Only the part of the tile within the rectangle is written
+            const unsigned int column_begin = std::max(tile_x, x_begin);
+            const unsigned int columns = std::min(tile_x + 8, x_end) - column_begin;
+            for (unsigned int y = row_begin; y < row_end; ++y) {
+                std::memcpy(dest + y * dest_stride + column_begin * 4,
+                            &texels[(y - tile_y) * 8 + column_begin - tile_x], columns * 4);
+            }
+        }
+    }
+}
+
 size_t CalculateTileSize(TextureFormat format) {
     switch (format) {
     case TextureFormat::RGBA8:
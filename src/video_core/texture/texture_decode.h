@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_texturing.h"
@@ -55,4 +57,55 @@ Common::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
 Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
                                    const TextureInfo& info, bool disable_alpha);
 
+/**
+ * Decodes all the texels of a single 8x8 texture tile at once. This is much faster than looking
+ * them up one by one, as the tile layout and the format are only handled once.
+ *
+ * @param source Pointer to the beginning of the tile.
+ * @param format Format of the tile.
+ * @param dest Receives the 64 texels of the tile, the texel (x, y) at index y * 8 + x, using the
+ *             same in-tile coordinates as LookupTexelInTile.
+ */
+void DecodeTile(const u8* source, TexturingRegs::TextureFormat format, Common::Vec4<u8>* dest);
+
+/**
+ * Decodes a rectangle of texels of a texture, as RGBA8.
+ *
+ * @param source Source pointer to read data from
+ * @param info TextureInfo object describing the texture setup
+ * @param x_begin,y_begin,x_end,y_end Texel coordinates of the rectangle, in the coordinate system
+ *                                    of LookupTexture. The end coordinates are exclusive.
+ * @param dest Destination of the texel (0, 0), the texel (x, y) is written to
+ *             dest + y * dest_stride + x * 4.
+ * @param dest_stride Distance in bytes between two rows of the destination. A negative stride
+ *                    flips the texture vertically.
+ */
+void DecodeTexture(const u8* source, const TextureInfo& info, unsigned int x_begin,
+                   unsigned int y_begin, unsigned int x_end, unsigned int y_end, u8* dest,
+                   std::ptrdiff_t dest_stride);
+
+/**
+ * Looks up texels like LookupTexture, but decodes the whole tile of a texel and keeps it around.
+ * This pays off for lookups which mostly hit the same tile in a row, e.g. when sampling a texture
+ * for neighbouring pixels.
+ */
+class TileCache {
+public:
+    Common::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
+                                   const TextureInfo& info) {
+        const u8* tile = source + (y / 8) * info.stride + (x / 8) * CalculateTileSize(info.format);
+        if (tile != cached_tile || info.format != cached_format) {
+            DecodeTile(tile, info.format, texels.data());
+            cached_tile = tile;
+            cached_format = info.format;
+        }
+        return texels[(y % 8) * 8 + x % 8];
+    }
+
+private:
+    const u8* cached_tile = nullptr;
+    TexturingRegs::TextureFormat cached_format{};
+    std::array<Common::Vec4<u8>, 8 * 8> texels;
+};
+
 } // namespace Pica::Texture
@@ -1,9 +1,13 @@
+#include <cstring>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include <boost/range/algorithm/fill.hpp>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
@@ -13,20 +17,137 @@
 #include "video_core/regs_pipeline.h"
 #include "video_core/shader/shader.h"
 #include "video_core/vertex_loader.h"
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/vertex_loader_jit_x64.h"
+#endif // ARCHITECTURE_x86_64
 #include "video_core/video_core.h"
 
 namespace Pica {
 
+namespace {
+
+using LoadAttributeFunc = void (*)(const u8* data, Common::Vec4<float24>& attribute);
+
+template <typename T, u32 NumElements>
+void LoadAttribute(const u8* data, Common::Vec4<float24>& attribute) {
+    T values[NumElements];
+    std::memcpy(values, data, sizeof(values));
+    for (u32 comp = 0; comp < NumElements; ++comp) {
+        attribute[comp] = float24::FromFloat32(static_cast<float>(values[comp]));
+    }
+
+    // Default attribute values set if array elements have < 4 components. This
+    // is *not* carried over from the default attribute settings even if they're
+    // enabled for this attribute.
+    for (u32 comp = NumElements; comp < 4; ++comp) {
+        attribute[comp] = comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+    }
+}
+
+template <typename T>
+constexpr std::array<LoadAttributeFunc, 4> load_attribute_funcs = {
+    LoadAttribute<T, 1>, LoadAttribute<T, 2>, LoadAttribute<T, 3>, LoadAttribute<T, 4>};
+
+LoadAttributeFunc GetLoadAttributeFunc(PipelineRegs::VertexAttributeFormat format, u32 elements) {
+    using Format = PipelineRegs::VertexAttributeFormat;
+
+    ASSERT(elements >= 1 && elements <= 4);
+    switch (format) {
+    case Format::BYTE:
+        return load_attribute_funcs<s8>[elements - 1];
+    case Format::UBYTE:
+        return load_attribute_funcs<u8>[elements - 1];
+    case Format::SHORT:
+        return load_attribute_funcs<s16>[elements - 1];
+    case Format::FLOAT:
+        return load_attribute_funcs<float>[elements - 1];
+    }
+    UNREACHABLE();
+    return nullptr;
+}
+
+/// Portable loader calling a conversion function specialized for each attribute's format
+class TemplateVertexLoader final : public CompiledVertexLoader {
+public:
+    explicit TemplateVertexLoader(const VertexLayout& layout) {
+        for (int i = 0; i < layout.num_total_attributes; ++i) {
+            if (layout.elements[i] != 0) {
+                loads.push_back({static_cast<u8>(i), layout.strides[i],
+                                 GetLoadAttributeFunc(layout.formats[i], layout.elements[i])});
+            } else if (layout.is_default[i]) {
+                defaults.push_back(static_cast<u8>(i));
+            }
+        }
+    }
+
+    void Load(const std::array<const u8*, 16>& attribute_data, u32 vertex,
+              Shader::AttributeBuffer& input,
+              const Shader::AttributeBuffer& default_attributes) const override {
+        for (const AttributeLoad& load : loads) {
+            load.func(attribute_data[load.attribute] + load.stride * vertex,
+                      input.attr[load.attribute]);
+        }
+        for (u8 attribute : defaults) {
+            input.attr[attribute] = default_attributes.attr[attribute];
+        }
+    }
+
+private:
+    struct AttributeLoad {
+        u8 attribute;
+        u32 stride;
+        LoadAttributeFunc func;
+    };
+
+    std::vector<AttributeLoad> loads;
+    std::vector<u8> defaults;
+};
+
+/**
+ * Returns the loader compiled for the given layout, compiling it on the first use. Loaders are
+ * compiled to native code if the shader JIT is enabled.
+ */
+const CompiledVertexLoader& GetCompiledVertexLoader(const VertexLayout& layout) {
+    static std::unordered_map<u64, std::unique_ptr<CompiledVertexLoader>> template_cache;
+#ifdef ARCHITECTURE_x86_64
+    static std::unordered_map<u64, std::unique_ptr<CompiledVertexLoader>> jit_cache;
+    const bool use_jit = VideoCore::g_shader_jit_enabled;
+    auto& cache = use_jit ? jit_cache : template_cache;
+#else
+    constexpr bool use_jit = false;
+    auto& cache = template_cache;
+#endif // ARCHITECTURE_x86_64
+
+    const u64 cache_key = Common::ComputeHash64(&layout, sizeof(layout));
+    auto iter = cache.find(cache_key);
+    if (iter == cache.end()) {
+        std::unique_ptr<CompiledVertexLoader> loader;
+#ifdef ARCHITECTURE_x86_64
+        if (use_jit) {
+            loader = std::make_unique<VertexLoaderJitX64>(layout);
+        }
+#endif // ARCHITECTURE_x86_64
+        if (!use_jit) {
+            loader = std::make_unique<TemplateVertexLoader>(layout);
+        }
+        iter = cache.emplace_hint(iter, cache_key, std::move(loader));
+    }
+    return *iter->second;
+}
+
+} // Anonymous namespace
+
 void VertexLoader::Setup(const PipelineRegs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
     const auto& attribute_config = regs.vertex_attributes;
-    num_total_attributes = attribute_config.GetNumTotalAttributes();
+    base_address = attribute_config.GetPhysicalBaseAddress();
+    layout.num_total_attributes = attribute_config.GetNumTotalAttributes();
 
     boost::fill(vertex_attribute_sources, 0xdeadbeef);
 
     for (int i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
+        layout.is_default[i] = attribute_config.IsDefaultAttribute(i);
     }
 
     // Setup attribute data from loaders
@@ -49,11 +170,9 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
                 offset = Common::AlignUp(offset,
                                          attribute_config.GetElementSizeInBytes(attribute_index));
                 vertex_attribute_sources[attribute_index] = loader_config.data_offset + offset;
-                vertex_attribute_strides[attribute_index] =
-                    static_cast<u32>(loader_config.byte_count);
-                vertex_attribute_formats[attribute_index] =
-                    attribute_config.GetFormat(attribute_index);
-                vertex_attribute_elements[attribute_index] =
+                layout.strides[attribute_index] = static_cast<u32>(loader_config.byte_count);
+                layout.formats[attribute_index] = attribute_config.GetFormat(attribute_index);
+                layout.elements[attribute_index] =
                     attribute_config.GetNumElements(attribute_index);
                 offset += attribute_config.GetStride(attribute_index);
             } else if (attribute_index < 16) {
@@ -68,96 +187,41 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
         }
     }
 
+    // Resolve the memory the attributes are read from once for the whole draw
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        if (layout.elements[i] != 0) {
+            vertex_attribute_data[i] =
+                VideoCore::g_memory->GetPhysicalPointer(base_address + vertex_attribute_sources[i]);
+        }
+    }
+
+    compiled_loader = &GetCompiledVertexLoader(layout);
     is_setup = true;
 }
 
-void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
-                              Shader::AttributeBuffer& input,
-                              DebugUtils::MemoryAccessTracker& memory_accesses) {
+void VertexLoader::LoadVertex(int index, int vertex, Shader::AttributeBuffer& input,
+                              DebugUtils::MemoryAccessTracker& memory_accesses) const {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
-    for (int i = 0; i < num_total_attributes; ++i) {
-        if (vertex_attribute_elements[i] != 0) {
-            // Load per-vertex data from the loader arrays
-            u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
-
-            if (g_debug_context && Pica::g_debug_context->recorder) {
-                memory_accesses.AddAccess(
-                    source_addr,
-                    vertex_attribute_elements[i] *
-                        ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
-                             ? 4
-                             : (vertex_attribute_formats[i] ==
-                                PipelineRegs::VertexAttributeFormat::SHORT)
-                                   ? 2
-                                   : 1));
-            }
-
-            switch (vertex_attribute_formats[i]) {
-            case PipelineRegs::VertexAttributeFormat::BYTE: {
-                const s8* srcdata = reinterpret_cast<const s8*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
+    if (g_debug_context && Pica::g_debug_context->recorder) {
+        for (int i = 0; i < layout.num_total_attributes; ++i) {
+            if (layout.elements[i] != 0) {
+                const u32 element_size =
+                    layout.formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT
+                        ? 4
+                        : layout.formats[i] == PipelineRegs::VertexAttributeFormat::SHORT ? 2 : 1;
+                memory_accesses.AddAccess(base_address + vertex_attribute_sources[i] +
+                                              layout.strides[i] * vertex,
+                                          layout.elements[i] * element_size);
             }
-            case PipelineRegs::VertexAttributeFormat::UBYTE: {
-                const u8* srcdata = reinterpret_cast<const u8*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
-            }
-            case PipelineRegs::VertexAttributeFormat::SHORT: {
-                const s16* srcdata = reinterpret_cast<const s16*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
-            }
-            case PipelineRegs::VertexAttributeFormat::FLOAT: {
-                const float* srcdata = reinterpret_cast<const float*>(
-                    VideoCore::g_memory->GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
-                    input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-                }
-                break;
-            }
-            }
-
-            // Default attribute values set if array elements have < 4 components. This
-            // is *not* carried over from the default attribute settings even if they're
-            // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
-                input.attr[i][comp] =
-                    comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
-            }
-
-            LOG_TRACE(HW_GPU,
-                      "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
-                      "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
-                      input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                      input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else if (vertex_attribute_is_default[i]) {
-            // Load the default attribute if we're configured to do so
-            input.attr[i] = g_state.input_default_attributes.attr[i];
-            LOG_TRACE(
-                HW_GPU,
-                "Loaded default attribute {:x} for vertex {:x} (index {:x}): ({}, {}, {}, {})", i,
-                vertex, index, input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else {
-            // TODO(yuriks): In this case, no data gets loaded and the vertex
-            // remains with the last value it had. This isn't currently maintained
-            // as global state, however, and so won't work in Citra yet.
         }
     }
+
+    compiled_loader->Load(vertex_attribute_data, static_cast<u32>(vertex), input,
+                          g_state.input_default_attributes);
+
+    LOG_TRACE(HW_GPU, "Loaded {} attributes for vertex {:x} (index {:x}) from base 0x{:08x}",
+              layout.num_total_attributes, vertex, index, base_address);
 }
 
 } // namespace Pica
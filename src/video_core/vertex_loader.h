@@ -14,6 +14,36 @@ namespace Shader {
 struct AttributeBuffer;
 }
 
+/// Describes how each vertex shader input attribute is loaded, independently of where from
+struct VertexLayout {
+    std::array<u32, 16> strides{};
+    std::array<PipelineRegs::VertexAttributeFormat, 16> formats{};
+    /// Number of elements loaded from memory, 0 if the attribute is not loaded from memory
+    std::array<u32, 16> elements{};
+    std::array<bool, 16> is_default{};
+    int num_total_attributes = 0;
+};
+
+/**
+ * Routine loading vertices of a specific VertexLayout. All attributes of a vertex are read,
+ * converted and written to the attribute buffer in a single pass.
+ */
+class CompiledVertexLoader {
+public:
+    virtual ~CompiledVertexLoader() = default;
+
+    /**
+     * Loads a single vertex
+     * @param attribute_data Pointers to the data of vertex 0 of each attribute loaded from memory
+     * @param vertex Index of the vertex to load
+     * @param input Attribute buffer receiving the vertex
+     * @param default_attributes Values of the attributes configured as default attributes
+     */
+    virtual void Load(const std::array<const u8*, 16>& attribute_data, u32 vertex,
+                      Shader::AttributeBuffer& input,
+                      const Shader::AttributeBuffer& default_attributes) const = 0;
+};
+
 class VertexLoader {
 public:
     VertexLoader() = default;
@@ -22,20 +52,19 @@ public:
     }
 
     void Setup(const PipelineRegs& regs);
-    void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input,
-                    DebugUtils::MemoryAccessTracker& memory_accesses);
+    void LoadVertex(int index, int vertex, Shader::AttributeBuffer& input,
+                    DebugUtils::MemoryAccessTracker& memory_accesses) const;
 
     int GetNumTotalAttributes() const {
-        return num_total_attributes;
+        return layout.num_total_attributes;
     }
 
 private:
+    u32 base_address = 0;
     std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
-    int num_total_attributes = 0;
+    std::array<const u8*, 16> vertex_attribute_data{};
+    VertexLayout layout;
+    const CompiledVertexLoader* compiled_loader = nullptr;
     bool is_setup = false;
 };
 
@@ -0,0 +1,116 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+namespace Pica {
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+/// Pointer to the array holding the data pointer of each attribute
+static const Reg64 ATTRIBUTE_DATA = ABI_PARAM1.cvt64();
+/// Pointer to the attribute buffer receiving the vertex
+static const Reg64 INPUT = ABI_PARAM3.cvt64();
+/// Pointer to the values of the default attributes
+static const Reg64 DEFAULT_ATTRIBUTES = ABI_PARAM4.cvt64();
+/// Index of the vertex being loaded, zero-extended to 64 bits
+static const Reg64 VERTEX = r11;
+/// Address of the data of the attribute currently being loaded
+static const Reg64 SOURCE = rax;
+/// Scratch registers
+static const Reg64 SCRATCH = r10;
+static const Xmm SCRATCH_XMM = xmm0;
+
+/// Memory allocated for each compiled loader, enough for a layout loading all attributes
+constexpr std::size_t MAX_LOADER_SIZE = 4096;
+
+/// Bit pattern of 1.0f, the default value of the w component
+constexpr u32 FLOAT_ONE = 0x3F800000;
+
+VertexLoaderJitX64::VertexLoaderJitX64(const VertexLayout& layout)
+    : Xbyak::CodeGenerator(MAX_LOADER_SIZE) {
+    program = (CompiledLoader*)getCurr();
+
+    // Writing the 32-bit register clears the upper half
+    mov(VERTEX.cvt32(), ABI_PARAM2.cvt32());
+
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        if (layout.elements[i] != 0) {
+            Compile_LoadAttribute(layout, i);
+        } else if (layout.is_default[i]) {
+            Compile_CopyDefaultAttribute(i);
+        }
+    }
+
+    ret();
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_LOADER_SIZE, "Compiled a vertex loader that exceeds the allocated "
+                                             "size!");
+    LOG_DEBUG(HW_GPU, "Compiled vertex loader size={}", getSize());
+}
+
+void VertexLoaderJitX64::Compile_LoadAttribute(const VertexLayout& layout, int attribute) {
+    using Format = PipelineRegs::VertexAttributeFormat;
+
+    const Format format = layout.formats[attribute];
+    const u32 elements = layout.elements[attribute];
+    const int output_offset = attribute * static_cast<int>(sizeof(Common::Vec4<float24>));
+
+    mov(SOURCE, qword[ATTRIBUTE_DATA + attribute * static_cast<int>(sizeof(const u8*))]);
+    imul(SCRATCH, VERTEX, static_cast<int>(layout.strides[attribute]));
+    add(SOURCE, SCRATCH);
+
+    if (format == Format::FLOAT && elements == 4) {
+        movups(SCRATCH_XMM, xword[SOURCE]);
+        movups(xword[INPUT + output_offset], SCRATCH_XMM);
+        return;
+    }
+
+    for (u32 comp = 0; comp < elements; ++comp) {
+        const int dest_offset = output_offset + static_cast<int>(comp * sizeof(float24));
+        switch (format) {
+        case Format::BYTE:
+            movsx(SCRATCH.cvt32(), byte[SOURCE + comp]);
+            break;
+        case Format::UBYTE:
+            movzx(SCRATCH.cvt32(), byte[SOURCE + comp]);
+            break;
+        case Format::SHORT:
+            movsx(SCRATCH.cvt32(), word[SOURCE + comp * 2]);
+            break;
+        case Format::FLOAT:
+            // float24 is stored as a 32-bit float, so floats are copied unchanged
+            mov(SCRATCH.cvt32(), dword[SOURCE + comp * 4]);
+            mov(dword[INPUT + dest_offset], SCRATCH.cvt32());
+            continue;
+        }
+        cvtsi2ss(SCRATCH_XMM, SCRATCH.cvt32());
+        movss(dword[INPUT + dest_offset], SCRATCH_XMM);
+    }
+
+    // Default attribute values set if array elements have < 4 components. This is *not* carried
+    // over from the default attribute settings even if they're enabled for this attribute.
+    for (u32 comp = elements; comp < 4; ++comp) {
+        const int dest_offset = output_offset + static_cast<int>(comp * sizeof(float24));
+        mov(dword[INPUT + dest_offset], comp == 3 ? FLOAT_ONE : 0);
+    }
+}
+
+void VertexLoaderJitX64::Compile_CopyDefaultAttribute(int attribute) {
+    const int offset = attribute * static_cast<int>(sizeof(Common::Vec4<float24>));
+    movaps(SCRATCH_XMM, xword[DEFAULT_ATTRIBUTES + offset]);
+    movaps(xword[INPUT + offset], SCRATCH_XMM);
+}
+
+} // namespace Pica
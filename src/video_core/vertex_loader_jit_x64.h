@@ -0,0 +1,38 @@
+// Copyright 2019 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+/**
+ * Vertex loader compiled to x86_64 code for a specific layout. Strides, formats and element counts
+ * are embedded into the generated code, so loading a vertex involves no branching on the layout.
+ */
+class VertexLoaderJitX64 final : public CompiledVertexLoader, private Xbyak::CodeGenerator {
+public:
+    explicit VertexLoaderJitX64(const VertexLayout& layout);
+
+    void Load(const std::array<const u8*, 16>& attribute_data, u32 vertex,
+              Shader::AttributeBuffer& input,
+              const Shader::AttributeBuffer& default_attributes) const override {
+        program(attribute_data.data(), vertex, &input, &default_attributes);
+    }
+
+private:
+    void Compile_LoadAttribute(const VertexLayout& layout, int attribute);
+    void Compile_CopyDefaultAttribute(int attribute);
+
+    using CompiledLoader = void(const u8* const* attribute_data, u32 vertex,
+                                Shader::AttributeBuffer* input,
+                                const Shader::AttributeBuffer* default_attributes);
+    CompiledLoader* program = nullptr;
+};
+
+} // namespace Pica